@@ -0,0 +1,180 @@
+/**
+ * @file MtcControlClient.c
+ * @brief Sends commands to the generator's control socket, or measures its round trip.
+ *
+ * Build and run next to a generator with the control socket on (plugin "Control"
+ * toggle, or MTCGenDaemon --control):
+ *
+ *     cc -O2 MtcControlClient.c -o mtc-control
+ *     ./mtc-control status                       one command per argument
+ *     ./mtc-control begin "set 3 pre=10" "remove 7" commit
+ *     ./mtc-control < commands.txt               one command per line
+ *     ./mtc-control --bench 10000                round-trip latency of ping, status, list
+ *
+ * -s <path> picks the socket (default $XDG_RUNTIME_DIR/mtcgen.sock, else
+ * /tmp/mtcgen-<uid>.sock, as the generator does).
+ */
+
+/* nanosleep() and clock_gettime() are POSIX, hidden by a strict -std=c99 */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static char input[1 << 16];
+static size_t inputUsed = 0;
+
+static int connect_to(const char* path)
+{
+    struct sockaddr_un address;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    snprintf(address.sun_path, sizeof(address.sun_path), "%s", path);
+
+    if (fd < 0 || connect(fd, (const struct sockaddr*)&address, sizeof(address)) != 0)
+    {
+        perror(path);
+        exit(1);
+    }
+    return fd;
+}
+
+/* Reads one reply line into line (without the newline); returns 0 on EOF */
+static int read_line(int fd, char* line, size_t size)
+{
+    for (;;)
+    {
+        char* end = memchr(input, '\n', inputUsed);
+        if (end != NULL)
+        {
+            size_t length = (size_t)(end - input);
+            size_t copied = length < size - 1 ? length : size - 1;
+            memcpy(line, input, copied);
+            line[copied] = '\0';
+            inputUsed -= length + 1;
+            memmove(input, end + 1, inputUsed);
+            return 1;
+        }
+
+        ssize_t n = inputUsed < sizeof(input)
+            ? recv(fd, input + inputUsed, sizeof(input) - inputUsed, 0) : 0;
+        if (n <= 0)
+            return 0;
+        inputUsed += (size_t)n;
+    }
+}
+
+/* Sends one command and reads its whole reply ("list" adds one line per cue) */
+static int run_command(int fd, const char* command, int print)
+{
+    char line[4096];
+    size_t length = strlen(command);
+    int extra = 0;
+
+    if (send(fd, command, length, 0) < 0 || send(fd, "\n", 1, 0) < 0)
+        return 0;
+    if (!read_line(fd, line, sizeof(line)))
+        return 0;
+    if (print)
+        puts(line);
+
+    if (strncmp(command, "list", 4) == 0 && strncmp(line, "ok ", 3) == 0)
+        extra = atoi(line + 3);
+    while (extra-- > 0 && read_line(fd, line, sizeof(line)))
+        if (print)
+            puts(line);
+    return 1;
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench(int fd, const char* command, int count)
+{
+    double* times = malloc(sizeof(double) * (size_t)count);
+    int i;
+
+    for (i = 0; i < count; ++i)
+    {
+        double start = now_us();
+        if (!run_command(fd, command, 0))
+        {
+            fprintf(stderr, "connection closed\n");
+            exit(1);
+        }
+        times[i] = now_us() - start;
+    }
+
+    qsort(times, (size_t)count, sizeof(double), compare_doubles);
+    printf("%-8s n=%d  min %.1f us  median %.1f us  p99 %.1f us  max %.1f us\n",
+        command, count, times[0], times[count / 2], times[count * 99 / 100], times[count - 1]);
+    free(times);
+}
+
+int main(int argc, char** argv)
+{
+    char path[108];
+    const char* runtimeDir = getenv("XDG_RUNTIME_DIR");
+    int first = 1, benchCount = 0, fd, i;
+
+    if (runtimeDir != NULL && runtimeDir[0] != '\0')
+        snprintf(path, sizeof(path), "%s/mtcgen.sock", runtimeDir);
+    else
+        snprintf(path, sizeof(path), "/tmp/mtcgen-%d.sock", (int)getuid());
+
+    for (; first < argc && argv[first][0] == '-'; first += 2)
+    {
+        if (first + 1 >= argc)
+            break;
+        if (strcmp(argv[first], "-s") == 0)
+            snprintf(path, sizeof(path), "%s", argv[first + 1]);
+        else if (strcmp(argv[first], "--bench") == 0)
+            benchCount = atoi(argv[first + 1]);
+    }
+
+    fd = connect_to(path);
+
+    if (benchCount > 0)
+    {
+        /* ping stays on the socket thread; status and list go through the message thread */
+        bench(fd, "ping", benchCount);
+        bench(fd, "status", benchCount);
+        bench(fd, "list", benchCount);
+    }
+    else if (first < argc)
+    {
+        for (i = first; i < argc; ++i)
+            if (!run_command(fd, argv[i], 1))
+                return 1;
+    }
+    else
+    {
+        char line[4096];
+        while (fgets(line, sizeof(line), stdin) != NULL)
+        {
+            line[strcspn(line, "\r\n")] = '\0';
+            if (line[0] != '\0' && !run_command(fd, line, 1))
+                return 1;
+        }
+    }
+
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file MtcShmReader.c
+ * @brief Prints the generator's timecode from shared memory, ten times a second.
+ *
+ * Build and run next to a generator that publishes (plugin "Shared Mem" toggle, or
+ * MTCGenDaemon --shm):
+ *
+ *     cc -O2 -I../Source MtcShmReader.c -o mtc-shm-reader   (add -lrt on old glibc)
+ *     ./mtc-shm-reader [/mtcgen]
+ */
+
+/* nanosleep() and clock_gettime() are POSIX, hidden by a strict -std=c99 */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <time.h>
+#include "MtcGenShm.h"
+
+int main(int argc, char** argv)
+{
+    const char* name = argc > 1 ? argv[1] : MTCGEN_SHM_DEFAULT_NAME;
+    const struct timespec interval = { 0, 100 * 1000 * 1000 };
+    const MtcGenShm* shm = NULL;
+
+    for (;;)
+    {
+        MtcGenShmTimecode tc;
+
+        if (shm == NULL)
+            shm = mtcgen_shm_open(name);
+
+        if (shm == NULL)
+        {
+            printf("\rwaiting for %s ...                                  ", name);
+        }
+        else if (!mtcgen_shm_read(shm, &tc))
+        {
+            /* Publisher gone: the segment may be recreated, so map it again */
+            mtcgen_shm_close(shm);
+            shm = NULL;
+            printf("\rno publisher on %s                                  ", name);
+        }
+        else if (tc.running)
+        {
+            printf("\r%02d:%02d:%02d:%02d @ %.2f fps  cue %u (note %d, bank %d)  %s   ",
+                tc.hours, tc.minutes, tc.seconds, tc.frames, tc.frameRate,
+                tc.cueId, tc.cueNote, tc.bank, tc.playing ? "playing" : "stopped");
+        }
+        else
+        {
+            printf("\r--:--:--:--  no cue running  (%llu blocks)  %s          ",
+                (unsigned long long)tc.blockCount, tc.playing ? "playing" : "stopped");
+        }
+
+        fflush(stdout);
+        nanosleep(&interval, NULL);
+    }
+}
@@ -0,0 +1,88 @@
+/**
+ * @file ArtNetSuite.cpp
+ * @brief Definitions for ArtNetSuite methods.
+ */
+
+#include "ArtNetSuite.h"
+#include "ArtNetTimecodeSender.h"
+#include <array>
+#include <cstring>
+
+namespace
+{
+    /**
+     * Binds a UDP socket on a free local port and points an ArtNetTimecodeSender at it by
+     * unicast to 127.0.0.1, so nothing leaves the machine. Two Frame events are pushed
+     * through the sink interface in turn, and the datagram that arrives for each must be
+     * the 19-byte OpTimeCode packet encodePacket() builds for that frame.
+     */
+    MtcGoldenSuite::Result checkArtNet()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "artnet_udp";
+
+        juce::DatagramSocket receiver;
+        if (!receiver.bindToPort(0))
+        {
+            r.message = "could not bind a local UDP port";
+            return r;
+        }
+        const int port = receiver.getBoundPort();
+
+        ArtNetTimecodeSender sender;
+        sender.setRateType(ArtNetTimecodeSender::EBU);
+        sender.setEnabled(true);
+
+        const juce::String target("127.0.0.1");
+        sender.setTarget(target, port);
+
+        for (int frame = 10; frame < 12; ++frame)
+        {
+            Timecode tc;
+            tc.hours = 1;
+            tc.minutes = 2;
+            tc.seconds = 3;
+            tc.frames = frame;
+            TimecodeSink::Event event;
+            event.type = TimecodeSink::Event::Frame;
+            event.frame = tc.pack();
+            sender.handleTimecodeEvents(&event, 1);
+
+            std::array<uint8_t, ArtNetTimecodeSender::packetSize> expected;
+            ArtNetTimecodeSender::encodePacket(expected.data(), tc.hours, tc.minutes, tc.seconds,
+                tc.frames, ArtNetTimecodeSender::EBU);
+
+            // Take the first datagram for this frame (the previous one may be resent)
+            std::array<uint8_t, 64> received;
+            while (r.message.isEmpty())
+            {
+                if (receiver.waitUntilReady(true, 1000) != 1)
+                {
+                    r.message = "no packet for frame " + juce::String(frame);
+                    break;
+                }
+
+                const int size = receiver.read(received.data(), (int)received.size(), false);
+                if (size != ArtNetTimecodeSender::packetSize)
+                    r.message = juce::String(size) + "-byte packet for frame " + juce::String(frame);
+                else if (std::memcmp(received.data(), expected.data(), expected.size()) == 0)
+                    break;
+            }
+
+            if (r.message.isNotEmpty())
+                break;
+        }
+
+        sender.setEnabled(false);
+        r.passed = r.message.isEmpty();
+        if (r.passed)
+            r.message = "OpTimeCode received from " + target + " on port " + juce::String(port);
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> ArtNetSuite::run()
+{
+    return { checkArtNet() };
+}
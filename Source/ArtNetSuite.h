@@ -0,0 +1,25 @@
+/**
+ * @file ArtNetSuite.h
+ * @brief Declaration of ArtNetSuite, checks of the Art-Net timecode sender on the wire.
+ */
+
+#ifndef ARTNETSUITE_H_INCLUDED
+#define ARTNETSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class ArtNetSuite
+ * @brief "artnet_udp" receives the sender's OpTimeCode packets on a local UDP socket,
+ * sent by unicast over loopback.
+ */
+class ArtNetSuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // ARTNETSUITE_H_INCLUDED
@@ -0,0 +1,145 @@
+/**
+ * @file ArtNetTimecodeSender.cpp
+ * @brief Definitions for ArtNetTimecodeSender methods.
+ */
+
+#include "ArtNetTimecodeSender.h"
+#include "RealtimeAudit.h"
+#include "TraceRecorder.h"
+
+//==============================================================================
+ArtNetTimecodeSender::ArtNetTimecodeSender()
+    : juce::Thread("Art-Net Timecode")
+{
+}
+
+ArtNetTimecodeSender::~ArtNetTimecodeSender()
+{
+    stopThread(1000);
+}
+
+//==============================================================================
+void ArtNetTimecodeSender::setEnabled(bool shouldBeEnabled)
+{
+    enabled.store(shouldBeEnabled);
+    if (shouldBeEnabled)
+    {
+        targetChanged.store(true);
+        startThread();
+    }
+    else
+    {
+        stopThread(1000);
+    }
+}
+
+void ArtNetTimecodeSender::setTarget(const juce::String& address, int port)
+{
+    {
+        MTCGEN_RT_LOCK("targetLock");
+        const juce::ScopedLock sl(targetLock);
+        targetAddress = address;
+        targetPort = port;
+    }
+    targetChanged.store(true);
+}
+
+juce::String ArtNetTimecodeSender::getTargetAddress() const
+{
+    MTCGEN_RT_LOCK("targetLock");
+    const juce::ScopedLock sl(targetLock);
+    return targetAddress;
+}
+
+int ArtNetTimecodeSender::getTargetPort() const
+{
+    MTCGEN_RT_LOCK("targetLock");
+    const juce::ScopedLock sl(targetLock);
+    return targetPort;
+}
+
+void ArtNetTimecodeSender::handleTimecodeEvents(const Event* events, int numEvents)
+{
+    if (!isEnabled())
+        return;
+
+    // Only the latest frame is ever sent, so earlier changes in the batch are skipped
+    for (int i = numEvents; --i >= 0;)
+    {
+        if (events[i].type == Event::Frame)
+        {
+            pendingFrame.store(events[i].frame, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+ArtNetTimecodeSender::RateType ArtNetTimecodeSender::rateTypeForFrameRate(double fps)
+{
+    // 29.97 is counted non-drop, so it is sent as SMPTE, like the MTC rate code
+    if (fps < 24.5)  return Film;
+    if (fps < 27.5)  return EBU;
+    return SMPTE;
+}
+
+/**
+ * @brief Fills in an Art-Net OpTimeCode packet (protocol revision 14).
+ */
+void ArtNetTimecodeSender::encodePacket(uint8_t* dest, int hh, int mm, int ss, int ff,
+    RateType type) noexcept
+{
+    static const uint8_t header[8] = { 'A','r','t','-','N','e','t', 0 };
+    std::memcpy(dest, header, sizeof(header));
+    dest[8] = 0x00;            // OpCode low byte  (OpTimeCode = 0x9700)
+    dest[9] = 0x97;            // OpCode high byte
+    dest[10] = 0;              // ProtVerHi
+    dest[11] = 14;             // ProtVerLo
+    dest[12] = 0;              // Filler1
+    dest[13] = 0;              // StreamId (0 = master)
+    dest[14] = (uint8_t)ff;
+    dest[15] = (uint8_t)ss;
+    dest[16] = (uint8_t)mm;
+    dest[17] = (uint8_t)hh;
+    dest[18] = (uint8_t)type;
+}
+
+//==============================================================================
+/**
+ * @brief Polls for a new frame once per millisecond and sends it.
+ *
+ * The socket and the resolved target live on this thread only, so nothing
+ * network-related ever runs on the audio callback.
+ */
+void ArtNetTimecodeSender::run()
+{
+    juce::DatagramSocket socket(true); // broadcast allowed
+    juce::String address;
+    int port = defaultPort;
+    uint32_t lastSent = 0;
+
+    while (!threadShouldExit())
+    {
+        MTCGEN_TRACE_THREAD("Art-Net Timecode");
+        if (targetChanged.exchange(false))
+        {
+            const juce::ScopedLock sl(targetLock);
+            address = targetAddress;
+            port = targetPort;
+            lastSent = 0; // resend the current frame to the new target
+        }
+
+        auto frame = pendingFrame.load(std::memory_order_acquire);
+        Timecode tc;
+        if (frame != lastSent && Timecode::unpack(frame, tc) && address.isNotEmpty())
+        {
+            MTCGEN_TRACE_SCOPE("artNetSend");
+            encodePacket(packet.data(), tc.hours, tc.minutes, tc.seconds, tc.frames,
+                getRateType());
+            MTCGEN_RT_BLOCKING("DatagramSocket::write");
+            socket.write(address, port, packet.data(), packetSize);
+            lastSent = frame;
+        }
+
+        wait(1);
+    }
+}
@@ -0,0 +1,115 @@
+/**
+ * @file ArtNetTimecodeSender.h
+ * @brief Declaration of the ArtNetTimecodeSender class that sends Art-Net OpTimeCode packets.
+ */
+
+#ifndef ARTNETTIMECODESENDER_H_INCLUDED
+#define ARTNETTIMECODESENDER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "Timecode.h"
+#include "TimecodeSink.h"
+
+/**
+ * @class ArtNetTimecodeSender
+ * @brief Sends the current timecode as Art-Net OpTimeCode packets over UDP.
+ *
+ * While Art-Net is enabled the processor registers it with its TimecodeDispatcher as a
+ * realtime TimecodeSink. On the audio thread, handleTimecodeEvents() only publishes the
+ * last Frame event of each batch, a single atomic store. A background thread picks the
+ * frame up, encodes it into a preallocated packet and writes it to the configured
+ * unicast or broadcast address.
+ */
+class ArtNetTimecodeSender : public TimecodeSink,
+                             private juce::Thread
+{
+public:
+    /**
+     * @enum RateType
+     * @brief Art-Net timecode "Type" field.
+     */
+    enum RateType
+    {
+        Film = 0,  /**< 24 fps */
+        EBU = 1,   /**< 25 fps */
+        DF = 2,    /**< 29.97 fps drop-frame */
+        SMPTE = 3  /**< 30 fps */
+    };
+
+    static constexpr int defaultPort = 6454; /**< Art-Net UDP port (0x1936) */
+    static constexpr int packetSize = 19;    /**< Size of an OpTimeCode packet in bytes */
+
+    /** Constructor */
+    ArtNetTimecodeSender();
+    /** Destructor: stops the sender thread. */
+    ~ArtNetTimecodeSender() override;
+
+    /**
+     * @brief Enables or disables sending. Starts/stops the sender thread.
+     * @param shouldBeEnabled True to send packets.
+     */
+    void setEnabled(bool shouldBeEnabled);
+
+    /** @brief True while the sender thread is running. */
+    bool isEnabled() const { return enabled.load(); }
+
+    /**
+     * @brief Sets the destination of the packets.
+     * @param address IPv4 address or host name (e.g. "2.255.255.255" for broadcast).
+     * @param port UDP port, normally defaultPort.
+     */
+    void setTarget(const juce::String& address, int port);
+
+    /** @brief Returns the configured destination address. */
+    juce::String getTargetAddress() const;
+
+    /** @brief Returns the configured destination port. */
+    int getTargetPort() const;
+
+    /**
+     * @brief Sets the rate type written into each packet.
+     * @param type One of RateType.
+     */
+    void setRateType(RateType type) { rateType.store((int)type); }
+
+    /** @brief Returns the rate type written into each packet. */
+    RateType getRateType() const { return (RateType)rateType.load(); }
+
+    /**
+     * @brief Maps an MTC frame rate onto the matching Art-Net rate type. 29.97 is
+     * counted non-drop and maps to SMPTE; DF is only sent when chosen by hand.
+     * @param fps Frames per second (24, 25, 29.97 or 30).
+     */
+    static RateType rateTypeForFrameRate(double fps);
+
+    /** @brief Pushes the last frame change of a batch, while enabled. Realtime-safe. */
+    void handleTimecodeEvents(const Event* events, int numEvents) override;
+
+    /**
+     * @brief Writes an OpTimeCode packet into dest.
+     * @param dest Buffer of at least packetSize bytes.
+     */
+    static void encodePacket(uint8_t* dest, int hh, int mm, int ss, int ff, RateType type) noexcept;
+
+private:
+    /** Sender thread loop: polls for new frames and writes them to the socket. */
+    void run() override;
+
+    std::atomic<bool>     enabled{ false };
+    std::atomic<int>      rateType{ SMPTE };
+    std::atomic<uint32_t> pendingFrame{ 0 };  /**< Timecode::pack() of the latest frame */
+    std::atomic<bool>     targetChanged{ true };
+
+    mutable juce::CriticalSection targetLock; /**< Protects targetAddress/targetPort */
+    juce::String targetAddress{ "255.255.255.255" };
+    int          targetPort{ defaultPort };
+
+    std::array<uint8_t, packetSize> packet{}; /**< Preallocated packet, only touched by run() */
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ArtNetTimecodeSender)
+};
+
+#endif // ARTNETTIMECODESENDER_H_INCLUDED
@@ -0,0 +1,164 @@
+/**
+ * @file BlockTimingMeter.cpp
+ * @brief Definitions for BlockTimingMeter methods.
+ */
+
+#include "BlockTimingMeter.h"
+
+//==============================================================================
+BlockTimingMeter::BlockTimingMeter()
+{
+    ticksToMicros = 1.0e6 / (double)juce::Time::getHighResolutionTicksPerSecond();
+    clearAll();
+}
+
+void BlockTimingMeter::clearAll() noexcept
+{
+    numBlocks.store(0, std::memory_order_relaxed);
+    numOverruns.store(0, std::memory_order_relaxed);
+    sumLoad.store(0.0, std::memory_order_relaxed);
+    minLoad.store(0.0, std::memory_order_relaxed);
+    maxLoad.store(0.0, std::memory_order_relaxed);
+    maxBlockMicros.store(0.0, std::memory_order_relaxed);
+
+    for (int p = 0; p < numPhases; ++p)
+    {
+        phaseSumMicros[(size_t)p].store(0.0, std::memory_order_relaxed);
+        phaseMaxMicros[(size_t)p].store(0.0, std::memory_order_relaxed);
+        phaseSlowestCount[(size_t)p].store(0, std::memory_order_relaxed);
+    }
+
+    for (auto& bin : histogram)
+        bin.store(0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void BlockTimingMeter::beginBlock() noexcept
+{
+    if (resetRequested.exchange(false))
+        clearAll();
+
+    blockStartTicks = lastMarkTicks = juce::Time::getHighResolutionTicks();
+    blockPhaseTicks.fill(0);
+}
+
+void BlockTimingMeter::endPhase(Phase phase) noexcept
+{
+    auto now = juce::Time::getHighResolutionTicks();
+    blockPhaseTicks[(size_t)phase] += now - lastMarkTicks;
+    lastMarkTicks = now;
+}
+
+/**
+ * @brief Single writer, so plain load/store pairs are enough for the running
+ * min/max/sum; readers may see a block half-applied, which is fine for a meter.
+ */
+void BlockTimingMeter::endBlock(int numSamples, double sampleRate) noexcept
+{
+    auto now = juce::Time::getHighResolutionTicks();
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return;
+
+    double micros = double(now - blockStartTicks) * ticksToMicros;
+    double budgetMicros = 1.0e6 * numSamples / sampleRate;
+    double load = micros / budgetMicros;
+
+    auto n = numBlocks.load(std::memory_order_relaxed);
+    sumLoad.store(sumLoad.load(std::memory_order_relaxed) + load, std::memory_order_relaxed);
+    if (n == 0 || load < minLoad.load(std::memory_order_relaxed))
+        minLoad.store(load, std::memory_order_relaxed);
+    if (load > maxLoad.load(std::memory_order_relaxed))
+        maxLoad.store(load, std::memory_order_relaxed);
+    if (micros > maxBlockMicros.load(std::memory_order_relaxed))
+        maxBlockMicros.store(micros, std::memory_order_relaxed);
+    if (load > 1.0)
+        numOverruns.fetch_add(1, std::memory_order_relaxed);
+
+    int bin = juce::jlimit(0, numBins - 1, (int)(load / binWidth));
+    histogram[(size_t)bin].fetch_add(1, std::memory_order_relaxed);
+
+    int slowest = 0;
+    for (int p = 0; p < numPhases; ++p)
+    {
+        double phaseMicros = double(blockPhaseTicks[(size_t)p]) * ticksToMicros;
+        auto& sum = phaseSumMicros[(size_t)p];
+        sum.store(sum.load(std::memory_order_relaxed) + phaseMicros, std::memory_order_relaxed);
+        if (phaseMicros > phaseMaxMicros[(size_t)p].load(std::memory_order_relaxed))
+            phaseMaxMicros[(size_t)p].store(phaseMicros, std::memory_order_relaxed);
+        if (blockPhaseTicks[(size_t)p] > blockPhaseTicks[(size_t)slowest])
+            slowest = p;
+    }
+    phaseSlowestCount[(size_t)slowest].fetch_add(1, std::memory_order_relaxed);
+
+    numBlocks.store(n + 1, std::memory_order_release);
+}
+
+//==============================================================================
+BlockTimingMeter::Stats BlockTimingMeter::getStats() const
+{
+    Stats s;
+    s.numBlocks = numBlocks.load(std::memory_order_acquire);
+    if (s.numBlocks == 0)
+        return s;
+
+    s.numOverruns = numOverruns.load(std::memory_order_relaxed);
+    s.minLoad = minLoad.load(std::memory_order_relaxed);
+    s.maxLoad = maxLoad.load(std::memory_order_relaxed);
+    s.meanLoad = sumLoad.load(std::memory_order_relaxed) / (double)s.numBlocks;
+    s.maxBlockMicros = maxBlockMicros.load(std::memory_order_relaxed);
+
+    // p99 from the histogram: upper edge of the bin holding the 99th percentile
+    juce::int64 total = 0;
+    for (auto& bin : histogram)
+        total += bin.load(std::memory_order_relaxed);
+
+    juce::int64 threshold = (total * 99 + 99) / 100;
+    juce::int64 seen = 0;
+    for (int b = 0; b < numBins; ++b)
+    {
+        seen += histogram[(size_t)b].load(std::memory_order_relaxed);
+        if (seen >= threshold)
+        {
+            s.p99Load = juce::jmin((b + 1) * binWidth, s.maxLoad);
+            break;
+        }
+    }
+
+    double mostTime = -1.0;
+    for (int p = 0; p < numPhases; ++p)
+    {
+        double sum = phaseSumMicros[(size_t)p].load(std::memory_order_relaxed);
+        s.phaseMeanMicros[(size_t)p] = sum / (double)s.numBlocks;
+        s.phaseMaxMicros[(size_t)p] = phaseMaxMicros[(size_t)p].load(std::memory_order_relaxed);
+        s.phaseSlowestCount[(size_t)p] = phaseSlowestCount[(size_t)p].load(std::memory_order_relaxed);
+        if (sum > mostTime)
+        {
+            mostTime = sum;
+            s.slowestPhase = p;
+        }
+    }
+
+    return s;
+}
+
+juce::String BlockTimingMeter::Stats::describe() const
+{
+    return "blocks=" + juce::String(numBlocks)
+        + " overruns=" + juce::String(numOverruns)
+        + juce::String::formatted(" min=%.4f mean=%.4f p99=%.4f max=%.4f max_us=%.1f",
+            minLoad, meanLoad, p99Load, maxLoad, maxBlockMicros)
+        + " phase=" + getPhaseName(slowestPhase);
+}
+
+const char* BlockTimingMeter::getPhaseName(int phase) noexcept
+{
+    switch (phase)
+    {
+    case MidiParse: return "MIDI parse";
+    case CueLookup: return "Cue lookup";
+    case Encode:    return "Encode";
+    case Send:      return "Send";
+    case Clock:     return "Clock";
+    default:        return "-";
+    }
+}
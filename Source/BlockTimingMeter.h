@@ -0,0 +1,124 @@
+/**
+ * @file BlockTimingMeter.h
+ * @brief Declaration of the BlockTimingMeter class (per-block CPU budget statistics).
+ */
+
+#ifndef BLOCKTIMINGMETER_H_INCLUDED
+#define BLOCKTIMINGMETER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/**
+ * @class BlockTimingMeter
+ * @brief Measures how much of each audio block's deadline processBlock uses.
+ *
+ * The audio thread brackets every callback with beginBlock()/endBlock() and marks the
+ * end of each phase with endPhase(). All bookkeeping is done with high-resolution ticks
+ * and relaxed atomics written by the audio thread only, so the meter never locks or
+ * allocates. Any thread (the editor, a headless test) can take a snapshot with getStats().
+ *
+ * Load is the block's duration divided by its budget, numSamples / sampleRate.
+ * A load above 1.0 counts as a deadline overrun.
+ */
+class BlockTimingMeter
+{
+public:
+    /**
+     * @enum Phase
+     * @brief Sections of processBlock that are timed separately.
+     */
+    enum Phase
+    {
+        MidiParse = 0, /**< Playhead query and incoming MIDI */
+        CueLookup,     /**< Finding the active mapping */
+        Encode,        /**< Computing the frame, MTC messages and sink events */
+        Send,          /**< Handing them to the MidiBuffer, port senders and sinks */
+        Clock,         /**< MIDI Clock / SPP, generated and sent */
+        numPhases
+    };
+
+    /**
+     * @struct Stats
+     * @brief A snapshot of the meter. Loads are fractions of the block budget.
+     */
+    struct Stats
+    {
+        juce::int64 numBlocks{ 0 };
+        juce::int64 numOverruns{ 0 };  /**< Blocks with load > 1.0 */
+        double minLoad{ 0.0 };
+        double meanLoad{ 0.0 };
+        double p99Load{ 0.0 };         /**< Resolution: binWidth */
+        double maxLoad{ 0.0 };
+        double maxBlockMicros{ 0.0 };
+
+        std::array<double, numPhases> phaseMeanMicros{};
+        std::array<double, numPhases> phaseMaxMicros{};
+        std::array<juce::int64, numPhases> phaseSlowestCount{}; /**< Blocks where the phase took longest */
+        int slowestPhase{ -1 };        /**< Phase with the most total time, or -1 */
+
+        /**
+         * @brief One line of key=value pairs ("blocks=... overruns=... min=... mean=...
+         * p99=... max=... max_us=... phase=<slowest phase>"), phase last as its name
+         * may contain spaces.
+         */
+        juce::String describe() const;
+    };
+
+    /** Constructor */
+    BlockTimingMeter();
+
+    /** @brief Starts timing a block. Audio thread only. */
+    void beginBlock() noexcept;
+
+    /** @brief Attributes the time since the previous mark to phase. Audio thread only. */
+    void endPhase(Phase phase) noexcept;
+
+    /**
+     * @brief Finishes the block and folds it into the statistics. Audio thread only.
+     * @param numSamples Samples in the block.
+     * @param sampleRate Current sample rate (Hz).
+     */
+    void endBlock(int numSamples, double sampleRate) noexcept;
+
+    /** @brief Returns a snapshot. Safe from any thread. */
+    Stats getStats() const;
+
+    /** @brief Clears the statistics at the start of the next block. Safe from any thread. */
+    void reset() noexcept { resetRequested.store(true); }
+
+    /** @brief Human-readable name of a phase. */
+    static const char* getPhaseName(int phase) noexcept;
+
+    static constexpr int numBins = 400;       /**< Load histogram bins (last one is overflow) */
+    static constexpr double binWidth = 0.005; /**< 0.5 % of the budget per bin */
+
+private:
+    /** Clears every counter. Audio thread only. */
+    void clearAll() noexcept;
+
+    // Audio thread only
+    juce::int64 blockStartTicks{ 0 };
+    juce::int64 lastMarkTicks{ 0 };
+    std::array<juce::int64, numPhases> blockPhaseTicks{};
+    double ticksToMicros{ 1.0 };
+
+    // Written by the audio thread, read by anyone
+    std::atomic<juce::int64> numBlocks{ 0 };
+    std::atomic<juce::int64> numOverruns{ 0 };
+    std::atomic<double> sumLoad{ 0.0 };
+    std::atomic<double> minLoad{ 0.0 };
+    std::atomic<double> maxLoad{ 0.0 };
+    std::atomic<double> maxBlockMicros{ 0.0 };
+    std::array<std::atomic<double>, numPhases> phaseSumMicros;
+    std::array<std::atomic<double>, numPhases> phaseMaxMicros;
+    std::array<std::atomic<juce::int64>, numPhases> phaseSlowestCount;
+    std::array<std::atomic<juce::uint32>, numBins> histogram;
+
+    std::atomic<bool> resetRequested{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BlockTimingMeter)
+};
+
+#endif // BLOCKTIMINGMETER_H_INCLUDED
@@ -0,0 +1,59 @@
+/**
+ * @file BlockTimingSuite.cpp
+ * @brief Definitions for BlockTimingSuite methods.
+ */
+
+#include "BlockTimingSuite.h"
+#include "MTCGenProcessor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /**
+     * Runs the standard script (quarter-frames and MIDI Clock, two cues, so every phase
+     * has work) and reads the meter once the run is over.
+     */
+    MtcGoldenSuite::Result checkBlockTiming()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "block_timing";
+
+        MTCGenAudioProcessor processor;
+        processor.setMTCFormat(QuarterFrame);
+        processor.setClockEnabled(true);
+        MtcGoldenSuite::addSecondCue(processor);
+
+        HostSimulator sim(processor, MtcGoldenSuite::scriptSampleRate);
+        MtcGoldenSuite::addStandardScript(sim);
+        sim.run();
+
+        const auto stats = processor.getBlockTimingMeter().getStats();
+        const double loads[] = { stats.minLoad, stats.meanLoad, stats.p99Load, stats.maxLoad };
+
+        if (stats.numBlocks != sim.getNumBlocks())
+            r.message = "meter counted " + juce::String(stats.numBlocks) + " blocks, the host ran "
+                + juce::String(sim.getNumBlocks());
+        else if (!std::all_of(std::begin(loads), std::end(loads),
+                     [](double l) { return std::isfinite(l) && l >= 0.0; }))
+            r.message = "load not finite: " + stats.describe();
+        // p99 is the upper edge of a histogram bin, so it can land on either side of the mean
+        else if (!(stats.minLoad <= stats.meanLoad && stats.meanLoad <= stats.maxLoad
+                   && stats.minLoad <= stats.p99Load && stats.p99Load <= stats.maxLoad))
+            r.message = "loads out of order (min <= mean, p99 <= max): " + stats.describe();
+        else if (!juce::isPositiveAndBelow(stats.slowestPhase, (int)BlockTimingMeter::numPhases))
+            r.message = "no phase reported: " + stats.describe();
+        else
+        {
+            r.passed = true;
+            r.message = stats.describe();
+        }
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> BlockTimingSuite::run()
+{
+    return { checkBlockTiming() };
+}
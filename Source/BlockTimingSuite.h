@@ -0,0 +1,26 @@
+/**
+ * @file BlockTimingSuite.h
+ * @brief Declaration of BlockTimingSuite, checks of the per-block CPU meter.
+ */
+
+#ifndef BLOCKTIMINGSUITE_H_INCLUDED
+#define BLOCKTIMINGSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class BlockTimingSuite
+ * @brief "block_timing" plays the standard script and checks what the processor's
+ * BlockTimingMeter reports: one block per processBlock call, finite and ordered loads,
+ * and a slowest phase. The message gives the meter's own summary line.
+ */
+class BlockTimingSuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // BLOCKTIMINGSUITE_H_INCLUDED
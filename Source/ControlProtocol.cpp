@@ -0,0 +1,292 @@
+/**
+ * @file ControlProtocol.cpp
+ * @brief Definitions for ControlProtocol methods.
+ */
+
+#include "ControlProtocol.h"
+#include "MTCGenProcessor.h"
+#include "Timecode.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    juce::StringArray tokenise(const juce::String& line)
+    {
+        return juce::StringArray::fromTokens(line.trim(), " \t", "");
+    }
+
+    bool parseInt(const juce::String& text, int minValue, int maxValue, int& out)
+    {
+        auto t = text.trim();
+        if (t.isEmpty() || !t.trimCharactersAtStart("-").containsOnly("0123456789"))
+            return false;
+        out = t.getIntValue();
+        return out >= minValue && out <= maxValue;
+    }
+
+    bool parseTime(const juce::String& text, double& out)
+    {
+        auto t = text.trim();
+        if (t.isEmpty() || !t.containsOnly("-0123456789.eE+"))
+            return false;
+        out = t.getDoubleValue();
+        return out >= -1.0;
+    }
+
+    juce::String ok(const juce::String& result = {})
+    {
+        return result.isEmpty() ? juce::String("ok\n") : "ok " + result + "\n";
+    }
+
+    juce::String err(const juce::String& message)
+    {
+        return "err " + message + "\n";
+    }
+}
+
+ControlProtocol::ControlProtocol(MTCGenAudioProcessor& proc)
+    : processor(proc)
+{
+}
+
+bool ControlProtocol::isEdit(const juce::String& verb)
+{
+    static const juce::StringArray edits{ "add", "set", "remove", "trigger", "release", "learn" };
+    return edits.contains(verb);
+}
+
+juce::String ControlProtocol::execute(const juce::String& line)
+{
+    const auto tokens = tokenise(line);
+    const auto verb = tokens[0].toLowerCase();
+    auto& cues = processor.getCues();
+
+    if (verb == "status")
+        return ok(describeStatus());
+
+    if (verb == "stats")
+        return ok(processor.getBlockTimingMeter().getStats().describe());
+
+    if (verb == "list")
+    {
+        juce::String reply = ok(juce::String(cues.size()));
+        for (int i = 0; i < cues.size(); ++i)
+            reply << describeCue(cues, i) << "\n";
+        return reply;
+    }
+
+    if (verb == "get")
+    {
+        int id = 0;
+        const int index = parseInt(tokens[1], 1, std::numeric_limits<int>::max(), id)
+            ? cues.indexOfCue((CueStore::CueId)id) : -1;
+        return index >= 0 ? ok(describeCue(cues, index)) : err("no cue " + tokens[1]);
+    }
+
+    if (verb == "bank")
+    {
+        int bank = 0;
+        if (!parseInt(tokens[1], 0, processor.getBanks().getNumBanks() - 1, bank))
+            return err("no bank " + tokens[1]);
+        processor.selectBank(bank);
+        return ok();
+    }
+
+    if (isEdit(verb))
+    {
+        // A batch of one; drop the count so a single add replies "ok <id>"
+        auto reply = executeBatch(juce::StringArray(line));
+        if (reply.startsWith("ok ") && reply.contains("ids="))
+            return ok(reply.fromFirstOccurrenceOf("ids=", false, false).trim());
+        return reply.startsWith("ok") ? ok() : reply.replace("err line 1: ", "err ");
+    }
+
+    return err("unknown command '" + verb + "'");
+}
+
+/**
+ * @brief Copies the active bank, applies every edit to the copy and swaps it in, or
+ * discards it at the first error.
+ */
+juce::String ControlProtocol::executeBatch(const juce::StringArray& edits)
+{
+    auto& banks = processor.getBanks();
+    const int bank = banks.getActiveIndex();
+    const auto& source = banks.getBank(bank);
+
+    auto edited = std::make_unique<CueStore>();
+    edited->copyFrom(source);
+    edited->reserve(edited->size() + edits.size());
+
+    std::vector<CueStore::CueId> timesSet;
+    juce::StringArray added;
+    for (int i = 0; i < edits.size(); ++i)
+    {
+        const auto error = applyEdit(*edited, edits[i], timesSet, added);
+        if (error.isNotEmpty())
+            return err("line " + juce::String(i + 1) + ": " + error);
+    }
+
+    if (!processor.replaceBankCues(bank, source, std::move(edited), timesSet))
+        return err("bank " + juce::String(bank) + " changed during the edit");
+
+    juce::String result(edits.size());
+    if (!added.isEmpty())
+        result << " ids=" << added.joinIntoString(",");
+    return ok(result);
+}
+
+juce::String ControlProtocol::applyEdit(CueStore& cues, const juce::String& line,
+    std::vector<CueStore::CueId>& timesSet, juce::StringArray& added)
+{
+    const auto tokens = tokenise(line);
+    const auto verb = tokens[0].toLowerCase();
+    int index = -1;
+    int firstField = 1;
+
+    if (verb == "add")
+    {
+        // Up to label=, which takes the rest of the line, "note=" included
+        int note = -1;
+        juce::String tc;
+        for (int t = 1; t < tokens.size() && !tokens[t].startsWithIgnoreCase("label="); ++t)
+        {
+            if (tokens[t].startsWith("note="))
+                parseInt(tokens[t].substring(5), 0, 127, note);
+            else if (tokens[t].startsWith("tc="))
+                tc = tokens[t].substring(3);
+        }
+
+        int h, m, s, f;
+        if (note < 0 || !MappingEntry::parseTimecode(tc, h, m, s, f))
+            return "add needs note=<0-127> and tc=<HH:MM:SS:FF>";
+
+        index = cues.add(MappingEntry(tc, note));
+        added.add(juce::String(cues.getCueId(index)));
+    }
+    else
+    {
+        int id = 0;
+        if (!parseInt(tokens[1], 1, std::numeric_limits<int>::max(), id)
+            || (index = cues.indexOfCue((CueStore::CueId)id)) < 0)
+            return "no cue " + tokens[1];
+        firstField = 2;
+    }
+
+    const auto id = cues.getCueId(index);
+    const double now = processor.getBlockTime();
+
+    if (verb == "remove")
+    {
+        cues.remove(index);
+        return {};
+    }
+    if (verb == "trigger")
+    {
+        cues.setDetectedStartTime(index, now);
+        cues.setDetectedEndTime(index, -1.0);
+        cues.setIsActive(index, true);
+        timesSet.push_back(id);
+        return {};
+    }
+    if (verb == "release")
+    {
+        cues.setDetectedEndTime(index, now);
+        cues.setIsActive(index, false);
+        timesSet.push_back(id);
+        return {};
+    }
+    if (verb == "learn")
+    {
+        cues.setDetectedStartTime(index, -1.0);
+        cues.setDetectedEndTime(index, -1.0);
+        cues.setIsActive(index, false);
+        timesSet.push_back(id);
+        return {};
+    }
+
+    // add / set: key=value fields, label= last
+    for (int t = firstField; t < tokens.size(); ++t)
+    {
+        const auto key = tokens[t].upToFirstOccurrenceOf("=", false, false).toLowerCase();
+        const auto value = tokens[t].fromFirstOccurrenceOf("=", false, false);
+        int n = 0;
+        double seconds = 0.0;
+
+        if (key == "label")
+        {
+            cues.setLabel(index, line.fromFirstOccurrenceOf("label=", false, true).trim());
+            break;
+        }
+        if (key == "note")
+        {
+            if (!parseInt(value, 0, 127, n))
+                return "note must be 0-127";
+            cues.setMidiNote(index, n);
+        }
+        else if (key == "tc")
+        {
+            int h, m, s, f;
+            if (!MappingEntry::parseTimecode(value, h, m, s, f))
+                return "tc must be HH:MM:SS:FF";
+            cues.setTimecodeString(index, value);
+        }
+        else if (key == "pre")
+        {
+            if (!parseInt(value, 0, MTCGenAudioProcessor::maxPreRollFrames, n))
+                return "pre must be 0-" + juce::String(MTCGenAudioProcessor::maxPreRollFrames);
+            cues.setPreRollFrames(index, n);
+        }
+        else if (key == "start" || key == "end")
+        {
+            if (!parseTime(value, seconds))
+                return key + " must be seconds (or -1 to clear)";
+            if (key == "start")
+                cues.setDetectedStartTime(index, seconds);
+            else
+                cues.setDetectedEndTime(index, seconds);
+            cues.setIsActive(index, false);
+            timesSet.push_back(id);
+        }
+        else
+        {
+            return "unknown field '" + tokens[t] + "'";
+        }
+    }
+    return {};
+}
+
+//==============================================================================
+juce::String ControlProtocol::describeCue(const CueStore& cues, int i) const
+{
+    return juce::String(cues.getCueId(i))
+        + " note=" + juce::String(cues.getMidiNote(i))
+        + " tc=" + cues.getTimecodeString(i)
+        + " pre=" + juce::String(cues.getPreRollFrames(i))
+        + " start=" + juce::String(cues.getDetectedStartTime(i), 3)
+        + " end=" + juce::String(cues.getDetectedEndTime(i), 3)
+        + " active=" + juce::String(cues.getIsActive(i) ? 1 : 0)
+        + " label=" + cues.getLabel(i);
+}
+
+juce::String ControlProtocol::describeStatus() const
+{
+    auto& cues = processor.getCues();
+    const int active = processor.getActiveMappingIndex();
+
+    Timecode tc;
+    const bool running = Timecode::unpack(processor.getCurrentFramePacked(), tc);
+
+    return "playing=" + juce::String(processor.isHostPlaying() ? 1 : 0)
+        + " bank=" + juce::String(processor.getBanks().getActiveIndex())
+        + " cue=" + juce::String(juce::isPositiveAndBelow(active, cues.size())
+                                    ? cues.getCueId(active) : 0u)
+        + " tc=" + (running ? juce::String::formatted("%02d:%02d:%02d:%02d",
+                                  tc.hours, tc.minutes, tc.seconds, tc.frames)
+                            : juce::String("-"))
+        + " rate=" + juce::String(processor.getFrameRate())
+        + " format=" + (processor.getMTCFormat() == QuarterFrame ? "qf" : "sysex")
+        + " time=" + juce::String(processor.getBlockTime(), 3)
+        + " cues=" + juce::String(cues.size());
+}
@@ -0,0 +1,90 @@
+/**
+ * @file ControlProtocol.h
+ * @brief Declaration of the ControlProtocol class (text commands for the control socket).
+ */
+
+#ifndef CONTROLPROTOCOL_H_INCLUDED
+#define CONTROLPROTOCOL_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "CueStore.h"
+
+class MTCGenAudioProcessor;
+
+/**
+ * @class ControlProtocol
+ * @brief Executes the line commands of the control socket against the processor.
+ *
+ * One command per line, one reply per command: "ok [result]" or "err <message>".
+ * Cues are addressed by their stable CueId and always belong to the active bank.
+ *
+ *     ping                     ok pong (answered by the socket thread, no processor access)
+ *     status                   ok playing=1 bank=0 cue=3 tc=01:00:00:12 rate=25 format=qf
+ *                                 time=12.345 cues=24
+ *     stats                    ok blocks=9000 overruns=0 min=0.0010 mean=0.0021 p99=0.0050
+ *                                 max=0.0310 max_us=165.2 phase=Encode
+ *                              (BlockTimingMeter::Stats::describe(): audio thread load)
+ *     list                     ok <n>, followed by n cue lines
+ *     get <id>                 ok <cue line>
+ *     add note=<n> tc=<HH:MM:SS:FF> [pre=<frames>] [start=<s>] [end=<s>] [label=<text>]
+ *                              ok <id>
+ *     set <id> [note=..] [tc=..] [pre=..] [start=..] [end=..] [label=..]
+ *     remove <id>
+ *     trigger <id>             starts the cue now, as its note-on would
+ *     release <id>             ends it now, as its note-off would
+ *     learn <id>               forgets the learned window; the next trigger learns it again
+ *     bank <n>                 selects a bank, as a program change would
+ *     begin / commit / abort   queue edits and apply them together
+ *
+ * A cue line is "<id> note=<n> tc=<tc> pre=<f> start=<s> end=<s> active=<0|1> label=<text>".
+ * label= takes the rest of the line, so it always comes last.
+ *
+ * Edits inside begin/commit are made on a copy of the active bank, which is then swapped
+ * in with one pointer store (MTCGenAudioProcessor::replaceBankCues()): the audio
+ * thread sees all of the batch or none of it, and an error anywhere discards the whole
+ * batch. Outside a batch every edit is a batch of one, trigger, release and learn
+ * included, as the audio thread writes learned times in the live bank.
+ *
+ * Message thread only; the socket thread hands lines over with MessageManager::callAsync.
+ */
+class ControlProtocol
+{
+public:
+    /** Constructor */
+    explicit ControlProtocol(MTCGenAudioProcessor& proc);
+
+    /** @brief True for verbs that change cues (and are queued inside a batch). */
+    static bool isEdit(const juce::String& verb);
+
+    /**
+     * @brief Runs one command outside a batch.
+     * @return The reply, one or more lines each ending in '\n'.
+     */
+    juce::String execute(const juce::String& line);
+
+    /**
+     * @brief Applies edit lines as one atomic update of the active bank.
+     * @return "ok <n> [ids=<added ids>]" or "err line <k>: <message>".
+     */
+    juce::String executeBatch(const juce::StringArray& edits);
+
+private:
+    /**
+     * @brief Applies one edit to cues.
+     * @param timesSet Receives cues whose learned times the edit wrote.
+     * @param added Receives the ids of added cues.
+     * @return Empty on success, else the error message.
+     */
+    juce::String applyEdit(CueStore& cues, const juce::String& line,
+        std::vector<CueStore::CueId>& timesSet, juce::StringArray& added);
+
+    juce::String describeCue(const CueStore& cues, int index) const;
+    juce::String describeStatus() const;
+
+    MTCGenAudioProcessor& processor;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ControlProtocol)
+};
+
+#endif // CONTROLPROTOCOL_H_INCLUDED
@@ -0,0 +1,239 @@
+/**
+ * @file ControlProtocolSuite.cpp
+ * @brief Definitions for ControlProtocolSuite methods.
+ */
+
+#include "ControlProtocolSuite.h"
+#include "ControlProtocol.h"
+#include "MTCGenProcessor.h"
+
+namespace
+{
+    /** The id in an "ok <id>" reply, or 0. */
+    int idOf(const juce::String& reply)
+    {
+        return reply.startsWith("ok ") ? reply.substring(3).trim().getIntValue() : 0;
+    }
+
+    /**
+     * Adds a cue with a spaced label, reads it back with get, changes its note, pre-roll
+     * and label with set, then removes it; get must then fail, and the default cue must
+     * be left as it was.
+     */
+    MtcGoldenSuite::Result checkEdits()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "control_edits";
+
+        MTCGenAudioProcessor processor;
+        ControlProtocol protocol(processor);
+        const int before = processor.getCues().size();
+
+        const auto added = protocol.execute("add note=61 tc=01:00:00:00 pre=5 label=Scene one");
+        const int id = idOf(added);
+        const auto idText = juce::String(id);
+        if (id <= 0)
+        {
+            r.message = "add replied " + added.trim();
+            return r;
+        }
+
+        const auto got = protocol.execute("get " + idText);
+        if (!got.startsWith("ok " + idText + " note=61 tc=01:00:00:00 pre=5 ")
+            || !got.endsWith(" active=0 label=Scene one\n"))
+        {
+            r.message = "get after add replied " + got.trim();
+            return r;
+        }
+
+        const auto set = protocol.execute("set " + idText + " note=62 pre=0 label=Scene  two");
+        const auto cue = processor.getCues().indexOfCue((CueStore::CueId)id);
+        if (set != "ok\n" || cue < 0 || processor.getCues().getMidiNote(cue) != 62
+            || processor.getCues().getPreRollFrames(cue) != 0
+            || processor.getCues().getLabel(cue) != "Scene  two")
+        {
+            r.message = "set replied " + set.trim() + ", get now "
+                + protocol.execute("get " + idText).trim();
+            return r;
+        }
+
+        const auto badSet = protocol.execute("set " + idText + " note=128");
+        if (!badSet.startsWith("err ") || processor.getCues().getMidiNote(cue) != 62)
+        {
+            r.message = "set note=128 replied " + badSet.trim();
+            return r;
+        }
+
+        const auto removed = protocol.execute("remove " + idText);
+        const auto gone = protocol.execute("get " + idText);
+        if (removed != "ok\n" || !gone.startsWith("err "))
+            r.message = "remove replied " + removed.trim() + ", then get " + gone.trim();
+        else if (processor.getCues().size() != before || processor.getCues().getMidiNote(0) != 60)
+            r.message = "default cue changed: " + protocol.execute("list").trim();
+        else
+            r.passed = true;
+        return r;
+    }
+
+    /**
+     * label= takes the rest of the line: a label holding "note=" and "tc=" must not be
+     * read as those fields, by add's required-field scan or by the field loop.
+     */
+    MtcGoldenSuite::Result checkLabel()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "control_label";
+
+        MTCGenAudioProcessor processor;
+        ControlProtocol protocol(processor);
+
+        const auto added = protocol.execute("add note=61 tc=01:00:00:00 label=a b note=5 tc=x");
+        const int cue = processor.getCues().indexOfCue((CueStore::CueId)idOf(added));
+        const auto noFields = protocol.execute("add label=note=5 tc=01:00:00:00");
+
+        if (cue < 0)
+            r.message = "add replied " + added.trim();
+        else if (processor.getCues().getMidiNote(cue) != 61
+                 || processor.getCues().getTimecodeString(cue) != "01:00:00:00"
+                 || processor.getCues().getLabel(cue) != "a b note=5 tc=x")
+            r.message = "label fields leaked: " + protocol.execute("get " + juce::String(idOf(added))).trim();
+        else if (!noFields.startsWith("err "))
+            r.message = "add with note= only inside the label replied " + noFields.trim();
+        else
+            r.passed = true;
+        return r;
+    }
+
+    /**
+     * A batch whose second line fails must leave the active bank as it was (the same
+     * object, size and content version) even though its first line was good. A good
+     * batch then replaces the bank once and reports the ids it added.
+     */
+    MtcGoldenSuite::Result checkBatch()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "control_batch";
+
+        MTCGenAudioProcessor processor;
+        ControlProtocol protocol(processor);
+        const auto* bank = &processor.getCues();
+        const int size = bank->size();
+        const auto version = bank->getContentVersion();
+
+        const auto failed = protocol.executeBatch({ "add note=61 tc=01:00:00:00", "set 999 note=1",
+                                                    "add note=62 tc=02:00:00:00" });
+        if (!failed.startsWith("err line 2: "))
+            r.message = "failing batch replied " + failed.trim();
+        else if (&processor.getCues() != bank || bank->size() != size
+                 || bank->getContentVersion() != version)
+            r.message = "failing batch changed the bank";
+        else
+        {
+            const auto applied = protocol.executeBatch({ "add note=61 tc=01:00:00:00",
+                                                         "add note=62 tc=02:00:00:00",
+                                                         "set 1 label=first" });
+            auto& cues = processor.getCues();
+            const auto ids = juce::StringArray::fromTokens(
+                applied.fromFirstOccurrenceOf("ids=", false, false).trim(), ",", "");
+
+            if (!applied.startsWith("ok 3 ids=") || ids.size() != 2)
+                r.message = "good batch replied " + applied.trim();
+            else if (&cues == bank || cues.size() != size + 2
+                     || cues.indexOfCue((CueStore::CueId)ids[0].getIntValue()) < 0
+                     || cues.indexOfCue((CueStore::CueId)ids[1].getIntValue()) < 0)
+                r.message = "good batch not applied: " + protocol.execute("list").trim();
+            else if (cues.getLabel(cues.indexOfCue(1)) != "first")
+                r.message = "set in the batch lost: " + protocol.execute("get 1").trim();
+            else
+                r.passed = true;
+        }
+        return r;
+    }
+
+    /**
+     * trigger, release and learn on their own are a batch of one too: each publishes a
+     * copy with the cue's times set, and the bank it replaced keeps the times it had.
+     */
+    MtcGoldenSuite::Result checkTrigger()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "control_trigger";
+
+        MTCGenAudioProcessor processor;
+        ControlProtocol protocol(processor);
+
+        const auto* before = &processor.getCues();
+        const auto triggered = protocol.execute("trigger 1");
+        const auto* afterTrigger = &processor.getCues();
+        const bool started = afterTrigger->getIsActive(0) && afterTrigger->getDetectedStartTime(0) >= 0.0
+            && afterTrigger->getDetectedEndTime(0) == -1.0;
+        const bool untouched = before->getDetectedStartTime(0) == -1.0 && !before->getIsActive(0);
+
+        const auto released = protocol.execute("release 1");
+        const auto& afterRelease = processor.getCues();
+        const bool ended = !afterRelease.getIsActive(0) && afterRelease.getDetectedEndTime(0) >= 0.0;
+
+        const auto learned = protocol.execute("learn 1");
+        const auto& afterLearn = processor.getCues();
+        const bool cleared = afterLearn.getDetectedStartTime(0) == -1.0
+            && afterLearn.getDetectedEndTime(0) == -1.0;
+
+        if (triggered != "ok\n" || released != "ok\n" || learned != "ok\n")
+            r.message = "replies " + triggered.trim() + " / " + released.trim() + " / " + learned.trim();
+        else if (afterTrigger == before || !started)
+            r.message = "trigger did not publish a started copy";
+        else if (!untouched)
+            r.message = "trigger wrote the bank it replaced";
+        else if (!ended)
+            r.message = "release did not publish the end time";
+        else if (!cleared)
+            r.message = "learn did not clear the times";
+        else if (!protocol.execute("trigger 99").startsWith("err "))
+            r.message = "trigger of a missing cue did not fail";
+        else
+            r.passed = true;
+        return r;
+    }
+
+    /**
+     * executeBatch() copies and swaps on the message thread in one call, so the bank can
+     * only go stale under it through another writer; this takes that path directly. A
+     * copy made before another edit replaced the bank must be refused, and the bank
+     * keep that other edit.
+     */
+    MtcGoldenSuite::Result checkStaleBank()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "control_stale_bank";
+
+        MTCGenAudioProcessor processor;
+        ControlProtocol protocol(processor);
+        auto& banks = processor.getBanks();
+        const int bank = banks.getActiveIndex();
+        const auto& source = banks.getBank(bank);
+
+        auto edited = std::make_unique<CueStore>();
+        edited->copyFrom(source);
+        edited->setLabel(0, "stale");
+
+        const auto other = protocol.execute("set 1 label=current");
+        const bool replaced = processor.replaceBankCues(bank, source, std::move(edited), {});
+        auto& cues = processor.getCues();
+
+        if (other != "ok\n")
+            r.message = "set replied " + other.trim();
+        else if (replaced)
+            r.message = "stale copy was swapped in";
+        else if (cues.getLabel(cues.indexOfCue(1)) != "current")
+            r.message = "bank lost the edit made meanwhile: " + protocol.execute("get 1").trim();
+        else
+            r.passed = true;
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> ControlProtocolSuite::run()
+{
+    return { checkEdits(), checkLabel(), checkTrigger(), checkBatch(), checkStaleBank() };
+}
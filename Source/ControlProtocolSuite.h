@@ -0,0 +1,32 @@
+/**
+ * @file ControlProtocolSuite.h
+ * @brief Declaration of ControlProtocolSuite, checks of the control socket commands.
+ */
+
+#ifndef CONTROLPROTOCOLSUITE_H_INCLUDED
+#define CONTROLPROTOCOLSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class ControlProtocolSuite
+ * @brief Drives ControlProtocol::execute() and executeBatch() against a processor:
+ *
+ * - "control_edits": add, get, set and remove, and the replies to each
+ * - "control_label": label= taking the rest of the line, "note=" and "tc=" included
+ * - "control_trigger": trigger, release and learn publishing a copy, not writing the
+ *   live bank
+ * - "control_batch": a batch whose second line fails leaves the bank untouched; a good
+ *   one is applied as a single replacement
+ * - "control_stale_bank": a copy of a bank that was replaced meanwhile is refused
+ */
+class ControlProtocolSuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // CONTROLPROTOCOLSUITE_H_INCLUDED
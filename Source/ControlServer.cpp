@@ -0,0 +1,351 @@
+/**
+ * @file ControlServer.cpp
+ * @brief Definitions for ControlServer methods.
+ */
+
+#include "ControlServer.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <vector>
+
+#if ! JUCE_WINDOWS
+ #include <cerrno>
+ #include <cstring>
+ #include <fcntl.h>
+ #include <poll.h>
+ #include <sys/socket.h>
+ #include <sys/stat.h>
+ #include <sys/un.h>
+ #include <unistd.h>
+
+namespace
+{
+    /** No accept(), recv() or send() on the socket can then stall the poll() loop. */
+    bool makeNonBlocking(int fd)
+    {
+        const int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    bool wouldBlock() noexcept
+    {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+}
+#endif
+
+ControlServer::ControlServer(MTCGenAudioProcessor& proc)
+    : juce::Thread("MTCGen Control"),
+      protocol(proc)
+{
+}
+
+ControlServer::~ControlServer()
+{
+    alive->store(false);
+    setEnabled(false);
+}
+
+juce::String ControlServer::getDefaultPath()
+{
+    auto runtimeDir = juce::SystemStats::getEnvironmentVariable("XDG_RUNTIME_DIR", {});
+    if (runtimeDir.isNotEmpty())
+        return runtimeDir + "/mtcgen.sock";
+
+#if JUCE_WINDOWS
+    return {};
+#else
+    return "/tmp/mtcgen-" + juce::String((int)getuid()) + ".sock";
+#endif
+}
+
+/**
+ * @brief Binds the socket (replacing a stale one), then starts the thread.
+ */
+bool ControlServer::setEnabled(bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == isEnabled())
+        return true;
+
+    if (!shouldBeEnabled)
+    {
+        stopThread(replyTimeoutMs + 1000);
+        closeListener();
+        return true;
+    }
+
+#if JUCE_WINDOWS
+    lastError = "The control socket needs Unix domain sockets (Linux, macOS)";
+    return false;
+#else
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.isEmpty() || path.getNumBytesAsUTF8() >= sizeof(address.sun_path))
+    {
+        lastError = "Invalid socket path '" + path + "'";
+        return false;
+    }
+    std::strcpy(address.sun_path, path.toRawUTF8());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0)
+    {
+        lastError = "socket: " + juce::String(std::strerror(errno));
+        return false;
+    }
+
+    auto* addr = reinterpret_cast<const sockaddr*>(&address);
+    int bound = bind(listenFd, addr, sizeof(address));
+    if (bound != 0 && errno == EADDRINUSE)
+    {
+        // Only replace the file if nobody answers on it
+        const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        const bool inUse = probe >= 0 && connect(probe, addr, sizeof(address)) == 0;
+        if (probe >= 0)
+            close(probe);
+
+        if (inUse)
+        {
+            close(listenFd);
+            listenFd = -1;
+            lastError = path + " is in use by another instance";
+            return false;
+        }
+
+        unlink(address.sun_path);
+        bound = bind(listenFd, addr, sizeof(address));
+    }
+
+    if (bound != 0)
+    {
+        lastError = "binding " + path + ": " + juce::String(std::strerror(errno));
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    if (chmod(address.sun_path, 0600) != 0 || listen(listenFd, maxClients) != 0)
+    {
+        lastError = "listening on " + path + ": " + juce::String(std::strerror(errno));
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    lastError.clear();
+    startThread();
+    return true;
+#endif
+}
+
+void ControlServer::closeListener()
+{
+#if ! JUCE_WINDOWS
+    if (listenFd >= 0)
+    {
+        close(listenFd);
+        listenFd = -1;
+        unlink(path.toRawUTF8());
+    }
+#endif
+}
+
+//==============================================================================
+/**
+ * @brief poll() over the listening socket and every client. A client is polled for
+ * input while its unsent replies are below maxPendingOutput, and for output while it
+ * has any; its lines are handled in order, and their replies go out in the same order.
+ */
+void ControlServer::run()
+{
+#if ! JUCE_WINDOWS
+    std::vector<Client> clients;
+    std::vector<pollfd> fds;
+    char buffer[4096];
+    makeNonBlocking(listenFd);
+
+    while (!threadShouldExit())
+    {
+        MTCGEN_TRACE_THREAD("MTCGen Control");
+        fds.clear();
+        fds.push_back({ listenFd, POLLIN, 0 });
+        for (auto& c : clients)
+        {
+            short events = 0;
+            if (!c.inputClosed && c.output.size() < (size_t)maxPendingOutput)
+                events |= POLLIN;
+            if (!c.output.empty())
+                events |= POLLOUT;
+            fds.push_back({ c.fd, events, 0 });
+        }
+
+        if (poll(fds.data(), (nfds_t)fds.size(), 100) <= 0)
+            continue;
+
+        if ((fds[0].revents & POLLIN) != 0)
+        {
+            const int fd = accept(listenFd, nullptr, nullptr);
+            if (fd >= 0 && (int)clients.size() < maxClients && makeNonBlocking(fd))
+                clients.push_back({ fd });
+            else if (fd >= 0)
+                close(fd);
+        }
+
+        for (size_t i = 0; i < clients.size(); ++i)
+        {
+            auto& client = clients[i];
+            const auto revents = fds[i + 1].revents;
+            bool drop = (revents & (POLLERR | POLLNVAL)) != 0;
+
+            if (!drop && !client.inputClosed && (revents & (POLLIN | POLLHUP)) != 0)
+            {
+                const auto n = recv(client.fd, buffer, sizeof(buffer), 0);
+                if (n > 0)
+                    client.input.append(buffer, (size_t)n);
+                else if (n == 0 || !wouldBlock())
+                    client.inputClosed = true;
+            }
+
+            // Lines held back by a full output are picked up again once it drains
+            drop = drop || !handleLines(client) || !flushOutput(client)
+                || (client.inputClosed && client.output.empty());
+
+            if (drop)
+                close(client.fd), client.fd = -1;
+        }
+
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+            [](const Client& c) { return c.fd < 0; }), clients.end());
+    }
+
+    for (auto& c : clients)
+        close(c.fd);
+#endif
+}
+
+bool ControlServer::handleLines(Client& client)
+{
+    size_t start = 0, end;
+    while (client.output.size() < (size_t)maxPendingOutput
+           && (end = client.input.find('\n', start)) != std::string::npos)
+    {
+        auto line = juce::String::fromUTF8(client.input.data() + start, (int)(end - start)).trim();
+        start = end + 1;
+        if (line.isEmpty())
+            continue;
+
+        const auto reply = handleLine(client, line);
+        client.output.append(reply.toRawUTF8(), reply.getNumBytesAsUTF8());
+    }
+    client.input.erase(0, start);
+
+    return client.input.size() <= (size_t)maxLineLength
+        || client.input.find('\n') != std::string::npos;
+}
+
+bool ControlServer::flushOutput(Client& client)
+{
+#if ! JUCE_WINDOWS
+    while (!client.output.empty())
+    {
+        const auto n = send(client.fd, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+        if (n < 0)
+            return wouldBlock();
+        client.output.erase(0, (size_t)n);
+    }
+#endif
+    return true;
+}
+
+juce::String ControlServer::handleLine(Client& client, const juce::String& line)
+{
+    MTCGEN_TRACE_SCOPE("controlCommand");
+    const auto verb = line.upToFirstOccurrenceOf(" ", false, false).toLowerCase();
+
+    if (verb == "ping")
+        return "ok pong\n";
+
+    if (verb == "begin")
+    {
+        if (client.inBatch)
+            return "err already in a batch\n";
+        client.inBatch = true;
+        client.queued.clear();
+        return "ok\n";
+    }
+
+    if (verb == "abort")
+    {
+        client.inBatch = false;
+        client.queued.clear();
+        return "ok\n";
+    }
+
+    if (verb == "commit")
+    {
+        if (!client.inBatch)
+            return "err no batch\n";
+
+        auto edits = client.queued;
+        client.inBatch = false;
+        client.queued.clear();
+        if (edits.isEmpty())
+            return "ok 0\n";
+        return callOnMessageThread([this, edits]() { return protocol.executeBatch(edits); });
+    }
+
+    if (client.inBatch && ControlProtocol::isEdit(verb))
+    {
+        client.queued.add(line);
+        return "ok queued\n";
+    }
+
+    return callOnMessageThread([this, line]() { return protocol.execute(line); });
+}
+
+/**
+ * @brief A call that times out is cancelled, so it cannot run (and apply its edit) after
+ * the client has been told it failed. One the message thread has already started is
+ * waited for instead: it is running, and its reply is the true one.
+ */
+juce::String ControlServer::callOnMessageThread(std::function<juce::String()> fn)
+{
+    enum State { Pending, Running, Cancelled };
+
+    struct Call
+    {
+        std::atomic<int> state{ Pending };
+        juce::WaitableEvent done;
+        juce::String reply;
+    };
+
+    auto call = std::make_shared<Call>();
+    auto isAlive = alive;
+    juce::MessageManager::callAsync([call, isAlive, fn]() {
+        int expected = Pending;
+        if (!call->state.compare_exchange_strong(expected, Running))
+            return;
+        if (isAlive->load())
+        {
+            MTCGEN_TRACE_SCOPE("controlExecute");
+            call->reply = fn();
+        }
+        call->done.signal();
+        });
+
+    // Short waits, so stopping the server never waits on a busy message thread
+    for (int waited = 0; waited < replyTimeoutMs; waited += 50)
+    {
+        if (call->done.wait(50))
+            return call->reply;
+        if (threadShouldExit())
+            break;
+    }
+
+    int expected = Pending;
+    if (call->state.compare_exchange_strong(expected, Cancelled))
+        return "err timeout waiting for the message thread\n";
+
+    call->done.wait();
+    return call->reply;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file ControlServer.h
+ * @brief Declaration of the ControlServer class (local Unix-socket control API).
+ */
+
+#ifndef CONTROLSERVER_H_INCLUDED
+#define CONTROLSERVER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include "ControlProtocol.h"
+
+class MTCGenAudioProcessor;
+
+/**
+ * @class ControlServer
+ * @brief Lets show-control scripts on the same machine drive the generator over a Unix
+ * domain socket, with the line protocol of ControlProtocol.
+ *
+ * A background thread accepts connections and reads lines from every client with
+ * poll(). Client sockets are non-blocking: replies are queued on the client and sent
+ * as its socket takes them, so a client that stops reading never stalls the others.
+ * Once maxPendingOutput bytes of its replies are unsent, its further lines wait until
+ * it catches up. Each client keeps its own batch: edits between "begin" and "commit" are
+ * queued on the socket thread and handed to the message thread together, so a batch
+ * costs one message-thread round trip however long it is. Everything else is handed
+ * over line by line with MessageManager::callAsync, and the socket thread waits for the
+ * reply. "ping" is answered on the socket thread, to measure the transport alone.
+ *
+ * The socket is created with mode 0600 (the owner's scripts only). A stale socket left
+ * by a crashed process is replaced; one that still answers is not. Not available on
+ * Windows.
+ */
+class ControlServer : private juce::Thread
+{
+public:
+    static constexpr int maxClients = 16;
+    static constexpr int maxLineLength = 65536;
+    static constexpr int maxPendingOutput = 1 << 20; /**< Unsent reply bytes before a client's lines wait */
+    static constexpr int replyTimeoutMs = 2000; /**< Message thread must answer within this */
+
+    /** Constructor */
+    explicit ControlServer(MTCGenAudioProcessor& proc);
+    /** Destructor: stops listening and removes the socket. */
+    ~ControlServer() override;
+
+    /**
+     * @brief $XDG_RUNTIME_DIR/mtcgen.sock, or /tmp/mtcgen-<uid>.sock without it.
+     */
+    static juce::String getDefaultPath();
+
+    /** @brief Sets the socket path. Takes effect on the next setEnabled(true). */
+    void setPath(const juce::String& newPath) { path = newPath; }
+
+    /** @brief Socket path. */
+    juce::String getPath() const { return path; }
+
+    /**
+     * @brief Starts or stops listening. Message thread.
+     * @return False if the socket could not be created; see getLastError().
+     */
+    bool setEnabled(bool shouldBeEnabled);
+
+    /** @brief True while listening. */
+    bool isEnabled() const { return isThreadRunning(); }
+
+    /** @brief Why the last setEnabled(true) failed. */
+    juce::String getLastError() const { return lastError; }
+
+private:
+    /** One connected client. */
+    struct Client
+    {
+        int fd{ -1 };
+        std::string input;           /**< Bytes received, not yet handled */
+        std::string output;          /**< Replies not yet sent */
+        bool inputClosed{ false };   /**< Peer sent EOF; closed once output is sent */
+        bool inBatch{ false };
+        juce::StringArray queued;    /**< Edits waiting for commit */
+    };
+
+    void run() override;
+
+    /**
+     * Answers the client's complete lines into its output, stopping while
+     * maxPendingOutput bytes are unsent. Socket thread.
+     * @return False if the client sent a line longer than maxLineLength.
+     */
+    bool handleLines(Client& client);
+
+    /** Handles one complete line and returns the reply. Socket thread. */
+    juce::String handleLine(Client& client, const juce::String& line);
+
+    /**
+     * Sends as much of the client's output as its socket takes without blocking.
+     * @return False if the connection is gone.
+     */
+    static bool flushOutput(Client& client);
+
+    /** Runs fn on the message thread and waits for its reply. Socket thread. */
+    juce::String callOnMessageThread(std::function<juce::String()> fn);
+
+    /** Closes the listening socket and removes its file. */
+    void closeListener();
+
+    ControlProtocol protocol;
+    juce::String path{ getDefaultPath() };
+    juce::String lastError;
+    int listenFd{ -1 };
+
+    /** Cleared on destruction, so a reply posted to the message thread too late is dropped. */
+    std::shared_ptr<std::atomic<bool>> alive{ std::make_shared<std::atomic<bool>>(true) };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ControlServer)
+};
+
+#endif // CONTROLSERVER_H_INCLUDED
@@ -0,0 +1,310 @@
+/**
+ * @file ControlServerSuite.cpp
+ * @brief Definitions for ControlServerSuite methods.
+ */
+
+#include "ControlServerSuite.h"
+#include "MTCGenProcessor.h"
+#include <algorithm>
+#include <string>
+#include <thread>
+
+#if ! JUCE_WINDOWS
+ #include <cerrno>
+ #include <cstring>
+ #include <fcntl.h>
+ #include <sys/socket.h>
+ #include <sys/time.h>
+ #include <sys/un.h>
+ #include <unistd.h>
+
+namespace
+{
+    /**
+     * A blocking connection with a receive timeout, so a server that stops answering
+     * fails the case instead of hanging the run.
+     */
+    class TestClient
+    {
+    public:
+        static constexpr int timeoutMs = 5000;
+
+        ~TestClient()
+        {
+            if (fd >= 0)
+                close(fd);
+        }
+
+        bool connectTo(const juce::String& path)
+        {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, path.toRawUTF8(), sizeof(address.sun_path) - 1);
+
+            fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            const timeval timeout{ timeoutMs / 1000, 0 };
+            return fd >= 0
+                && setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0
+                && connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+        }
+
+        /** Sends the whole of text; false if the connection failed. */
+        bool sendAll(const std::string& text)
+        {
+            for (size_t sent = 0; sent < text.size();)
+            {
+                const auto n = send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0)
+                    return false;
+                sent += (size_t)n;
+            }
+            return true;
+        }
+
+        /** Sends without waiting: as much of text as the socket takes now. */
+        size_t sendSome(const std::string& text)
+        {
+            const auto n = send(fd, text.data(), text.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+            return n > 0 ? (size_t)n : 0;
+        }
+
+        /** Next reply line, without its newline; empty on timeout or EOF. */
+        juce::String readLine()
+        {
+            char buffer[4096];
+            for (;;)
+            {
+                const auto end = input.find('\n');
+                if (end != std::string::npos)
+                {
+                    auto line = juce::String::fromUTF8(input.data(), (int)end);
+                    input.erase(0, end + 1);
+                    return line;
+                }
+
+                const auto n = recv(fd, buffer, sizeof(buffer), 0);
+                if (n <= 0)
+                    return {};
+                input.append(buffer, (size_t)n);
+            }
+        }
+
+        /** Sends one command and returns the first line of its reply. */
+        juce::String command(const juce::String& line)
+        {
+            return sendAll(line.toStdString() + "\n") ? readLine() : juce::String();
+        }
+
+    private:
+        int fd{ -1 };
+        std::string input;
+    };
+
+    /** The ids in a reply's "ids=a,b" field. */
+    juce::StringArray idsOf(const juce::String& reply)
+    {
+        return juce::StringArray::fromTokens(reply.fromFirstOccurrenceOf("ids=", false, false), ",", "");
+    }
+
+    /**
+     * Runs the commands of a show-control script over the socket and checks each
+     * reply, and that the edits reached the processor.
+     */
+    MtcGoldenSuite::Result checkRoundTrip(const juce::String& path, MTCGenAudioProcessor& processor)
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "socket_round_trip";
+
+        TestClient client;
+        if (!client.connectTo(path))
+        {
+            r.message = "could not connect to " + path;
+            return r;
+        }
+
+        const auto pong = client.command("ping");
+        const auto status = client.command("status");
+        const auto added = client.command("add note=70 tc=02:00:00:00 label=Over the socket");
+        const auto id = added.fromFirstOccurrenceOf("ok ", false, false).trim();
+        const auto got = client.command("get " + id);
+        const auto begun = client.command("begin");
+        const auto queued1 = client.command("add note=71 tc=02:10:00:00");
+        const auto queued2 = client.command("add note=72 tc=02:20:00:00");
+        const auto committed = client.command("commit");
+        const auto listed = client.command("list");
+        const int numListed = listed.fromFirstOccurrenceOf("ok ", false, false).getIntValue();
+        juce::StringArray cueLines;
+        for (int i = 0; i < numListed; ++i)
+            cueLines.add(client.readLine());
+        const auto unknown = client.command("frobnicate");
+
+        if (pong != "ok pong")
+            r.message = "ping replied '" + pong + "'";
+        else if (!status.startsWith("ok playing="))
+            r.message = "status replied '" + status + "'";
+        else if (id.getIntValue() <= 0 || !got.startsWith("ok " + id + " note=70 tc=02:00:00:00")
+                 || !got.endsWith("label=Over the socket"))
+            r.message = "add replied '" + added + "', get '" + got + "'";
+        else if (begun != "ok" || queued1 != "ok queued" || queued2 != "ok queued"
+                 || !committed.startsWith("ok 2 ids=") || idsOf(committed).size() != 2)
+            r.message = "batch replied '" + begun + "', '" + queued1 + "', '" + queued2 + "', '"
+                + committed + "'";
+        else if (numListed != 4 || cueLines.size() != 4 || cueLines.contains({}))
+            r.message = "list replied '" + listed + "' and " + juce::String(cueLines.size()) + " lines";
+        else if (!unknown.startsWith("err "))
+            r.message = "an unknown command replied '" + unknown + "'";
+        else if (processor.getCues().size() != 4)
+            r.message = "the processor has " + juce::String(processor.getCues().size()) + " cues";
+        else
+            r.passed = true;
+        return r;
+    }
+
+    /**
+     * One client sends pings as fast as the socket takes them and never reads the
+     * replies, until its socket is full. Another client's commands, message-thread ones
+     * included, must still be answered, every one well within the reply timeout.
+     */
+    MtcGoldenSuite::Result checkSlowReader(const juce::String& path)
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "socket_slow_reader";
+
+        TestClient flooder, other;
+        if (!flooder.connectTo(path) || !other.connectTo(path))
+        {
+            r.message = "could not connect to " + path;
+            return r;
+        }
+
+        std::string pings;
+        for (int i = 0; i < 4096; ++i)
+            pings += "ping\n";
+
+        // Until the socket stays full for 200 ms: the server has stopped reading it
+        size_t flooded = 0;
+        auto lastProgress = juce::Time::getMillisecondCounterHiRes();
+        while (juce::Time::getMillisecondCounterHiRes() - lastProgress < 200.0 && flooded < (64u << 20))
+        {
+            const auto n = flooder.sendSome(pings);
+            if (n > 0)
+                lastProgress = juce::Time::getMillisecondCounterHiRes();
+            else
+                juce::Thread::sleep(5);
+            flooded += n;
+        }
+
+        double slowestMs = 0.0;
+        for (int i = 0; i < 50 && r.message.isEmpty(); ++i)
+        {
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            const auto reply = other.command(i % 2 == 0 ? "ping" : "status");
+            slowestMs = juce::jmax(slowestMs, juce::Time::getMillisecondCounterHiRes() - start);
+            if (!reply.startsWith("ok "))
+                r.message = "command " + juce::String(i) + " replied '" + reply + "' while another client was full";
+        }
+
+        if (r.message.isEmpty() && slowestMs > ControlServer::replyTimeoutMs / 4)
+            r.message = juce::String::formatted("slowest reply %.1f ms while another client was full", slowestMs);
+
+        r.passed = r.message.isEmpty();
+        if (r.passed)
+            r.message = juce::String::formatted("%d KB unread by one client, slowest reply to the other %.2f ms",
+                (int)(flooded / 1024), slowestMs);
+        return r;
+    }
+
+    /** Round trips of one command; false if any failed. */
+    bool timeCommand(TestClient& client, const juce::String& command, int count, juce::String& summary)
+    {
+        std::vector<double> us;
+        us.reserve((size_t)count);
+        for (int i = 0; i < count; ++i)
+        {
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            const auto reply = client.command(command);
+            if (!reply.startsWith("ok"))
+                return false;
+            for (int extra = command == "list" ? reply.substring(3).getIntValue() : 0; extra > 0; --extra)
+                client.readLine();
+            us.push_back((juce::Time::getMillisecondCounterHiRes() - start) * 1000.0);
+        }
+
+        std::sort(us.begin(), us.end());
+        summary << (summary.isEmpty() ? "" : "; ") << command << juce::String::formatted(
+            " min %.1f median %.1f p99 %.1f max %.1f us",
+            us.front(), us[us.size() / 2], us[us.size() * 99 / 100], us.back());
+        return true;
+    }
+
+    /**
+     * The round trips Examples/MtcControlClient.c --bench measures, against the real
+     * server and processor: ping stays on the socket thread, status and list take the
+     * message-thread hop.
+     */
+    MtcGoldenSuite::Result checkBench(const juce::String& path)
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "socket_bench";
+
+        TestClient client;
+        if (!client.connectTo(path))
+        {
+            r.message = "could not connect to " + path;
+            return r;
+        }
+
+        juce::String summary;
+        for (auto* command : { "ping", "status", "list" })
+            if (!timeCommand(client, command, 2000, summary))
+            {
+                r.message = juce::String(command) + " failed during the benchmark";
+                return r;
+            }
+
+        r.passed = true;
+        r.message = summary;
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> ControlServerSuite::run()
+{
+    MTCGenAudioProcessor processor;
+    auto& server = processor.getControlServer();
+    const auto socketFile = juce::File::createTempFile(".sock");
+    server.setPath(socketFile.getFullPathName());
+
+    if (!server.setEnabled(true))
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "socket_round_trip";
+        r.message = server.getLastError();
+        return { r };
+    }
+
+    // The commands run on the message thread, so the client works from its own thread
+    std::vector<MtcGoldenSuite::Result> results;
+    std::thread client([&]() {
+        const auto path = socketFile.getFullPathName();
+        results.push_back(checkRoundTrip(path, processor));
+        results.push_back(checkSlowReader(path));
+        results.push_back(checkBench(path));
+        juce::MessageManager::getInstance()->stopDispatchLoop();
+        });
+    juce::MessageManager::getInstance()->runDispatchLoop();
+    client.join();
+
+    server.setEnabled(false);
+    return results;
+}
+
+#else
+
+std::vector<MtcGoldenSuite::Result> ControlServerSuite::run()
+{
+    return {};
+}
+
+#endif
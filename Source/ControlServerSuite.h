@@ -0,0 +1,35 @@
+/**
+ * @file ControlServerSuite.h
+ * @brief Declaration of ControlServerSuite, loopback checks of the control socket.
+ */
+
+#ifndef CONTROLSERVERSUITE_H_INCLUDED
+#define CONTROLSERVERSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class ControlServerSuite
+ * @brief Starts a processor's ControlServer on a temporary socket and talks to it from a
+ * client thread, while the main thread runs the message loop the commands execute on:
+ *
+ * - "socket_round_trip": ping, status, add, get, a begin/commit batch and list, each
+ *   answered over the socket
+ * - "socket_slow_reader": a client that floods the server and never reads must not
+ *   hold up another client's commands
+ * - "socket_bench": round-trip latency of ping (socket thread only), status and list
+ *   (through the message thread), reported as min/median/p99/max
+ *
+ * The message loop can only be run once in a process, so this is the one suite that
+ * runs it. Returns no cases on Windows, where the control socket is not available.
+ */
+class ControlServerSuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // CONTROLSERVERSUITE_H_INCLUDED
@@ -0,0 +1,193 @@
+/**
+ * @file CueBankSet.cpp
+ * @brief Definitions for CueBankSet methods.
+ */
+
+#include "CueBankSet.h"
+#include <algorithm>
+
+//==============================================================================
+CueBankSet::CueBankSet()
+{
+    addBank("Bank 1");
+}
+
+int CueBankSet::addBank(const juce::String& name)
+{
+    if (owned.size() >= maxBanks)
+        return -1;
+
+    owned.add(new CueStore());
+    names.add(name);
+    publish([](int active) { return active; });
+    return owned.size() - 1;
+}
+
+void CueBankSet::removeBank(int index)
+{
+    if (owned.size() <= 1 || !juce::isPositiveAndBelow(index, owned.size()))
+        return;
+
+    collectRetired();
+    auto* removed = owned.removeAndReturn(index);
+    names.remove(index);
+
+    // Later banks move down one; removing the active bank selects the one taking its place
+    const int remaining = owned.size();
+    publish([index, remaining](int active) {
+        return active > index || active >= remaining ? active - 1 : active;
+        });
+    retire(removed);
+}
+
+const CueStore* CueBankSet::replaceBank(int index, std::unique_ptr<CueStore> replacement)
+{
+    if (!juce::isPositiveAndBelow(index, owned.size()) || replacement == nullptr)
+        return nullptr;
+
+    collectRetired();
+    auto* old = owned[index];
+    auto* fresh = replacement.release();
+    owned.set(index, fresh, false);
+
+    // Replaced in the published table in place: selection names the slot, not the bank,
+    // so it picks the new bank up without being touched
+    const auto word = selection.load(std::memory_order_acquire);
+    tables[(size_t)tableOf(word)].slots[(size_t)index].store(fresh, std::memory_order_release);
+    bumpLayoutVersion();
+    retire(old);
+    return old;
+}
+
+void CueBankSet::clear()
+{
+    // Publish a fresh bank before retiring the old ones, so getActive() never dangles
+    collectRetired();
+    juce::Array<CueStore*> old;
+    while (!owned.isEmpty())
+        old.add(owned.removeAndReturn(owned.size() - 1));
+    names.clear();
+
+    owned.add(new CueStore());
+    names.add("Bank 1");
+    publish([](int) { return 0; });
+
+    for (auto* bank : old)
+        retire(bank);
+}
+
+void CueBankSet::purgeRetired()
+{
+    retired.clear();
+}
+
+/**
+ * @brief A bank retired while n blocks had started can only be held by those blocks, as
+ * any later block loads the active bank through the new table or slot; once n blocks
+ * have finished it is unreachable. select() only ever stores an index, so it cannot
+ * bring a retired bank back.
+ */
+void CueBankSet::collectRetired()
+{
+    const auto finished = blocksFinished.load(std::memory_order_acquire);
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+        [finished](const RetiredBank& r) { return r.epoch <= finished; }), retired.end());
+}
+
+void CueBankSet::waitForRunningBlocks() const
+{
+    // Ordered after the caller's stores, as in retire(): a block counted after this load
+    // started after them
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto started = blocksStarted.load();
+    while (blocksFinished.load(std::memory_order_acquire) < started)
+        juce::Thread::sleep(1);
+}
+
+void CueBankSet::retire(CueStore* bank)
+{
+    // Ordered after the stores that unpublished the bank: a block counted after this
+    // load started after them and cannot have found it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    retired.push_back({ std::unique_ptr<CueStore>(bank), blocksStarted.load() });
+}
+
+//==============================================================================
+juce::String CueBankSet::getBankName(int index) const
+{
+    return names[index];
+}
+
+void CueBankSet::setBankName(int index, const juce::String& name)
+{
+    if (juce::isPositiveAndBelow(index, names.size()))
+    {
+        names.set(index, name);
+        bumpLayoutVersion();
+    }
+}
+
+/**
+ * @brief The index is checked against the table named by the same word the swap
+ * replaces, so if publish() switches tables in between, the swap fails and the index is
+ * checked again against the new one.
+ */
+bool CueBankSet::select(int index) noexcept
+{
+    auto word = selection.load(std::memory_order_acquire);
+    do
+    {
+        const auto& table = tables[(size_t)tableOf(word)];
+        if (!juce::isPositiveAndBelow(index, table.numBanks.load(std::memory_order_acquire)))
+            return false;
+    }
+    while (!selection.compare_exchange_weak(word, pack(tableOf(word), index), std::memory_order_acq_rel));
+
+    bumpLayoutVersion();
+    return true;
+}
+
+int CueBankSet::getMaxPreRollFrames() const noexcept
+{
+    int maxFrames = 0;
+    for (auto* bank : owned)
+        maxFrames = juce::jmax(maxFrames, bank->getMaxPreRollFrames());
+    return maxFrames;
+}
+
+//==============================================================================
+void CueBankSet::publish(const std::function<int(int)>& remap)
+{
+    waitForSpareTable();
+
+    // Only this thread switches tables, so the spare stays the spare across retries
+    auto word = selection.load(std::memory_order_acquire);
+    const int spare = 1 - tableOf(word);
+    auto& table = tables[(size_t)spare];
+    const int n = owned.size();
+    for (int i = 0; i < n; ++i)
+        table.slots[(size_t)i].store(owned[i], std::memory_order_relaxed);
+    table.numBanks.store(n, std::memory_order_relaxed);
+
+    // A program change that lands first is moved with its bank; one that lands after
+    // fails its swap on the old table and retries on this one
+    while (!selection.compare_exchange_weak(word,
+        pack(spare, juce::jlimit(0, n - 1, remap(indexOf(word)))), std::memory_order_acq_rel))
+    {
+    }
+
+    // Blocks counted after this load start after the switch and never see the old table
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    spareTableEpoch = blocksStarted.load();
+    bumpLayoutVersion();
+}
+
+/**
+ * @brief A block lasts milliseconds, so an add or remove waits at most that long; with
+ * no block running it returns at once.
+ */
+void CueBankSet::waitForSpareTable() const
+{
+    while (blocksFinished.load(std::memory_order_acquire) < spareTableEpoch)
+        juce::Thread::sleep(1);
+}
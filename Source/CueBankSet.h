@@ -0,0 +1,201 @@
+/**
+ * @file CueBankSet.h
+ * @brief Declaration of the CueBankSet class, named banks of cues switched in constant time.
+ */
+
+#ifndef CUEBANKSET_H_INCLUDED
+#define CUEBANKSET_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "CueStore.h"
+
+/**
+ * @class CueBankSet
+ * @brief Holds up to 128 named banks of mappings (one per MIDI program), each a
+ * complete CueStore with its own lookup arrays, and the bank currently driving output.
+ *
+ * The banks are published as a table of pointers, and the active bank is one atomic
+ * word holding both the table and the index into it, so the index and the bank it
+ * names can never disagree. select() may be called from the audio thread (on a program
+ * change) as well as from the UI: it is a compare-and-swap on that word, takes constant
+ * time whatever the bank sizes, never allocates and never locks.
+ *
+ * Adding, removing and renaming banks is message-thread only. Adding or removing a bank
+ * fills the spare of two tables and switches to it with a compare-and-swap that also
+ * moves the active index, so a program change racing it is kept (and shifted with its
+ * bank) rather than undone, and a select() still holding the old table fails and
+ * retries on the new one. A removed or replaced bank is retired rather than deleted,
+ * because the audio thread may still be reading it. The audio thread brackets every
+ * block with beginBlock()/endBlock(); each retired bank (and each table switched away
+ * from) is stamped with the number of blocks started at the time, and is freed (or
+ * refilled) once that many blocks have finished. purgeRetired() frees them all once
+ * audio processing has stopped.
+ */
+class CueBankSet
+{
+public:
+    static constexpr int maxBanks = 128; /**< One per MIDI program number */
+
+    /** Constructor: starts with one empty bank. */
+    CueBankSet();
+
+    /** @brief Number of banks (at least one). Any thread. */
+    int getNumBanks() const noexcept
+    {
+        return tables[(size_t)tableOf(selection.load(std::memory_order_acquire))].numBanks.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Appends an empty bank. Message thread.
+     * @return Index of the new bank, or -1 if maxBanks are in use.
+     */
+    int addBank(const juce::String& name);
+
+    /**
+     * @brief Removes a bank, shifting the later ones down. The last remaining bank
+     * cannot be removed. Message thread.
+     */
+    void removeBank(int index);
+
+    /**
+     * @brief Swaps an edited copy in for the bank at index in one pointer store, so the
+     * audio thread sees either the old cues or the new ones, never a partial edit. The
+     * old bank is retired. Message thread.
+     * @return The retired bank (alive at least until the next change), or nullptr if
+     *         index is out of range.
+     */
+    const CueStore* replaceBank(int index, std::unique_ptr<CueStore> replacement);
+
+    /** @brief Retires every bank and starts again with one empty bank. Message thread. */
+    void clear();
+
+    /**
+     * @brief Frees retired banks. Message thread, and only while the audio thread is not
+     * processing.
+     */
+    void purgeRetired();
+
+    /**
+     * @brief Frees the retired banks no block can still be reading. Message thread;
+     * every change that retires a bank calls it first, so at most the banks retired
+     * since the last finished block are kept.
+     */
+    void collectRetired();
+
+    /**
+     * @brief Waits until every block started before the call has finished, so a bank
+     * retired before it is no longer written. Message thread; returns at once while no
+     * block is running.
+     */
+    void waitForRunningBlocks() const;
+
+    /** @name Block epoch (audio thread, around each processBlock) */
+    //@{
+    void beginBlock() noexcept { blocksStarted.fetch_add(1); }
+    void endBlock() noexcept { blocksFinished.fetch_add(1, std::memory_order_release); }
+    //@}
+
+    /** @name Names (message thread) */
+    //@{
+    juce::String getBankName(int index) const;
+    void setBankName(int index, const juce::String& name);
+    //@}
+
+    /** @brief The bank at index. Message thread. */
+    CueStore& getBank(int index) { return *owned[index]; }
+
+    /**
+     * @brief The bank driving output. Message or audio thread; the audio thread loads
+     * it once per block (and again after a program change) and uses that reference for
+     * the whole block, as a bank replaced meanwhile stays alive until the block ends.
+     */
+    CueStore& getActive() noexcept { return *bankAt(selection.load(std::memory_order_acquire)); }
+    const CueStore& getActive() const noexcept { return *bankAt(selection.load(std::memory_order_acquire)); }
+
+    /** @brief Index of the bank driving output. Any thread. */
+    int getActiveIndex() const noexcept { return indexOf(selection.load(std::memory_order_acquire)); }
+
+    /**
+     * @brief The active bank and its index from one read, so the two always match even
+     * with a select() on another thread in between. Any thread.
+     */
+    CueStore& getActive(int& index) noexcept
+    {
+        const auto word = selection.load(std::memory_order_acquire);
+        index = indexOf(word);
+        return *bankAt(word);
+    }
+
+    /**
+     * @brief Makes a bank the active one. Constant time, lock- and allocation-free;
+     * safe on the audio thread, and on the message thread while it runs.
+     * @return False if index is out of range (the active bank is left unchanged).
+     */
+    bool select(int index) noexcept;
+
+    /** @brief Longest pre-roll of any cue in any bank, in frames. Message thread. */
+    int getMaxPreRollFrames() const noexcept;
+
+    /** @brief Changes when banks are added, removed, renamed or selected. */
+    juce::uint32 getLayoutVersion() const noexcept { return layoutVersion.load(std::memory_order_relaxed); }
+
+private:
+    /** A published table of banks. Only the spare table is ever refilled. */
+    struct BankTable
+    {
+        std::array<std::atomic<CueStore*>, maxBanks> slots{};
+        std::atomic<int> numBanks{ 0 };
+    };
+
+    /** The active-bank word: table in bit 8, bank index in the low byte. */
+    static constexpr juce::uint32 pack(int table, int index) noexcept { return (juce::uint32)(table << 8 | index); }
+    static constexpr int tableOf(juce::uint32 word) noexcept { return (int)(word >> 8) & 1; }
+    static constexpr int indexOf(juce::uint32 word) noexcept { return (int)(word & 0xff); }
+    CueStore* bankAt(juce::uint32 word) const noexcept
+    {
+        return tables[(size_t)tableOf(word)].slots[(size_t)indexOf(word)].load(std::memory_order_acquire);
+    }
+
+    /**
+     * Fills the spare table from owned[] and switches to it, moving the active index
+     * through remap (old index to new) in the same compare-and-swap.
+     */
+    void publish(const std::function<int(int)>& remap);
+
+    /** Waits until no block that may still read the spare table is running. */
+    void waitForSpareTable() const;
+
+    void bumpLayoutVersion() noexcept { layoutVersion.fetch_add(1, std::memory_order_relaxed); }
+
+    /** Keeps a bank that is no longer published until the blocks running now are done. */
+    void retire(CueStore* bank);
+
+    /** A retired bank and the block count that must have finished before it is freed. */
+    struct RetiredBank
+    {
+        std::unique_ptr<CueStore> bank;
+        juce::uint64 epoch;
+    };
+
+    // Read by select() and getActive() on any thread
+    std::array<BankTable, 2> tables;
+    std::atomic<juce::uint32> selection{ pack(0, 0) };  /**< Only word naming the active bank */
+    std::atomic<juce::uint32> layoutVersion{ 0 };
+    std::atomic<juce::uint64> blocksStarted{ 0 };
+    std::atomic<juce::uint64> blocksFinished{ 0 };
+
+    // Message thread only
+    juce::uint64 spareTableEpoch{ 0 };  /**< Blocks started when the spare was switched away from */
+    juce::OwnedArray<CueStore> owned;   /**< Banks in program order */
+    std::vector<RetiredBank> retired;   /**< Removed banks, see collectRetired() */
+    juce::StringArray names;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CueBankSet)
+};
+
+#endif // CUEBANKSET_H_INCLUDED
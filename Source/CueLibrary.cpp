@@ -0,0 +1,317 @@
+/**
+ * @file CueLibrary.cpp
+ * @brief Definitions for CueLibrary methods and the .mtclib file layout.
+ */
+
+#include "CueLibrary.h"
+#include "CueBankSet.h"
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace
+{
+    constexpr char libraryMagic[8] = { 'M', 'T', 'C', 'L', 'I', 'B', 0, 0 };
+    constexpr juce::uint32 byteOrderMark = 0x01020304;
+    constexpr juce::uint32 formatVersion = 1;
+
+    enum Column
+    {
+        banksColumn, notesColumn, wholeSecondsColumn, frameNumbersColumn, preRollColumn,
+        cueIdsColumn, startTimesColumn, endTimesColumn, labelsColumn, timecodesColumn,
+        stringsColumn, numColumns
+    };
+
+    /** Byte range of a UTF-8 string in the string table. */
+    struct StringRef
+    {
+        juce::uint32 offset;
+        juce::uint32 length;
+    };
+
+    struct BankRecord
+    {
+        juce::uint32 firstCue;
+        juce::uint32 numCues;
+        juce::uint32 nextCueId;
+        juce::uint32 reserved;
+        StringRef name;
+    };
+
+    /** Start of the file. Every column starts on an 8-byte boundary. */
+    struct Header
+    {
+        char magic[8];
+        juce::uint32 byteOrder;
+        juce::uint32 version;
+        juce::uint32 numBanks;
+        juce::uint32 numCues;
+        juce::uint32 stringBytes;
+        juce::uint32 reserved;
+        juce::uint64 offsets[numColumns];
+    };
+
+    juce::uint64 columnBytes(const Header& h, int c) noexcept
+    {
+        const auto n = (juce::uint64)h.numCues;
+        switch (c)
+        {
+            case banksColumn:        return h.numBanks * (juce::uint64)sizeof(BankRecord);
+            case notesColumn:        return n * sizeof(int8_t);
+            case wholeSecondsColumn:
+            case frameNumbersColumn:
+            case preRollColumn:      return n * sizeof(int32_t);
+            case cueIdsColumn:       return n * sizeof(CueStore::CueId);
+            case startTimesColumn:
+            case endTimesColumn:     return n * sizeof(double);
+            case labelsColumn:
+            case timecodesColumn:    return n * sizeof(StringRef);
+            case stringsColumn:      return h.stringBytes;
+            default:                 return 0;
+        }
+    }
+
+    juce::uint64 align8(juce::uint64 n) noexcept { return (n + 7) & ~(juce::uint64)7; }
+
+    const Header& headerOf(const char* base) noexcept { return *reinterpret_cast<const Header*>(base); }
+
+    // One mapping per file per process; instances hold it, the cache only finds it
+    juce::CriticalSection cacheLock;
+    std::map<juce::String, std::weak_ptr<const CueLibrary>> cache;
+}
+
+//==============================================================================
+CueLibrary::CueLibrary(const juce::File& sourceFile, std::unique_ptr<juce::MemoryMappedFile> mapping)
+    : file(sourceFile), modificationTime(sourceFile.getLastModificationTime()),
+    mapped(std::move(mapping)), base(static_cast<const char*>(mapped->getData()))
+{
+}
+
+std::shared_ptr<const CueLibrary> CueLibrary::open(const juce::File& file, juce::String& error)
+{
+    const auto key = file.getFullPathName();
+    const juce::ScopedLock sl(cacheLock);
+
+    auto cached = cache.find(key);
+    if (cached != cache.end())
+        if (auto existing = cached->second.lock())
+            if (existing->modificationTime == file.getLastModificationTime())
+                return existing;
+
+    auto mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly, false);
+    if (mapping->getData() == nullptr)
+    {
+        error = "Could not map " + key;
+        return nullptr;
+    }
+
+    std::shared_ptr<const CueLibrary> library(new CueLibrary(file, std::move(mapping)));
+    if (!library->validate(error))
+        return nullptr;
+
+    cache[key] = library;
+    return library;
+}
+
+bool CueLibrary::validate(juce::String& error) const
+{
+    const auto size = (juce::uint64)mapped->getSize();
+    const auto& h = headerOf(base);
+
+    if (size < sizeof(Header) || std::memcmp(h.magic, libraryMagic, sizeof(libraryMagic)) != 0)
+        error = file.getFileName() + " is not a cue library";
+    else if (h.byteOrder != byteOrderMark)
+        error = file.getFileName() + " was written on a machine with the other byte order";
+    else if (h.version != formatVersion)
+        error = file.getFileName() + " is cue library version " + juce::String(h.version)
+            + ", this build reads version " + juce::String(formatVersion);
+
+    for (int c = 0; c < numColumns && error.isEmpty(); ++c)
+        if (h.offsets[c] % 8 != 0 || h.offsets[c] < sizeof(Header) || h.offsets[c] > size
+            || columnBytes(h, c) > size - h.offsets[c])
+            error = file.getFileName() + " is truncated or corrupt";
+
+    for (int b = 0; b < (int)h.numBanks && error.isEmpty(); ++b)
+    {
+        const auto& bank = reinterpret_cast<const BankRecord*>(column(banksColumn))[b];
+        if ((juce::uint64)bank.firstCue + bank.numCues > h.numCues)
+            error = file.getFileName() + " has a corrupt bank table";
+    }
+
+    return error.isEmpty();
+}
+
+//==============================================================================
+/**
+ * @brief Packs the banks' columns into one block, every column 8-byte aligned, and
+ * replaces the file with it in one go.
+ */
+bool CueLibrary::write(CueBankSet& banks, const juce::File& file, juce::String& error)
+{
+    std::vector<BankRecord> bankRecords;
+    std::vector<int8_t> notes;
+    std::vector<int32_t> wholeSeconds, frameNumbers, preRolls;
+    std::vector<CueStore::CueId> cueIds;
+    std::vector<double> startTimes, endTimes;
+    std::vector<StringRef> labels, timecodes;
+    juce::MemoryOutputStream strings;
+
+    auto addString = [&strings](const juce::String& s) {
+        StringRef ref{ (juce::uint32)strings.getDataSize(), (juce::uint32)s.getNumBytesAsUTF8() };
+        strings.write(s.toRawUTF8(), ref.length);
+        return ref;
+    };
+
+    for (int b = 0; b < banks.getNumBanks(); ++b)
+    {
+        auto& cues = banks.getBank(b);
+        BankRecord record{ (juce::uint32)notes.size(), (juce::uint32)cues.size(), 1, 0,
+                           addString(banks.getBankName(b)) };
+
+        for (int i = 0; i < cues.size(); ++i)
+        {
+            int hh, mm, ss, ff;
+            MappingEntry::parseTimecode(cues.getTimecodeString(i), hh, mm, ss, ff);
+
+            notes.push_back((int8_t)cues.getMidiNote(i));
+            wholeSeconds.push_back((hh * 60 + mm) * 60 + ss);
+            frameNumbers.push_back(ff);
+            preRolls.push_back(cues.getPreRollFrames(i));
+            cueIds.push_back(cues.getCueId(i));
+            startTimes.push_back(cues.getDetectedStartTime(i));
+            endTimes.push_back(cues.getDetectedEndTime(i));
+            labels.push_back(addString(cues.getLabel(i)));
+            timecodes.push_back(addString(cues.getTimecodeString(i)));
+            record.nextCueId = juce::jmax(record.nextCueId, cues.getCueId(i) + 1);
+        }
+        bankRecords.push_back(record);
+    }
+
+    Header h{};
+    std::memcpy(h.magic, libraryMagic, sizeof(libraryMagic));
+    h.byteOrder = byteOrderMark;
+    h.version = formatVersion;
+    h.numBanks = (juce::uint32)bankRecords.size();
+    h.numCues = (juce::uint32)notes.size();
+    h.stringBytes = (juce::uint32)strings.getDataSize();
+
+    const void* columns[numColumns] = {
+        bankRecords.data(), notes.data(), wholeSeconds.data(), frameNumbers.data(),
+        preRolls.data(), cueIds.data(), startTimes.data(), endTimes.data(),
+        labels.data(), timecodes.data(), strings.getData()
+    };
+
+    juce::uint64 end = align8(sizeof(Header));
+    for (int c = 0; c < numColumns; ++c)
+    {
+        h.offsets[c] = end;
+        end = align8(end + columnBytes(h, c));
+    }
+
+    juce::MemoryBlock data((size_t)end, true);
+    std::memcpy(data.getData(), &h, sizeof(h));
+    for (int c = 0; c < numColumns; ++c)
+        if (columnBytes(h, c) > 0)
+            std::memcpy(static_cast<char*>(data.getData()) + h.offsets[c], columns[c],
+                (size_t)columnBytes(h, c));
+
+    if (!file.replaceWithData(data.getData(), data.getSize()))
+    {
+        error = "Could not write " + file.getFullPathName();
+        return false;
+    }
+    return true;
+}
+
+//==============================================================================
+const char* CueLibrary::column(int index) const noexcept
+{
+    return base + headerOf(base).offsets[index];
+}
+
+juce::String CueLibrary::getString(const void* refs, int index) const
+{
+    const auto& ref = static_cast<const StringRef*>(refs)[index];
+    if ((juce::uint64)ref.offset + ref.length > headerOf(base).stringBytes)
+        return {};
+    return juce::String::fromUTF8(column(stringsColumn) + ref.offset, (int)ref.length);
+}
+
+int CueLibrary::getNumBanks() const noexcept
+{
+    return (int)headerOf(base).numBanks;
+}
+
+juce::String CueLibrary::getBankName(int bank) const
+{
+    const auto* banks = reinterpret_cast<const BankRecord*>(column(banksColumn));
+    return juce::isPositiveAndBelow(bank, getNumBanks()) ? getString(&banks[bank].name, 0) : juce::String();
+}
+
+int CueLibrary::getFirstCue(int bank) const noexcept
+{
+    const auto* banks = reinterpret_cast<const BankRecord*>(column(banksColumn));
+    return juce::isPositiveAndBelow(bank, getNumBanks()) ? (int)banks[bank].firstCue : 0;
+}
+
+int CueLibrary::getNumCues(int bank) const noexcept
+{
+    const auto* banks = reinterpret_cast<const BankRecord*>(column(banksColumn));
+    return juce::isPositiveAndBelow(bank, getNumBanks()) ? (int)banks[bank].numCues : 0;
+}
+
+CueStore::CueId CueLibrary::getNextCueId(int bank) const noexcept
+{
+    const auto* banks = reinterpret_cast<const BankRecord*>(column(banksColumn));
+    return juce::isPositiveAndBelow(bank, getNumBanks()) ? banks[bank].nextCueId : 1;
+}
+
+int CueLibrary::getTotalNumCues() const noexcept
+{
+    return (int)headerOf(base).numCues;
+}
+
+const int8_t* CueLibrary::getMidiNotes() const noexcept
+{
+    return reinterpret_cast<const int8_t*>(column(notesColumn));
+}
+
+const int32_t* CueLibrary::getBaseWholeSeconds() const noexcept
+{
+    return reinterpret_cast<const int32_t*>(column(wholeSecondsColumn));
+}
+
+const int32_t* CueLibrary::getBaseFrameNumbers() const noexcept
+{
+    return reinterpret_cast<const int32_t*>(column(frameNumbersColumn));
+}
+
+const int32_t* CueLibrary::getPreRollFrames() const noexcept
+{
+    return reinterpret_cast<const int32_t*>(column(preRollColumn));
+}
+
+const CueStore::CueId* CueLibrary::getCueIds() const noexcept
+{
+    return reinterpret_cast<const CueStore::CueId*>(column(cueIdsColumn));
+}
+
+const double* CueLibrary::getStartTimes() const noexcept
+{
+    return reinterpret_cast<const double*>(column(startTimesColumn));
+}
+
+const double* CueLibrary::getEndTimes() const noexcept
+{
+    return reinterpret_cast<const double*>(column(endTimesColumn));
+}
+
+juce::String CueLibrary::getLabel(int cue) const
+{
+    return getString(column(labelsColumn), cue);
+}
+
+juce::String CueLibrary::getTimecodeString(int cue) const
+{
+    return getString(column(timecodesColumn), cue);
+}
@@ -0,0 +1,100 @@
+/**
+ * @file CueLibrary.h
+ * @brief Declaration of the CueLibrary class, a read-only cue file mapped into memory.
+ */
+
+#ifndef CUELIBRARY_H_INCLUDED
+#define CUELIBRARY_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <cstdint>
+#include <memory>
+#include "CueStore.h"
+
+class CueBankSet;
+
+/**
+ * @class CueLibrary
+ * @brief A show's cue banks in a binary file (.mtclib) that plugin instances map
+ * read-only instead of each parsing and holding their own copy.
+ *
+ * The file is laid out like CueStore: one packed column per field (notes, base
+ * timecodes, pre-rolls, cue ids, default learned times) across every bank's cues, plus
+ * a string table for labels and timecode strings. A CueStore linked to a library bank
+ * (CueStore::attachLibrary()) reads those columns in place; it keeps only its own
+ * learned times and active flags, and takes a private copy of the bank the first time
+ * one of its cues is edited.
+ *
+ * open() maps each file once per process and hands every instance the same mapping;
+ * instances in other processes share the same pages through the OS page cache. Writing
+ * a library replaces the file, so instances that still map the old one keep it.
+ *
+ * The columns are in the writing machine's byte order; a file from a machine of the
+ * other order is rejected.
+ */
+class CueLibrary
+{
+public:
+    static constexpr const char* fileExtension = ".mtclib";
+
+    /**
+     * @brief Maps a library file, or returns the mapping this process already has of
+     * it (unless the file has changed since). Any thread.
+     * @param error Set to a description of the failure.
+     * @return nullptr if the file cannot be mapped or is not a valid library.
+     */
+    static std::shared_ptr<const CueLibrary> open(const juce::File& file, juce::String& error);
+
+    /**
+     * @brief Writes every bank's cues, names and learned times as a library. Message thread.
+     */
+    static bool write(CueBankSet& banks, const juce::File& file, juce::String& error);
+
+    /** @brief File the library was mapped from. */
+    const juce::File& getFile() const noexcept { return file; }
+
+    /** @name Banks */
+    //@{
+    int getNumBanks() const noexcept;
+    juce::String getBankName(int bank) const;
+
+    /** @brief Library cue number of the bank's first cue. */
+    int getFirstCue(int bank) const noexcept;
+    int getNumCues(int bank) const noexcept;
+
+    /** @brief Cue id a store linked to the bank hands out next. */
+    CueStore::CueId getNextCueId(int bank) const noexcept;
+    //@}
+
+    /** @name Columns, indexed by library cue number */
+    //@{
+    int getTotalNumCues() const noexcept;
+    const int8_t*  getMidiNotes() const noexcept;
+    const int32_t* getBaseWholeSeconds() const noexcept;
+    const int32_t* getBaseFrameNumbers() const noexcept;
+    const int32_t* getPreRollFrames() const noexcept;
+    const CueStore::CueId* getCueIds() const noexcept;
+    const double*  getStartTimes() const noexcept;
+    const double*  getEndTimes() const noexcept;
+    juce::String getLabel(int cue) const;
+    juce::String getTimecodeString(int cue) const;
+    //@}
+
+private:
+    CueLibrary(const juce::File& sourceFile, std::unique_ptr<juce::MemoryMappedFile> mapping);
+
+    /** Checks the header and that every column lies inside the file. */
+    bool validate(juce::String& error) const;
+
+    const char* column(int index) const noexcept;
+    juce::String getString(const void* refs, int index) const;
+
+    juce::File file;
+    juce::Time modificationTime;
+    std::unique_ptr<juce::MemoryMappedFile> mapped;
+    const char* base{ nullptr };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CueLibrary)
+};
+
+#endif // CUELIBRARY_H_INCLUDED
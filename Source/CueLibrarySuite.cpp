@@ -0,0 +1,305 @@
+/**
+ * @file CueLibrarySuite.cpp
+ * @brief Definitions for CueLibrarySuite methods.
+ */
+
+#include "CueLibrarySuite.h"
+#include "CueLibrary.h"
+#include "MTCGenProcessor.h"
+#include <cstring>
+
+namespace
+{
+    /**
+     * Fills a processor with numBanks banks of cuesPerBank cues each (bank 0 keeps its
+     * default cue). Timecodes, notes, pre-rolls and labels vary per cue, labels include
+     * non-ASCII text, every third cue has learned times and every seventh is removed
+     * again, so cue ids have gaps. Bank 1 is left empty.
+     */
+    void buildShow(MTCGenAudioProcessor& processor, int numBanks, int cuesPerBank)
+    {
+        const juce::String bankName(juce::CharPointer_UTF8("B\xc3\xa4nk "));
+        const juce::String scene(juce::CharPointer_UTF8(" \xe2\x80\x93 sc\xc3\xa8ne"));
+
+        for (int b = 0; b < numBanks; ++b)
+        {
+            const int index = b == 0 ? 0 : processor.addBank(bankName + juce::String(b));
+            if (index < 0 || b == 1)
+                continue;
+
+            processor.selectBank(index);
+            processor.editActiveCues([b, cuesPerBank, &scene](CueStore& cues) {
+                for (int i = 0; i < cuesPerBank; ++i)
+                {
+                    const auto tc = juce::String::formatted("%02d:%02d:%02d:%02d",
+                        b % 24, i / 60 % 60, i % 60, i % 25);
+                    const auto label = i % 5 == 0 ? juce::String() : "Cue " + juce::String(i) + scene;
+                    const int cue = cues.add(MappingEntry(tc, (b + i) % 128, label));
+                    cues.setPreRollFrames(cue, i % 11);
+                    if (i % 3 == 0)
+                    {
+                        cues.setDetectedStartTime(cue, b * 1000.0 + i);
+                        cues.setDetectedEndTime(cue, b * 1000.0 + i + 0.5);
+                    }
+                }
+                for (int i = cues.size() - 1; i >= 0; --i)
+                    if (i % 7 == 3)
+                        cues.remove(i);
+                });
+        }
+        processor.selectBank(0);
+    }
+
+    /** Compares every column and string of library with banks; empty if they match. */
+    juce::String compareWithBanks(const CueLibrary& library, CueBankSet& banks)
+    {
+        if (library.getNumBanks() != banks.getNumBanks())
+            return "library has " + juce::String(library.getNumBanks()) + " banks, the show "
+                + juce::String(banks.getNumBanks());
+
+        int cue = 0;
+        for (int b = 0; b < banks.getNumBanks(); ++b)
+        {
+            auto& cues = banks.getBank(b);
+            if (library.getBankName(b) != banks.getBankName(b) || library.getFirstCue(b) != cue
+                || library.getNumCues(b) != cues.size())
+                return "bank " + juce::String(b) + " record differs";
+
+            for (int i = 0; i < cues.size(); ++i, ++cue)
+            {
+                int hh, mm, ss, ff;
+                MappingEntry::parseTimecode(cues.getTimecodeString(i), hh, mm, ss, ff);
+
+                if (library.getMidiNotes()[cue] != cues.getMidiNote(i)
+                    || library.getBaseWholeSeconds()[cue] != (hh * 60 + mm) * 60 + ss
+                    || library.getBaseFrameNumbers()[cue] != ff
+                    || library.getPreRollFrames()[cue] != cues.getPreRollFrames(i)
+                    || library.getCueIds()[cue] != cues.getCueId(i)
+                    || library.getStartTimes()[cue] != cues.getDetectedStartTime(i)
+                    || library.getEndTimes()[cue] != cues.getDetectedEndTime(i)
+                    || library.getLabel(cue) != cues.getLabel(i)
+                    || library.getTimecodeString(cue) != cues.getTimecodeString(i))
+                    return "bank " + juce::String(b) + " cue " + juce::String(i) + " differs";
+
+                if (library.getNextCueId(b) <= cues.getCueId(i))
+                    return "bank " + juce::String(b) + " next cue id "
+                        + juce::String(library.getNextCueId(b)) + " is already taken";
+            }
+        }
+
+        return cue == library.getTotalNumCues() ? juce::String()
+            : "library has " + juce::String(library.getTotalNumCues()) + " cues, the show "
+                + juce::String(cue);
+    }
+
+    /** Compares the banks of a processor linked to a library with banks; empty if they match. */
+    juce::String compareLinked(CueBankSet& linked, CueBankSet& banks)
+    {
+        if (linked.getNumBanks() != banks.getNumBanks())
+            return "linked " + juce::String(linked.getNumBanks()) + " banks of "
+                + juce::String(banks.getNumBanks());
+
+        for (int b = 0; b < banks.getNumBanks(); ++b)
+        {
+            auto& a = linked.getBank(b);
+            auto& e = banks.getBank(b);
+            if (!a.isLinkedToLibrary() || a.getLibraryBank() != b
+                || linked.getBankName(b) != banks.getBankName(b) || a.size() != e.size())
+                return "linked bank " + juce::String(b) + " differs";
+
+            for (int i = 0; i < e.size(); ++i)
+                if (a.getMidiNote(i) != e.getMidiNote(i) || a.getCueId(i) != e.getCueId(i)
+                    || a.getPreRollFrames(i) != e.getPreRollFrames(i)
+                    || a.getBaseSeconds(i, 25.0) != e.getBaseSeconds(i, 25.0)
+                    || a.getDetectedStartTime(i) != e.getDetectedStartTime(i)
+                    || a.getDetectedEndTime(i) != e.getDetectedEndTime(i)
+                    || a.getLabel(i) != e.getLabel(i)
+                    || a.getTimecodeString(i) != e.getTimecodeString(i))
+                    return "linked bank " + juce::String(b) + " cue " + juce::String(i) + " differs";
+        }
+        return {};
+    }
+
+    /**
+     * Writes a six-bank show, opens the file twice and links a second processor to it;
+     * every open must return the same mapping, and it must match the show column by
+     * column, directly and through the linked banks.
+     */
+    MtcGoldenSuite::Result checkRoundTrip()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "library_round_trip";
+
+        MTCGenAudioProcessor source;
+        buildShow(source, 6, 200);
+
+        const auto file = juce::File::createTempFile(CueLibrary::fileExtension);
+        juce::String error;
+        if (!CueLibrary::write(source.getBanks(), file, error))
+        {
+            r.message = error;
+            return r;
+        }
+
+        auto first = CueLibrary::open(file, error);
+        auto second = CueLibrary::open(file, error);
+        MTCGenAudioProcessor linked;
+        const bool linkedOk = linked.linkCueLibrary(file, error);
+        auto third = CueLibrary::open(file, error);
+
+        if (first == nullptr || second == nullptr || !linkedOk)
+            r.message = "could not open the library: " + error;
+        else if (first != second || first != third)
+            r.message = "opening the file again mapped it again";
+        else
+        {
+            r.message = compareWithBanks(*first, source.getBanks());
+            if (r.message.isEmpty())
+                r.message = compareLinked(linked.getBanks(), source.getBanks());
+
+            r.passed = r.message.isEmpty();
+            if (r.passed)
+                r.message = juce::String(first->getNumBanks()) + " banks, "
+                    + juce::String(first->getTotalNumCues()) + " cues, "
+                    + juce::String(file.getSize()) + " bytes";
+        }
+
+        file.deleteFile();
+        return r;
+    }
+
+    /**
+     * Starts from a small valid library and writes altered copies of it: every prefix
+     * short of the string table's end, then the whole file with the header's version
+     * and byte order mark changed (both are uint32s after the 8-byte magic). Each must
+     * fail to open, with an error saying why.
+     */
+    MtcGoldenSuite::Result checkRejects()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "library_rejects";
+
+        MTCGenAudioProcessor source;
+        buildShow(source, 3, 4);
+
+        const auto good = juce::File::createTempFile(CueLibrary::fileExtension);
+        const auto bad = juce::File::createTempFile(CueLibrary::fileExtension);
+        juce::MemoryBlock data;
+        juce::String error;
+        if (!CueLibrary::write(source.getBanks(), good, error) || !good.loadFileAsData(data)
+            || CueLibrary::open(good, error) == nullptr)
+        {
+            r.message = "could not write and open a library: " + error;
+            good.deleteFile();
+            return r;
+        }
+
+        auto opens = [&bad, &error](const void* bytes, size_t size) {
+            error.clear();
+            bad.replaceWithData(bytes, size);
+            return CueLibrary::open(bad, error) != nullptr || error.isEmpty();
+        };
+
+        // The string table ends the file, followed by at most 7 bytes of padding
+        for (size_t size = 0; size + 8 <= data.getSize() && r.message.isEmpty(); ++size)
+            if (opens(data.getData(), size))
+                r.message = "a " + juce::String((int)size) + "-byte prefix of a "
+                    + juce::String((int)data.getSize()) + "-byte library was accepted";
+
+        const struct { size_t offset; juce::uint32 value; const char* expected; } patches[] = {
+            { 8, 0x04030201, "byte order" },
+            { 12, 2, "version" }
+        };
+        for (const auto& patch : patches)
+        {
+            if (r.message.isNotEmpty())
+                break;
+            juce::MemoryBlock altered(data);
+            std::memcpy(static_cast<char*>(altered.getData()) + patch.offset, &patch.value,
+                sizeof(patch.value));
+            if (opens(altered.getData(), altered.getSize()) || !error.contains(patch.expected))
+                r.message = juce::String("a library with the wrong ") + patch.expected
+                    + " was not refused as such: " + error;
+        }
+
+        r.passed = r.message.isEmpty();
+        if (r.passed)
+            r.message = "every prefix of " + juce::String((int)data.getSize())
+                + " bytes refused, and the wrong version and byte order";
+
+        good.deleteFile();
+        bad.deleteFile();
+        return r;
+    }
+
+    /**
+     * A 64-bank show of 1000 cues a bank, loaded into a fresh processor twice: once
+     * from its XML state with setStateInformation(), once by linking its library, the
+     * file just written and so in the page cache. A second instance linking the same
+     * file shares the first one's mapping. The times are reported, not checked.
+     */
+    MtcGoldenSuite::Result checkLoadTime()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "library_load_time";
+
+        MTCGenAudioProcessor source;
+        buildShow(source, 64, 1000);
+
+        juce::MemoryBlock state;
+        source.getStateInformation(state);
+        const auto file = juce::File::createTempFile(CueLibrary::fileExtension);
+        juce::String error;
+        if (!CueLibrary::write(source.getBanks(), file, error))
+        {
+            r.message = error;
+            return r;
+        }
+
+        auto totalCues = [](CueBankSet& banks) {
+            int n = 0;
+            for (int b = 0; b < banks.getNumBanks(); ++b)
+                n += banks.getBank(b).size();
+            return n;
+        };
+
+        MTCGenAudioProcessor fromXml, firstLinked, secondLinked;
+        auto start = juce::Time::getMillisecondCounterHiRes();
+        fromXml.setStateInformation(state.getData(), (int)state.getSize());
+        const double xmlMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+        start = juce::Time::getMillisecondCounterHiRes();
+        const bool firstOk = firstLinked.linkCueLibrary(file, error);
+        const double firstMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+        start = juce::Time::getMillisecondCounterHiRes();
+        const bool secondOk = secondLinked.linkCueLibrary(file, error);
+        const double secondMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+        const int expected = totalCues(source.getBanks());
+        if (!firstOk || !secondOk)
+            r.message = "could not link the library: " + error;
+        else if (totalCues(fromXml.getBanks()) != expected || totalCues(firstLinked.getBanks()) != expected
+                 || totalCues(secondLinked.getBanks()) != expected)
+            r.message = "loaded " + juce::String(totalCues(fromXml.getBanks())) + " cues from XML and "
+                + juce::String(totalCues(firstLinked.getBanks())) + " from the library, of "
+                + juce::String(expected);
+        else
+        {
+            r.passed = true;
+            r.message = juce::String::formatted(
+                "%d cues: XML %.1f ms (%d KB), library %.2f ms (%d KB), second instance %.2f ms",
+                expected, xmlMs, (int)(state.getSize() / 1024), firstMs, (int)(file.getSize() / 1024),
+                secondMs);
+        }
+
+        file.deleteFile();
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> CueLibrarySuite::run()
+{
+    return { checkRoundTrip(), checkRejects(), checkLoadTime() };
+}
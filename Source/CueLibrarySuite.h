@@ -0,0 +1,32 @@
+/**
+ * @file CueLibrarySuite.h
+ * @brief Declaration of CueLibrarySuite, checks of the memory-mapped cue library.
+ */
+
+#ifndef CUELIBRARYSUITE_H_INCLUDED
+#define CUELIBRARYSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class CueLibrarySuite
+ * @brief Writes cue libraries from a processor's banks and maps them back:
+ *
+ * - "library_round_trip": a multi-bank library opened twice gives one shared mapping,
+ *   and every column and string, read directly and through a linked processor, matches
+ *   the banks it was written from
+ * - "library_rejects": every truncation of a valid file, a wrong version and the other
+ *   byte order are refused
+ * - "library_load_time": a large show linked from its library, timed against loading
+ *   the same show from XML with setStateInformation()
+ */
+class CueLibrarySuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // CUELIBRARYSUITE_H_INCLUDED
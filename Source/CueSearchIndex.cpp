@@ -0,0 +1,87 @@
+/**
+ * @file CueSearchIndex.cpp
+ * @brief Definitions for CueSearchIndex methods.
+ */
+
+#include "CueSearchIndex.h"
+
+//==============================================================================
+void CueSearchIndex::rebuild(const CueStore& cues)
+{
+    haystacks.clear();
+    haystacks.reserve((size_t)cues.size());
+    for (int i = 0; i < cues.size(); ++i)
+        haystacks.push_back(makeHaystack(cues, i));
+
+    filterAll();
+}
+
+void CueSearchIndex::updateCue(const CueStore& cues, int index)
+{
+    if (index < 0 || index >= (int)haystacks.size())
+        return;
+
+    haystacks[(size_t)index] = makeHaystack(cues, index);
+
+    bool wasMatch = std::binary_search(matches.begin(), matches.end(), index);
+    bool isMatch = matchesQuery(haystacks[(size_t)index]);
+
+    if (isMatch && !wasMatch)
+        matches.insert(std::lower_bound(matches.begin(), matches.end(), index), index);
+    else if (!isMatch && wasMatch)
+        matches.erase(std::lower_bound(matches.begin(), matches.end(), index));
+}
+
+/**
+ * @brief Narrows the previous result when the new query only adds characters;
+ * any other change falls back to a full scan.
+ */
+void CueSearchIndex::setQuery(const juce::String& newQuery)
+{
+    auto lower = newQuery.toLowerCase().trim();
+    if (lower == query)
+        return;
+
+    bool narrowing = query.isNotEmpty() && lower.startsWith(query);
+
+    query = lower;
+    terms = juce::StringArray::fromTokens(query, " \t", "");
+    terms.removeEmptyStrings();
+
+    if (!narrowing)
+    {
+        filterAll();
+        return;
+    }
+
+    auto out = matches.begin();
+    for (int index : matches)
+        if (matchesQuery(haystacks[(size_t)index]))
+            *out++ = index;
+    matches.erase(out, matches.end());
+}
+
+//==============================================================================
+juce::String CueSearchIndex::makeHaystack(const CueStore& cues, int index)
+{
+    return (cues.getLabel(index) + " "
+        + juce::MidiMessage::getMidiNoteName(cues.getMidiNote(index), true, true, 4) + " "
+        + cues.getTimecodeString(index)).toLowerCase();
+}
+
+bool CueSearchIndex::matchesQuery(const juce::String& haystack) const
+{
+    for (auto& term : terms)
+        if (!haystack.contains(term))
+            return false;
+    return true;
+}
+
+void CueSearchIndex::filterAll()
+{
+    matches.clear();
+    matches.reserve(haystacks.size());
+    for (int i = 0; i < (int)haystacks.size(); ++i)
+        if (matchesQuery(haystacks[(size_t)i]))
+            matches.push_back(i);
+}
@@ -0,0 +1,72 @@
+/**
+ * @file CueSearchIndex.h
+ * @brief Declaration of the CueSearchIndex class used to filter the mapping table.
+ */
+
+#ifndef CUESEARCHINDEX_H_INCLUDED
+#define CUESEARCHINDEX_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "CueStore.h"
+
+/**
+ * @class CueSearchIndex
+ * @brief Filters cues by label, note name and timecode.
+ *
+ * Each cue gets one lower-case search string ("label note timecode") built when the
+ * store changes. Typing more characters only re-checks the cues that matched the
+ * previous query, so narrowing a search over tens of thousands of cues stays cheap.
+ */
+class CueSearchIndex
+{
+public:
+    /** Constructor */
+    CueSearchIndex() = default;
+
+    /**
+     * @brief Rebuilds every search string from the store and re-applies the query.
+     */
+    void rebuild(const CueStore& cues);
+
+    /**
+     * @brief Refreshes the search string of one cue after an edit.
+     * @param index Index of the edited cue in the store.
+     */
+    void updateCue(const CueStore& cues, int index);
+
+    /**
+     * @brief Sets the filter text. Whitespace-separated terms must all match.
+     */
+    void setQuery(const juce::String& newQuery);
+
+    /** @brief The current filter text (lower case). */
+    const juce::String& getQuery() const { return query; }
+
+    /** @brief Number of cues passing the filter. */
+    int getNumMatches() const { return (int)matches.size(); }
+
+    /**
+     * @brief Store index of the n-th matching cue, in store order.
+     */
+    int getMatch(int n) const { return matches[(size_t)n]; }
+
+private:
+    /** Builds the lower-case search string for one cue. */
+    static juce::String makeHaystack(const CueStore& cues, int index);
+
+    /** True if every term of the current query occurs in haystack. */
+    bool matchesQuery(const juce::String& haystack) const;
+
+    /** Re-filters all cues against the current query. */
+    void filterAll();
+
+    std::vector<juce::String> haystacks; /**< One search string per cue, by store index */
+    std::vector<int> matches;            /**< Store indices passing the filter */
+    juce::String query;                  /**< Lower-case filter text */
+    juce::StringArray terms;             /**< query split on whitespace */
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CueSearchIndex)
+};
+
+#endif // CUESEARCHINDEX_H_INCLUDED
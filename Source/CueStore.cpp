@@ -0,0 +1,331 @@
+/**
+ * @file CueStore.cpp
+ * @brief Definitions for CueStore methods.
+ */
+
+#include "CueStore.h"
+#include "CueLibrary.h"
+#include <cstring>
+
+//==============================================================================
+void CueStore::clear()
+{
+    midiNotes.clear();
+    activeFlags.clear();
+    startTimes.clear();
+    endTimes.clear();
+    baseWholeSeconds.clear();
+    baseFrameNumbers.clear();
+    preRollFrames.clear();
+    cueIds.clear();
+    labels.clear();
+    timecodeStrings.clear();
+    libraryBank = -1;
+    updateViews();
+    bumpContentVersion();
+}
+
+void CueStore::reserve(int numToReserve)
+{
+    makeEditable();
+    auto n = (size_t)juce::jmax(0, numToReserve);
+    midiNotes.reserve(n);
+    activeFlags.reserve(n);
+    startTimes.reserve(n);
+    endTimes.reserve(n);
+    baseWholeSeconds.reserve(n);
+    baseFrameNumbers.reserve(n);
+    preRollFrames.reserve(n);
+    cueIds.reserve(n);
+    labels.reserve(n);
+    timecodeStrings.reserve(n);
+}
+
+void CueStore::copyFrom(const CueStore& other)
+{
+    midiNotes = other.midiNotes;
+    activeFlags = other.activeFlags;
+    startTimes = other.startTimes;
+    endTimes = other.endTimes;
+    baseWholeSeconds = other.baseWholeSeconds;
+    baseFrameNumbers = other.baseFrameNumbers;
+    preRollFrames = other.preRollFrames;
+    cueIds = other.cueIds;
+    labels = other.labels;
+    timecodeStrings = other.timecodeStrings;
+    nextCueId = other.nextCueId;
+    storeId = other.storeId;
+    library = other.library;
+    libraryBank = other.libraryBank;
+    libraryFirstCue = other.libraryFirstCue;
+    updateViews();
+
+    // Carried on, so a view keyed on store id and version sees the copy as newer
+    contentVersion.store(other.getContentVersion() + 1, std::memory_order_relaxed);
+    timesVersion.store(other.getTimesVersion() + 1, std::memory_order_relaxed);
+}
+
+juce::uint32 CueStore::makeStoreId() noexcept
+{
+    static std::atomic<juce::uint32> next{ 1 };
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void CueStore::attachLibrary(std::shared_ptr<const CueLibrary> newLibrary, int bank)
+{
+    clear();
+    library = std::move(newLibrary);
+    libraryBank = bank;
+    libraryFirstCue = library->getFirstCue(bank);
+
+    const int n = library->getNumCues(bank);
+    const auto first = (size_t)libraryFirstCue;
+    startTimes.assign(library->getStartTimes() + first, library->getStartTimes() + first + (size_t)n);
+    endTimes.assign(library->getEndTimes() + first, library->getEndTimes() + first + (size_t)n);
+    activeFlags.assign((size_t)n, 0);
+    nextCueId = library->getNextCueId(bank);
+
+    updateViews();
+    bumpContentVersion();
+    bumpTimesVersion();
+}
+
+bool CueStore::differsFromLibrary(int i) const noexcept
+{
+    if (library == nullptr || libraryBank < 0)
+        return true;
+    const auto cue = (size_t)(libraryFirstCue + i);
+    return startTimes[(size_t)i] != library->getStartTimes()[cue]
+        || endTimes[(size_t)i] != library->getEndTimes()[cue];
+}
+
+/**
+ * @brief Keeping the cue ids and learned times means the stream and anything holding
+ * a CueId carry on as before.
+ */
+void CueStore::makeEditable()
+{
+    if (libraryBank < 0)
+        return;
+
+    const auto n = (size_t)numCues;
+    midiNotes.assign(notesView, notesView + n);
+    baseWholeSeconds.assign(wholeSecondsView, wholeSecondsView + n);
+    baseFrameNumbers.assign(frameNumbersView, frameNumbersView + n);
+    preRollFrames.assign(preRollView, preRollView + n);
+    cueIds.assign(cueIdsView, cueIdsView + n);
+
+    labels.clear();
+    timecodeStrings.clear();
+    labels.reserve(n);
+    timecodeStrings.reserve(n);
+    for (int i = 0; i < numCues; ++i)
+    {
+        labels.push_back(library->getLabel(libraryFirstCue + i));
+        timecodeStrings.push_back(library->getTimecodeString(libraryFirstCue + i));
+    }
+
+    libraryBank = -1;
+    updateViews();
+}
+
+void CueStore::updateViews() noexcept
+{
+    if (libraryBank >= 0)
+    {
+        const auto first = libraryFirstCue;
+        numCues = library->getNumCues(libraryBank);
+        notesView = library->getMidiNotes() + first;
+        wholeSecondsView = library->getBaseWholeSeconds() + first;
+        frameNumbersView = library->getBaseFrameNumbers() + first;
+        preRollView = library->getPreRollFrames() + first;
+        cueIdsView = library->getCueIds() + first;
+    }
+    else
+    {
+        numCues = (int)midiNotes.size();
+        notesView = midiNotes.data();
+        wholeSecondsView = baseWholeSeconds.data();
+        frameNumbersView = baseFrameNumbers.data();
+        preRollView = preRollFrames.data();
+        cueIdsView = cueIds.data();
+    }
+}
+
+//==============================================================================
+int CueStore::add(const MappingEntry& entry)
+{
+    makeEditable();
+    midiNotes.push_back((int8_t)entry.getMidiNote());
+    activeFlags.push_back(entry.getIsActive() ? 1 : 0);
+    startTimes.push_back(entry.getDetectedStartTime());
+    endTimes.push_back(entry.getDetectedEndTime());
+    baseWholeSeconds.push_back(0);
+    baseFrameNumbers.push_back(0);
+    preRollFrames.push_back(juce::jmax(0, entry.getPreRollFrames()));
+    parseBase((int)midiNotes.size() - 1, entry.getTimecodeString());
+
+    auto id = entry.getCueId();
+    if (id == 0)
+        id = nextCueId++;
+    else
+        nextCueId = juce::jmax(nextCueId, id + 1);
+    cueIds.push_back(id);
+
+    labels.push_back(entry.getLabel());
+    timecodeStrings.push_back(entry.getTimecodeString());
+    updateViews();
+    bumpContentVersion();
+    return size() - 1;
+}
+
+void CueStore::remove(int index)
+{
+    if (index < 0 || index >= size())
+        return;
+
+    makeEditable();
+    auto i = (std::ptrdiff_t)index;
+    midiNotes.erase(midiNotes.begin() + i);
+    activeFlags.erase(activeFlags.begin() + i);
+    startTimes.erase(startTimes.begin() + i);
+    endTimes.erase(endTimes.begin() + i);
+    baseWholeSeconds.erase(baseWholeSeconds.begin() + i);
+    baseFrameNumbers.erase(baseFrameNumbers.begin() + i);
+    preRollFrames.erase(preRollFrames.begin() + i);
+    cueIds.erase(cueIds.begin() + i);
+    labels.erase(labels.begin() + i);
+    timecodeStrings.erase(timecodeStrings.begin() + i);
+    updateViews();
+    bumpContentVersion();
+}
+
+MappingEntry CueStore::getEntry(int i) const
+{
+    MappingEntry m(getTimecodeString(i), getMidiNote(i), getLabel(i));
+    m.setDetectedStartTime(getDetectedStartTime(i));
+    m.setDetectedEndTime(getDetectedEndTime(i));
+    m.setIsActive(getIsActive(i));
+    m.setPreRollFrames(getPreRollFrames(i));
+    m.setCueId(getCueId(i));
+    return m;
+}
+
+//==============================================================================
+juce::String CueStore::getLabel(int i) const
+{
+    return libraryBank >= 0 ? library->getLabel(libraryFirstCue + i) : labels[(size_t)i];
+}
+
+juce::String CueStore::getTimecodeString(int i) const
+{
+    return libraryBank >= 0 ? library->getTimecodeString(libraryFirstCue + i) : timecodeStrings[(size_t)i];
+}
+
+void CueStore::setTimecodeString(int i, const juce::String& tc)
+{
+    makeEditable();
+    timecodeStrings[(size_t)i] = tc;
+    parseBase(i, tc);
+    bumpContentVersion();
+}
+
+int CueStore::indexOfCue(CueId id) const noexcept
+{
+    const auto* ids = cueIdsView;
+    const int n = size();
+    for (int i = 0; i < n; ++i)
+        if (ids[i] == id)
+            return i;
+    return -1;
+}
+
+void CueStore::parseBase(int i, const juce::String& tc)
+{
+    int hh, mm, ss, ff;
+    MappingEntry::parseTimecode(tc, hh, mm, ss, ff);
+    baseWholeSeconds[(size_t)i] = (hh * 60 + mm) * 60 + ss;
+    baseFrameNumbers[(size_t)i] = ff;
+}
+
+double CueStore::getBaseSeconds(int i, double frameRate) const noexcept
+{
+    // Frame numbers past the nominal rate carry into seconds, as the parsed frame count did
+    const int nominalFps = juce::jmax(1, juce::roundToInt(frameRate));
+    auto ff = frameNumbersView[i];
+    return double(wholeSecondsView[i] + ff / nominalFps) + double(ff % nominalFps) / frameRate;
+}
+
+//==============================================================================
+/**
+ * @brief Flags are only ever 0 or 1, so this is a byte search: memchr() tests a whole
+ * vector of cues per step where a loop tests one, which is what makes the scan cheap
+ * even while all the flags are in cache.
+ */
+int CueStore::findActive() const noexcept
+{
+    if (numCues == 0)
+        return -1;
+
+    const auto* flags = activeFlags.data();
+    const auto* found = static_cast<const uint8_t*>(std::memchr(flags, 1, (size_t)size()));
+    return found != nullptr ? (int)(found - flags) : -1;
+}
+
+/** @brief A byte search like findActive(); notes outside int8 range can never match. */
+int CueStore::findNote(int midiNote) const noexcept
+{
+    if (midiNote < INT8_MIN || midiNote > INT8_MAX || numCues == 0)
+        return -1;
+
+    const auto* notes = notesView;
+    const auto* found = static_cast<const int8_t*>(
+        std::memchr(notes, (uint8_t)(int8_t)midiNote, (size_t)size()));
+    return found != nullptr ? (int)(found - notes) : -1;
+}
+
+/**
+ * @brief Same rule as before: hostTime must be strictly inside [start, end),
+ * an unset start (-1) never matches and an unset end (-1) is open-ended.
+ */
+int CueStore::findWindow(double hostTime) const noexcept
+{
+    const auto* starts = startTimes.data();
+    const auto* ends = endTimes.data();
+    const int n = size();
+    for (int i = 0; i < n; ++i)
+    {
+        double start = starts[i];
+        double end = ends[i];
+
+        if (start < 0.0)                   continue;  // never set
+        if (hostTime <= start)             continue;  // started at or before the note-on
+        if (end >= 0.0 && hostTime >= end) continue;  // past the note-off
+        return i;
+    }
+    return -1;
+}
+
+int CueStore::findPreRoll(double from, double to, double frameRate) const noexcept
+{
+    const auto* starts = startTimes.data();
+    const auto* preRolls = preRollView;
+    const int n = size();
+    for (int i = 0; i < n; ++i)
+    {
+        if (preRolls[i] <= 0 || starts[i] < 0.0 || starts[i] <= from)
+            continue;
+        if (starts[i] - preRolls[i] / frameRate < to)
+            return i;
+    }
+    return -1;
+}
+
+int CueStore::getMaxPreRollFrames() const noexcept
+{
+    int maxFrames = 0;
+    for (int i = 0; i < numCues; ++i)
+        maxFrames = juce::jmax(maxFrames, (int)preRollView[i]);
+    return maxFrames;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file CueStore.h
+ * @brief Declaration of the CueStore class, a struct-of-arrays container for mappings.
+ */
+
+#ifndef CUESTORE_H_INCLUDED
+#define CUESTORE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "MappingEntry.h"
+
+class CueLibrary;
+
+/**
+ * @class CueStore
+ * @brief Holds all MIDI-note-to-timecode mappings split into hot and cold data.
+ *
+ * The fields read on the audio thread (note, learned start/end, active flag and the
+ * pre-parsed base timecode) live in contiguous parallel arrays, so scans such as
+ * findActive() or findNote() only touch a few bytes per cue. Labels and timecode
+ * strings are kept in separate cold arrays and are reached by the same index.
+ *
+ * Every cue also carries a stable CueId. Indices shift when a cue is removed, so
+ * anything that holds on to a cue across edits (the UI, control APIs) should keep
+ * the id and resolve it with indexOfCue() when it acts.
+ *
+ * A store can also be linked to a bank of a memory-mapped CueLibrary: its notes, base
+ * timecodes, pre-rolls, ids and strings are then read from the mapped file, and only
+ * the learned times and active flags are the store's own. The first edit to any other
+ * field copies the bank into the store (makeEditable()), so a linked store is
+ * never written through.
+ */
+class CueStore
+{
+public:
+    /** Stable cue identifier, never reused within a store. 0 means "none". */
+    using CueId = juce::uint32;
+
+    /** Constructor */
+    CueStore() = default;
+
+    /** @brief Number of cues. */
+    int size() const { return numCues; }
+
+    /** @brief True if there are no cues. */
+    bool isEmpty() const { return numCues == 0; }
+
+    /** @brief Removes all cues. */
+    void clear();
+
+    /** @brief Reserves storage for numToReserve cues in every array. */
+    void reserve(int numToReserve);
+
+    /**
+     * @brief Makes this store a copy of other, cue ids, store id and change counters
+     * included (the counters then move on by one), so a batch of edits can be made off
+     * to the side and swapped in at once (see CueBankSet::replaceBank()).
+     */
+    void copyFrom(const CueStore& other);
+
+    /**
+     * @brief Identifies the bank rather than the object: copyFrom() keeps it, so a bank
+     * replaced by an edited copy is still the same bank to the stream.
+     */
+    juce::uint32 getStoreId() const noexcept { return storeId; }
+
+    /** @name Cue library link (message thread) */
+    //@{
+    /**
+     * @brief Replaces the cues with a library bank, read in place. Learned times start
+     * from the library's.
+     */
+    void attachLibrary(std::shared_ptr<const CueLibrary> library, int bank);
+
+    /** @brief True while the cues are read from a library bank (no field edited yet). */
+    bool isLinkedToLibrary() const noexcept { return libraryBank >= 0; }
+
+    /** @brief Library bank the cues are read from, or -1. */
+    int getLibraryBank() const noexcept { return libraryBank; }
+
+    /** @brief True if cue i's learned times differ from the linked library's. */
+    bool differsFromLibrary(int i) const noexcept;
+
+    /**
+     * @brief Copies a linked library bank into the store's own arrays, keeping cue ids
+     * and learned times. Every field edit does this first; does nothing if not linked.
+     */
+    void makeEditable();
+    //@}
+
+    /**
+     * @brief Appends a cue. Keeps the entry's cue id if it has one, otherwise assigns one.
+     * @return Index of the new cue.
+     */
+    int add(const MappingEntry& entry);
+
+    /**
+     * @brief Removes the cue at index, keeping the order of the others.
+     */
+    void remove(int index);
+
+    /**
+     * @brief Builds a MappingEntry copy of the cue (for XML and the UI).
+     */
+    MappingEntry getEntry(int index) const;
+
+    /** @name Hot fields (audio thread) */
+    //@{
+    int getMidiNote(int i) const { return notesView[i]; }
+    void setMidiNote(int i, int note) { makeEditable(); midiNotes[(size_t)i] = (int8_t)note; bumpContentVersion(); }
+
+    double getDetectedStartTime(int i) const { return startTimes[(size_t)i]; }
+    void setDetectedStartTime(int i, double t) { startTimes[(size_t)i] = t; bumpTimesVersion(); }
+
+    double getDetectedEndTime(int i) const { return endTimes[(size_t)i]; }
+    void setDetectedEndTime(int i, double t) { endTimes[(size_t)i] = t; bumpTimesVersion(); }
+
+    bool getIsActive(int i) const { return activeFlags[(size_t)i] != 0; }
+    void setIsActive(int i, bool b) { activeFlags[(size_t)i] = b ? 1 : 0; bumpTimesVersion(); }
+
+    /**
+     * @brief Base timecode in seconds, matching MappingEntry::getTimeInSeconds().
+     * @param frameRate Rate the FF field is read at. Base times are stored as whole
+     *        seconds plus a frame number, so a rate change needs no re-parse.
+     */
+    double getBaseSeconds(int i, double frameRate) const noexcept;
+
+    /** @brief Frames of timecode sent ahead of the cue point (0 = none). */
+    int getPreRollFrames(int i) const { return preRollView[i]; }
+    void setPreRollFrames(int i, int frames) { makeEditable(); preRollFrames[(size_t)i] = juce::jmax(0, frames); bumpContentVersion(); }
+    //@}
+
+    /** @name Cold fields (message thread) */
+    //@{
+    CueId getCueId(int i) const { return cueIdsView[i]; }
+
+    /** @brief Index of the cue with the given id, or -1 if it no longer exists. */
+    int indexOfCue(CueId id) const noexcept;
+
+    juce::String getLabel(int i) const;
+    void setLabel(int i, const juce::String& l) { makeEditable(); labels[(size_t)i] = l; bumpContentVersion(); }
+
+    juce::String getTimecodeString(int i) const;
+    void setTimecodeString(int i, const juce::String& tc);
+    //@}
+
+    /** @name Change counters
+     *  Views compare these against the value they last rendered to skip rebuilds.
+     */
+    //@{
+    /** @brief Changes on add/remove and on label, note, timecode or pre-roll edits. */
+    juce::uint32 getContentVersion() const noexcept { return contentVersion.load(std::memory_order_relaxed); }
+
+    /** @brief Changes whenever a learned start/end time or active flag is written. */
+    juce::uint32 getTimesVersion() const noexcept { return timesVersion.load(std::memory_order_relaxed); }
+    //@}
+
+    /** @name Scans */
+    //@{
+    /** @brief Index of the first cue whose note-on is live, or -1. */
+    int findActive() const noexcept;
+
+    /** @brief Index of the first cue mapped to midiNote, or -1. */
+    int findNote(int midiNote) const noexcept;
+
+    /**
+     * @brief Index of the first cue whose learned window strictly contains hostTime, or -1.
+     */
+    int findWindow(double hostTime) const noexcept;
+
+    /**
+     * @brief Index of the first cue whose learned start lies after from and whose
+     * pre-roll begins before to, or -1. Used to lead into a learned cue during playback.
+     */
+    int findPreRoll(double from, double to, double frameRate) const noexcept;
+
+    /** @brief Longest pre-roll of any cue, in frames. */
+    int getMaxPreRollFrames() const noexcept;
+    //@}
+
+private:
+    /** Splits a timecode string into the base whole-seconds and frame-number fields of cue i. */
+    void parseBase(int i, const juce::String& tc);
+
+    /** Points the views at the store's arrays, or at the linked library bank. */
+    void updateViews() noexcept;
+
+    void bumpContentVersion() noexcept { contentVersion.fetch_add(1, std::memory_order_relaxed); }
+    void bumpTimesVersion() noexcept { timesVersion.fetch_add(1, std::memory_order_relaxed); }
+
+    /** Hands out store ids. */
+    static juce::uint32 makeStoreId() noexcept;
+
+    CueId  nextCueId{ 1 };      /**< Next id handed out by add() */
+    juce::uint32 storeId{ makeStoreId() };
+
+    std::atomic<juce::uint32> contentVersion{ 0 };
+    std::atomic<juce::uint32> timesVersion{ 0 };
+
+    // Hot: touched on every audio block
+    std::vector<int8_t>  midiNotes;
+    std::vector<uint8_t> activeFlags;
+    std::vector<double>  startTimes;
+    std::vector<double>  endTimes;
+    std::vector<int32_t> baseWholeSeconds;  /**< HH:MM:SS of the base timecode */
+    std::vector<int32_t> baseFrameNumbers;  /**< FF of the base timecode */
+    std::vector<int32_t> preRollFrames;
+
+    // Cold: touched by the editor and state save/load only
+    std::vector<CueId>        cueIds;
+    std::vector<juce::String> labels;
+    std::vector<juce::String> timecodeStrings;
+
+    // Linked library: kept for the store's lifetime, since the audio thread may still
+    // read the mapped columns when makeEditable() switches the views away from them
+    std::shared_ptr<const CueLibrary> library;
+    int libraryBank{ -1 };
+    int libraryFirstCue{ 0 };
+
+    // What the getters and scans read: the arrays above, or the library's columns
+    int numCues{ 0 };
+    const int8_t*  notesView{ nullptr };
+    const int32_t* wholeSecondsView{ nullptr };
+    const int32_t* frameNumbersView{ nullptr };
+    const int32_t* preRollView{ nullptr };
+    const CueId*   cueIdsView{ nullptr };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CueStore)
+};
+
+#endif // CUESTORE_H_INCLUDED
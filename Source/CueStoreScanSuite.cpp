@@ -0,0 +1,128 @@
+/**
+ * @file CueStoreScanSuite.cpp
+ * @brief Definitions for CueStoreScanSuite methods.
+ */
+
+#include "CueStoreScanSuite.h"
+#include "CueStore.h"
+#include "MappingEntry.h"
+
+namespace
+{
+    /** @name Scans over the layout before CueStore, as the processor wrote them */
+    //@{
+    int vectorFindActive(const std::vector<MappingEntry>& mappings)
+    {
+        for (size_t i = 0; i < mappings.size(); ++i)
+            if (mappings[i].getIsActive())
+                return (int)i;
+        return -1;
+    }
+
+    int vectorFindNote(const std::vector<MappingEntry>& mappings, int midiNote)
+    {
+        for (size_t i = 0; i < mappings.size(); ++i)
+            if (mappings[i].getMidiNote() == midiNote)
+                return (int)i;
+        return -1;
+    }
+
+    int vectorFindWindow(const std::vector<MappingEntry>& mappings, double hostTime)
+    {
+        for (size_t i = 0; i < mappings.size(); ++i)
+        {
+            double start = mappings[i].getDetectedStartTime();
+            double end = mappings[i].getDetectedEndTime();
+
+            if (start < 0.0)                   continue;
+            if (hostTime <= start)             continue;
+            if (end >= 0.0 && hostTime >= end) continue;
+            return (int)i;
+        }
+        return -1;
+    }
+    //@}
+
+    /**
+     * Times scan over enough repeats to visit about 20 million cues, and returns
+     * nanoseconds per cue. Each result is summed into check, so the scans are not
+     * optimised away and the two layouts can be compared.
+     */
+    template <typename Scan>
+    double nanosPerCue(int numCues, juce::int64& check, Scan&& scan)
+    {
+        const int repeats = juce::jmax(1, 20000000 / numCues);
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+        for (int i = 0; i < repeats; ++i)
+            check += scan();
+        const auto ms = juce::Time::getMillisecondCounterHiRes() - start;
+        return ms * 1.0e6 / ((double)repeats * numCues);
+    }
+
+    /**
+     * Fills both layouts with the same cues so that only the last one matches each scan
+     * (the worst case, a full pass): it alone is active, is mapped to note 127, and has
+     * a learned window around the probe time. Fails unless every store scan beats its
+     * vector scan by minSpeedup. The store reads a byte or two doubles per cue where the
+     * vector strides over whole entries, so it should be several times faster; the margin
+     * leaves room for a noisy machine.
+     */
+    MtcGoldenSuite::Result checkScans(int numCues)
+    {
+        constexpr double minSpeedup = 1.5;
+
+        MtcGoldenSuite::Result r;
+        r.name = "cuestore_scan_" + juce::String(numCues);
+
+        CueStore store;
+        std::vector<MappingEntry> mappings;
+        store.reserve(numCues);
+        mappings.reserve((size_t)numCues);
+        for (int i = 0; i < numCues; ++i)
+        {
+            MappingEntry m("00:10:00:00", i == numCues - 1 ? 127 : i % 127, "Cue " + juce::String(i));
+            m.setDetectedStartTime((double)i);
+            m.setDetectedEndTime(i + 0.5);
+            m.setIsActive(i == numCues - 1);
+            store.add(m);
+            mappings.push_back(m);
+        }
+
+        const double probe = numCues - 1 + 0.25;
+        juce::int64 vectorCheck = 0, storeCheck = 0;
+
+        // Read through volatile pointers, so no repeat can be hoisted out of the timing loop
+        const std::vector<MappingEntry>* volatile v = &mappings;
+        const CueStore* volatile s = &store;
+
+        const double vectorActive = nanosPerCue(numCues, vectorCheck, [&] { return vectorFindActive(*v); });
+        const double storeActive = nanosPerCue(numCues, storeCheck, [&] { return s->findActive(); });
+        const double vectorNote = nanosPerCue(numCues, vectorCheck, [&] { return vectorFindNote(*v, 127); });
+        const double storeNote = nanosPerCue(numCues, storeCheck, [&] { return s->findNote(127); });
+        const double vectorWindow = nanosPerCue(numCues, vectorCheck, [&] { return vectorFindWindow(*v, probe); });
+        const double storeWindow = nanosPerCue(numCues, storeCheck, [&] { return s->findWindow(probe); });
+
+        const int last = numCues - 1;
+        if (store.findActive() != last || store.findNote(127) != last || store.findWindow(probe) != last
+            || vectorCheck != storeCheck)
+        {
+            r.message = "store scans disagree with the vector scans";
+            return r;
+        }
+
+        r.message = juce::String::formatted(
+            "ns/cue vector -> store: active %.2f -> %.2f, note %.2f -> %.2f, window %.2f -> %.2f",
+            vectorActive, storeActive, vectorNote, storeNote, vectorWindow, storeWindow);
+        r.passed = storeActive * minSpeedup < vectorActive && storeNote * minSpeedup < vectorNote
+            && storeWindow * minSpeedup < vectorWindow;
+        if (!r.passed)
+            r.message << juce::String::formatted("; every store scan must be %.1fx faster", minSpeedup);
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> CueStoreScanSuite::run()
+{
+    return { checkScans(10000), checkScans(100000) };
+}
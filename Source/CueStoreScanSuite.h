@@ -0,0 +1,28 @@
+/**
+ * @file CueStoreScanSuite.h
+ * @brief Declaration of CueStoreScanSuite, the cost of the CueStore scans.
+ */
+
+#ifndef CUESTORESCANSUITE_H_INCLUDED
+#define CUESTORESCANSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class CueStoreScanSuite
+ * @brief "cuestore_scan_<cues>" times CueStore::findActive(), findNote() and
+ * findWindow() against the same scans over a std::vector<MappingEntry>, the layout the
+ * store replaced, at 10k and 100k cues. It fails if the two ever disagree, or if a store
+ * scan is not at least 1.5 times as fast as its vector scan. The message gives
+ * nanoseconds per cue scanned for each.
+ */
+class CueStoreScanSuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // CUESTORESCANSUITE_H_INCLUDED
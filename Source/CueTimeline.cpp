@@ -0,0 +1,368 @@
+/**
+ * @file CueTimeline.cpp
+ * @brief Definitions for CueTimeline methods.
+ */
+
+#include "CueTimeline.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace
+{
+    const juce::Colour backgroundColour{ 0xff1e1e1e };
+    const juce::Colour rulerColour{ 0xff2c2c2c };
+    const juce::Colour windowColour{ 0xff3a7bd5 };
+    const juce::Colour overlapColour{ 0xffe08a2e };
+    const juce::Colour runningColour{ 0x5532cd32 };
+
+    /** Ruler steps in seconds; the first that leaves this many pixels between ticks wins. */
+    constexpr double rulerSteps[] = { 1, 2, 5, 10, 15, 30, 60, 120, 300, 600, 900, 1800, 3600, 7200 };
+    constexpr int minTickSpacing = 80;
+
+    juce::String formatRulerTime(double seconds)
+    {
+        auto s = (int)std::floor(seconds);
+        return juce::String::formatted("%d:%02d:%02d", s / 3600, (s / 60) % 60, s % 60);
+    }
+}
+
+//==============================================================================
+CueTimeline::CueTimeline(MTCGenAudioProcessor& proc)
+    : processor(proc),
+    vBlank(this, [this]() { onVBlank(); })
+{
+    setOpaque(true);
+    rebuildGeometry();
+}
+
+CueTimeline::~CueTimeline() {}
+
+//==============================================================================
+/**
+ * @brief Runs once per display refresh. Unless the cues changed, this is a few version
+ * compares, one atomic load and at most two thin repaint rectangles.
+ */
+void CueTimeline::onVBlank()
+{
+    if (geometryChanged())
+    {
+        rebuildGeometry();
+        invalidateTiles();
+    }
+
+    const int x = timeToX(processor.getBlockTime());
+    if (x == shownPlayheadX)
+        return;
+
+    // A running cue's band grows with the playhead, so the span between them repaints too
+    if (!openCues.empty() && shownPlayheadX >= 0)
+        repaint(juce::Rectangle<int>::leftTopRightBottom(juce::jmin(x, shownPlayheadX) - 1, 0,
+            juce::jmax(x, shownPlayheadX) + 2, getHeight()));
+    else
+    {
+        repaint(shownPlayheadX - 1, 0, 3, getHeight());
+        repaint(x - 1, 0, 3, getHeight());
+    }
+
+    shownPlayheadX = x;
+}
+
+bool CueTimeline::geometryChanged() const
+{
+    const auto& cues = processor.getCues();
+    return &cues != shownCues
+        || processor.getBanks().getLayoutVersion() != shownBanksVersion
+        || cues.getContentVersion() != shownContentVersion
+        || cues.getTimesVersion() != shownTimesVersion;
+}
+
+/**
+ * @brief Collects the learned windows, sorts them by start and assigns each to the
+ * first lane whose previous window has ended (greedy interval packing).
+ */
+void CueTimeline::rebuildGeometry()
+{
+    const auto& cues = processor.getCues();
+    shownCues = &cues;
+    shownBanksVersion = processor.getBanks().getLayoutVersion();
+    shownContentVersion = cues.getContentVersion();
+    shownTimesVersion = cues.getTimesVersion();
+
+    windows.clear();
+    openCues.clear();
+    windows.reserve((size_t)cues.size());
+
+    for (int i = 0; i < cues.size(); ++i)
+    {
+        const double start = cues.getDetectedStartTime(i);
+        const double end = cues.getDetectedEndTime(i);
+        if (start < 0.0)
+            continue;
+
+        if (end < start)
+            openCues.push_back(i);
+        else
+            windows.push_back({ start, end, i, 0 });
+    }
+
+    std::sort(windows.begin(), windows.end(),
+        [](const Window& a, const Window& b) { return a.start < b.start; });
+
+    double laneEnds[maxLanes];
+    std::fill(std::begin(laneEnds), std::end(laneEnds), -1.0);
+    numLanes = 1;
+    longestWindow = 0.0;
+
+    for (auto& w : windows)
+    {
+        int lane = 0;
+        while (lane < maxLanes - 1 && laneEnds[lane] > w.start)
+            ++lane;
+
+        w.lane = lane;
+        laneEnds[lane] = juce::jmax(laneEnds[lane], w.end);
+        numLanes = juce::jmax(numLanes, lane + 1);
+        longestWindow = juce::jmax(longestWindow, w.end - w.start);
+    }
+}
+
+void CueTimeline::invalidateTiles()
+{
+    tiles.clear();
+    repaint();
+}
+
+//==============================================================================
+void CueTimeline::paint(juce::Graphics& g)
+{
+    // Only after a zoom, resize or cue change, or when moved to a screen with another scale
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (scale != cachedScale)
+    {
+        tiles.clear();
+        cachedScale = scale;
+    }
+
+    const auto clip = g.getClipBounds();
+    const juce::int64 first = (scrollPixels + juce::jmax(0, clip.getX())) / tileWidth;
+    const juce::int64 last = (scrollPixels + clip.getRight()) / tileWidth;
+
+    for (auto index = first; index <= last; ++index)
+    {
+        const auto& tile = getTile(index, scale);
+        const int x = (int)(index * tileWidth - scrollPixels);
+        g.drawImage(tile, juce::Rectangle<int>(x, 0, tileWidth, getHeight()).toFloat());
+    }
+
+    paintOpenWindows(g);
+
+    const int playheadX = timeToX(processor.getBlockTime());
+    g.setColour(juce::Colours::red);
+    g.fillRect(playheadX, 0, 1, getHeight());
+}
+
+void CueTimeline::resized()
+{
+    tiles.clear();
+}
+
+const juce::Image& CueTimeline::getTile(juce::int64 index, float scale)
+{
+    auto found = tiles.find(index);
+    if (found != tiles.end())
+        return found->second;
+
+    // Keep the cache bounded: drop the tile farthest from the one being added
+    if ((int)tiles.size() >= maxTiles)
+    {
+        auto farthest = std::abs(tiles.begin()->first - index) > std::abs(tiles.rbegin()->first - index)
+            ? tiles.begin() : std::prev(tiles.end());
+        tiles.erase(farthest);
+    }
+
+    juce::Image image(juce::Image::RGB, juce::jmax(1, juce::roundToInt(tileWidth * scale)),
+        juce::jmax(1, juce::roundToInt(getHeight() * scale)), false);
+    {
+        juce::Graphics gi(image);
+        gi.addTransform(juce::AffineTransform::scale(scale));
+        renderTile(gi, index);
+    }
+
+    return tiles.emplace(index, std::move(image)).first->second;
+}
+
+/**
+ * @brief Renders one tile. Windows come from a binary search over the sorted list, and
+ * within each lane a window that falls entirely on pixels already filled is skipped,
+ * so a zoomed-out tile holding thousands of short cues costs at most a few hundred fills.
+ */
+void CueTimeline::renderTile(juce::Graphics& g, juce::int64 index) const
+{
+    const int height = getHeight();
+    const double pixel0 = (double)(index * tileWidth);
+    const double t0 = pixel0 * secondsPerPixel;
+    const double t1 = t0 + tileWidth * secondsPerPixel;
+    auto localX = [&](double t) { return t / secondsPerPixel - pixel0; };
+
+    g.fillAll(backgroundColour);
+    g.setColour(rulerColour);
+    g.fillRect(0, 0, tileWidth, rulerHeight);
+
+    // Ruler: ticks on an absolute grid, so neighbouring tiles line up
+    double step = rulerSteps[std::size(rulerSteps) - 1];
+    for (auto s : rulerSteps)
+    {
+        if (s / secondsPerPixel >= minTickSpacing)
+        {
+            step = s;
+            break;
+        }
+    }
+
+    // Starts one label width early, so a label crossing in from the previous tile is drawn
+    g.setFont(10.0f);
+    for (double t = std::floor((t0 - minTickSpacing * secondsPerPixel) / step) * step; t < t1; t += step)
+    {
+        const int x = (int)std::floor(localX(t));
+        g.setColour(juce::Colours::grey);
+        g.fillRect(x, rulerHeight - 5, 1, height - rulerHeight + 5);
+        g.setColour(juce::Colours::lightgrey);
+        g.drawText(formatRulerTime(t), x + 3, 0, minTickSpacing - 6, rulerHeight,
+            juce::Justification::centredLeft, false);
+    }
+
+    // Windows crossing [t0, t1): none can start earlier than t0 - longestWindow
+    auto it = std::lower_bound(windows.begin(), windows.end(), t0 - longestWindow,
+        [](const Window& w, double t) { return w.start < t; });
+
+    int filledTo[maxLanes];
+    std::fill(std::begin(filledTo), std::end(filledTo), -1);
+    const auto& cues = processor.getCues();
+
+    for (; it != windows.end() && it->start < t1; ++it)
+    {
+        if (it->end < t0)
+            continue;
+
+        const int x0 = (int)std::floor(localX(it->start));
+        const int x1 = juce::jmax(x0 + 1, (int)std::ceil(localX(it->end)));
+        if (x1 <= filledTo[it->lane])
+            continue;
+
+        filledTo[it->lane] = x1;
+        auto lane = getLaneBounds(it->lane);
+        auto bar = juce::Rectangle<int>::leftTopRightBottom(x0, lane.getY() + 1, x1, lane.getBottom() - 1);
+
+        g.setColour(it->lane == 0 ? windowColour : overlapColour);
+        g.fillRect(bar);
+
+        if (bar.getWidth() >= 40 && juce::isPositiveAndBelow(it->cue, cues.size()))
+        {
+            g.setColour(juce::Colours::white);
+            g.drawText(cues.getLabel(it->cue), bar.reduced(3, 0),
+                juce::Justification::centredLeft, true);
+        }
+    }
+}
+
+void CueTimeline::paintOpenWindows(juce::Graphics& g) const
+{
+    if (openCues.empty())
+        return;
+
+    const auto& cues = processor.getCues();
+    const int playheadX = timeToX(processor.getBlockTime());
+    g.setColour(runningColour);
+
+    for (auto cue : openCues)
+    {
+        if (!juce::isPositiveAndBelow(cue, cues.size()))
+            continue;
+
+        const int x0 = timeToX(cues.getDetectedStartTime(cue));
+        if (playheadX > x0)
+            g.fillRect(x0, rulerHeight, playheadX - x0, getHeight() - rulerHeight);
+    }
+}
+
+//==============================================================================
+int CueTimeline::timeToX(double t) const noexcept
+{
+    // Clamped well outside the component, so far-away times cannot overflow an int
+    const double x = std::floor(t / secondsPerPixel) - (double)scrollPixels;
+    return (int)juce::jlimit(-100000.0, 100000.0, x);
+}
+
+juce::Rectangle<int> CueTimeline::getLaneBounds(int lane) const
+{
+    const int laneHeight = juce::jmax(1, (getHeight() - rulerHeight) / numLanes);
+    return { 0, rulerHeight + lane * laneHeight, tileWidth, laneHeight };
+}
+
+void CueTimeline::setScroll(juce::int64 newScrollPixels)
+{
+    // Time 0 (session start) is the left limit
+    scrollPixels = juce::jmax((juce::int64)0, newScrollPixels);
+    shownPlayheadX = -1;
+}
+
+void CueTimeline::zoomAround(int x, double newSecondsPerPixel)
+{
+    newSecondsPerPixel = juce::jlimit(minSecondsPerPixel, maxSecondsPerPixel, newSecondsPerPixel);
+    if (newSecondsPerPixel == secondsPerPixel)
+        return;
+
+    const double anchor = xToTime(x);
+    secondsPerPixel = newSecondsPerPixel;
+    setScroll((juce::int64)std::llround(anchor / secondsPerPixel) - x);
+    invalidateTiles();
+}
+
+void CueTimeline::fitAll()
+{
+    double from = processor.getBlockTime(), to = from;
+    if (!windows.empty())
+    {
+        from = windows.front().start;
+        for (auto& w : windows)
+            to = juce::jmax(to, w.end);
+    }
+
+    const double span = juce::jmax(10.0, (to - from) * 1.1);
+    secondsPerPixel = juce::jlimit(minSecondsPerPixel, maxSecondsPerPixel,
+        span / juce::jmax(1, getWidth()));
+    setScroll((juce::int64)std::floor((from - span * 0.05) / secondsPerPixel));
+    invalidateTiles();
+}
+
+//==============================================================================
+void CueTimeline::mouseDown(const juce::MouseEvent& e)
+{
+    dragStartX = e.x;
+    dragStartScroll = scrollPixels;
+}
+
+void CueTimeline::mouseDrag(const juce::MouseEvent& e)
+{
+    // Whole-pixel panning keeps the cached tiles valid
+    setScroll(dragStartScroll - (e.x - dragStartX));
+    repaint();
+}
+
+void CueTimeline::mouseDoubleClick(const juce::MouseEvent&)
+{
+    fitAll();
+}
+
+void CueTimeline::mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel)
+{
+    if (wheel.deltaX != 0.0f)
+    {
+        setScroll(scrollPixels - juce::roundToInt(wheel.deltaX * 200.0f));
+        repaint();
+    }
+
+    if (wheel.deltaY != 0.0f)
+        zoomAround(e.x, secondsPerPixel * std::pow(1.5, -wheel.deltaY * 4.0));
+}
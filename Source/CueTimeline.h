@@ -0,0 +1,128 @@
+/**
+ * @file CueTimeline.h
+ * @brief Declaration of the CueTimeline component (zoomable view of learned cue windows).
+ */
+
+#ifndef CUETIMELINE_H_INCLUDED
+#define CUETIMELINE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <map>
+#include <vector>
+#include "MTCGenProcessor.h"
+
+/**
+ * @class CueTimeline
+ * @brief Draws every cue's learned [start, end] window of the active bank on a time
+ * axis, with the host playhead on top, so overlaps and gaps across a show are visible.
+ *
+ * Cue geometry is rebuilt only when the bank, its cues or their learned times change:
+ * windows are sorted by start and packed into lanes, so overlapping windows sit on
+ * separate rows (lanes past the first are drawn in the overlap colour).
+ *
+ * The static picture is rendered into fixed-width image tiles on the absolute pixel
+ * grid of the current zoom. Panning only renders tiles that scroll into view; zooming,
+ * resizing or a geometry change drops the cache. Per display refresh, only the playhead
+ * strip (and the growing end of a cue that is still running) is repainted, on top of
+ * the cached tiles.
+ *
+ * Mouse wheel zooms around the pointer, dragging pans, double-click fits every cue.
+ */
+class CueTimeline : public juce::Component
+{
+public:
+    /**
+     * @brief Constructs the timeline.
+     * @param proc Processor whose active bank and playhead are shown.
+     */
+    explicit CueTimeline(MTCGenAudioProcessor& proc);
+    ~CueTimeline() override;
+
+    void paint(juce::Graphics&) override;
+    void resized() override;
+    void mouseDown(const juce::MouseEvent&) override;
+    void mouseDrag(const juce::MouseEvent&) override;
+    void mouseDoubleClick(const juce::MouseEvent&) override;
+    void mouseWheelMove(const juce::MouseEvent&, const juce::MouseWheelDetails&) override;
+
+private:
+    static constexpr int tileWidth = 256;      /**< Logical pixels per cached tile */
+    static constexpr int maxTiles = 48;        /**< Tiles kept before the farthest are dropped */
+    static constexpr int maxLanes = 8;         /**< Overlaps deeper than this share the last lane */
+    static constexpr int rulerHeight = 16;
+    static constexpr double minSecondsPerPixel = 0.001;
+    static constexpr double maxSecondsPerPixel = 60.0;
+
+    /** One learned window, in host seconds. */
+    struct Window
+    {
+        double start;
+        double end;
+        int cue;
+        int lane;
+    };
+
+    /** Called on each display refresh: picks up cue changes and moves the playhead. */
+    void onVBlank();
+
+    /** True if the bank, its cues or their learned times changed since the last rebuild. */
+    bool geometryChanged() const;
+
+    /** Re-reads and lane-packs the windows of the active bank. */
+    void rebuildGeometry();
+
+    /** Drops every cached tile and repaints. */
+    void invalidateTiles();
+
+    /** Returns the cached tile, rendering it first if needed. */
+    const juce::Image& getTile(juce::int64 index, float scale);
+
+    /** Draws the ruler and the windows crossing one tile. */
+    void renderTile(juce::Graphics& g, juce::int64 index) const;
+
+    /** Draws the windows that are still open (note held) up to the playhead. */
+    void paintOpenWindows(juce::Graphics& g) const;
+
+    /** Scrolls to a whole-pixel offset (not before time 0). */
+    void setScroll(juce::int64 newScrollPixels);
+
+    /** Sets the zoom, keeping the time under x in place. */
+    void zoomAround(int x, double newSecondsPerPixel);
+
+    /** Zooms and scrolls so every window is visible. */
+    void fitAll();
+
+    double xToTime(double x) const noexcept { return (scrollPixels + x) * secondsPerPixel; }
+    int timeToX(double t) const noexcept;
+    juce::Rectangle<int> getLaneBounds(int lane) const;
+
+    MTCGenAudioProcessor& processor;
+
+    // Geometry (message thread)
+    std::vector<Window> windows;         /**< Sorted by start */
+    std::vector<int> openCues;           /**< Started but not yet ended */
+    double longestWindow{ 0.0 };         /**< Bounds the back-search when rendering a tile */
+    int numLanes{ 1 };
+    const CueStore* shownCues{ nullptr };
+    juce::uint32 shownBanksVersion{ 0 };
+    juce::uint32 shownContentVersion{ 0 };
+    juce::uint32 shownTimesVersion{ 0 };
+
+    // View: the left edge is scrollPixels whole pixels from time 0 at this zoom, so
+    // tiles always start on the same pixel boundaries while panning
+    double secondsPerPixel{ 0.5 };
+    juce::int64 scrollPixels{ 0 };
+    int dragStartX{ 0 };
+    juce::int64 dragStartScroll{ 0 };
+
+    std::map<juce::int64, juce::Image> tiles;  /**< Tile index -> rendered image */
+    float cachedScale{ 0.0f };                 /**< Pixel scale the tiles were built for */
+
+    int shownPlayheadX{ -1 };
+
+    juce::VBlankAttachment vBlank;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CueTimeline)
+};
+
+#endif // CUETIMELINE_H_INCLUDED
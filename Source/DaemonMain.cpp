@@ -0,0 +1,413 @@
+/**
+ * @file DaemonMain.cpp
+ * @brief Entry point of MTCGenDaemon, the headless console build of the generator.
+ *
+ * Built only by Daemon/MTCGenDaemon.jucer (with MTCGEN_HEADLESS=1); the plugin
+ * project does not compile this file.
+ */
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+#include "MTCGenProcessor.h"
+#include "HeadlessHost.h"
+#include "FileTimecodeSink.h"
+#include "MtcFileExporter.h"
+#include "TraceRecorder.h"
+#include "TriggerFileImporter.h"
+
+namespace
+{
+    std::atomic<bool> quitRequested{ false };
+
+    void handleSignal(int) { quitRequested.store(true); }
+
+    const char* usage =
+        "Usage: MTCGenDaemon --cues <file.xml> | --library <file.mtclib> [options]\n"
+        "\n"
+        "  --cues <file>         Cue file: an MTCGenState XML document (see README)\n"
+        "  --library <file>      Cue library to map instead of the cue file's banks\n"
+        "  --out <name>          MIDI output to drive; repeat for several ports\n"
+        "  --in <name>           MIDI input carrying the cue triggers\n"
+        "  --stdin               Read triggers from stdin instead: 'on <note>', 'off <note>',\n"
+        "                        'pc <program>', 'start', 'continue', 'stop', 'quit';\n"
+        "                        'stats' prints the audio thread's block load\n"
+        "  --rate <fps>          24, 25, 29.97 or 30 (default: from the cue file)\n"
+        "  --format <sysex|qf>   Full Frame SysEx or quarter-frames (default: from the cue file)\n"
+        "  --bank <n>            Cue bank to start with (default: from the cue file)\n"
+        "  --clock               Also send MIDI Clock and SPP while the transport plays; MIDI\n"
+        "                        Start/Continue/Stop (on --in or stdin) drive the transport\n"
+        "  --bpm <tempo>         Transport tempo for the clock (default 120)\n"
+        "  --artnet <address>    Also send Art-Net timecode to this address\n"
+        "  --shm                 Publish timecode in POSIX shared memory for local programs\n"
+        "  --shm-name <name>     Shared-memory segment name (default /mtcgen)\n"
+        "  --control             Accept cue commands on a Unix socket (see README)\n"
+        "  --control-path <path> Socket path (default $XDG_RUNTIME_DIR/mtcgen.sock)\n"
+        "  --sample-rate <hz>    Internal sample clock (default 48000)\n"
+        "  --block <samples>     Block size (default 256)\n"
+        "  --trace <file.json>   Record a Chrome trace of every thread until exit\n"
+        "  --record <file.txt>   Log every frame, quarter-frame, locate and cue start/stop\n"
+        "  --import <file.mid>   Learn cue start/end times from a MIDI file's notes first\n"
+        "  --write-library <file.mtclib>\n"
+        "                        Save the loaded banks as a cue library and exit\n"
+        "  --export <file.mid>   Render the stream to a Standard MIDI File and exit\n"
+        "  --from <s> --to <s>   Host-time range to export (default: 0 to the last cue)\n"
+        "  --list                List MIDI devices and exit\n";
+
+    /** Every value given for a repeatable option, in order. */
+    juce::StringArray getValuesForOption(const juce::ArgumentList& args, const juce::String& option)
+    {
+        juce::StringArray values;
+        for (int i = 0; i + 1 < args.size(); ++i)
+            if (args[i] == option)
+                values.add(args[i + 1].text);
+        return values;
+    }
+
+    void listDevices()
+    {
+        std::cout << "MIDI outputs:\n";
+        for (auto& d : juce::MidiOutput::getAvailableDevices())
+            std::cout << "  " << d.name << "\n";
+        std::cout << "MIDI inputs:\n";
+        for (auto& d : juce::MidiInput::getAvailableDevices())
+            std::cout << "  " << d.name << "\n";
+    }
+
+    /** Loads a cue file through the same path as a saved plugin session. */
+    bool loadCueFile(MTCGenAudioProcessor& processor, const juce::File& file)
+    {
+        auto xml = juce::XmlDocument::parse(file);
+        if (xml == nullptr || !xml->hasTagName("MTCGenState"))
+            return false;
+
+        juce::MemoryBlock state;
+        juce::AudioProcessor::copyXmlToBinary(*xml, state);
+        processor.setStateInformation(state.getData(), (int)state.getSize());
+        return true;
+    }
+
+    /** Parses one stand-in trigger line; returns false on "quit". */
+    bool handleStdinLine(HeadlessHost& host, MTCGenAudioProcessor& processor,
+        const juce::String& line)
+    {
+        auto tokens = juce::StringArray::fromTokens(line.trim(), false);
+        if (tokens.isEmpty())
+            return true;
+
+        const auto command = tokens[0].toLowerCase();
+        const int value = juce::jlimit(0, 127, tokens[1].getIntValue());
+
+        if (command == "quit")
+            return false;
+        if (command == "on")
+            host.addMessage(juce::MidiMessage::noteOn(1, value, (juce::uint8)100));
+        else if (command == "off")
+            host.addMessage(juce::MidiMessage::noteOff(1, value));
+        else if (command == "pc")
+            host.addMessage(juce::MidiMessage::programChange(1, value));
+        else if (command == "start")
+            host.addMessage(juce::MidiMessage::midiStart());
+        else if (command == "continue")
+            host.addMessage(juce::MidiMessage::midiContinue());
+        else if (command == "stop")
+            host.addMessage(juce::MidiMessage::midiStop());
+        else if (command == "stats")
+            std::cout << processor.getBlockTimingMeter().getStats().describe() << std::endl;
+        else
+            std::cerr << "unknown command: " << line << "\n";
+
+        return true;
+    }
+
+    /**
+     * Handles stdin lines until "quit", the end of input or quitRequested. Waits in poll()
+     * rather than a blocking read, so shutdown always wakes it within 100 ms and main()
+     * can join it before the host and processor go away.
+     */
+    void readStdin(HeadlessHost& host, MTCGenAudioProcessor& processor)
+    {
+        std::string pending;
+        char buffer[1024];
+
+        while (!quitRequested.load())
+        {
+            pollfd in{ STDIN_FILENO, POLLIN, 0 };
+            const int ready = poll(&in, 1, 100);
+            if (ready < 0 && errno != EINTR)
+                return;
+            if (ready <= 0)
+                continue;
+
+            const auto n = read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR)
+                continue;
+
+            // At the end of input, a last line without a newline still counts
+            if (n <= 0)
+                pending += '\n';
+            else
+                pending.append(buffer, (size_t)n);
+
+            for (auto end = pending.find('\n'); end != std::string::npos; end = pending.find('\n'))
+            {
+                const auto line = juce::String::fromUTF8(pending.data(), (int)end);
+                pending.erase(0, end + 1);
+                if (!handleStdinLine(host, processor, line))
+                    return;
+            }
+
+            if (n <= 0)
+                return;
+        }
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        std::cout << usage;
+        return 0;
+    }
+
+    // Creates the message manager the processor's parameters expect; no windows
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    if (args.containsOption("--list"))
+    {
+        listDevices();
+        return 0;
+    }
+
+    auto cueFile = juce::File::getCurrentWorkingDirectory()
+        .getChildFile(args.getValueForOption("--cues"));
+    MTCGenAudioProcessor processor;
+    if (args.containsOption("--cues") ? !loadCueFile(processor, cueFile)
+                                      : !args.containsOption("--library"))
+    {
+        std::cerr << "could not load cue file " << cueFile.getFullPathName() << "\n" << usage;
+        return 1;
+    }
+
+    if (args.containsOption("--library"))
+    {
+        auto file = juce::File::getCurrentWorkingDirectory()
+            .getChildFile(args.getValueForOption("--library"));
+        juce::String error;
+        if (!processor.linkCueLibrary(file, error))
+        {
+            std::cerr << error << "\n";
+            return 1;
+        }
+    }
+    else if (processor.getCueLibraryError().isNotEmpty())
+    {
+        std::cerr << processor.getCueLibraryError() << "\n";
+    }
+
+    if (args.containsOption("--rate"))
+        processor.setFrameRate(args.getValueForOption("--rate").getDoubleValue());
+    if (args.containsOption("--format"))
+        processor.setMTCFormat(args.getValueForOption("--format") == "qf" ? QuarterFrame : FullSysEx);
+    if (args.containsOption("--bank"))
+        processor.selectBank(args.getValueForOption("--bank").getIntValue());
+    if (args.containsOption("--clock"))
+        processor.setClockEnabled(true);
+    if (args.containsOption("--artnet"))
+    {
+        processor.getArtNetSender().setTarget(args.getValueForOption("--artnet"),
+            ArtNetTimecodeSender::defaultPort);
+        processor.setArtNetEnabled(true);
+    }
+
+    if (args.containsOption("--import"))
+    {
+        auto file = juce::File::getCurrentWorkingDirectory()
+            .getChildFile(args.getValueForOption("--import"));
+        TriggerFileImporter::Summary summary;
+        juce::String error;
+        if (!TriggerFileImporter::importFile(processor, file, summary, error))
+        {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        std::cerr << summary.describe() << "\n";
+    }
+
+    if (args.containsOption("--write-library"))
+    {
+        auto file = juce::File::getCurrentWorkingDirectory()
+            .getChildFile(args.getValueForOption("--write-library"));
+        juce::String error;
+        if (!CueLibrary::write(processor.getBanks(), file, error))
+        {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        std::cerr << "wrote " << file.getFullPathName() << "\n";
+        return 0;
+    }
+
+    if (args.containsOption("--export"))
+    {
+        MtcFileExporter::Options options;
+        options.startSeconds = args.getValueForOption("--from").getDoubleValue();
+        options.endSeconds = args.getValueForOption("--to").getDoubleValue();
+        if (args.containsOption("--sample-rate"))
+            options.sampleRate = args.getValueForOption("--sample-rate").getDoubleValue();
+
+        auto file = juce::File::getCurrentWorkingDirectory()
+            .getChildFile(args.getValueForOption("--export"));
+        juce::String error;
+        const auto startMs = juce::Time::getMillisecondCounterHiRes();
+        if (!MtcFileExporter::exportToFile(MtcFileExporter::snapshotState(processor),
+                options, file, error))
+        {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        std::cerr << "wrote " << file.getFullPathName() << " in "
+            << juce::roundToInt(juce::Time::getMillisecondCounterHiRes() - startMs) << " ms\n";
+        return 0;
+    }
+
+    if (args.containsOption("--shm"))
+    {
+        auto& shared = processor.getSharedTimecode();
+        if (args.containsOption("--shm-name"))
+            shared.setName(args.getValueForOption("--shm-name"));
+        if (!shared.setEnabled(true))
+        {
+            std::cerr << shared.getLastError() << "\n";
+            return 1;
+        }
+    }
+
+    if (args.containsOption("--control"))
+    {
+        auto& control = processor.getControlServer();
+        if (args.containsOption("--control-path"))
+            control.setPath(args.getValueForOption("--control-path"));
+        if (!control.setEnabled(true))
+        {
+            std::cerr << control.getLastError() << "\n";
+            return 1;
+        }
+        std::cerr << "control socket " << control.getPath() << "\n";
+    }
+
+    // Outputs by name; the selector API takes indices into the current device list
+    auto available = processor.getAvailableMidiOutputNames();
+    juce::Array<int> outputs;
+    for (auto& name : getValuesForOption(args, "--out"))
+    {
+        int index = available.indexOf(name);
+        if (index < 0)
+            std::cerr << "MIDI output not found: " << name << "\n";
+        else
+            outputs.addIfNotAlreadyThere(index);
+    }
+    processor.setSelectedMidiOutputs(outputs);
+
+    const double sampleRate = args.containsOption("--sample-rate")
+        ? args.getValueForOption("--sample-rate").getDoubleValue() : 48000.0;
+    const int blockSize = args.containsOption("--block")
+        ? args.getValueForOption("--block").getIntValue() : 256;
+    if (sampleRate < 8000.0 || blockSize < 16 || blockSize > 8192)
+    {
+        std::cerr << "invalid --sample-rate or --block\n";
+        return 1;
+    }
+
+    HeadlessHost host(processor, sampleRate, blockSize);
+    if (args.containsOption("--bpm"))
+        host.setTempo(args.getValueForOption("--bpm").getDoubleValue());
+    const bool useStdin = args.containsOption("--stdin");
+    if (!useStdin && args.containsOption("--in")
+        && !host.openMidiInput(args.getValueForOption("--in")))
+    {
+        std::cerr << "MIDI input not found: " << args.getValueForOption("--in") << "\n";
+        return 1;
+    }
+
+    if (args.containsOption("--trace"))
+    {
+        auto file = juce::File::getCurrentWorkingDirectory()
+            .getChildFile(args.getValueForOption("--trace"));
+        juce::String error;
+        if (!TraceRecorder::start(file, error))
+        {
+            std::cerr << error << "\n";
+            return 1;
+        }
+    }
+
+    // Registered last, so no early return leaves the processor holding the sink
+    FileTimecodeSink record;
+    if (args.containsOption("--record"))
+    {
+        auto file = juce::File::getCurrentWorkingDirectory()
+            .getChildFile(args.getValueForOption("--record"));
+        juce::String error;
+        if (!record.open(file, error))
+        {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        processor.getTimecodeSinks().addSink(&record, TimecodeSink::Deferred);
+    }
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    host.start();
+    std::cerr << "MTCGenDaemon running (" << processor.getBanks().getNumBanks() << " banks, "
+        << outputs.size() << " outputs, started in "
+        << juce::roundToInt(juce::Time::getMillisecondCounterHiRes() - startMs) << " ms)\n";
+
+    // The main thread runs the message loop, which the control socket's commands run on
+    std::thread stdinReader;
+    if (useStdin)
+    {
+        stdinReader = std::thread([&host, &processor]() {
+            readStdin(host, processor);
+            quitRequested.store(true);
+            });
+    }
+
+    std::thread quitWatcher([]() {
+        while (!quitRequested.load())
+            juce::Thread::sleep(100);
+        juce::MessageManager::getInstance()->stopDispatchLoop();
+        });
+    juce::MessageManager::getInstance()->runDispatchLoop();
+    quitWatcher.join();
+    if (stdinReader.joinable())
+        stdinReader.join();
+
+    processor.getControlServer().setEnabled(false);
+    host.stop();
+
+    processor.getTimecodeSinks().flush();
+    processor.getTimecodeSinks().removeSink(&record);
+    record.close();
+
+    if (TraceRecorder::isRecording())
+    {
+        TraceRecorder::stop();
+        std::cerr << "trace: " << TraceRecorder::getNumEvents() << " events ("
+            << TraceRecorder::getNumDropped() << " dropped) in "
+            << TraceRecorder::getFile().getFullPathName() << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,263 @@
+/**
+ * @file ExportSuite.cpp
+ * @brief Definitions for ExportSuite methods.
+ */
+
+#include "ExportSuite.h"
+#include "MTCGenProcessor.h"
+#include "MtcFileExporter.h"
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    /** One event read back from a Standard MIDI File, as raw MIDI bytes. */
+    struct SmfEvent
+    {
+        juce::int64 tick;
+        std::vector<juce::uint8> bytes;
+    };
+
+    /** A tempo change: from this tick on, this many microseconds per quarter note. */
+    struct TempoChange
+    {
+        juce::int64 tick;
+        double microsPerQuarter;
+    };
+
+    juce::uint32 readVarLen(juce::MemoryInputStream& in)
+    {
+        juce::uint32 value = 0;
+        for (int i = 0; i < 4 && !in.isExhausted(); ++i)
+        {
+            const auto byte = (juce::uint8)in.readByte();
+            value = (value << 7) | (byte & 0x7f);
+            if ((byte & 0x80) == 0)
+                break;
+        }
+        return value;
+    }
+
+    /**
+     * Reads back a format 0 file written by MtcFileExporter: its division, its tempo map
+     * and every SysEx (F0) and escape (F7) event, by hand rather than with juce::MidiFile,
+     * which does not read escape events as raw bytes. Returns a description of the first
+     * problem, or an empty string.
+     */
+    juce::String readSmf(const juce::MemoryBlock& file, int& division,
+        std::vector<TempoChange>& tempos, std::vector<SmfEvent>& events)
+    {
+        juce::MemoryInputStream in(file, false);
+
+        char chunk[4];
+        if (in.read(chunk, 4) != 4 || std::memcmp(chunk, "MThd", 4) != 0 || in.readIntBigEndian() != 6)
+            return "no MThd header";
+        const int format = in.readShortBigEndian();
+        const int numTracks = in.readShortBigEndian();
+        division = in.readShortBigEndian();
+        if (format != 0 || numTracks != 1 || division <= 0)
+            return juce::String::formatted("format %d, %d tracks, division %d", format, numTracks, division);
+
+        if (in.read(chunk, 4) != 4 || std::memcmp(chunk, "MTrk", 4) != 0)
+            return "no MTrk chunk";
+        const int trackLength = in.readIntBigEndian();
+        const auto trackEnd = in.getPosition() + trackLength;
+        if (trackEnd != in.getTotalLength())
+            return "track length does not match the file";
+
+        juce::int64 tick = 0;
+        while (in.getPosition() < trackEnd)
+        {
+            tick += readVarLen(in);
+            const auto status = (juce::uint8)in.readByte();
+
+            if (status == 0xff)
+            {
+                const auto type = (juce::uint8)in.readByte();
+                const auto length = readVarLen(in);
+                juce::MemoryBlock data;
+                in.readIntoMemoryBlock(data, (ssize_t)length);
+                if (type == 0x51 && length == 3)
+                {
+                    const auto* t = static_cast<const juce::uint8*>(data.getData());
+                    tempos.push_back({ tick, (double)((t[0] << 16) | (t[1] << 8) | t[2]) });
+                }
+                else if (type == 0x2f)
+                    return in.getPosition() == trackEnd ? juce::String() : "data after end of track";
+            }
+            else if (status == 0xf0 || status == 0xf7)
+            {
+                // SysEx carries the bytes after F0; an escape carries the raw message
+                SmfEvent e{ tick, {} };
+                if (status == 0xf0)
+                    e.bytes.push_back(0xf0);
+                const auto length = readVarLen(in);
+                for (juce::uint32 i = 0; i < length; ++i)
+                    e.bytes.push_back((juce::uint8)in.readByte());
+                events.push_back(std::move(e));
+            }
+            else
+                return juce::String::formatted("unexpected status %02x at tick %d", status, (int)tick);
+        }
+        return "no end of track";
+    }
+
+    /** Seconds from the start of the file at tick, under the tempo map. */
+    double secondsAtTick(juce::int64 tick, const std::vector<TempoChange>& tempos, int division)
+    {
+        double seconds = 0.0;
+        juce::int64 from = 0;
+        double micros = 500000.0; // The SMF default, 120 BPM
+        for (auto& t : tempos)
+        {
+            if (t.tick >= tick)
+                break;
+            seconds += (double)(t.tick - from) * micros / (1.0e6 * division);
+            from = t.tick;
+            micros = t.microsPerQuarter;
+        }
+        return seconds + (double)(tick - from) * micros / (1.0e6 * division);
+    }
+
+    /**
+     * Exports the session to a file and reads it back: the same events as the render, in
+     * order, each at most half a tick from its sample position under the tempo map.
+     * Returns a description of the first problem, or an empty string.
+     */
+    juce::String checkSmf(const juce::MemoryBlock& state, const MtcFileExporter::Options& options,
+        const std::vector<MtcFileExporter::Event>& rendered)
+    {
+        juce::TemporaryFile temp(".mid");
+        juce::String error;
+        if (!MtcFileExporter::exportToFile(state, options, temp.getFile(), error))
+            return "export failed: " + error;
+
+        juce::MemoryBlock data;
+        temp.getFile().loadFileAsData(data);
+
+        int division = 0;
+        std::vector<TempoChange> tempos;
+        std::vector<SmfEvent> read;
+        error = readSmf(data, division, tempos, read);
+        if (error.isNotEmpty())
+            return "the file does not read back: " + error;
+        if (read.size() != rendered.size())
+            return juce::String((int)read.size()) + " events in the file, "
+                + juce::String((int)rendered.size()) + " rendered";
+
+        const double sr = options.sampleRate;
+        for (size_t i = 0; i < read.size(); ++i)
+        {
+            const auto& packet = rendered[i].packet;
+            if (read[i].bytes.size() != (size_t)packet.size
+                || std::memcmp(read[i].bytes.data(), packet.data(), (size_t)packet.size) != 0)
+                return "file event " + juce::String((int)i) + " has other bytes than the render";
+
+            // Half a tick at 120 BPM, plus rounding
+            const double samples = secondsAtTick(read[i].tick, tempos, division) * sr;
+            const double halfTick = sr / MtcFileExporter::ticksPerSecond / 2.0;
+            if (std::abs(samples - (double)rendered[i].sample) > halfTick + 1.0e-6)
+                return juce::String::formatted("file event %d at tick %d is sample %.1f, rendered at %d",
+                    (int)i, (int)read[i].tick, samples, (int)rendered[i].sample);
+        }
+        return {};
+    }
+
+    /**
+     * Renders a session of four learned cues (quarter-frames, idle gaps between them) with
+     * MtcFileExporter on one thread and on four, with segments short enough that the
+     * parallel render splits after every cue. Fails unless it did split, on the first
+     * event that differs, and unless the file written from the same session reads back
+     * as the same events, each at the tick its sample position maps to under the file's
+     * tempo map. The message gives both render times.
+     */
+    MtcGoldenSuite::Result checkParallelExport()
+    {
+        constexpr int numThreads = 4;
+        constexpr int expectedSegments = 5; // Split after each cue, the last before the idle tail
+
+        MtcGoldenSuite::Result r;
+        r.name = "export_parallel";
+
+        MTCGenAudioProcessor processor;
+        processor.setFrameRate(25.0);
+        processor.setMTCFormat(QuarterFrame);
+        processor.editActiveCues([](CueStore& cues) {
+            const double windows[][2] = { { 2.0, 8.0 }, { 20.0, 30.0 }, { 45.0, 55.0 }, { 70.0, 80.0 } };
+            int hour = 1;
+            for (auto& w : windows)
+            {
+                MappingEntry cue("0" + juce::String(hour) + ":00:00:00", 69 + hour, "Export Cue");
+                ++hour;
+                cue.setDetectedStartTime(w[0]);
+                cue.setDetectedEndTime(w[1]);
+                cues.add(cue);
+            }
+            });
+        const auto state = MtcFileExporter::snapshotState(processor);
+
+        MtcFileExporter::Options options;
+        options.minSegmentSeconds = 5.0;
+
+        auto renderWith = [&](int threads, double& ms, int& numSegments) {
+            options.numThreads = threads;
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            auto events = MtcFileExporter::render(state, options, &numSegments);
+            ms = juce::Time::getMillisecondCounterHiRes() - start;
+            return events;
+        };
+
+        double serialMs = 0.0, parallelMs = 0.0;
+        int serialSegments = 0, parallelSegments = 0;
+        const auto serial = renderWith(1, serialMs, serialSegments);
+        const auto parallel = renderWith(numThreads, parallelMs, parallelSegments);
+
+        if (serial.empty())
+        {
+            r.message = "the serial render produced no events";
+            return r;
+        }
+
+        if (parallelSegments != expectedSegments)
+        {
+            r.message = "the parallel render ran in " + juce::String(parallelSegments)
+                + " segments, expected " + juce::String(expectedSegments);
+            return r;
+        }
+
+        for (size_t i = 0; i < juce::jmin(serial.size(), parallel.size()); ++i)
+        {
+            const auto& a = serial[i];
+            const auto& b = parallel[i];
+            if (a.sample != b.sample || a.packet.size != b.packet.size
+                || std::memcmp(a.packet.data(), b.packet.data(), (size_t)a.packet.size) != 0)
+            {
+                r.message = "event " + juce::String((int)i) + " differs (sample "
+                    + juce::String(a.sample) + " serial, " + juce::String(b.sample) + " parallel)";
+                return r;
+            }
+        }
+
+        if (serial.size() != parallel.size())
+        {
+            r.message = juce::String((int)serial.size()) + " events serial, "
+                + juce::String((int)parallel.size()) + " parallel";
+            return r;
+        }
+
+        r.message = checkSmf(state, options, serial);
+        if (r.message.isNotEmpty())
+            return r;
+
+        r.passed = true;
+        r.message = juce::String::formatted("%d events, 1 thread %.1f ms in %d segments, %d threads %.1f ms in %d",
+            (int)serial.size(), serialMs, serialSegments, numThreads, parallelMs, parallelSegments);
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> ExportSuite::run()
+{
+    return { checkParallelExport() };
+}
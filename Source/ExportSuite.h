@@ -0,0 +1,28 @@
+/**
+ * @file ExportSuite.h
+ * @brief Declaration of ExportSuite, checks of the offline MTC file export.
+ */
+
+#ifndef EXPORTSUITE_H_INCLUDED
+#define EXPORTSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class ExportSuite
+ * @brief "export_parallel" renders a session with MtcFileExporter on one thread and on
+ * several, and fails unless the parallel render was split into segments and the events
+ * match byte for byte. It then writes the session as a Standard MIDI File, reads it back
+ * and checks every event's tick against its sample position under the file's tempo map.
+ * It reports both render times.
+ */
+class ExportSuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // EXPORTSUITE_H_INCLUDED
@@ -0,0 +1,69 @@
+/**
+ * @file FileTimecodeSink.cpp
+ * @brief Definitions for FileTimecodeSink methods.
+ */
+
+#include "FileTimecodeSink.h"
+#include "RealtimeAudit.h"
+
+namespace
+{
+    const char* typeName(TimecodeSink::Event::Type type) noexcept
+    {
+        switch (type)
+        {
+            case TimecodeSink::Event::Frame:        return "frame";
+            case TimecodeSink::Event::QuarterFrame: return "qf";
+            case TimecodeSink::Event::Locate:       return "locate";
+            case TimecodeSink::Event::CueStart:     return "start";
+            case TimecodeSink::Event::CueStop:      return "stop";
+            default:                                return "?";
+        }
+    }
+}
+
+//==============================================================================
+bool FileTimecodeSink::open(const juce::File& file, juce::String& error)
+{
+    file.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+    if (!stream->openedOk())
+    {
+        error = "Could not write " + file.getFullPathName();
+        return false;
+    }
+    out = std::move(stream);
+    return true;
+}
+
+void FileTimecodeSink::close()
+{
+    if (out != nullptr)
+        out->flush();
+    out.reset();
+}
+
+void FileTimecodeSink::handleTimecodeEvents(const Event* events, int numEvents)
+{
+    if (out == nullptr)
+        return;
+
+    // Caught by the audit if the sink is ever registered as realtime
+    MTCGEN_RT_BLOCKING("FileTimecodeSink write");
+    juce::MemoryOutputStream text;
+    for (int i = 0; i < numEvents; ++i)
+        text << formatEvent(events[i]) << "\n";
+    out->write(text.getData(), text.getDataSize());
+}
+
+juce::String FileTimecodeSink::formatEvent(const Event& e)
+{
+    Timecode tc;
+    const auto timecode = Timecode::unpack(e.frame, tc)
+        ? juce::String::formatted("%02d:%02d:%02d:%02d", tc.hours, tc.minutes, tc.seconds, tc.frames)
+        : juce::String("--:--:--:--");
+
+    return juce::String(e.hostTime, 6) + "\t" + typeName(e.type) + "\t" + timecode
+        + "\t" + juce::String(e.cueId) + "\t" + juce::String((int)e.note)
+        + "\t" + juce::String::toHexString((int)e.data);
+}
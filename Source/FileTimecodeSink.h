@@ -0,0 +1,45 @@
+/**
+ * @file FileTimecodeSink.h
+ * @brief Declaration of the FileTimecodeSink class, a TimecodeSink that logs to a text file.
+ */
+
+#ifndef FILETIMECODESINK_H_INCLUDED
+#define FILETIMECODESINK_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <memory>
+#include "TimecodeSink.h"
+
+/**
+ * @class FileTimecodeSink
+ * @brief Writes every event as one tab-separated line: host time, event type,
+ * timecode, cue id, note and quarter-frame data byte, for comparing runs with diff.
+ *
+ * Writing to disk can block, so register it as deferred.
+ */
+class FileTimecodeSink : public TimecodeSink
+{
+public:
+    FileTimecodeSink() = default;
+
+    /**
+     * @brief Opens (and truncates) the file. Message thread.
+     * @return False if the file cannot be written.
+     */
+    bool open(const juce::File& file, juce::String& error);
+
+    /** @brief Flushes and closes the file. Only while the sink is not registered. */
+    void close();
+
+    void handleTimecodeEvents(const Event* events, int numEvents) override;
+
+    /** @brief One event as the line written for it (without the newline). */
+    static juce::String formatEvent(const Event& event);
+
+private:
+    std::unique_ptr<juce::FileOutputStream> out;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FileTimecodeSink)
+};
+
+#endif // FILETIMECODESINK_H_INCLUDED
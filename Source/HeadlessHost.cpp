@@ -0,0 +1,162 @@
+/**
+ * @file HeadlessHost.cpp
+ * @brief Definitions for HeadlessHost methods.
+ */
+
+#include "HeadlessHost.h"
+
+namespace
+{
+    /** Falling this many blocks behind resynchronises the clock instead of catching up. */
+    constexpr int maxBlocksBehind = 8;
+}
+
+//==============================================================================
+HeadlessHost::HeadlessHost(juce::AudioProcessor& proc, double rate, int block)
+    : juce::Thread("MTCGen Clock"), processor(proc), sampleRate(rate), blockSize(block)
+{
+}
+
+HeadlessHost::~HeadlessHost()
+{
+    stop();
+    processor.setPlayHead(nullptr);
+}
+
+bool HeadlessHost::openMidiInput(const juce::String& nameOrIdentifier)
+{
+    for (auto& d : juce::MidiInput::getAvailableDevices())
+    {
+        if (d.name != nameOrIdentifier && d.identifier != nameOrIdentifier)
+            continue;
+
+        midiInput = juce::MidiInput::openDevice(d.identifier, this);
+        if (midiInput != nullptr)
+        {
+            midiInput->start();
+            return true;
+        }
+    }
+    return false;
+}
+
+void HeadlessHost::addMessage(const juce::MidiMessage& message)
+{
+    auto m = message;
+    m.setTimeStamp(juce::Time::getMillisecondCounterHiRes() * 0.001);
+    handleTransport(m);
+    collector.addMessageToQueue(m);
+}
+
+void HeadlessHost::handleIncomingMidiMessage(juce::MidiInput*, const juce::MidiMessage& message)
+{
+    // MidiInput already stamps messages on the millisecond counter
+    handleTransport(message);
+    collector.addMessageToQueue(message);
+}
+
+void HeadlessHost::handleTransport(const juce::MidiMessage& message) noexcept
+{
+    if (message.isMidiStart())
+    {
+        rewindRequested.store(true);
+        playing.store(true);
+    }
+    else if (message.isMidiContinue())
+    {
+        playing.store(true);
+    }
+    else if (message.isMidiStop())
+    {
+        playing.store(false);
+    }
+}
+
+void HeadlessHost::setTempo(double bpm) noexcept
+{
+    tempo.store(juce::jlimit(20.0, 999.0, bpm));
+}
+
+//==============================================================================
+void HeadlessHost::start()
+{
+    if (isThreadRunning())
+        return;
+
+    buffer.setSize(0, blockSize);
+    midi.ensureSize(4096);
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+    collector.reset(sampleRate);
+    processor.setPlayHead(this);
+
+    startThread(juce::Thread::Priority::highest);
+}
+
+void HeadlessHost::stop()
+{
+    if (midiInput != nullptr)
+        midiInput->stop();
+
+    if (isThreadRunning())
+    {
+        stopThread(1000);
+        processor.releaseResources();
+    }
+}
+
+/**
+ * @brief Calls processBlock on a fixed schedule. Wake-ups are only millisecond
+ * accurate, but every block still covers exactly blockSize samples of the clock, so
+ * the processor's sample positions stay exact and only the send time jitters.
+ */
+void HeadlessHost::run()
+{
+    const double blockMs = 1000.0 * blockSize / sampleRate;
+    double dueMs = juce::Time::getMillisecondCounterHiRes();
+    juce::int64 samples = 0;
+
+    while (!threadShouldExit())
+    {
+        midi.clear();
+        collector.removeNextBlockOfMessages(midi, blockSize);
+        updatePosition(samples, blockMs);
+
+        {
+            const juce::ScopedLock sl(processor.getCallbackLock());
+            processor.processBlock(buffer, midi);
+        }
+        samples += blockSize;
+
+        dueMs += blockMs;
+        auto now = juce::Time::getMillisecondCounterHiRes();
+        if (now - dueMs > maxBlocksBehind * blockMs)
+            dueMs = now;
+        else if (dueMs > now)
+            wait(juce::jmax(0, (int)(dueMs - now)));
+    }
+}
+
+/**
+ * @brief Time comes from the sample clock and the host time from the wake-up, as a
+ * real host reports them; the musical position only advances while playing.
+ */
+void HeadlessHost::updatePosition(juce::int64 samples, double blockMs)
+{
+    const bool isPlaying = playing.load();
+    const double bpm = tempo.load();
+    if (rewindRequested.exchange(false))
+        ppq = 0.0;
+
+    position.setIsPlaying(isPlaying);
+    position.setTimeInSamples(samples);
+    position.setTimeInSeconds(samples / sampleRate);
+    position.setHostTimeNs((juce::uint64)(juce::Time::getMillisecondCounterHiRes() * 1.0e6));
+    position.setBpm(bpm);
+    position.setTimeSignature(juce::AudioPlayHead::TimeSignature{});
+    position.setPpqPosition(ppq);
+    position.setPpqPositionOfLastBarStart(std::floor(ppq / 4.0) * 4.0);
+
+    if (isPlaying)
+        ppq += blockMs / 60000.0 * bpm;
+}
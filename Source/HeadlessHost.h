@@ -0,0 +1,104 @@
+/**
+ * @file HeadlessHost.h
+ * @brief Declaration of the HeadlessHost class, a minimal real-time host with no audio device.
+ */
+
+#ifndef HEADLESSHOST_H_INCLUDED
+#define HEADLESSHOST_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+
+/**
+ * @class HeadlessHost
+ * @brief Runs an AudioProcessor on its own sample clock, feeding it MIDI from an input
+ * port or from injected messages. Used by the headless daemon.
+ *
+ * A high-priority thread calls processBlock once per block period, paced against the
+ * system's high-resolution millisecond counter. Incoming MIDI goes through a
+ * MidiMessageCollector, which places each message at the sample matching its arrival
+ * time.
+ *
+ * The host is also the processor's playhead. Its time is the sample clock, which runs
+ * from start() whether or not the transport plays, so cues learned against it keep
+ * their times. The transport only adds a play state and a musical position (at a fixed
+ * tempo, in 4/4) for MIDI Clock and SPP: MIDI Start plays from the top, Continue plays
+ * from where it stopped and Stop stops, whether they arrive on the input or through
+ * addMessage(). A change takes effect at the next block.
+ *
+ * If the clock falls far behind (the machine was suspended, say), it resynchronises
+ * instead of running a burst of blocks to catch up.
+ */
+class HeadlessHost : private juce::Thread,
+    private juce::MidiInputCallback,
+    private juce::AudioPlayHead
+{
+public:
+    /**
+     * @param proc Processor to run; must outlive the host.
+     * @param sampleRate Rate of the simulated sample clock.
+     * @param blockSize Samples per processBlock call.
+     */
+    HeadlessHost(juce::AudioProcessor& proc, double sampleRate, int blockSize);
+
+    /** Destructor: stops the clock and closes the MIDI input. */
+    ~HeadlessHost() override;
+
+    /**
+     * @brief Opens a MIDI input by name or identifier and routes it to the processor.
+     * @return False if no such device could be opened.
+     */
+    bool openMidiInput(const juce::String& nameOrIdentifier);
+
+    /** @brief Injects a message as if it had just arrived (local stand-in input). */
+    void addMessage(const juce::MidiMessage& message);
+
+    /** @brief Prepares the processor and starts the clock. */
+    void start();
+
+    /** @brief Stops the clock and releases the processor. */
+    void stop();
+
+    /** @brief Sets the transport tempo used for the musical position. Any thread. */
+    void setTempo(double bpm) noexcept;
+
+    /** @brief True while the transport plays. Any thread. */
+    bool isPlaying() const noexcept { return playing.load(std::memory_order_relaxed); }
+
+private:
+    /** Clock loop: one processBlock per block period. */
+    void run() override;
+
+    void handleIncomingMidiMessage(juce::MidiInput*, const juce::MidiMessage&) override;
+
+    /** Applies MIDI Start, Continue and Stop to the transport. */
+    void handleTransport(const juce::MidiMessage& message) noexcept;
+
+    /** Fills position for the coming block; clock thread. */
+    void updatePosition(juce::int64 samples, double blockMs);
+
+    juce::Optional<PositionInfo> getPosition() const override { return position; }
+    bool canControlTransport() override { return true; }
+    void transportPlay(bool shouldStartPlaying) override { playing.store(shouldStartPlaying); }
+
+    juce::AudioProcessor& processor;
+    const double sampleRate;
+    const int blockSize;
+
+    juce::MidiMessageCollector collector;
+    std::unique_ptr<juce::MidiInput> midiInput;
+
+    juce::AudioBuffer<float> buffer;  /**< Empty-channel buffer handed to processBlock */
+    juce::MidiBuffer midi;            /**< Per-block MIDI, sized in start() */
+
+    std::atomic<bool> playing{ false };
+    std::atomic<bool> rewindRequested{ false };  /**< Set by MIDI Start, applied by the clock */
+    std::atomic<double> tempo{ 120.0 };
+    double ppq{ 0.0 };                           /**< Clock thread only */
+    PositionInfo position;                       /**< Clock thread only; read in processBlock */
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HeadlessHost)
+};
+
+#endif // HEADLESSHOST_H_INCLUDED
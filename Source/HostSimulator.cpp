@@ -0,0 +1,234 @@
+/**
+ * @file HostSimulator.cpp
+ * @brief Definitions for HostSimulator methods.
+ */
+
+#include "HostSimulator.h"
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+HostSimulator::HostSimulator(juce::AudioProcessor& proc, double initialSampleRate)
+    : processor(proc), sampleRate(initialSampleRate)
+{
+    processor.setPlayHead(this);
+}
+
+HostSimulator::~HostSimulator()
+{
+    if (preparedBlockSize > 0)
+        processor.releaseResources();
+    processor.setPlayHead(nullptr);
+}
+
+void HostSimulator::addMidi(juce::int64 samplePosition, const juce::MidiMessage& message)
+{
+    scriptedMidi.emplace_back(samplePosition, message);
+}
+
+void HostSimulator::prepare(double newSampleRate, int blockSize)
+{
+    if (preparedBlockSize > 0)
+        processor.releaseResources();
+
+    sampleRate = newSampleRate;
+    preparedBlockSize = blockSize;
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+}
+
+//==============================================================================
+/**
+ * @brief Reports the simulated transport. Host time advances with processed
+ * samples only, so results never depend on the machine running them.
+ */
+juce::Optional<juce::AudioPlayHead::PositionInfo> HostSimulator::getPosition() const
+{
+    PositionInfo info;
+    info.setTimeInSeconds(reportedSeconds);
+    info.setTimeInSamples((juce::int64)std::llround(reportedSeconds * sampleRate));
+    info.setPpqPosition(ppq);
+    info.setBpm(bpm);
+    info.setIsPlaying(isPlaying);
+    info.setIsLooping(isLooping);
+    if (isLooping)
+        info.setLoopPoints(LoopPoints{ loopStart * bpm / 60.0, loopEnd * bpm / 60.0 });
+    info.setHostTimeNs((juce::uint64)wallNanos);
+    return info;
+}
+
+double HostSimulator::nextReportedSeconds()
+{
+    double seconds = hostSeconds;
+    if (positionError.jitterSeconds > 0.0)
+        seconds += (random.nextDouble() * 2.0 - 1.0) * positionError.jitterSeconds;
+    if (positionError.quantumSeconds > 0.0)
+        seconds = std::floor(seconds / positionError.quantumSeconds) * positionError.quantumSeconds;
+    return juce::jmax(0.0, seconds);
+}
+
+//==============================================================================
+void HostSimulator::run()
+{
+    captured.clear();
+    wallSamples = 0;
+    numBlocks = 0;
+    wallNanos = 0.0;
+    hostSeconds = 0.0;
+    reportedSeconds = 0.0;
+    random.setSeed(positionError.seed);
+    ppq = 0.0;
+    isPlaying = false;
+    isLooping = false;
+
+    std::stable_sort(scriptedMidi.begin(), scriptedMidi.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    size_t nextMidi = 0;
+    juce::AudioBuffer<float> audio;
+    juce::MidiBuffer midi;
+    midi.ensureSize(8192); // As a host would, so the audit never sees the buffer grow
+    const int numChannels = juce::jmax(processor.getTotalNumInputChannels(),
+        processor.getTotalNumOutputChannels());
+
+    for (auto& seg : segments)
+    {
+        double newRate = seg.sampleRate > 0.0 ? seg.sampleRate : sampleRate;
+        if (preparedBlockSize == 0 || newRate != sampleRate || seg.blockSize > preparedBlockSize)
+            prepare(newRate, juce::jmax(seg.blockSize, preparedBlockSize));
+
+        bpm = seg.bpm;
+        isPlaying = seg.playing;
+        isLooping = seg.playing && seg.loopEndSeconds > seg.loopStartSeconds;
+        loopStart = seg.loopStartSeconds;
+        loopEnd = seg.loopEndSeconds;
+
+        if (seg.locateSeconds >= 0.0)
+        {
+            hostSeconds = seg.locateSeconds;
+            ppq = hostSeconds * bpm / 60.0;
+        }
+
+        for (juce::int64 done = 0; done < seg.lengthSamples;)
+        {
+            int n = (int)juce::jmin((juce::int64)seg.blockSize, seg.lengthSamples - done);
+            audio.setSize(numChannels, n, false, false, true);
+
+            midi.clear();
+            while (nextMidi < scriptedMidi.size() && scriptedMidi[nextMidi].first < wallSamples + n)
+            {
+                auto& ev = scriptedMidi[nextMidi++];
+                midi.addEvent(ev.second, (int)juce::jmax((juce::int64)0, ev.first - wallSamples));
+            }
+
+            reportedSeconds = nextReportedSeconds();
+            {
+                const juce::ScopedLock sl(processor.getCallbackLock());
+                processor.processBlock(audio, midi);
+            }
+            ++numBlocks;
+            if (onBlock)
+                onBlock();
+
+            double dt = n / sampleRate;
+            for (const auto meta : midi)
+                captured.push_back({ wallSamples + meta.samplePosition,
+                    std::vector<juce::uint8>(meta.data, meta.data + meta.numBytes),
+                    wallNanos * 1.0e-9 + meta.samplePosition / sampleRate });
+
+            wallSamples += n;
+            wallNanos += dt * 1.0e9;
+            done += n;
+
+            if (isPlaying)
+            {
+                hostSeconds += dt;
+                ppq += dt * bpm / 60.0;
+                if (isLooping && hostSeconds >= loopEnd)
+                {
+                    hostSeconds = loopStart + (hostSeconds - loopEnd);
+                    ppq = hostSeconds * bpm / 60.0;
+                }
+            }
+        }
+    }
+}
+
+//==============================================================================
+HostSimulator::IntervalStats HostSimulator::getIntervalStats(juce::uint8 statusByte) const
+{
+    // Collect runs of event times, split at transport/position messages
+    std::vector<std::vector<double>> runs(1);
+    for (auto& ev : captured)
+    {
+        if (ev.bytes.empty())
+            continue;
+
+        auto status = ev.bytes[0];
+        if (status == statusByte)
+            runs.back().push_back(ev.seconds);
+        else if (status == 0xF2 || status == 0xFA || status == 0xFB || status == 0xFC)
+            runs.emplace_back();
+    }
+
+    IntervalStats stats;
+    double total = 0.0;
+
+    for (auto& run : runs)
+    {
+        if (run.size() < 2)
+            continue;
+
+        double runMean = (run.back() - run.front()) / double(run.size() - 1);
+        for (size_t i = 1; i < run.size(); ++i)
+        {
+            double interval = run[i] - run[i - 1];
+            stats.maxJitterSeconds = juce::jmax(stats.maxJitterSeconds, std::abs(interval - runMean));
+            total += interval;
+            ++stats.numIntervals;
+        }
+    }
+
+    if (stats.numIntervals > 0)
+        stats.meanSeconds = total / stats.numIntervals;
+    return stats;
+}
+
+//==============================================================================
+juce::String HostSimulator::toGoldenText() const
+{
+    juce::String text;
+    for (auto& ev : captured)
+        text << juce::String(ev.samplePosition) << " "
+             << juce::String::toHexString(ev.bytes.data(), (int)ev.bytes.size()) << "\n";
+    return text;
+}
+
+bool HostSimulator::writeGolden(const juce::File& file) const
+{
+    return file.replaceWithText(toGoldenText());
+}
+
+bool HostSimulator::matchesGolden(const juce::File& file, juce::String& firstDifference) const
+{
+    if (!file.existsAsFile())
+    {
+        firstDifference = "missing golden file " + file.getFullPathName();
+        return false;
+    }
+
+    auto expected = juce::StringArray::fromLines(file.loadFileAsString().trimEnd());
+    auto actual = juce::StringArray::fromLines(toGoldenText().trimEnd());
+
+    for (int i = 0; i < juce::jmax(expected.size(), actual.size()); ++i)
+    {
+        if (expected[i] != actual[i])
+        {
+            firstDifference = "line " + juce::String(i + 1) + ": expected \"" + expected[i]
+                + "\", got \"" + actual[i] + "\"";
+            return false;
+        }
+    }
+
+    return true;
+}
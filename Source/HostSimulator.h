@@ -0,0 +1,171 @@
+/**
+ * @file HostSimulator.h
+ * @brief Declaration of the HostSimulator class, a deterministic stand-in for a DAW.
+ */
+
+#ifndef HOSTSIMULATOR_H_INCLUDED
+#define HOSTSIMULATOR_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+
+/**
+ * @class HostSimulator
+ * @brief Drives an AudioProcessor's processBlock from a scripted transport and MIDI input.
+ *
+ * The script is a list of TransportSegments (play, stop, locate, loop, block size,
+ * sample rate, tempo) plus MIDI events at absolute sample positions. run() plays it
+ * back block by block without any real-time waiting and records every event the
+ * processor leaves in the MidiBuffer, stamped with its absolute sample position.
+ *
+ * The captured stream can be written to, or compared against, a golden text file
+ * (one line per event: "<sample> <hex bytes>"), so a change in generator timing
+ * shows up as a diff instead of at a show.
+ */
+class HostSimulator : private juce::AudioPlayHead
+{
+public:
+    /**
+     * @struct TransportSegment
+     * @brief One stretch of scripted host behaviour.
+     */
+    struct TransportSegment
+    {
+        juce::int64 lengthSamples{ 0 };  /**< Duration of the segment */
+        int    blockSize{ 512 };         /**< Block size used during the segment */
+        double sampleRate{ 0.0 };        /**< New sample rate, or 0 to keep the current one */
+        bool   playing{ true };          /**< Transport running */
+        double locateSeconds{ -1.0 };    /**< Jump to this host time at segment start, or -1 */
+        double loopStartSeconds{ -1.0 }; /**< Loop range while playing, ignored if end <= start */
+        double loopEndSeconds{ -1.0 };
+        double bpm{ 120.0 };             /**< Tempo reported during the segment */
+    };
+
+    /**
+     * @struct CapturedEvent
+     * @brief One event emitted by the processor.
+     */
+    struct CapturedEvent
+    {
+        juce::int64 samplePosition;      /**< Absolute sample since run() started */
+        std::vector<juce::uint8> bytes;  /**< Raw MIDI bytes */
+        double seconds{ 0.0 };           /**< Simulated wall-clock time of the event */
+    };
+
+    /**
+     * @struct IntervalStats
+     * @brief Spacing of one kind of event (e.g. MIDI Clock) in the captured stream.
+     */
+    struct IntervalStats
+    {
+        int numIntervals{ 0 };
+        double meanSeconds{ 0.0 };
+        double maxJitterSeconds{ 0.0 }; /**< Largest |interval - mean of its run| */
+    };
+
+    /**
+     * @struct PositionError
+     * @brief How far the reported position strays from the transport, as on hosts whose
+     * playhead jitters or is rounded. The transport itself stays sample-exact.
+     */
+    struct PositionError
+    {
+        double jitterSeconds{ 0.0 };     /**< Uniform random error within +/- this, or 0 */
+        double quantumSeconds{ 0.0 };    /**< Rounded down to a multiple of this, or 0 */
+        juce::int64 seed{ 1 };           /**< Seed for the jitter, so every run repeats */
+    };
+
+    /**
+     * @brief Constructs a simulator and attaches it as the processor's playhead.
+     * @param proc Processor under test.
+     * @param initialSampleRate Sample rate passed to prepareToPlay.
+     */
+    HostSimulator(juce::AudioProcessor& proc, double initialSampleRate);
+    ~HostSimulator() override;
+
+    /** @brief Appends a transport segment to the script. */
+    void addSegment(const TransportSegment& segment) { segments.push_back(segment); }
+
+    /**
+     * @brief Schedules an incoming MIDI event.
+     * @param samplePosition Absolute sample since run() starts.
+     */
+    void addMidi(juce::int64 samplePosition, const juce::MidiMessage& message);
+
+    /**
+     * @brief Makes getPosition() report the position with this error, from the next
+     * run() on. The default reports it exactly.
+     */
+    void setPositionError(const PositionError& error) { positionError = error; }
+
+    /** @brief Called after every processBlock, e.g. to sample the processor's state. */
+    std::function<void()> onBlock;
+
+    /** @brief Exact transport position of the block being processed, without any error. */
+    double getTransportSeconds() const { return hostSeconds; }
+
+    /** @brief Plays the whole script. Clears anything captured before. */
+    void run();
+
+    /** @brief Events captured by the last run(). */
+    const std::vector<CapturedEvent>& getCaptured() const { return captured; }
+
+    /** @brief processBlock calls made by the last run(). */
+    juce::int64 getNumBlocks() const { return numBlocks; }
+
+    /**
+     * @brief Measures the spacing of captured events whose first byte is statusByte.
+     * Runs are split at any other system real-time/common message (Start, Stop, Continue,
+     * SPP), so a locate does not count as jitter.
+     */
+    IntervalStats getIntervalStats(juce::uint8 statusByte) const;
+
+    /** @brief Captured stream as golden text, one "<sample> <hex bytes>" line per event. */
+    juce::String toGoldenText() const;
+
+    /** @brief Writes toGoldenText() to file. */
+    bool writeGolden(const juce::File& file) const;
+
+    /**
+     * @brief Compares the captured stream with a golden file.
+     * @param file Golden file written by writeGolden().
+     * @param firstDifference Set to a description of the first mismatching line.
+     * @return True if identical.
+     */
+    bool matchesGolden(const juce::File& file, juce::String& firstDifference) const;
+
+private:
+    juce::Optional<PositionInfo> getPosition() const override;
+
+    /** The position to report for the next block: hostSeconds with positionError applied. */
+    double nextReportedSeconds();
+
+    /** Calls prepareToPlay for a (new) sample rate and block size. */
+    void prepare(double newSampleRate, int blockSize);
+
+    juce::AudioProcessor& processor;
+
+    std::vector<TransportSegment> segments;
+    std::vector<std::pair<juce::int64, juce::MidiMessage>> scriptedMidi;
+    std::vector<CapturedEvent> captured;
+
+    // Simulated host state, reported through getPosition()
+    double sampleRate;
+    int    preparedBlockSize{ 0 };
+    juce::int64 wallSamples{ 0 };    /**< Samples processed since run() started */
+    juce::int64 numBlocks{ 0 };      /**< Blocks processed since run() started */
+    double wallNanos{ 0.0 };         /**< Simulated host clock (getHostTimeNs) */
+    double hostSeconds{ 0.0 };
+    double reportedSeconds{ 0.0 };   /**< hostSeconds as getPosition() reports it */
+    PositionError positionError;
+    juce::Random random;
+    double ppq{ 0.0 };
+    double bpm{ 120.0 };
+    bool   isPlaying{ false };
+    bool   isLooping{ false };
+    double loopStart{ 0.0 }, loopEnd{ 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HostSimulator)
+};
+
+#endif // HOSTSIMULATOR_H_INCLUDED
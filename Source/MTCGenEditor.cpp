@@ -4,6 +4,8 @@
  */
 
 #include "MTCGenEditor.h"
+#include "MtcFileExporter.h"
+#include "TraceRecorder.h"
 
  //==============================================================================
  /**
@@ -12,40 +14,133 @@
   */
 MTCGenAudioProcessorEditor::MTCGenAudioProcessorEditor(MTCGenAudioProcessor& p)
     : AudioProcessorEditor(&p), processor(p), mappingTable(processor),
-    midiOutputSelector(processor)
+    cueTimeline(processor), midiOutputSelector(processor), timecodeDisplay(processor)
 {
-    setSize(600, 700);
+    setSize(600, 950);
 
     addAndMakeVisible(mappingTable);
+
+    // Like the timecode display, follows the display refresh on its own
+    addAndMakeVisible(cueTimeline);
     addAndMakeVisible(midiOutputSelector);
 
-    currentTimecodeLabel.setJustificationType(juce::Justification::centred);
-    currentTimecodeLabel.setFont(juce::Font("Consolas", 36.0f, juce::Font::plain));
-    currentTimecodeLabel.setColour(juce::Label::backgroundColourId, juce::Colours::black);
-    currentTimecodeLabel.setColour(juce::Label::textColourId, juce::Colours::lime);
-    currentTimecodeLabel.setBorderSize(juce::BorderSize<int>(2));
-    currentTimecodeLabel.setText("Timecode: --:--:--:--", juce::dontSendNotification);
-    addAndMakeVisible(currentTimecodeLabel);
+    // Repaints itself on display refresh; the 10 Hz timer below doesn't drive it
+    addAndMakeVisible(timecodeDisplay);
+
+    // Rate, format, output enable, offset and clock are host parameters; item id = choice index + 1
+    auto& params = processor.getParameters();
 
     frameRateComboBox.addItem("24", 1);
     frameRateComboBox.addItem("25", 2);
     frameRateComboBox.addItem("29.97", 3);
     frameRateComboBox.addItem("30", 4);
-    frameRateComboBox.setSelectedId(
-        processor.getFrameRate() == 24.0 ? 1 :
-        processor.getFrameRate() == 25.0 ? 2 :
-        processor.getFrameRate() == 29.97 ? 3 : 4,
-        juce::dontSendNotification);
-    frameRateComboBox.addListener(this);
     addAndMakeVisible(frameRateComboBox);
+    frameRateAttachment = std::make_unique<APVTS::ComboBoxAttachment>(
+        params, MTCGenAudioProcessor::frameRateParamID, frameRateComboBox);
 
     mtcFormatComboBox.addItem("Full SysEx", 1);
     mtcFormatComboBox.addItem("Quarter Frame", 2);
-    mtcFormatComboBox.setSelectedId(
-        processor.getMTCFormat() == FullSysEx ? 1 : 2,
-        juce::dontSendNotification);
-    mtcFormatComboBox.addListener(this);
     addAndMakeVisible(mtcFormatComboBox);
+    mtcFormatAttachment = std::make_unique<APVTS::ComboBoxAttachment>(
+        params, MTCGenAudioProcessor::mtcFormatParamID, mtcFormatComboBox);
+
+    addAndMakeVisible(outputEnabledToggle);
+    outputEnabledAttachment = std::make_unique<APVTS::ButtonAttachment>(
+        params, MTCGenAudioProcessor::outputEnabledParamID, outputEnabledToggle);
+
+    offsetSlider.setSliderStyle(juce::Slider::IncDecButtons);
+    offsetSlider.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 70, 20);
+    offsetSlider.setTextValueSuffix(" fr");
+    offsetSlider.setTooltip("Global offset added to every cue, in frames");
+    addAndMakeVisible(offsetSlider);
+    offsetAttachment = std::make_unique<APVTS::SliderAttachment>(
+        params, MTCGenAudioProcessor::offsetParamID, offsetSlider);
+
+    clockEnabledToggle.setTooltip("Send 24-PPQN MIDI Clock and Song Position Pointer");
+    addAndMakeVisible(clockEnabledToggle);
+    clockEnabledAttachment = std::make_unique<APVTS::ButtonAttachment>(
+        params, MTCGenAudioProcessor::clockEnabledParamID, clockEnabledToggle);
+
+    // MIDI thru: what of the input reaches the next plugin; channel item id = choice index + 1
+    thruTriggersToggle.setTooltip("Pass mapped trigger notes and bank program changes downstream");
+    addAndMakeVisible(thruTriggersToggle);
+    thruTriggersAttachment = std::make_unique<APVTS::ButtonAttachment>(
+        params, MTCGenAudioProcessor::thruTriggersParamID, thruTriggersToggle);
+
+    thruSysExToggle.setTooltip("Pass incoming MTC and SysEx downstream");
+    addAndMakeVisible(thruSysExToggle);
+    thruSysExAttachment = std::make_unique<APVTS::ButtonAttachment>(
+        params, MTCGenAudioProcessor::thruSysExParamID, thruSysExToggle);
+
+    thruChannelComboBox.addItem("Keep Channel", 1);
+    for (int ch = 1; ch <= 16; ++ch)
+        thruChannelComboBox.addItem("Channel " + juce::String(ch), ch + 1);
+    thruChannelComboBox.setTooltip("Move passed channel messages to one MIDI channel");
+    addAndMakeVisible(thruChannelComboBox);
+    thruChannelAttachment = std::make_unique<APVTS::ComboBoxAttachment>(
+        params, MTCGenAudioProcessor::thruChannelParamID, thruChannelComboBox);
+
+    auto& artNet = processor.getArtNetSender();
+    artNetToggle.setToggleState(processor.isArtNetEnabled(), juce::dontSendNotification);
+    artNetToggle.onClick = [this]() {
+        applyArtNetTarget();
+        processor.setArtNetEnabled(artNetToggle.getToggleState());
+        };
+    addAndMakeVisible(artNetToggle);
+
+    artNetAddressEditor.setText(artNet.getTargetAddress(), juce::dontSendNotification);
+    artNetAddressEditor.onReturnKey = [this]() { applyArtNetTarget(); };
+    artNetAddressEditor.onFocusLost = [this]() { applyArtNetTarget(); };
+    addAndMakeVisible(artNetAddressEditor);
+
+    artNetPortEditor.setInputRestrictions(5, "0123456789");
+    artNetPortEditor.setText(juce::String(artNet.getTargetPort()), juce::dontSendNotification);
+    artNetPortEditor.onReturnKey = [this]() { applyArtNetTarget(); };
+    artNetPortEditor.onFocusLost = [this]() { applyArtNetTarget(); };
+    addAndMakeVisible(artNetPortEditor);
+
+    // Item id = RateType + 2, so "Follow Frame Rate" (-1) is id 1
+    artNetRateComboBox.addItem("Follow Frame Rate", 1);
+    artNetRateComboBox.addItem("Film (24)", 2);
+    artNetRateComboBox.addItem("EBU (25)", 3);
+    artNetRateComboBox.addItem("DF (29.97)", 4);
+    artNetRateComboBox.addItem("SMPTE (30)", 5);
+    artNetRateComboBox.setSelectedId(processor.getArtNetRateType() + 2, juce::dontSendNotification);
+    artNetRateComboBox.addListener(this);
+    addAndMakeVisible(artNetRateComboBox);
+
+    sharedMemoryToggle.setToggleState(processor.getSharedTimecode().isEnabled(),
+        juce::dontSendNotification);
+    sharedMemoryToggle.setTooltip("Publish the timecode to local programs in shared memory "
+        + processor.getSharedTimecode().getName());
+    sharedMemoryToggle.onClick = [this]() {
+        auto& shared = processor.getSharedTimecode();
+        if (!shared.setEnabled(sharedMemoryToggle.getToggleState()))
+        {
+            sharedMemoryToggle.setToggleState(false, juce::dontSendNotification);
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                "Shared Memory", shared.getLastError());
+        }
+        };
+    addAndMakeVisible(sharedMemoryToggle);
+
+    controlToggle.setToggleState(processor.getControlServer().isEnabled(),
+        juce::dontSendNotification);
+    controlToggle.setTooltip("Accept cue commands from local scripts on "
+        + processor.getControlServer().getPath());
+    controlToggle.onClick = [this]() {
+        auto& control = processor.getControlServer();
+        if (!control.setEnabled(controlToggle.getToggleState()))
+        {
+            controlToggle.setToggleState(false, juce::dontSendNotification);
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                "Control Socket", control.getLastError());
+        }
+        };
+    addAndMakeVisible(controlToggle);
+
+    exportButton.onClick = [this]() { exportMtcFile(); };
+    addAndMakeVisible(exportButton);
 
     debugToggle.setButtonText("Show Debug");
     debugToggle.onClick = [this]() {
@@ -54,6 +149,43 @@ MTCGenAudioProcessorEditor::MTCGenAudioProcessorEditor(MTCGenAudioProcessor& p)
         };
     addAndMakeVisible(debugToggle);
 
+    traceToggle.setTooltip("Record a timeline of every thread to a Chrome trace file "
+        "(open it in ui.perfetto.dev)");
+    traceToggle.onClick = [this]() {
+        if (traceToggle.getToggleState())
+        {
+            auto file = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                .getChildFile("MTCGen-trace-"
+                    + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".json");
+            juce::String error;
+            if (!TraceRecorder::start(file, error))
+            {
+                traceToggle.setToggleState(false, juce::dontSendNotification);
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                    "Trace", error);
+            }
+        }
+        else if (TraceRecorder::isRecording())
+        {
+            TraceRecorder::stop();
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon, "Trace",
+                "Wrote " + juce::String(TraceRecorder::getNumEvents()) + " events ("
+                + juce::String(TraceRecorder::getNumDropped()) + " dropped) to\n"
+                + TraceRecorder::getFile().getFullPathName());
+        }
+        };
+    addAndMakeVisible(traceToggle);
+
+    cpuMeterLabel.setFont(juce::Font("Consolas", 12.0f, juce::Font::plain));
+    cpuMeterLabel.setColour(juce::Label::textColourId, juce::Colours::white);
+    addAndMakeVisible(cpuMeterLabel);
+
+    cpuMeterResetButton.onClick = [this]() {
+        processor.getBlockTimingMeter().reset();
+        processor.getPlayheadDll().reset();
+        };
+    addAndMakeVisible(cpuMeterResetButton);
+
     debugPanel.setMultiLine(true);
     debugPanel.setReadOnly(true);
     debugPanel.setFont(juce::Font("Consolas", 12.0f, juce::Font::plain));
@@ -62,7 +194,7 @@ MTCGenAudioProcessorEditor::MTCGenAudioProcessorEditor(MTCGenAudioProcessor& p)
     debugPanel.setVisible(false);
     addAndMakeVisible(debugPanel);
 
-    startTimer(100); // 10 Hz UI update
+    startTimer(100); // 10 Hz UI update (table, debug log)
 }
 
 /** Destructor */
@@ -79,44 +211,83 @@ void MTCGenAudioProcessorEditor::resized()
 {
     auto area = getLocalBounds().reduced(10);
 
+    // Set aside before the table takes its share: two playhead lines and the last
+    // numDebugEventsShown MIDI events
+    auto debugArea = area.removeFromBottom(120);
+
     auto topArea = area.removeFromTop(area.getHeight() * 0.45f);
     mappingTable.setBounds(topArea);
 
+    cueTimeline.setBounds(area.removeFromTop(90).reduced(0, 4));
+
     auto midiArea = area.removeFromTop(150);
     midiOutputSelector.setBounds(midiArea);
 
     auto ctrl = area.removeFromTop(40);
-    frameRateComboBox.setBounds(ctrl.removeFromLeft(150));
-    mtcFormatComboBox.setBounds(ctrl.removeFromLeft(150).reduced(5));
+    frameRateComboBox.setBounds(ctrl.removeFromLeft(120));
+    mtcFormatComboBox.setBounds(ctrl.removeFromLeft(140).reduced(5));
+    outputEnabledToggle.setBounds(ctrl.removeFromLeft(80).reduced(5));
+    offsetSlider.setBounds(ctrl.removeFromLeft(160).reduced(5));
+    clockEnabledToggle.setBounds(ctrl.removeFromLeft(80).reduced(5));
+
+    auto artNetRow = area.removeFromTop(30);
+    artNetToggle.setBounds(artNetRow.removeFromLeft(90));
+    artNetAddressEditor.setBounds(artNetRow.removeFromLeft(150).reduced(2));
+    artNetPortEditor.setBounds(artNetRow.removeFromLeft(70).reduced(2));
+    artNetRateComboBox.setBounds(artNetRow.removeFromLeft(150).reduced(2));
+    sharedMemoryToggle.setBounds(artNetRow.removeFromRight(110));
 
-    currentTimecodeLabel.setBounds(area.removeFromTop(80));
+    auto thruRow = area.removeFromTop(30);
+    thruTriggersToggle.setBounds(thruRow.removeFromLeft(120));
+    thruSysExToggle.setBounds(thruRow.removeFromLeft(130));
+    thruChannelComboBox.setBounds(thruRow.removeFromLeft(140).reduced(2));
+    controlToggle.setBounds(thruRow.removeFromLeft(70));
+    exportButton.setBounds(thruRow.removeFromRight(110).reduced(2));
 
-    auto dbgToggleArea = area.removeFromTop(24).removeFromLeft(100).reduced(4);
-    debugToggle.setBounds(dbgToggleArea);
+    timecodeDisplay.setBounds(area.removeFromTop(80));
+
+    auto dbgRow = area.removeFromTop(24);
+    debugToggle.setBounds(dbgRow.removeFromLeft(100).reduced(4));
+    traceToggle.setBounds(dbgRow.removeFromLeft(64).reduced(4));
+    cpuMeterResetButton.setBounds(dbgRow.removeFromRight(60).reduced(2));
+    cpuMeterLabel.setBounds(dbgRow);
 
     if (debugPanel.isVisible())
-        debugPanel.setBounds(area.reduced(4));
+        debugPanel.setBounds(debugArea.reduced(4));
 }
 
 /**
- * @brief Timer callback: updates timecode display, table, and debug log.
+ * @brief Timer callback: updates timecode display, table, port health and debug log.
  */
 void MTCGenAudioProcessorEditor::timerCallback()
 {
-    processor.updateTimecodeFromPlayHead();
-
-    auto tc = processor.getCurrentTimecode();
-    currentTimecodeLabel.setText(
-        tc.isEmpty() ? "Timecode: --:--:--:--"
-        : "Timecode: " + tc,
-        juce::dontSendNotification);
+    MTCGEN_TRACE_SCOPE("editorRefresh");
 
     mappingTable.refreshTable();
+    midiOutputSelector.updateHealth();
+    // Another instance's editor may have started or stopped the (process-wide) trace
+    traceToggle.setToggleState(TraceRecorder::isRecording(), juce::dontSendNotification);
+
+    auto cpu = processor.getBlockTimingMeter().getStats();
+    if (cpu.numBlocks > 0)
+        cpuMeterLabel.setText(juce::String::formatted(
+            "CPU  mean %.1f%%  p99 %.1f%%  max %.1f%%  overruns %d  slowest: %s",
+            cpu.meanLoad * 100.0, cpu.p99Load * 100.0, cpu.maxLoad * 100.0,
+            (int)cpu.numOverruns, BlockTimingMeter::getPhaseName(cpu.slowestPhase)),
+            juce::dontSendNotification);
 
     if (debugPanel.isVisible())
     {
         auto events = processor.getDebugEvents();
         juce::String log;
+
+        auto dll = processor.getPlayheadDll().getStats();
+        log += juce::String::formatted("Playhead  residual rms %.3f ms  max %.3f ms  rate %.6f  snaps %d\n",
+            dll.rmsResidualMs, dll.maxResidualMs, dll.rateRatio, (int)dll.numSnaps);
+        if (dll.hasHostTime)
+            log += juce::String::formatted("Callbacks jitter rms %.3f ms  max %.3f ms\n",
+                dll.rmsCallbackJitterMs, dll.maxCallbackJitterMs);
+
         for (auto& e : events)
             log += juce::String(e.time, 3) + " : " + e.desc + "\n";
         debugPanel.setText(log, juce::dontSendNotification);
@@ -124,19 +295,67 @@ void MTCGenAudioProcessorEditor::timerCallback()
 }
 
 /**
- * @brief Handles changes to frame-rate or MTC-format ComboBoxes.
+ * @brief Handles changes to the Art-Net rate ComboBox (rate and format use attachments).
  * @param cb Pointer to the ComboBox that changed.
  */
 void MTCGenAudioProcessorEditor::comboBoxChanged(juce::ComboBox* cb)
 {
-    if (cb == &frameRateComboBox)
-    {
-        int id = frameRateComboBox.getSelectedId();
-        processor.setFrameRate(id == 1 ? 24.0 : id == 2 ? 25.0 : id == 3 ? 29.97 : 30.0);
-    }
-    else if (cb == &mtcFormatComboBox)
+    if (cb == &artNetRateComboBox)
     {
-        processor.setMTCFormat(
-            mtcFormatComboBox.getSelectedId() == 1 ? FullSysEx : QuarterFrame);
+        processor.setArtNetRateType(artNetRateComboBox.getSelectedId() - 2);
     }
 }
+
+/**
+ * @brief Applies the address and port typed into the Art-Net editors.
+ */
+void MTCGenAudioProcessorEditor::applyArtNetTarget()
+{
+    int port = artNetPortEditor.getText().getIntValue();
+    if (port <= 0 || port > 65535)
+        port = ArtNetTimecodeSender::defaultPort;
+
+    processor.getArtNetSender().setTarget(artNetAddressEditor.getText().trim(), port);
+}
+
+/**
+ * @brief Snapshots the session on the message thread, then renders and writes the
+ * file on a background thread and reports the result when it is done.
+ */
+void MTCGenAudioProcessorEditor::exportMtcFile()
+{
+    exportChooser = std::make_unique<juce::FileChooser>("Export MTC to a MIDI file",
+        juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("MTC.mid"),
+        "*.mid");
+
+    const auto flags = juce::FileBrowserComponent::saveMode
+        | juce::FileBrowserComponent::canSelectFiles
+        | juce::FileBrowserComponent::warnAboutOverwriting;
+
+    exportChooser->launchAsync(flags, [this](const juce::FileChooser& chooser) {
+        const auto file = chooser.getResult();
+        if (file == juce::File())
+            return;
+
+        auto state = MtcFileExporter::snapshotState(processor);
+        MtcFileExporter::Options options;
+        options.sampleRate = processor.getSampleRate() > 0.0 ? processor.getSampleRate() : 48000.0;
+
+        exportButton.setEnabled(false);
+        juce::Component::SafePointer<MTCGenAudioProcessorEditor> safeThis(this);
+
+        juce::Thread::launch([state, options, file, safeThis]() {
+            juce::String error;
+            const bool ok = MtcFileExporter::exportToFile(state, options, file, error);
+
+            juce::MessageManager::callAsync([ok, error, file, safeThis]() {
+                if (safeThis != nullptr)
+                    safeThis->exportButton.setEnabled(true);
+
+                juce::AlertWindow::showMessageBoxAsync(
+                    ok ? juce::MessageBoxIconType::InfoIcon : juce::MessageBoxIconType::WarningIcon,
+                    "Export MTC", ok ? "Wrote " + file.getFullPathName() : error);
+                });
+            });
+        });
+}
@@ -18,7 +18,9 @@
 #include <JuceHeader.h>
 #include "MTCGenProcessor.h"
 #include "MappingTableComponent.h"
+#include "CueTimeline.h"
 #include "MidiOutputSelector.h"
+#include "TimecodeDisplay.h"
 
 /**
  * @brief The main GUI editor for the MTCGen plugin.
@@ -37,18 +39,61 @@ public:
     void comboBoxChanged(juce::ComboBox*) override;
 
 private:
+    /** Pushes the Art-Net address/port editors to the processor's sender. */
+    void applyArtNetTarget();
+
+    /** Asks for a file and renders the current session's MTC to it in the background. */
+    void exportMtcFile();
+
     MTCGenAudioProcessor& processor;
     MappingTableComponent   mappingTable;
+    CueTimeline             cueTimeline;
     MidiOutputSelector      midiOutputSelector;
 
-    juce::Label             currentTimecodeLabel;
+    TimecodeDisplay         timecodeDisplay;
     juce::ComboBox          frameRateComboBox;
     juce::ComboBox          mtcFormatComboBox;
+    juce::ToggleButton      outputEnabledToggle{ "Output" };
+    juce::Slider            offsetSlider;
+    juce::ToggleButton      clockEnabledToggle{ "Clock" };
+
+    // Art-Net timecode output
+    juce::ToggleButton      artNetToggle{ "Art-Net" };
+    juce::TextEditor        artNetAddressEditor;
+    juce::TextEditor        artNetPortEditor;
+    juce::ComboBox          artNetRateComboBox;
+    juce::ToggleButton      sharedMemoryToggle{ "Shared Mem" };
+
+    // MIDI thru filter
+    juce::ToggleButton      thruTriggersToggle{ "Thru Triggers" };
+    juce::ToggleButton      thruSysExToggle{ "Thru MTC/SysEx" };
+    juce::ComboBox          thruChannelComboBox;
+
+    // Local control socket
+    juce::ToggleButton      controlToggle{ "Control" };
+
+    // Offline export to a Standard MIDI File
+    juce::TextButton        exportButton{ "Export MTC..." };
+    std::unique_ptr<juce::FileChooser> exportChooser;
 
     // Inline debug panel
     juce::ToggleButton      debugToggle{ "Debug" };
+    juce::ToggleButton      traceToggle{ "Trace" };
+    juce::Label             cpuMeterLabel;
+    juce::TextButton        cpuMeterResetButton{ "Reset" };
     juce::TextEditor        debugPanel;
 
+    // Parameter attachments (declared after the controls they bind, so destroyed first)
+    using APVTS = juce::AudioProcessorValueTreeState;
+    std::unique_ptr<APVTS::ComboBoxAttachment> frameRateAttachment;
+    std::unique_ptr<APVTS::ComboBoxAttachment> mtcFormatAttachment;
+    std::unique_ptr<APVTS::ButtonAttachment>   outputEnabledAttachment;
+    std::unique_ptr<APVTS::SliderAttachment>   offsetAttachment;
+    std::unique_ptr<APVTS::ButtonAttachment>   clockEnabledAttachment;
+    std::unique_ptr<APVTS::ButtonAttachment>   thruTriggersAttachment;
+    std::unique_ptr<APVTS::ButtonAttachment>   thruSysExAttachment;
+    std::unique_ptr<APVTS::ComboBoxAttachment> thruChannelAttachment;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MTCGenAudioProcessorEditor)
 };
 
@@ -4,19 +4,63 @@
  */
 
 #include "MTCGenProcessor.h"
-#include "MTCGenEditor.h"
-#include <deque>
+#if ! MTCGEN_HEADLESS
+ #include "MTCGenEditor.h"
+#endif
+#include "RealtimeAudit.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <unordered_map>
 
  //==============================================================================
 MTCGenAudioProcessor::MTCGenAudioProcessor()
-    : AudioProcessor(BusesProperties())
+    : AudioProcessor(BusesProperties()),
+    parameters(*this, nullptr, "PARAMETERS", createParameterLayout())
 {
-    mappings.emplace_back("00:10:00:00", 60, "Default Mapping");
+    frameRateParam = parameters.getRawParameterValue(frameRateParamID);
+    mtcFormatParam = parameters.getRawParameterValue(mtcFormatParamID);
+    offsetParam = parameters.getRawParameterValue(offsetParamID);
+    outputEnabledParam = parameters.getRawParameterValue(outputEnabledParamID);
+    clockEnabledParam = parameters.getRawParameterValue(clockEnabledParamID);
+    thruTriggersParam = parameters.getRawParameterValue(thruTriggersParamID);
+    thruSysExParam = parameters.getRawParameterValue(thruSysExParamID);
+    thruChannelParam = parameters.getRawParameterValue(thruChannelParamID);
+
+    banks.getActive().add(MappingEntry("00:10:00:00", 60, "Default Mapping"));
 }
 
-MTCGenAudioProcessor::~MTCGenAudioProcessor()
+MTCGenAudioProcessor::~MTCGenAudioProcessor() {}
+
+juce::AudioProcessorValueTreeState::ParameterLayout MTCGenAudioProcessor::createParameterLayout()
 {
-    stopTimer();
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID{ frameRateParamID, 1 }, "Frame Rate",
+        juce::StringArray{ "24", "25", "29.97", "30" }, 3));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID{ mtcFormatParamID, 1 }, "MTC Format",
+        juce::StringArray{ "Full SysEx", "Quarter Frame" }, (int)FullSysEx));
+    // +/- one hour at 30 fps
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID{ offsetParamID, 1 }, "Offset (frames)", -108000, 108000, 0));
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID{ outputEnabledParamID, 1 }, "Output Enabled", true));
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID{ clockEnabledParamID, 1 }, "MIDI Clock", false));
+
+    // MIDI thru; the defaults pass the input through unchanged
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID{ thruTriggersParamID, 1 }, "Thru Triggers", true));
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID{ thruSysExParamID, 1 }, "Thru MTC/SysEx", true));
+    juce::StringArray channels{ "Keep" };
+    for (int ch = 1; ch <= 16; ++ch)
+        channels.add(juce::String(ch));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID{ thruChannelParamID, 1 }, "Thru Channel", channels, 0));
+
+    return layout;
 }
 
 //==============================================================================
@@ -26,19 +70,64 @@ bool MTCGenAudioProcessor::acceptsMidi() const { return true; }
 bool MTCGenAudioProcessor::producesMidi() const { return true; }
 bool MTCGenAudioProcessor::isMidiEffect() const { return true; }
 double MTCGenAudioProcessor::getTailLengthSeconds() const { return 0.0; }
-int MTCGenAudioProcessor::getNumPrograms() { return 1; }
-int MTCGenAudioProcessor::getCurrentProgram() { return 0; }
-void MTCGenAudioProcessor::setCurrentProgram(int) {}
-const juce::String MTCGenAudioProcessor::getProgramName(int) { return {}; }
-void MTCGenAudioProcessor::changeProgramName(int, const juce::String&) {}
+
+// Host programs are the cue banks
+int MTCGenAudioProcessor::getNumPrograms() { return banks.getNumBanks(); }
+int MTCGenAudioProcessor::getCurrentProgram() { return banks.getActiveIndex(); }
+void MTCGenAudioProcessor::setCurrentProgram(int index) { selectBank(index); }
+const juce::String MTCGenAudioProcessor::getProgramName(int index) { return banks.getBankName(index); }
+void MTCGenAudioProcessor::changeProgramName(int index, const juce::String& name) { banks.setBankName(index, name); }
 
 void MTCGenAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
     auto xml = std::make_unique<juce::XmlElement>("MTCGenState");
-    for (auto& m : mappings)
-        xml->addChildElement(m.createXml());
-    xml->setAttribute("frameRate", frameRate);
-    xml->setAttribute("mtcFormat", (int)mtcFormat);
+    if (cueLibraryFile != juce::File())
+        xml->setAttribute("cueLibrary", cueLibraryFile.getFullPathName());
+
+    for (int b = 0; b < banks.getNumBanks(); ++b)
+    {
+        auto& cues = banks.getBank(b);
+        auto* bankXml = xml->createNewChildElement("CueBank");
+        bankXml->setAttribute("name", banks.getBankName(b));
+
+        const auto* unresolved = b < (int)unresolvedLibraryBanks.size()
+            ? unresolvedLibraryBanks[(size_t)b].get() : nullptr;
+
+        if (cues.isLinkedToLibrary())
+        {
+            // The cues are in the library; only this session's learned times are saved
+            bankXml->setAttribute("libraryBank", cues.getLibraryBank());
+            for (int i = 0; i < cues.size(); ++i)
+            {
+                if (!cues.differsFromLibrary(i))
+                    continue;
+                auto* learned = bankXml->createNewChildElement("Learned");
+                learned->setAttribute("cueId", (int)cues.getCueId(i));
+                learned->setAttribute("detectedStartTime", cues.getDetectedStartTime(i));
+                learned->setAttribute("detectedEndTime", cues.getDetectedEndTime(i));
+            }
+        }
+        else if (unresolved != nullptr && cues.isEmpty())
+        {
+            bankXml->setAttribute("libraryBank", unresolved->getIntAttribute("libraryBank"));
+            for (auto* learned : unresolved->getChildWithTagNameIterator("Learned"))
+                bankXml->addChildElement(new juce::XmlElement(*learned));
+        }
+        else
+        {
+            for (int i = 0; i < cues.size(); ++i)
+                bankXml->addChildElement(cues.getEntry(i).createXml());
+        }
+    }
+    xml->setAttribute("activeBank", banks.getActiveIndex());
+    if (auto params = parameters.copyState().createXml())
+        xml->addChildElement(params.release());
+    xml->setAttribute("artNetEnabled", isArtNetEnabled());
+    xml->setAttribute("artNetAddress", artNetSender.getTargetAddress());
+    xml->setAttribute("artNetPort", artNetSender.getTargetPort());
+    xml->setAttribute("artNetRateType", getArtNetRateType());
+    xml->setAttribute("sharedMemoryEnabled", sharedTimecode.isEnabled());
+    xml->setAttribute("controlEnabled", controlServer.isEnabled());
     copyXmlToBinary(*xml, destData);
 }
 
@@ -46,15 +135,96 @@ void MTCGenAudioProcessor::setStateInformation(const void* data, int sizeInBytes
 {
     if (auto xmlState = getXmlFromBinary(data, sizeInBytes))
     {
-        mappings.clear();
-        forEachXmlChildElement(*xmlState, e)
+        if (auto* params = xmlState->getChildByName(parameters.state.getType().toString()))
         {
-            MappingEntry m;
-            m.loadFromXml(*e);
-            mappings.push_back(m);
+            parameters.replaceState(juce::ValueTree::fromXml(*params));
         }
-        frameRate = xmlState->getDoubleAttribute("frameRate", frameRate);
-        setMTCFormat((MTCFormat)xmlState->getIntAttribute("mtcFormat", (int)mtcFormat));
+        else
+        {
+            // Sessions saved before rate and format became parameters
+            setFrameRate(xmlState->getDoubleAttribute("frameRate", getFrameRate()));
+            setMTCFormat((MTCFormat)xmlState->getIntAttribute("mtcFormat", (int)getMTCFormat()));
+        }
+
+        // Each bank is built off to the side and published complete, before the next;
+        // sessions saved before banks existed keep their mappings directly under the
+        // root, as one bank
+        banks.clear();
+        auto loadBank = [this](int index, const juce::XmlElement& parent)
+            {
+                auto cues = std::make_unique<CueStore>();
+                for (auto* e : parent.getChildWithTagNameIterator("MappingEntry"))
+                {
+                    MappingEntry m;
+                    m.loadFromXml(*e);
+                    cues->add(m);
+                }
+                banks.replaceBank(index, std::move(cues));
+            };
+
+        // Banks saved from a cue library link to it again and get their learned times
+        // back; the cues themselves are read from the mapping, not parsed
+        cueLibrary.reset();
+        cueLibraryError.clear();
+        unresolvedLibraryBanks.clear();
+        cueLibraryFile = juce::File();
+        if (xmlState->hasAttribute("cueLibrary"))
+        {
+            cueLibraryFile = juce::File(xmlState->getStringAttribute("cueLibrary"));
+            cueLibrary = CueLibrary::open(cueLibraryFile, cueLibraryError);
+        }
+
+        auto loadLibraryBank = [this](int index, const juce::XmlElement& bankXml)
+            {
+                const int libraryBank = bankXml.getIntAttribute("libraryBank");
+                if (cueLibrary == nullptr
+                    || !juce::isPositiveAndBelow(libraryBank, cueLibrary->getNumBanks()))
+                {
+                    unresolvedLibraryBanks.resize(juce::jmax(unresolvedLibraryBanks.size(), (size_t)index + 1));
+                    unresolvedLibraryBanks[(size_t)index] = std::make_unique<juce::XmlElement>(bankXml);
+                    return;
+                }
+
+                auto cues = std::make_unique<CueStore>();
+                cues->attachLibrary(cueLibrary, libraryBank);
+                for (auto* e : bankXml.getChildWithTagNameIterator("Learned"))
+                {
+                    const int i = cues->indexOfCue((CueStore::CueId)e->getIntAttribute("cueId"));
+                    if (i < 0)
+                        continue;
+                    cues->setDetectedStartTime(i, e->getDoubleAttribute("detectedStartTime", -1.0));
+                    cues->setDetectedEndTime(i, e->getDoubleAttribute("detectedEndTime", -1.0));
+                }
+                banks.replaceBank(index, std::move(cues));
+            };
+
+        int numLoaded = 0;
+        for (auto* bankXml : xmlState->getChildWithTagNameIterator("CueBank"))
+        {
+            int index = numLoaded == 0 ? 0 : banks.addBank({});
+            if (index < 0)
+                break;
+
+            banks.setBankName(index, bankXml->getStringAttribute("name", "Bank " + juce::String(index + 1)));
+            if (bankXml->hasAttribute("libraryBank"))
+                loadLibraryBank(index, *bankXml);
+            else
+                loadBank(index, *bankXml);
+            ++numLoaded;
+        }
+        if (numLoaded == 0)
+            loadBank(0, *xmlState);
+
+        banks.select(xmlState->getIntAttribute("activeBank", 0));
+
+        artNetSender.setTarget(
+            xmlState->getStringAttribute("artNetAddress", artNetSender.getTargetAddress()),
+            xmlState->getIntAttribute("artNetPort", artNetSender.getTargetPort()));
+        setArtNetRateType(xmlState->getIntAttribute("artNetRateType", getArtNetRateType()));
+        setArtNetEnabled(xmlState->getBoolAttribute("artNetEnabled", false));
+        sharedTimecode.setEnabled(xmlState->getBoolAttribute("sharedMemoryEnabled", false));
+        controlServer.setEnabled(xmlState->getBoolAttribute("controlEnabled", false));
+        updateLatency();
     }
 }
 
@@ -64,95 +234,389 @@ void MTCGenAudioProcessor::prepareToPlay(double sampleRate, int)
 {
     currentSampleRate = sampleRate;
     internalTime = 0.0;
-    if (mtcFormat == QuarterFrame)
-    {
-        auto intervalMs = int(1000.0 / (frameRate * 8.0));
-        startTimer(intervalMs);
-    }
-}
+    lastPlayheadTime = 0.0;
+    blockRateIndex = -1;
 
-void MTCGenAudioProcessor::releaseResources()
-{
-    stopTimer();
+    // Room for a block's clock ticks plus transport messages, so the audio thread
+    // never grows it
+    clockEvents.ensureSize(2048);
+    mtcEvents.ensureSize(4096);
+    thruFilter.prepare();
+    clockGenerator.reset();
+    numClockEdges = 0;
+    clockHostPlaying = clockOutputPlaying = false;
+    clockSamples = 0;
+    playheadDll.prepare(sampleRate);
+
+    streamCue = 0;
+    streamBank = 0;
+
+    // Hosts may call these from their own threads, where the message thread could be
+    // editing the bank list; retired banks are then left to the next edit to collect
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        banks.purgeRetired();
+    updateLatency();
 }
 
-//==============================================================================
-/**
- * @brief Queries the host playhead; on failure, returns last internalTime.
- * @return Time in seconds.
- */
-double MTCGenAudioProcessor::getPlayheadTime() const
+void MTCGenAudioProcessor::releaseResources()
 {
-    juce::AudioPlayHead::CurrentPositionInfo pos;
-    if (auto* ph = getPlayHead(); ph && ph->getCurrentPosition(pos))
-        return pos.timeInSeconds;
-    return internalTime;
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        banks.purgeRetired();
 }
 
 //==============================================================================
 /**
- * @brief Audio/MIDI callback: logs NoteOn/Off, arms/disarms mappings, and emits MTC.
+ * @brief Audio/MIDI callback: logs NoteOn/Off, arms/disarms mappings, and emits MTC
+ * and (optionally) MIDI Clock.
  */
 void MTCGenAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
     juce::MidiBuffer& midiMessages)
 {
+    MTCGEN_RT_SCOPE("processBlock");
+    MTCGEN_TRACE_THREAD("Audio");
+    MTCGEN_TRACE_SCOPE("processBlock");
     juce::ScopedNoDenormals noDenormals;
+    banks.beginBlock();
+    blockMeter.beginBlock();
+
+    // The whole block runs against one bank, loaded once; only a program change below
+    // moves it, never a switch made on the message thread meanwhile
+    int bankIndex = 0;
+    CueStore* cues = &banks.getActive(bankIndex);
+
+    // Port senders pace each message from here; an offline render sends as it goes
+    blockStartMs = isNonRealtime() ? 0.0 : juce::Time::getMillisecondCounterHiRes();
     buffer.clear();
+    updateBlockParameters();
+
+    // 1) Update internalTime from host playhead, smoothed while playing
+    juce::Optional<juce::AudioPlayHead::PositionInfo> pos;
+    if (auto* ph = getPlayHead())
+        pos = ph->getPosition();
+    const bool playing = pos.hasValue() && pos->getIsPlaying();
+    hostPlaying.store(playing, std::memory_order_relaxed);
 
-    // 1) Update internalTime from host playhead
-    juce::AudioPlayHead::CurrentPositionInfo pos;
-    if (auto* ph = getPlayHead(); ph && ph->getCurrentPosition(pos))
-        internalTime = pos.timeInSeconds;
+    if (pos.hasValue() && pos->getTimeInSeconds().hasValue())
+        internalTime = playheadDll.process(*pos->getTimeInSeconds(), pos->getTimeInSamples(),
+            pos->getHostTimeNs(), playing, buffer.getNumSamples());
     else
         internalTime += buffer.getNumSamples() / currentSampleRate;
+    blockTime.store(internalTime, std::memory_order_relaxed);
+    endCuesOnJump(*cues);
 
-    // 2) Handle incoming MIDI
-    for (auto meta : midiMessages)
+    // 2) Handle incoming MIDI, filtering what passes thru in the same pass
+    const bool filterThru = thruFilter.isActive();
+    if (filterThru)
+        thruFilter.begin();
+
+    for (const auto meta : midiMessages)
     {
+        // System messages never trigger; getMessage() would copy a SysEx to the heap
+        if (meta.data[0] >= 0xf0)
+        {
+            if (filterThru)
+                thruFilter.add(meta, false);
+            continue;
+        }
+
         auto msg = meta.getMessage();
         double tstamp = internalTime + meta.samplePosition / currentSampleRate;
+        bool trigger = false;
 
         if (msg.isNoteOn())
         {
             int note = msg.getNoteNumber();
-            startMappingForNote(note, tstamp);
-            addDebugEvent("NoteOn  " + juce::MidiMessage::getMidiNoteName(note, true, true, 4),
-                tstamp);
+            trigger = startMappingForNote(*cues, note, tstamp);
+            if (trigger)
+                MTCGEN_TRACE_INSTANT("cueTrigger");
+            addDebugEvent(note, tstamp);
         }
         else if (msg.isNoteOff())
         {
             int note = msg.getNoteNumber();
-            stopMappingForNote(note);
-            addDebugEvent("NoteOff " + juce::MidiMessage::getMidiNoteName(note, true, true, 4),
-                tstamp);
+            trigger = stopMappingForNote(*cues, note);
+            addDebugEvent(-1 - note, tstamp);
+        }
+        else if (msg.isProgramChange())
+        {
+            // Switches from this event on: later notes in the same block use the new bank
+            trigger = banks.select(msg.getProgramChangeNumber());
+            if (trigger)
+            {
+                cues = &banks.getActive(bankIndex);
+                MTCGEN_TRACE_INSTANT("bankSwitch");
+            }
+        }
+
+        if (filterThru)
+            thruFilter.add(meta, trigger);
+    }
+
+    if (filterThru)
+        thruFilter.end(midiMessages);
+    blockMeter.endPhase(BlockTimingMeter::MidiParse);
+
+    // 3) Pick the cue to drive. Output runs lookaheadSeconds (the reported latency)
+    //    behind the input, so a note-on can lead in with its pre-roll before its cue point.
+    const int numSamples = buffer.getNumSamples();
+    const double outputTime = internalTime - lookaheadSeconds;
+    double emitFrom = outputTime;
+    int active = selectCue(*cues, outputTime, outputTime + numSamples / currentSampleRate,
+        frameRate, emitFrom);
+    activeMappingIndex.store(active, std::memory_order_relaxed);
+    blockMeter.endPhase(BlockTimingMeter::CueLookup);
+
+    // 4) Encode: the frame, the block's Full Frame / quarter-frame MTC at their sample
+    //    positions and the matching sink events
+    const bool toSinks = timecodeSinks.hasSinks();
+    mtcEvents.clear();
+    Timecode tc;
+    if (active >= 0)
+    {
+        tc = Timecode::fromSeconds(
+            getCueOutputSeconds(*cues, active, emitFrom, frameRate, offsetFrames), frameRate);
+
+        streamRestarted = false;
+        if (outputEnabled)
+            writeMtc(mtcEvents, *cues, active, outputTime, emitFrom, numSamples);
+        else
+            streamCue = 0;
+
+        if (toSinks)
+            addSinkEvents(*cues, outputEnabled ? active : -1, tc, outputTime, emitFrom, numSamples);
+    }
+    else
+    {
+        streamCue = 0;
+        if (toSinks)
+            addSinkEvents(*cues, -1, {}, outputTime, outputTime, numSamples);
+    }
+    blockMeter.endPhase(BlockTimingMeter::Encode);
+
+    // 5) Send: publish the frame for the display and the port senders (lock-free), the
+    //    MTC into the host's buffer, and the batch to Art-Net and the other sinks
+    currentFrame.store(active >= 0 ? tc.pack() : 0, std::memory_order_release);
+    if (active >= 0 && outputEnabled && midiOutputRouter.hasOutputs())
+        midiOutputRouter.pushFrame(tc, Timecode::mtcRateCode(frameRate));
+    midiMessages.addEvents(mtcEvents, 0, -1, 0);
+
+    if (toSinks)
+        timecodeSinks.dispatch();
+
+    // Local consumers read the frame, cue and transport from shared memory
+    if (sharedTimecode.isEnabled())
+    {
+        sharedTimecode.publish(currentFrame.load(std::memory_order_relaxed), frameRate,
+            active >= 0 ? cues->getCueId(active) : 0u,
+            active >= 0 ? cues->getMidiNote(active) : -1,
+            bankIndex, playing, internalTime);
+    }
+    blockMeter.endPhase(BlockTimingMeter::Send);
+
+    // 6) MIDI Clock / SPP from the host's musical position, delayed like the MTC, through
+    //    the same outputs
+    clockEvents.clear();
+    if (clockEnabled && outputEnabled)
+    {
+        writeClock(clockEvents, playing,
+            pos.hasValue() ? pos->getPpqPosition().orFallback(0.0) : 0.0,
+            pos.hasValue() ? pos->getBpm().orFallback(120.0) : 120.0,
+            numSamples);
+    }
+    else
+    {
+        clockGenerator.stop(clockEvents);
+        numClockEdges = 0;
+        clockHostPlaying = clockOutputPlaying = playing;
+    }
+    clockSamples += numSamples;
+
+    if (!clockEvents.isEmpty())
+    {
+        midiMessages.addEvents(clockEvents, 0, -1, 0);
+        for (const auto meta : clockEvents)
+            sendToOutputs(meta.data, meta.numBytes, meta.samplePosition);
+    }
+    blockMeter.endPhase(BlockTimingMeter::Clock);
+
+    blockMeter.endBlock(numSamples, currentSampleRate);
+    banks.endBlock();
+}
+
+/**
+ * @brief Writes one block of MTC for a cue. Full SysEx sends a Full Frame per block;
+ * Quarter Frame sends a Full Frame when the stream (re)starts, then each quarter-frame
+ * (four per frame) at its own sample position, continuing across blocks. The encoding
+ * itself is the kernel picked for the current rate and format (see MtcKernels).
+ */
+void MTCGenAudioProcessor::writeMtc(juce::MidiBuffer& out, const CueStore& cues, int cue,
+    double outputTime, double emitFrom, int numSamples)
+{
+    MTCGEN_TRACE_SCOPE("writeMtc");
+    const double sr = currentSampleRate;
+    // MTC time at output time x is x + mtcOffset (below the base time during pre-roll)
+    const double mtcOffset = cues.getBaseSeconds(cue, frameRate) + offsetFrames / frameRate
+        - cues.getDetectedStartTime(cue);
+
+    // A new cue or bank, a rate change or a jump of more than a frame restarts the stream
+    const auto id = cues.getCueId(cue);
+    const bool restart = id != streamCue || cues.getStoreId() != streamBank
+        || frameRate != streamRate
+        || std::abs(outputTime + mtcOffset - streamNextMtc) > 1.0 / frameRate;
+    if (restart)
+        MTCGEN_TRACE_INSTANT("streamRestart");
+    streamRestarted = restart;
+
+    MtcKernels::Block block;
+    block.outputTime = outputTime;
+    block.mtcOffset = mtcOffset;
+    block.startMtc = juce::jmax(0.0, emitFrom + mtcOffset);
+    block.sampleRate = sr;
+    block.startSample = juce::jlimit(0, numSamples - 1, (int)((emitFrom - outputTime) * sr));
+    block.numSamples = numSamples;
+    block.restart = restart;
+    mtcKernel(out, block, nextQuarterFrame);
+
+    // out holds only this block's MTC (the caller clears it)
+    for (const auto meta : out)
+        sendToOutputs(meta.data, meta.numBytes, meta.samplePosition);
+
+    streamCue = id;
+    streamBank = cues.getStoreId();
+    streamRate = frameRate;
+    streamNextMtc = outputTime + numSamples / sr + mtcOffset;
+}
+
+/**
+ * @brief The MTC runs lookaheadSeconds behind the host, so the clock does too: while
+ * the output plays, its position is the host's less the lookahead at the current tempo,
+ * and a host start or stop reaches the output that many samples later, at its sample
+ * in the block. Until a stop arrives the clock plays on into the position the host
+ * stopped at; until a start arrives it holds the position the host started from. With
+ * no lookahead this is the host's position and transport, unchanged.
+ */
+void MTCGenAudioProcessor::writeClock(juce::MidiBuffer& out, bool playing, double ppq, double bpm,
+    int numSamples) noexcept
+{
+    if (bpm <= 0.0)
+        return;
+
+    const int lookahead = juce::roundToInt(lookaheadSeconds * currentSampleRate);
+    const double samplesPerQuarter = currentSampleRate * 60.0 / bpm;
+
+    if (playing != clockHostPlaying)
+    {
+        // A full queue lets the oldest edge through at once rather than losing the newest
+        if (numClockEdges == (int)clockEdges.size())
+        {
+            clockOutputPlaying = clockEdges[0].playing;
+            std::move(clockEdges.begin() + 1, clockEdges.end(), clockEdges.begin());
+            --numClockEdges;
         }
+        clockEdges[(size_t)numClockEdges++] = { clockSamples + lookahead, ppq, playing };
+        clockHostPlaying = playing;
     }
 
-    // 3) Generate Full SysEx MTC if active
-    if (mtcFormat == FullSysEx)
+    // One part per stretch between edges reached in this block
+    for (int s = 0; s < numSamples;)
     {
-        if (auto* m = findActiveMapping(internalTime))
+        int end = numSamples;
+        if (numClockEdges > 0)
         {
-            double elapsed = internalTime - m->getDetectedStartTime();
-            double baseSecs = m->getTimeInSeconds(frameRate);
-            double outTime = baseSecs + elapsed;
-
-            int totalSecs = int(outTime);
-            int hh = totalSecs / 3600;
-            int mm = (totalSecs % 3600) / 60;
-            int ss = totalSecs % 60;
-            int ff = int((outTime - totalSecs) * frameRate);
-
-            uint8_t sx[10] = {
-                0xF0,0x7F,0x7F,0x01,0x01,
-                (uint8_t)hh,(uint8_t)mm,
-                (uint8_t)ss,(uint8_t)ff,0xF7
-            };
-            auto sysExMsg = juce::MidiMessage::createSysExMessage(sx, 10);
-            midiMessages.addEvent(sysExMsg, 0);
-            for (auto* out : midiOutputs)
-                if (out) out->sendMessageNow(sysExMsg);
+            const auto& next = clockEdges[0];
+            end = (int)juce::jlimit((juce::int64)s, (juce::int64)numSamples, next.due - clockSamples);
+            if (end == s)
+            {
+                clockOutputPlaying = next.playing;
+                std::move(clockEdges.begin() + 1, clockEdges.begin() + numClockEdges, clockEdges.begin());
+                --numClockEdges;
+                continue;
+            }
         }
+
+        // Edges alternate, so a pending edge is the opposite of the output's transport
+        double position = ppq;
+        if (clockOutputPlaying && numClockEdges > 0)
+            position = clockEdges[0].ppq - (double)(clockEdges[0].due - clockSamples - s) / samplesPerQuarter;
+        else if (clockOutputPlaying)
+            position = ppq + (double)(s - lookahead) / samplesPerQuarter;
+        else if (numClockEdges > 0)
+            position = clockEdges[0].ppq;
+
+        clockGenerator.process(out, clockOutputPlaying, position, bpm, end - s, currentSampleRate, s);
+        s = end;
+    }
+}
+
+/**
+ * @brief Events go out in time order: the previous cue's stop at the block start, then
+ * at the first output sample the new cue's start, a locate if the stream restarted and
+ * the frame if it changed, then the block's quarter-frames.
+ */
+void MTCGenAudioProcessor::addSinkEvents(const CueStore& cues, int cue, const Timecode& tc,
+    double outputTime, double emitFrom, int numSamples)
+{
+    const auto id = cue >= 0 ? cues.getCueId(cue) : 0u;
+    const auto bank = cue >= 0 ? cues.getStoreId() : 0u;
+    const bool cueChanged = id != sinkCue || bank != sinkBank;
+
+    TimecodeSink::Event e;
+    e.rateCode = (juce::uint8)Timecode::mtcRateCode(frameRate);
+    e.hostTime = outputTime;
+
+    if (sinkCue != 0 && cueChanged)
+    {
+        e.type = TimecodeSink::Event::CueStop;
+        e.cueId = sinkCue;
+        e.note = (juce::int8)sinkNote;
+        timecodeSinks.add(e);
+    }
+
+    if (cue < 0)
+    {
+        sinkCue = 0;
+        sinkBank = 0;
+        sinkFrame = 0;
+        return;
+    }
+
+    e.samplePosition = juce::jlimit(0, numSamples - 1, (int)((emitFrom - outputTime) * currentSampleRate));
+    e.hostTime = emitFrom;
+    e.cueId = id;
+    e.note = (juce::int8)cues.getMidiNote(cue);
+    e.frame = tc.pack();
+
+    if (cueChanged)
+    {
+        e.type = TimecodeSink::Event::CueStart;
+        timecodeSinks.add(e);
+    }
+    if (streamRestarted)
+    {
+        e.type = TimecodeSink::Event::Locate;
+        timecodeSinks.add(e);
+    }
+    if (e.frame != sinkFrame)
+    {
+        e.type = TimecodeSink::Event::Frame;
+        timecodeSinks.add(e);
+    }
+
+    sinkCue = id;
+    sinkBank = bank;
+    sinkNote = e.note;
+    sinkFrame = e.frame;
+
+    e.type = TimecodeSink::Event::QuarterFrame;
+    e.frame = 0;
+    for (const auto meta : mtcEvents)
+    {
+        if (meta.data[0] != 0xf1)
+            continue;
+        e.data = meta.data[1];
+        e.samplePosition = meta.samplePosition;
+        e.hostTime = outputTime + meta.samplePosition / currentSampleRate;
+        timecodeSinks.add(e);
     }
 }
 
@@ -160,188 +624,528 @@ void MTCGenAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
 /**
  * @brief Locates which mapping to drive based on live Note-On or stored window.
  * @param hostTime Current host time in seconds.
- * @return Pointer to MappingEntry or nullptr.
+ * @return Index into cues or -1.
  */
-MappingEntry* MTCGenAudioProcessor::findActiveMapping(double hostTime)
+int MTCGenAudioProcessor::findActiveMapping(const CueStore& cues, double hostTime) const
 {
     // 1) If a Note-On is live, keep driving that mapping (even if hostTime ≤ start).
-    for (auto& m : mappings)
-        if (m.getIsActive())
-            return &m;
+    int live = cues.findActive();
+    if (live >= 0)
+        return live;
 
     // 2) Otherwise only auto-start if we've jumped _into_ the stored [start,end] window.
     //    Note the strict > and <, so hostTime must be strictly inside.
-    for (int i = 0; i < (int)mappings.size(); ++i)
-    {
-        auto& m = mappings[i];
-        double start = m.getDetectedStartTime();
-        double end = m.getDetectedEndTime(); // –1 if still held
+    return cues.findWindow(hostTime);
+}
 
-        if (start < 0.0)                continue;  // never set
-        if (hostTime <= start)         continue;  // started at or before the note-on
-        if (end >= 0.0 && hostTime >= end) continue;  // past the note-off
+/**
+ * @brief Extends findActiveMapping() with pre-roll: a learned cue whose lead-in starts
+ * inside [from, to) is picked up early, and a live cue is held back until its own
+ * lead-in (cue point minus its pre-roll) is reached.
+ */
+int MTCGenAudioProcessor::selectCue(const CueStore& cues, double from, double to, double rate,
+    double& emitFrom) const
+{
+    MTCGEN_TRACE_SCOPE("cueLookup");
+    int cue = findActiveMapping(cues, from);
+    if (cue < 0)
+        cue = cues.findPreRoll(from, to, rate);
+    if (cue < 0)
+        return -1;
 
-        activeMappingIndex = i;
-        return &m;
-    }
+    double leadIn = cues.getDetectedStartTime(cue) - cues.getPreRollFrames(cue) / rate;
+    emitFrom = juce::jmax(from, leadIn);
+    if (emitFrom >= to)
+        return -1;
 
-    return nullptr;
+    return cue;
 }
 
 
-//==============================================================================
 /**
- * Called on the UI‐thread timer to update/clear mappings when playback stops or scrubs,
- * and to compute the currentTimecode for any active mapping.
+ * @brief Only the jump is detected here; processBlock() re-selects the cue itself.
  */
-void MTCGenAudioProcessor::updateTimecodeFromPlayHead()
+void MTCGenAudioProcessor::endCuesOnJump(CueStore& cues) noexcept
 {
-    double hostTime = getPlayheadTime();
-
-    // 1) Detect a backward jump (stop or scrub) and record implicit End-times:
-    if (hostTime < lastPlayheadTime)
+    if (internalTime < lastPlayheadTime)
     {
-        for (auto& m : mappings)
+        for (int i = cues.findActive(); i >= 0; i = cues.findActive())
         {
-            if (m.getIsActive() && m.getDetectedEndTime() < 0.0)
-            {
-                // Stop at the last position
-                m.setDetectedEndTime(lastPlayheadTime);
-                m.setIsActive(false);
-            }
+            // Stop at the last position
+            if (cues.getDetectedEndTime(i) < 0.0)
+                cues.setDetectedEndTime(i, lastPlayheadTime);
+            cues.setIsActive(i, false);
         }
-        activeMappingIndex = -1;
-        currentTimecode.clear();
     }
+    lastPlayheadTime = internalTime;
+}
 
-    lastPlayheadTime = hostTime;
-    internalTime = hostTime;
+//==============================================================================
+void MTCGenAudioProcessor::setMTCFormat(MTCFormat fmt)
+{
+    setParameterPlainValue(mtcFormatParamID, (float)fmt);
+}
+
+bool MTCGenAudioProcessor::startMappingForNote(int midiNote, double startTime)
+{
+    return startMappingForNote(banks.getActive(), midiNote, startTime);
+}
 
-    // 2) Find which mapping to drive (either live Note-On, or a window you jumped into):
-    juce::ScopedLock sl(timecodeLock);
-    MappingEntry* m = findActiveMapping(hostTime);
+bool MTCGenAudioProcessor::stopMappingForNote(int midiNote)
+{
+    return stopMappingForNote(banks.getActive(), midiNote);
+}
 
-    if (m != nullptr)
+bool MTCGenAudioProcessor::startMappingForNote(CueStore& cues, int midiNote, double startTime)
+{
+    int i = cues.findNote(midiNote);
+    if (i >= 0)
     {
-        // compute base + elapsed
-        double elapsed = hostTime - m->getDetectedStartTime();
-        double baseSeconds = m->getTimeInSeconds(frameRate);
-        double outTime = baseSeconds + elapsed;
-
-        int totalSecs = int(outTime);
-        int hh = totalSecs / 3600;
-        int mm = (totalSecs % 3600) / 60;
-        int ss = totalSecs % 60;
-        int ff = int((outTime - totalSecs) * frameRate);
-
-        currentTimecode = juce::String::formatted("%02d:%02d:%02d:%02d", hh, mm, ss, ff);
+        cues.setDetectedStartTime(i, startTime);
+        cues.setDetectedEndTime(i, -1.0);
+        cues.setIsActive(i, true);
     }
-    else
+    return i >= 0;
+}
+
+bool MTCGenAudioProcessor::stopMappingForNote(CueStore& cues, int midiNote)
+{
+    int i = cues.findNote(midiNote);
+    if (i >= 0)
     {
-        currentTimecode.clear();
+        cues.setDetectedEndTime(i, internalTime);
+        cues.setIsActive(i, false);
     }
+    return i >= 0;
 }
 
+juce::StringArray MTCGenAudioProcessor::getAvailableMidiOutputNames() const
+{
+    juce::StringArray list;
+    for (auto& d : juce::MidiOutput::getAvailableDevices())
+        list.add(d.name);
+    return list;
+}
 
-
-//==============================================================================
-void MTCGenAudioProcessor::setMTCFormat(MTCFormat fmt)
+void MTCGenAudioProcessor::selectBank(int index)
 {
-    mtcFormat = fmt;
-    quarterFrameIndex = 0;
-    if (fmt == QuarterFrame)
-        startTimer(int(1000.0 / (frameRate * 8.0)));
-    else
-        stopTimer();
+    if (banks.select(index))
+        updateHostDisplay();
 }
 
-void MTCGenAudioProcessor::hiResTimerCallback() { sendQuarterFrame(); }
+int MTCGenAudioProcessor::addBank(const juce::String& name)
+{
+    int index = banks.addBank(name);
+    if (index >= 0)
+        updateHostDisplay();
+    return index;
+}
 
-/** @brief Unchanged quarter-frame handling. */
-void MTCGenAudioProcessor::sendQuarterFrame() { /* ... */ }
+void MTCGenAudioProcessor::removeBank(int index)
+{
+    if (banks.getNumBanks() > 1 && juce::isPositiveAndBelow(index, (int)unresolvedLibraryBanks.size()))
+        unresolvedLibraryBanks.erase(unresolvedLibraryBanks.begin() + index);
+    banks.removeBank(index);
+    updateLatency();
+    updateHostDisplay();
+}
 
-void MTCGenAudioProcessor::startMappingForNote(int midiNote, double startTime)
+namespace
 {
-    for (auto& m : mappings)
-        if (m.getMidiNote() == midiNote)
+    /** One cue's learned start, end and active flag, as read from a bank. */
+    struct LearnedTimes
+    {
+        double start{ -1.0 };
+        double end{ -1.0 };
+        bool active{ false };
+
+        static LearnedTimes read(const CueStore& cues, int i)
+        {
+            return { cues.getDetectedStartTime(i), cues.getDetectedEndTime(i), cues.getIsActive(i) };
+        }
+
+        void write(CueStore& cues, int i) const
         {
-            m.setDetectedStartTime(startTime);
-            m.setDetectedEndTime(-1.0);
-            m.setIsActive(true);
-            break;
+            cues.setDetectedStartTime(i, start);
+            cues.setDetectedEndTime(i, end);
+            cues.setIsActive(i, active);
         }
+
+        bool operator==(const LearnedTimes& other) const noexcept
+        {
+            return start == other.start && end == other.end && active == other.active;
+        }
+    };
 }
 
-void MTCGenAudioProcessor::stopMappingForNote(int midiNote)
+/**
+ * @brief Learned times are never written into a published bank from here. They are
+ * copied into the edited store before it is swapped in; a block that loaded the old
+ * bank before the swap may still learn into it, so once such blocks have finished, any
+ * cue whose times changed since they were copied goes into a further copy of the live
+ * bank, swapped in the same way (unless the live bank has learned that cue itself
+ * since). That repeats until a round finds nothing new, normally the first, as each
+ * round only covers the blocks that overlapped its swap.
+ */
+bool MTCGenAudioProcessor::replaceBankCues(int bank, const CueStore& copiedFrom,
+    std::unique_ptr<CueStore> edited, const std::vector<CueStore::CueId>& timesSet)
 {
-    for (auto& m : mappings)
-        if (m.getMidiNote() == midiNote)
+    if (!juce::isPositiveAndBelow(bank, banks.getNumBanks()) || &banks.getBank(bank) != &copiedFrom)
+        return false;
+
+    // Per cue of the store being published: the cue of the bank it replaces its times
+    // were read from (-1 for cues added, or whose times the edit set), the times read
+    // there and the times it was published with
+    const auto n = (size_t)edited->size();
+    std::vector<int> sources(n, -1);
+    std::vector<LearnedTimes> read(n), published(n);
+    {
+        std::unordered_map<CueStore::CueId, int> indexOfId;
+        indexOfId.reserve((size_t)copiedFrom.size());
+        for (int i = 0; i < copiedFrom.size(); ++i)
+            indexOfId[copiedFrom.getCueId(i)] = i;
+
+        auto sortedTimesSet = timesSet;
+        std::sort(sortedTimesSet.begin(), sortedTimesSet.end());
+
+        for (int i = 0; i < (int)n; ++i)
+        {
+            const auto id = edited->getCueId(i);
+            const auto found = indexOfId.find(id);
+            if (found == indexOfId.end()
+                || std::binary_search(sortedTimesSet.begin(), sortedTimesSet.end(), id))
+                continue;
+
+            sources[(size_t)i] = found->second;
+            read[(size_t)i] = published[(size_t)i] = LearnedTimes::read(copiedFrom, found->second);
+            read[(size_t)i].write(*edited, i);
+        }
+    }
+
+    for (auto next = std::move(edited); next != nullptr;)
+    {
+        const auto* old = banks.replaceBank(bank, std::move(next));
+        if (old == nullptr)
+            return false;
+
+        // The old bank's times are final once the blocks that may hold it are done
+        banks.waitForRunningBlocks();
+
+        const auto& live = banks.getBank(bank);
+        std::vector<LearnedTimes> nextRead, nextPublished;
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            if (sources[i] < 0)
+                continue;
+            const auto learned = LearnedTimes::read(*old, sources[i]);
+            if (learned == read[i])
+                continue;
+
+            if (next == nullptr)
+            {
+                next = std::make_unique<CueStore>();
+                next->copyFrom(live);
+                for (int c = 0; c < next->size(); ++c)
+                    nextRead.push_back(LearnedTimes::read(*next, c));
+                nextPublished = nextRead;
+            }
+
+            // A learn in the live bank is newer than one made in the old bank
+            if (nextRead[i] == published[i])
+            {
+                learned.write(*next, (int)i);
+                nextPublished[i] = learned;
+            }
+        }
+
+        if (next != nullptr)
         {
-            m.setDetectedEndTime(internalTime);
-            m.setIsActive(false);
-            break;
+            // Every cue of the copy is read from the live bank, at the same index
+            sources.resize(nextRead.size());
+            for (size_t i = 0; i < sources.size(); ++i)
+                sources[i] = (int)i;
+            read = std::move(nextRead);
+            published = std::move(nextPublished);
         }
+    }
+
+    updateLatency();
+    return true;
 }
 
-juce::String MTCGenAudioProcessor::getCurrentTimecode()
+/**
+ * @brief Each bank is linked on its own store and swapped in whole, so playback sees a
+ * bank either as it was or as the library has it.
+ */
+bool MTCGenAudioProcessor::linkCueLibrary(const juce::File& file, juce::String& error)
 {
-    const juce::ScopedLock sl(timecodeLock);
-    return currentTimecode;
+    auto library = CueLibrary::open(file, error);
+    if (library == nullptr)
+        return false;
+
+    banks.clear();
+    unresolvedLibraryBanks.clear();
+    const int numBanks = juce::jlimit(1, CueBankSet::maxBanks, library->getNumBanks());
+    for (int b = 0; b < numBanks; ++b)
+    {
+        const int index = b == 0 ? 0 : banks.addBank({});
+        auto linked = std::make_unique<CueStore>();
+        linked->attachLibrary(library, b);
+        banks.replaceBank(index, std::move(linked));
+        banks.setBankName(index, library->getBankName(b));
+    }
+
+    cueLibrary = std::move(library);
+    cueLibraryFile = file;
+    cueLibraryError.clear();
+    updateLatency();
+    updateHostDisplay();
+    return true;
 }
 
-juce::StringArray MTCGenAudioProcessor::getAvailableMidiOutputNames() const
+void MTCGenAudioProcessor::unlinkCueLibrary()
 {
-    juce::StringArray list;
-    for (auto& d : juce::MidiOutput::getAvailableDevices())
-        list.add(d.name);
-    return list;
+    for (int b = 0; b < banks.getNumBanks(); ++b)
+    {
+        if (!banks.getBank(b).isLinkedToLibrary())
+            continue;
+
+        const auto& linked = banks.getBank(b);
+        auto copy = std::make_unique<CueStore>();
+        copy->copyFrom(linked);
+        copy->makeEditable();
+        replaceBankCues(b, linked, std::move(copy), {});
+    }
+
+    cueLibrary.reset();
+    cueLibraryFile = juce::File();
+    cueLibraryError.clear();
+    unresolvedLibraryBanks.clear();
+}
+
+bool MTCGenAudioProcessor::editActiveCues(const std::function<void(CueStore&)>& edit,
+    const std::vector<CueStore::CueId>& timesSet)
+{
+    const int bank = banks.getActiveIndex();
+    const auto& source = banks.getBank(bank);
+
+    auto edited = std::make_unique<CueStore>();
+    edited->copyFrom(source);
+    edit(*edited);
+    return replaceBankCues(bank, source, std::move(edited), timesSet);
 }
 
 void MTCGenAudioProcessor::removeMapping(int index)
 {
-    if (index >= 0 && index < (int)mappings.size())
-        mappings.erase(mappings.begin() + index);
+    if (juce::isPositiveAndBelow(index, getCues().size()))
+        editActiveCues([index](CueStore& cues) { cues.remove(index); });
+}
+
+void MTCGenAudioProcessor::setCuePreRoll(int index, int frames)
+{
+    if (juce::isPositiveAndBelow(index, getCues().size()))
+        editActiveCues([index, frames](CueStore& cues) {
+            cues.setPreRollFrames(index, juce::jlimit(0, maxPreRollFrames, frames));
+            });
+}
+
+/**
+ * @brief Reports the longest pre-roll in any bank as latency. It is sized at the slowest
+ * rate, so neither an automated rate change nor a program change needs a new latency
+ * from the audio thread.
+ */
+void MTCGenAudioProcessor::updateLatency()
+{
+    const double seconds = banks.getMaxPreRollFrames() / frameRateChoices[0];
+    const int samples = (int)std::ceil(seconds * currentSampleRate);
+    lookaheadSamples.store(samples, std::memory_order_relaxed);
+    setLatencySamples(samples);
 }
 
 void MTCGenAudioProcessor::setSelectedMidiOutputs(const juce::Array<int>& indices)
 {
     selectedMidiOutputIndices = indices;
-    midiOutputs.clear();
-    auto devices = juce::MidiOutput::getAvailableDevices();
+    auto available = juce::MidiOutput::getAvailableDevices();
+    juce::Array<juce::MidiDeviceInfo> devices;
     for (auto idx : indices)
-        if (idx >= 0 && idx < (int)devices.size())
-            if (auto out = juce::MidiOutput::openDevice(devices[idx].identifier))
-                midiOutputs.add(out.release());
+        if (idx >= 0 && idx < (int)available.size())
+            devices.add(available[idx]);
+
+    // Ports are opened by their own sender threads
+    midiOutputRouter.setOutputs(devices);
+}
+
+void MTCGenAudioProcessor::sendToOutputs(const juce::uint8* data, int size,
+    int samplePosition) noexcept
+{
+    // Only queues the bytes; each port's sender thread does the driver write when due
+    const double dueMs = blockStartMs > 0.0
+        ? blockStartMs + samplePosition * 1000.0 / currentSampleRate : 0.0;
+    midiOutputRouter.send(data, size, dueMs);
 }
 
-void MTCGenAudioProcessor::addDebugEvent(const juce::String& desc, double time)
+void MTCGenAudioProcessor::addDebugEvent(int note, double time) noexcept
 {
-    debugEvents.push_back({ desc, time });
-    if (debugEvents.size() > 5)
-        debugEvents.pop_front();
+    const auto n = debugEventsWritten.load(std::memory_order_relaxed);
+    auto& e = debugEvents[n % debugEvents.size()];
+    e.time.store(time, std::memory_order_relaxed);
+    e.note.store(note, std::memory_order_relaxed);
+    debugEventsWritten.store(n + 1, std::memory_order_release);
 }
 
+/**
+ * @brief Copies the newest events, then drops any the audio thread may have started to
+ * overwrite meanwhile (the slot of event i is reused by event i + ring size).
+ */
 std::vector<MTCGenAudioProcessor::MidiEventInfo> MTCGenAudioProcessor::getDebugEvents() const
 {
-    return { debugEvents.begin(), debugEvents.end() };
+    const auto ringSize = (juce::uint32)debugEvents.size();
+    const auto written = debugEventsWritten.load(std::memory_order_acquire);
+    const auto first = written - juce::jmin(written, (juce::uint32)numDebugEventsShown);
+
+    std::vector<std::pair<int, double>> copied;
+    for (auto i = first; i != written; ++i)
+    {
+        auto& e = debugEvents[i % ringSize];
+        copied.push_back({ e.note.load(std::memory_order_relaxed), e.time.load(std::memory_order_relaxed) });
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto after = debugEventsWritten.load(std::memory_order_relaxed);
+
+    std::vector<MidiEventInfo> events;
+    for (auto i = first; i != written; ++i)
+    {
+        if (after - i >= ringSize)
+            continue;
+        const auto [note, time] = copied[(size_t)(i - first)];
+        events.push_back({ (note >= 0 ? "NoteOn  " : "NoteOff ")
+            + juce::MidiMessage::getMidiNoteName(note >= 0 ? note : -1 - note, true, true, 4), time });
+    }
+    return events;
 }
 
 //==============================================================================
-// Change frame rate and restart/stop the high-res timer if in QuarterFrame mode
+// Parameters: the message thread writes through the APVTS, the audio thread reads the
+// raw atomics once per block in updateBlockParameters()
+void MTCGenAudioProcessor::setParameterPlainValue(const char* paramID, float plainValue)
+{
+    if (auto* param = parameters.getParameter(paramID))
+        param->setValueNotifyingHost(param->convertTo0to1(plainValue));
+}
+
 void MTCGenAudioProcessor::setFrameRate(double newRate)
 {
-    frameRate = newRate;
-    quarterFrameIndex = 0;
+    int best = numFrameRateChoices - 1;
+    for (int i = 0; i < numFrameRateChoices; ++i)
+        if (std::abs(frameRateChoices[i] - newRate) < std::abs(frameRateChoices[best] - newRate))
+            best = i;
+
+    setParameterPlainValue(frameRateParamID, (float)best);
+    setArtNetRateType(getArtNetRateType());
+}
+
+double MTCGenAudioProcessor::getFrameRate() const noexcept
+{
+    int index = juce::roundToInt(frameRateParam->load(std::memory_order_relaxed));
+    return frameRateChoices[juce::jlimit(0, numFrameRateChoices - 1, index)];
+}
+
+MTCFormat MTCGenAudioProcessor::getMTCFormat() const noexcept
+{
+    return mtcFormatParam->load(std::memory_order_relaxed) >= 0.5f ? QuarterFrame : FullSysEx;
+}
+
+int MTCGenAudioProcessor::getOffsetFrames() const noexcept
+{
+    return juce::roundToInt(offsetParam->load(std::memory_order_relaxed));
+}
+
+bool MTCGenAudioProcessor::isOutputEnabled() const noexcept
+{
+    return outputEnabledParam->load(std::memory_order_relaxed) >= 0.5f;
+}
+
+bool MTCGenAudioProcessor::isClockEnabled() const noexcept
+{
+    return clockEnabledParam->load(std::memory_order_relaxed) >= 0.5f;
+}
+
+void MTCGenAudioProcessor::setClockEnabled(bool shouldBeEnabled)
+{
+    setParameterPlainValue(clockEnabledParamID, shouldBeEnabled ? 1.0f : 0.0f);
+}
+
+void MTCGenAudioProcessor::updateBlockParameters() noexcept
+{
+    int rateIndex = juce::jlimit(0, numFrameRateChoices - 1,
+        juce::roundToInt(frameRateParam->load(std::memory_order_relaxed)));
+
+    const auto format = getMTCFormat();
+    if (rateIndex != blockRateIndex || format != mtcFormat)
+        mtcKernel = MtcKernels::select(rateIndex, format == QuarterFrame);
+
+    if (rateIndex != blockRateIndex)
+    {
+        blockRateIndex = rateIndex;
+        frameRate = frameRateChoices[rateIndex];
+        if (getArtNetRateType() < 0)
+            artNetSender.setRateType(ArtNetTimecodeSender::rateTypeForFrameRate(frameRate));
+    }
+
+    mtcFormat = format;
+    offsetFrames = getOffsetFrames();
+    outputEnabled = isOutputEnabled();
+    clockEnabled = isClockEnabled();
+    thruFilter.setOptions(thruTriggersParam->load(std::memory_order_relaxed) >= 0.5f,
+        thruSysExParam->load(std::memory_order_relaxed) >= 0.5f,
+        juce::roundToInt(thruChannelParam->load(std::memory_order_relaxed)));
+    lookaheadSeconds = lookaheadSamples.load(std::memory_order_relaxed) / currentSampleRate;
+}
+
+double MTCGenAudioProcessor::getCueOutputSeconds(const CueStore& cues, int cue, double hostTime,
+    double rate, int offset) const noexcept
+{
+    double elapsed = hostTime - cues.getDetectedStartTime(cue);
+    return juce::jmax(0.0, cues.getBaseSeconds(cue, rate) + elapsed + offset / rate);
+}
+
+/**
+ * @brief Registered after the sender starts and unregistered before it stops, so the
+ * sink is never called while the sender is not running.
+ */
+void MTCGenAudioProcessor::setArtNetEnabled(bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == artNetSender.isEnabled())
+        return;
 
-    if (mtcFormat == QuarterFrame)
-        startTimer(int(1000.0 / (frameRate * 8.0)));
+    if (shouldBeEnabled)
+    {
+        artNetSender.setEnabled(true);
+        timecodeSinks.addSink(&artNetSender, TimecodeSink::Realtime);
+    }
     else
-        stopTimer();
+    {
+        timecodeSinks.removeSink(&artNetSender);
+        artNetSender.setEnabled(false);
+    }
 }
 
+void MTCGenAudioProcessor::setArtNetRateType(int type)
+{
+    artNetRateType.store(type, std::memory_order_relaxed);
+    artNetSender.setRateType(type < 0
+        ? ArtNetTimecodeSender::rateTypeForFrameRate(getFrameRate())
+        : (ArtNetTimecodeSender::RateType)type);
+}
 
+#if MTCGEN_HEADLESS
+juce::AudioProcessorEditor* MTCGenAudioProcessor::createEditor() { return nullptr; }
+bool MTCGenAudioProcessor::hasEditor() const { return false; }
+#else
 juce::AudioProcessorEditor* MTCGenAudioProcessor::createEditor() { return new MTCGenAudioProcessorEditor(*this); }
 bool MTCGenAudioProcessor::hasEditor() const { return true; }
+#endif
 
 /**
  * @brief JUCE plugin factory function.
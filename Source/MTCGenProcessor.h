@@ -8,8 +8,33 @@
 
 #include <JuceHeader.h>
 #include <vector>
-#include <deque>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <functional>
 #include "MappingEntry.h"
+#include "Timecode.h"
+#include "CueStore.h"
+#include "CueBankSet.h"
+#include "CueLibrary.h"
+#include "ArtNetTimecodeSender.h"
+#include "BlockTimingMeter.h"
+#include "MidiClockGenerator.h"
+#include "MidiOutputRouter.h"
+#include "MidiThruFilter.h"
+#include "PlayheadDll.h"
+#include "SharedTimecodePublisher.h"
+#include "TimecodeDispatcher.h"
+#include "ControlServer.h"
+#include "MtcKernels.h"
+
+/**
+ * MTCGEN_HEADLESS=1 builds the processor without its editor (and without any of the
+ * GUI sources), as used by the MTCGenDaemon console target.
+ */
+#ifndef MTCGEN_HEADLESS
+ #define MTCGEN_HEADLESS 0
+#endif
 
  /**
   * @enum MTCFormat
@@ -25,8 +50,7 @@ enum MTCFormat
  * @class MTCGenAudioProcessor
  * @brief JUCE AudioProcessor for generating MTC streams based on MIDI note mappings.
  */
-class MTCGenAudioProcessor : public juce::AudioProcessor,
-    private juce::HighResolutionTimer
+class MTCGenAudioProcessor : public juce::AudioProcessor
 {
 public:
     /** Constructor */
@@ -56,83 +80,199 @@ public:
     void setStateInformation(const void*, int) override;
     //@}
 
+    /** @name Parameter IDs */
+    //@{
+    static constexpr const char* frameRateParamID = "frameRate";
+    static constexpr const char* mtcFormatParamID = "mtcFormat";
+    static constexpr const char* offsetParamID = "offsetFrames";
+    static constexpr const char* outputEnabledParamID = "outputEnabled";
+    static constexpr const char* clockEnabledParamID = "clockEnabled";
+    static constexpr const char* thruTriggersParamID = "thruTriggers";
+    static constexpr const char* thruSysExParamID = "thruSysEx";
+    static constexpr const char* thruChannelParamID = "thruChannel";
+    //@}
+
+    /** Rates offered by the frameRate parameter, in choice order. */
+    static constexpr double frameRateChoices[] = { 24.0, 25.0, 29.97, 30.0 };
+    static constexpr int numFrameRateChoices = 4;
+
+    /** Longest per-cue pre-roll accepted by setCuePreRoll(), in frames. */
+    static constexpr int maxPreRollFrames = 300;
+
     /**
-     * @brief Accessor for all MIDI-to-timecode mappings.
-     * @return Reference to the internal vector of MappingEntry.
+     * @brief Host-automatable parameters (rate, format, global offset, output enable).
+     * @return Reference to the processor's AudioProcessorValueTreeState.
      */
-    std::vector<MappingEntry>& getMappings() { return mappings; }
+    juce::AudioProcessorValueTreeState& getParameters() { return parameters; }
 
     /**
-     * @brief Queries the host playhead for current time, falling back to internalTime.
-     * @return Time in seconds.
+     * @brief Accessor for the mappings of the active bank. Only the audio thread writes
+     * through it (learned times); every change from the message thread goes through
+     * editActiveCues().
+     * @return Reference to the active bank's struct-of-arrays cue store.
      */
-    double getCurrentHostTime() const;
+    CueStore& getCues() { return banks.getActive(); }
 
     /**
-     * @brief Safely queries the host playhead time (works on UI thread).
-     * @return Time in seconds.
+     * @brief Applies edit to a copy of the active bank and swaps the copy in with
+     * replaceBankCues(), so the audio thread never reads a bank while it is resized or
+     * unlinked from its library, nor has its learned times written under it. Use it for
+     * every edit, learned times included. Message thread.
+     * @param timesSet Cues whose learned times edit sets, so they are not carried over
+     *                 from the bank (see replaceBankCues()).
+     * @return False if the bank was replaced while the copy was edited.
      */
-    double getPlayheadTime() const;
+    bool editActiveCues(const std::function<void(CueStore&)>& edit,
+        const std::vector<CueStore::CueId>& timesSet = {});
+
+    /**
+     * @brief All cue banks. Host programs and incoming program changes select among them.
+     */
+    CueBankSet& getBanks() { return banks; }
+
+    /**
+     * @brief Makes a bank the active one (as a program change would). Message thread.
+     */
+    void selectBank(int index);
+
+    /**
+     * @brief Appends an empty bank. Message thread.
+     * @return Index of the new bank, or -1 if CueBankSet::maxBanks are in use.
+     */
+    int addBank(const juce::String& name);
+
+    /** @brief Removes a bank (the last one is kept). Message thread. */
+    void removeBank(int index);
+
+    /**
+     * @brief Swaps an edited copy of a bank in as one atomic update (see
+     * CueBankSet::replaceBank()). Learned times the audio thread wrote to the old bank
+     * while the copy was being edited, or during blocks still running at the swap, are
+     * carried over, except for the cues in timesSet, whose times the edit itself set.
+     * They are written into copies before those are published, never into the live
+     * bank. Message thread; may wait for the running block to finish.
+     * @param bank Index of the bank the copy was made from; read it once, as a program
+     *             change may select another bank while the copy is edited.
+     * @param copiedFrom The bank the copy was made from.
+     * @return False, with nothing changed, if that bank has been replaced since.
+     */
+    bool replaceBankCues(int bank, const CueStore& copiedFrom, std::unique_ptr<CueStore> edited,
+        const std::vector<CueStore::CueId>& timesSet);
+
+    /**
+     * @brief Replaces every bank with the banks of a cue library file, read from the
+     * process-wide mapping (see CueLibrary). Sessions then save only the library's path
+     * and the learned times that differ from it. Message thread.
+     * @return False, with the banks unchanged, if the file cannot be mapped.
+     */
+    bool linkCueLibrary(const juce::File& file, juce::String& error);
+
+    /**
+     * @brief Gives every bank still linked its own copy of its cues and forgets the
+     * library. Message thread.
+     */
+    void unlinkCueLibrary();
+
+    /** @brief The linked library, or nullptr. Message thread. */
+    const CueLibrary* getCueLibrary() const noexcept { return cueLibrary.get(); }
+
+    /** @brief Why the library the last loaded session refers to could not be mapped. */
+    const juce::String& getCueLibraryError() const noexcept { return cueLibraryError; }
 
     /**
      * @brief Called on Note-On: captures startTime and arms this mapping.
      * @param midiNote MIDI note number triggering the mapping.
      * @param startTime Timestamp (s) when note-on occurred.
+     * @return True if the note is mapped in the active bank.
      */
-    void startMappingForNote(int midiNote, double startTime);
+    bool startMappingForNote(int midiNote, double startTime);
 
     /**
      * @brief Called on Note-Off: captures endTime and disarms this mapping.
      * @param midiNote MIDI note number triggering the mapping.
+     * @return True if the note is mapped in the active bank.
      */
-    void stopMappingForNote(int midiNote);
+    bool stopMappingForNote(int midiNote);
 
     /**
-     * @brief Returns the most recently computed timecode string.
-     * @return "HH:MM:SS:FF" or empty if inactive.
+     * @brief Lock-free read of the current frame, safe from any thread.
+     * @return Timecode::pack() of the current frame, or 0 if inactive.
      */
-    juce::String getCurrentTimecode();
+    juce::uint32 getCurrentFramePacked() const noexcept { return currentFrame.load(std::memory_order_acquire); }
 
     /**
-     * @brief Removes the mapping at the given index.
-     * @param index Index in the mappings vector.
+     * @brief Lock-free read of the host time at the start of the last block, safe from
+     * any thread (the playhead itself may only be queried on the audio thread).
+     */
+    double getBlockTime() const noexcept { return blockTime.load(std::memory_order_relaxed); }
+
+    /** @brief Host transport state at the last block, safe from any thread. */
+    bool isHostPlaying() const noexcept { return hostPlaying.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Removes the mapping at the given index (through editActiveCues()).
+     * @param index Index in the cue store.
      */
     void removeMapping(int index);
 
     /**
-     * @brief Called periodically by the editor’s timer to update internal timecode.
+     * @brief Sets how many frames before its cue point a cue starts running, so
+     * receivers are already locked when the cue is reached (through editActiveCues()).
+     * Updates the reported latency. Message thread.
+     * @param index Index in the cue store.
+     * @param frames Pre-roll in frames, clamped to [0, maxPreRollFrames].
      */
-    void updateTimecodeFromPlayHead();
+    void setCuePreRoll(int index, int frames);
 
     /**
-     * @brief Sets the timecode frame rate (e.g., 24, 25, 29.97, 30).
-     * @param newRate Frames per second.
+     * @brief Sets the frameRate parameter (e.g., 24, 25, 29.97, 30). Message thread.
+     * @param newRate Frames per second; the nearest offered rate is used.
      */
     void setFrameRate(double newRate);
 
     /**
-     * @brief Retrieves the configured timecode frame rate.
+     * @brief Retrieves the frameRate parameter. Lock-free, any thread.
      * @return Frames per second.
      */
-    double getFrameRate() const { return frameRate; }
+    double getFrameRate() const noexcept;
 
     /**
-     * @brief Switches between Full SysEx and Quarter-Frame output.
+     * @brief Sets the mtcFormat parameter. Message thread.
      * @param fmt Desired MTCFormat.
      */
     void setMTCFormat(MTCFormat fmt);
 
     /**
-     * @brief Retrieves the current MTC format.
+     * @brief Retrieves the mtcFormat parameter. Lock-free, any thread.
      * @return Current MTCFormat.
      */
-    MTCFormat getMTCFormat() const { return mtcFormat; }
+    MTCFormat getMTCFormat() const noexcept;
 
     /**
-     * @brief Index of the mapping currently driving timecode.
+     * @brief Global offset added to every cue's output, in frames. Lock-free, any thread.
+     */
+    int getOffsetFrames() const noexcept;
+
+    /**
+     * @brief False while MTC / Art-Net output is muted by the outputEnabled parameter.
+     */
+    bool isOutputEnabled() const noexcept;
+
+    /**
+     * @brief True while the clockEnabled parameter turns on MIDI Clock / SPP output.
+     */
+    bool isClockEnabled() const noexcept;
+
+    /**
+     * @brief Sets the clockEnabled parameter. Message thread.
+     */
+    void setClockEnabled(bool shouldBeEnabled);
+
+    /**
+     * @brief Index of the mapping that drove timecode in the last block. Any thread.
      * @return Mapping index or -1 if none.
      */
-    int getActiveMappingIndex() const { return activeMappingIndex; }
+    int getActiveMappingIndex() const noexcept { return activeMappingIndex.load(std::memory_order_relaxed); }
 
     /**
      * @brief Lists available system MIDI outputs.
@@ -146,6 +286,11 @@ public:
      */
     void setSelectedMidiOutputs(const juce::Array<int>&);
 
+    /**
+     * @brief The selected output ports and their health, for the editor.
+     */
+    const MidiOutputRouter& getMidiOutputRouter() const { return midiOutputRouter; }
+
     /**
      * @struct MidiEventInfo
      * @brief Holds a debug descriptor and timestamp for recent MIDI events.
@@ -157,51 +302,258 @@ public:
     };
 
     /**
-     * @brief Fetches the last few MIDI debug events (up to 5).
+     * @brief Fetches the last few MIDI debug events (up to 5). Message thread.
      * @return Vector of MidiEventInfo.
      */
     std::vector<MidiEventInfo> getDebugEvents() const;
 
+    static constexpr int numDebugEventsShown = 5;
+
+    /**
+     * @brief Accessor for the Art-Net timecode output (address, port, rate type).
+     * Enable it with setArtNetEnabled(), which also registers it as a sink.
+     * @return Reference to the sender owned by this processor.
+     */
+    ArtNetTimecodeSender& getArtNetSender() { return artNetSender; }
+
+    /**
+     * @brief Starts or stops Art-Net output. The sender is a realtime sink only while
+     * enabled, so with nothing else registered the audio thread builds no sink events.
+     * Message thread; disabling waits for a dispatch() in progress.
+     */
+    void setArtNetEnabled(bool shouldBeEnabled);
+
+    /** @brief True while Art-Net output is on. */
+    bool isArtNetEnabled() const { return artNetSender.isEnabled(); }
+
+    /**
+     * @brief Accessor for the shared-memory timecode publisher (name, enable).
+     * @return Reference to the publisher owned by this processor.
+     */
+    SharedTimecodePublisher& getSharedTimecode() { return sharedTimecode; }
+
+    /**
+     * @brief Accessor for the local control socket (path, enable).
+     * @return Reference to the server owned by this processor.
+     */
+    ControlServer& getControlServer() { return controlServer; }
+
+    /**
+     * @brief Where further timecode destinations register (see TimecodeSink). The
+     * Art-Net sender is registered as a realtime sink while it is enabled.
+     */
+    TimecodeDispatcher& getTimecodeSinks() { return timecodeSinks; }
+
+    /**
+     * @brief Sets the Art-Net rate type, or -1 to follow the MTC frame rate.
+     * @param type ArtNetTimecodeSender::RateType value or -1.
+     */
+    void setArtNetRateType(int type);
+
+    /**
+     * @brief Retrieves the Art-Net rate type override.
+     * @return RateType value, or -1 when following the frame rate.
+     */
+    int getArtNetRateType() const { return artNetRateType.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Per-block CPU budget statistics of processBlock.
+     * @return Reference to the meter; call getStats() or reset() from any thread.
+     */
+    BlockTimingMeter& getBlockTimingMeter() { return blockMeter; }
+
+    /**
+     * @brief Playhead smoothing and its residuals against the host.
+     * @return Reference to the loop; call getStats() or reset() from any thread.
+     */
+    PlayheadDll& getPlayheadDll() { return playheadDll; }
+
 private:
-    /** HighResolutionTimer callback (for quarter-frame timing) */
-    void hiResTimerCallback() override;
+    /** Builds the rate, format, offset and output-enable parameters. */
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+
+    /** Sets a parameter from a plain (unnormalised) value and notifies the host. */
+    void setParameterPlainValue(const char* paramID, float plainValue);
+
+    /**
+     * @brief Reads the parameter atomics once at the start of a block. Rate changes are
+     * detected here, so the whole block encodes with one consistent rate.
+     */
+    void updateBlockParameters() noexcept;
+
+    /**
+     * @brief Output time of a cue: base timecode + time since its start + global offset.
+     */
+    double getCueOutputSeconds(const CueStore& cues, int cue, double hostTime, double rate,
+        int offset) const noexcept;
+
+    /**
+     * @brief On a backward jump of the playhead (stop, return or scrub), gives the cues
+     * still running the last position played as their end time. Audio thread.
+     */
+    void endCuesOnJump(CueStore& cues) noexcept;
 
-    /** Remembers the last hostTime to detect transport jumps */
-    double lastPlayheadTime{ 0.0 };  
+    /** internalTime of the previous block, to detect transport jumps (audio thread) */
+    double lastPlayheadTime{ 0.0 };
 
     /**
-     * @brief Determines which MappingEntry should be active at hostTime.
+     * @brief Determines which mapping should be active at hostTime.
      * @param hostTime Current playhead time (s).
-     * @return Pointer to the chosen MappingEntry or nullptr.
+     * @return Index of the chosen mapping in cues, or -1.
      */
-    MappingEntry* findActiveMapping(double hostTime);
+    int findActiveMapping(const CueStore& cues, double hostTime) const;
 
-    /** Sends the next quarter-frame MTC message. */
-    void sendQuarterFrame();
+    /**
+     * @brief findActiveMapping() plus pre-roll: picks the cue to drive over [from, to).
+     * @param emitFrom Set to the time output starts within the range (a lead-in can
+     *                 begin part-way through).
+     * @return Index of the cue, or -1 if nothing runs in the range.
+     */
+    int selectCue(const CueStore& cues, double from, double to, double rate, double& emitFrom) const;
+
+    /**
+     * @brief Adds one block of MTC for a cue (Full Frame and/or quarter-frames at their
+     * sample positions) to the buffer and the selected outputs. Audio thread.
+     * @param outputTime Output time (s) of the block's first sample.
+     * @param emitFrom Time (s) output starts within the block.
+     */
+    void writeMtc(juce::MidiBuffer& out, const CueStore& cues, int cue, double outputTime,
+        double emitFrom, int numSamples);
+
+    /**
+     * @brief Adds the block's MIDI Clock / SPP, lookaheadSeconds behind the host like the
+     * MTC: see the definition. Audio thread.
+     * @param ppq Host position at the block start.
+     */
+    void writeClock(juce::MidiBuffer& out, bool playing, double ppq, double bpm, int numSamples) noexcept;
+
+    /**
+     * @brief Adds the block's sink events: cue start/stop, locate, frame change and the
+     * quarter-frames writeMtc() put in mtcEvents. Audio thread.
+     * @param cue Cue driving the output, or -1 for none.
+     */
+    void addSinkEvents(const CueStore& cues, int cue, const Timecode& tc, double outputTime,
+        double emitFrom, int numSamples);
+
+    /**
+     * @brief Note-On/Off against the bank processBlock() loaded for the block, so a
+     * bank switched on the message thread mid-block is not half-used. Audio thread.
+     */
+    bool startMappingForNote(CueStore& cues, int midiNote, double startTime);
+    bool stopMappingForNote(CueStore& cues, int midiNote);
+
+    /** Reports the longest cue pre-roll to the host as latency. Message thread. */
+    void updateLatency();
 
     /**
-     * @brief Logs a debug event (NoteOn/Off) with timestamp.
-     * @param description Text describing the event.
+     * @brief Logs a debug event (NoteOn/Off) with timestamp into debugEvents. Audio
+     * thread; the text is only made by getDebugEvents().
+     * @param note MIDI note, negated minus one for a Note-Off.
      * @param time Timestamp in seconds.
      */
-    void addDebugEvent(const juce::String& description, double time);
+    void addDebugEvent(int note, double time) noexcept;
 
-    double currentSampleRate{ 44100.0 };   /**< Audio sample rate (Hz) */
+    /**
+     * Queues a message's raw bytes on every selected MIDI output port (MTC and clock
+     * share this path), due at its sample position's wall-clock time in the block.
+     */
+    void sendToOutputs(const juce::uint8* data, int size, int samplePosition) noexcept;
+
+    juce::AudioProcessorValueTreeState parameters; /**< Rate, format, offset, output enable */
+    std::atomic<float>* frameRateParam{ nullptr };     /**< Choice index into frameRateChoices */
+    std::atomic<float>* mtcFormatParam{ nullptr };     /**< MTCFormat as a choice index */
+    std::atomic<float>* offsetParam{ nullptr };        /**< Global offset in frames */
+    std::atomic<float>* outputEnabledParam{ nullptr }; /**< 0 or 1 */
+    std::atomic<float>* clockEnabledParam{ nullptr };  /**< 0 or 1 */
+    std::atomic<float>* thruTriggersParam{ nullptr };  /**< 0 or 1 */
+    std::atomic<float>* thruSysExParam{ nullptr };     /**< 0 or 1 */
+    std::atomic<float>* thruChannelParam{ nullptr };   /**< 0 = keep, 1..16 */
+
+    // Parameter snapshot taken by updateBlockParameters (audio thread only)
+    int    blockRateIndex{ -1 };          /**< Rate index the snapshot was taken at */
     double frameRate{ 30.0 };             /**< MTC frames per second */
-    double internalTime{ 0.0 };           /**< Fallback time source */
-    juce::CriticalSection timecodeLock; /**< Protects currentTimecode */
-    juce::String currentTimecode;       /**< Last computed "HH:MM:SS:FF" */
+    MTCFormat mtcFormat{ FullSysEx };     /**< FullSysEx or QuarterFrame */
+    MtcKernels::Function mtcKernel{ MtcKernels::select(3, false) }; /**< Encoder for rate and format */
+    int    offsetFrames{ 0 };             /**< Global offset in frames */
+    bool   outputEnabled{ true };         /**< MTC / Art-Net output on */
+    bool   clockEnabled{ false };         /**< MIDI Clock / SPP output on */
+    double lookaheadSeconds{ 0.0 };       /**< Output delay behind the input */
+
+    std::atomic<int> lookaheadSamples{ 0 }; /**< Reported latency, see updateLatency */
+
+    // MTC stream state (audio thread only)
+    CueStore::CueId streamCue{ 0 };       /**< Cue the stream runs for, 0 = none */
+    juce::uint32 streamBank{ 0 };         /**< Store id of the bank streamCue belongs to */
+    double streamRate{ 0.0 };             /**< Rate the stream runs at */
+    double streamNextMtc{ 0.0 };          /**< Expected MTC time at the next block */
+    juce::int64 nextQuarterFrame{ 0 };    /**< Next quarter-frame, counted from 00:00:00:00 */
+    bool streamRestarted{ false };        /**< writeMtc() restarted the stream this block */
+
+    // What the sinks were last told (audio thread only)
+    CueStore::CueId sinkCue{ 0 };         /**< Cue of the last CueStart, 0 = stopped */
+    juce::uint32 sinkBank{ 0 };           /**< Store id of sinkCue's bank */
+    int sinkNote{ -1 };
+    juce::uint32 sinkFrame{ 0 };          /**< Frame of the last Frame event */
 
-    std::vector<MappingEntry> mappings; /**< All user mappings */
-    int activeMappingIndex{ -1 };         /**< Currently active mapping */
+    double currentSampleRate{ 44100.0 };   /**< Audio sample rate (Hz) */
+    double blockStartMs{ 0.0 };            /**< Wall-clock time the block began, 0 offline (audio thread) */
+    double internalTime{ 0.0 };           /**< Smoothed host time of the block start */
+    PlayheadDll playheadDll;              /**< Smooths the host position while playing */
+    std::atomic<juce::uint32> currentFrame{ 0 }; /**< Packed current frame, see Timecode */
+    std::atomic<double> blockTime{ 0.0 };        /**< internalTime of the last block */
+    std::atomic<bool> hostPlaying{ false };      /**< Transport state of the last block */
+
+    CueBankSet banks;                   /**< All user mappings, one store per bank */
+    std::atomic<int> activeMappingIndex{ -1 }; /**< Mapping of the last block, audio thread writes */
+
+    // Cue library (message thread)
+    std::shared_ptr<const CueLibrary> cueLibrary; /**< Linked library, see linkCueLibrary */
+    juce::File cueLibraryFile;          /**< Library the session refers to, mapped or not */
+    juce::String cueLibraryError;
+    /** Saved library banks whose library could not be mapped, by bank index; written
+        back unchanged so a missing drive does not lose the learned times */
+    std::vector<std::unique_ptr<juce::XmlElement>> unresolvedLibraryBanks;
 
     juce::Array<int> selectedMidiOutputIndices; /**< Chosen MIDI outputs */
-    juce::OwnedArray<juce::MidiOutput> midiOutputs; /**< Open MIDIOutput instances */
+    MidiOutputRouter midiOutputRouter;          /**< Per-port sender threads and watchdog */
+
+    /** One logged event. Fields are atomics so the message thread may copy them while
+        the audio thread overwrites the oldest; debugEventsWritten tells which survived. */
+    struct DebugEvent
+    {
+        std::atomic<double> time{ 0.0 };
+        std::atomic<int> note{ 0 };       /**< Note-On note, or -1 - note for a Note-Off */
+    };
+    std::array<DebugEvent, 16> debugEvents;          /**< Ring, written by the audio thread */
+    std::atomic<juce::uint32> debugEventsWritten{ 0 };
+
+    ArtNetTimecodeSender artNetSender;     /**< UDP timecode output */
+    std::atomic<int> artNetRateType{ -1 }; /**< Art-Net rate type, -1 = follow frameRate */
+    SharedTimecodePublisher sharedTimecode; /**< Timecode for local processes */
+    TimecodeDispatcher timecodeSinks;      /**< Declared after the sinks it holds pointers to */
+
+    BlockTimingMeter blockMeter;           /**< CPU budget of each processBlock call */
+
+    MidiClockGenerator clockGenerator;     /**< 24-PPQN clock and SPP from the playhead */
+
+    /** A host start or stop on its way to the clock output (audio thread) */
+    struct ClockEdge
+    {
+        juce::int64 due{ 0 };   /**< clockSamples at which the output follows it */
+        double ppq{ 0.0 };      /**< Host position at the start or stop */
+        bool playing{ false };  /**< Transport state after it */
+    };
+    std::array<ClockEdge, 8> clockEdges; /**< Pending, oldest first */
+    int numClockEdges{ 0 };
+    bool clockHostPlaying{ false };       /**< Host transport as last queued */
+    bool clockOutputPlaying{ false };     /**< Transport the clock output runs with */
+    juce::int64 clockSamples{ 0 };        /**< Samples processed since prepareToPlay */
 
-    MTCFormat mtcFormat{ FullSysEx };    /**< FullSysEx or QuarterFrame */
-    int quarterFrameIndex{ 0 };          /**< Index for quarter-frame sequence */
+    juce::MidiBuffer clockEvents;          /**< Per-block clock output, sized in prepareToPlay */
+    juce::MidiBuffer mtcEvents;            /**< Per-block MTC output, sized in prepareToPlay */
+    MidiThruFilter thruFilter;             /**< Which incoming events pass downstream */
 
-    std::deque<MidiEventInfo> debugEvents; /**< Rolling log of last 5 events */
+    ControlServer controlServer{ *this };  /**< Declared last: stops before anything it drives */
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MTCGenAudioProcessor)
 };
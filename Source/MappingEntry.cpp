@@ -12,17 +12,29 @@
 
 double MappingEntry::getTimeInSeconds(double frameRate) const
 {
-    auto parts = juce::StringArray::fromTokens(timecodeString, ":", "");
-    if (parts.size() != 4)
+    int hours, minutes, seconds, frames;
+    if (!parseTimecode(timecodeString, hours, minutes, seconds, frames))
         return 0.0;
 
-    int hours = parts[0].getIntValue();
-    int minutes = parts[1].getIntValue();
-    int seconds = parts[2].getIntValue();
-    int frames = parts[3].getIntValue();
     return hours * 3600 + minutes * 60 + seconds + frames / frameRate;
 }
 
+bool MappingEntry::parseTimecode(const juce::String& tc, int& hours, int& minutes,
+    int& seconds, int& frames)
+{
+    hours = minutes = seconds = frames = 0;
+
+    auto parts = juce::StringArray::fromTokens(tc, ":", "");
+    if (parts.size() != 4)
+        return false;
+
+    hours = parts[0].getIntValue();
+    minutes = parts[1].getIntValue();
+    seconds = parts[2].getIntValue();
+    frames = parts[3].getIntValue();
+    return true;
+}
+
 juce::XmlElement* MappingEntry::createXml() const
 {
     auto* xml = new juce::XmlElement("MappingEntry");
@@ -31,6 +43,8 @@ juce::XmlElement* MappingEntry::createXml() const
     xml->setAttribute("label", label);
     xml->setAttribute("detectedStartTime", detectedStartTime);
     xml->setAttribute("detectedEndTime", detectedEndTime);
+    xml->setAttribute("preRollFrames", preRollFrames);
+    xml->setAttribute("cueId", (int)cueId);
     // isActive is transient and not saved.
     return xml;
 }
@@ -45,4 +59,6 @@ void MappingEntry::loadFromXml(const juce::XmlElement& xml)
         label = xml.getStringAttribute("label");
     detectedStartTime = xml.getDoubleAttribute("detectedStartTime", -1.0);
     detectedEndTime = xml.getDoubleAttribute("detectedEndTime", -1.0);
+    preRollFrames = xml.getIntAttribute("preRollFrames", 0);
+    cueId = (juce::uint32)xml.getIntAttribute("cueId", 0);
 }
@@ -54,12 +54,27 @@ public:
     bool getIsActive() const { return isActive; }
     void setIsActive(bool b) { isActive = b; }
 
+    // Frames of timecode sent before the cue point so receivers are locked at it:
+    int getPreRollFrames() const { return preRollFrames; }
+    void setPreRollFrames(int frames) { preRollFrames = frames; }
+
+    // Stable identifier (0 = not yet assigned by a CueStore):
+    juce::uint32 getCueId() const { return cueId; }
+    void setCueId(juce::uint32 id) { cueId = id; }
+
     /**
      * @brief Converts the mapping’s preset timecode (HH:MM:SS:FF) into seconds,
      * using the given frame rate.
      */
     double getTimeInSeconds(double frameRate) const;
 
+    /**
+     * @brief Splits an "HH:MM:SS:FF" string into its fields.
+     * @return False (and all fields 0) if the string is not four ':'-separated parts.
+     */
+    static bool parseTimecode(const juce::String& tc, int& hours, int& minutes,
+        int& seconds, int& frames);
+
     // XML serialization
     juce::XmlElement* createXml() const;
     void loadFromXml(const juce::XmlElement& xml);
@@ -72,6 +87,8 @@ private:
     double detectedStartTime;
     double detectedEndTime;
     bool isActive;
+    int preRollFrames{ 0 };
+    juce::uint32 cueId{ 0 };
 };
 
 #endif // MAPPINGENTRY_H_INCLUDED
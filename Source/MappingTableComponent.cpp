@@ -4,10 +4,12 @@
  */
 
 #include "MappingTableComponent.h"
+#include "TriggerFileImporter.h"
 
 //==============================================================================
 /**
- * @brief Construct the MappingTableComponent, set up the table and header.
+ * @brief Construct the MappingTableComponent, set up the header, search box and
+ * the shared cell editors.
  */
 MappingTableComponent::MappingTableComponent(MTCGenAudioProcessor& proc)
     : processor(proc)
@@ -16,250 +18,534 @@ MappingTableComponent::MappingTableComponent(MTCGenAudioProcessor& proc)
     addMappingButton.setButtonText("Add Mapping");
     addMappingButton.addListener(this);
 
-    addAndMakeVisible(table);
-    table.setModel(this);
-
-    auto& h = table.getHeader();
-    h.addColumn("Label", 1, 120);
-    h.addColumn("MIDI Note", 2, 100);
-    h.addColumn("Mapping TC", 3, 150);
-    h.addColumn("Start", 4, 150);
-    h.addColumn("", 5, 80);  // Set Start
-    h.addColumn("End", 6, 150);
-    h.addColumn("", 7, 80);  // Set End
-    h.addColumn("", 8, 80);  // Delete
-    h.setStretchToFitActive(true);
-}
+    bankComboBox.setEditableText(true);
+    bankComboBox.setTooltip("Cue bank (selected by MIDI program change); type to rename");
+    bankComboBox.onChange = [this]()
+        {
+            auto& banks = processor.getBanks();
+            if (bankComboBox.getSelectedId() > 0)
+                processor.selectBank(bankComboBox.getSelectedId() - 1);
+            else if (bankComboBox.getText().isNotEmpty())
+                banks.setBankName(banks.getActiveIndex(), bankComboBox.getText());
+            refreshTable();
+        };
+    addAndMakeVisible(bankComboBox);
 
-/** Destructor */
-MappingTableComponent::~MappingTableComponent() {}
+    addBankButton.setTooltip("Add a cue bank");
+    addBankButton.addListener(this);
+    addAndMakeVisible(addBankButton);
 
-//==============================================================================
-int MappingTableComponent::getNumRows()
-{
-    return static_cast<int>(processor.getMappings().size());
+    removeBankButton.setTooltip("Remove the selected cue bank");
+    removeBankButton.addListener(this);
+    addAndMakeVisible(removeBankButton);
+
+    importButton.setTooltip("Learn cue start/end times from the notes of a MIDI file "
+        "(e.g. the host's exported trigger track)");
+    importButton.addListener(this);
+    addAndMakeVisible(importButton);
+
+    libraryButton.setTooltip("Share the cue banks between instances through a cue library file");
+    libraryButton.addListener(this);
+    addAndMakeVisible(libraryButton);
+
+    searchBox.setTextToShowWhenEmpty("Search cues", juce::Colours::grey);
+    searchBox.setTooltip("Search label, note or timecode");
+    searchBox.onTextChange = [this]()
+        {
+            commitEdit();
+            searchIndex.setQuery(searchBox.getText());
+            updateScrollRange();
+            rowArea.repaint();
+        };
+    addAndMakeVisible(searchBox);
+
+    header.addColumn("Label", labelColumn, 120);
+    header.addColumn("MIDI Note", noteColumn, 100);
+    header.addColumn("Mapping TC", timecodeColumn, 150);
+    header.addColumn("Pre-roll", preRollColumn, 70);
+    header.addColumn("Start", startColumn, 150);
+    header.addColumn("", setStartColumn, 80);
+    header.addColumn("End", endColumn, 150);
+    header.addColumn("", setEndColumn, 80);
+    header.addColumn("", deleteColumn, 80);
+    header.setStretchToFitActive(true);
+    header.addListener(this);
+    addAndMakeVisible(header);
+
+    rowArea.setOpaque(true);
+    addAndMakeVisible(rowArea);
+
+    scrollBar.setAutoHide(false);
+    scrollBar.setSingleStepSize(rowHeight);
+    scrollBar.addListener(this);
+    addAndMakeVisible(scrollBar);
+
+    // One editor and one note picker, moved over whichever cell is being edited
+    cellEditor.setFont(14.0f);
+    cellEditor.onReturnKey = [this]() { commitEdit(); };
+    cellEditor.onEscapeKey = [this]() { cancelEdit(); };
+    cellEditor.onFocusLost = [this]() { commitEdit(); };
+    rowArea.addChildComponent(cellEditor);
+
+    for (int i = 0; i < 128; ++i)
+        notePicker.addItem(juce::MidiMessage::getMidiNoteName(i, true, true, 4), i + 1);
+    notePicker.onChange = [this]() { commitEdit(); };
+    rowArea.addChildComponent(notePicker);
+
+    searchIndex.rebuild(processor.getCues());
+    indexedStoreId = processor.getCues().getStoreId();
+    indexedVersion = processor.getCues().getContentVersion();
+    updateBankList();
 }
 
-void MappingTableComponent::paintRowBackground(juce::Graphics& g,
-    int row, int, int, bool)
+/** Destructor */
+MappingTableComponent::~MappingTableComponent()
 {
-    if (row == processor.getActiveMappingIndex())
-        g.fillAll(juce::Colours::lightblue);
-    else
-        g.fillAll(juce::Colours::white);
+    header.removeListener(this);
+    scrollBar.removeListener(this);
 }
 
+//==============================================================================
 /**
- * @brief Paint the text for the Start and End columns.
+ * @brief Rebuilds the search index if the bank was switched or cues were added,
+ * removed or edited elsewhere, and repaints when learned times or the active cue changed.
  */
- // paintCell: only draw columns 1–3 here; Start/End (4,6) are handled by components
-void MappingTableComponent::paintCell(juce::Graphics& g,
-    int row, int columnId,
-    int width, int height,
-    bool /*selected*/)
+void MappingTableComponent::refreshTable()
 {
-    if (row < 0 || row >= getNumRows())
-        return;
+    auto& banks = processor.getBanks();
+    if (banks.getLayoutVersion() != shownBanksVersion)
+        updateBankList();
 
-    const auto& m = processor.getMappings()[row];
-    juce::String text;
+    auto& cues = processor.getCues();
 
-    switch (columnId)
+    if (cues.getStoreId() != indexedStoreId || cues.getContentVersion() != indexedVersion)
     {
-    case 1: // Label
-        text = m.getLabel();
-        break;
+        commitEdit();
+        searchIndex.rebuild(cues);
+        if (cues.getStoreId() != indexedStoreId)
+            scrollBar.setCurrentRangeStart(0.0);
+        indexedStoreId = cues.getStoreId();
+        indexedVersion = cues.getContentVersion();
+        updateScrollRange();
+        rowArea.repaint();
+    }
 
-    case 2: // MIDI Note
-        text = juce::MidiMessage::getMidiNoteName(
-            m.getMidiNote(), true, true, 4);
-        break;
+    auto timesVersion = cues.getTimesVersion();
+    auto activeIndex = processor.getActiveMappingIndex();
+    if (timesVersion != paintedTimesVersion || activeIndex != paintedActiveIndex)
+    {
+        paintedTimesVersion = timesVersion;
+        paintedActiveIndex = activeIndex;
+        rowArea.repaint();
+    }
+}
 
-    case 3: // Mapping Timecode
-        text = m.getTimecodeString();
-        break;
+void MappingTableComponent::updateBankList()
+{
+    auto& banks = processor.getBanks();
+    shownBanksVersion = banks.getLayoutVersion();
 
-    default:
-        return; // columns 4,5,6,7,8 use components
-    }
+    bankComboBox.clear(juce::dontSendNotification);
+    for (int i = 0; i < banks.getNumBanks(); ++i)
+        bankComboBox.addItem(juce::String(i) + ": " + banks.getBankName(i), i + 1);
+    bankComboBox.setSelectedId(banks.getActiveIndex() + 1, juce::dontSendNotification);
+    removeBankButton.setEnabled(banks.getNumBanks() > 1);
+}
+
+void MappingTableComponent::updateScrollRange()
+{
+    double visible = rowArea.getHeight();
+    double total = (double)searchIndex.getNumMatches() * rowHeight;
+    scrollBar.setRangeLimits(0.0, juce::jmax(total, visible), juce::dontSendNotification);
+    scrollBar.setCurrentRange(scrollBar.getCurrentRangeStart(), visible, juce::dontSendNotification);
+}
+
+juce::Rectangle<int> MappingTableComponent::getCellBounds(int row, int columnId) const
+{
+    auto column = header.getColumnPosition(header.getIndexOfColumnId(columnId, true));
+    int y = row * rowHeight - (int)scrollBar.getCurrentRangeStart();
+    return { column.getX(), y, column.getWidth(), rowHeight };
+}
+
+juce::String MappingTableComponent::formatLearnedTime(double t) const
+{
+    if (t < 0.0)
+        return {};
 
-    g.setColour(juce::Colours::black);
-    g.drawText(text,
-        2, 0,
-        width - 4, height,
-        juce::Justification::centredLeft,
-        true);
+    int tot = int(t);
+    int hh = tot / 3600;
+    int mm = (tot % 3600) / 60;
+    int ss = tot % 60;
+    int ff = int((t - tot) * processor.getFrameRate());
+    return juce::String::formatted("%02d:%02d:%02d:%02d", hh, mm, ss, ff);
 }
 
+//==============================================================================
 /**
- * @brief Provide in-cell editors and buttons for each column.
+ * @brief Paints only the rows that intersect the visible area.
  */
-juce::Component* MappingTableComponent::refreshComponentForCell(int row,
-    int columnId,
-    bool /*selected*/,
-    juce::Component* existing)
+void MappingTableComponent::paintRows(juce::Graphics& g)
 {
-    if (row < 0 || row >= getNumRows())
-        return nullptr;
+    const auto& cues = processor.getCues();
+    const int activeIndex = processor.getActiveMappingIndex();
+    const int numRows = searchIndex.getNumMatches();
+    const int scrollY = (int)scrollBar.getCurrentRangeStart();
+    const int width = rowArea.getWidth();
+    const int height = rowArea.getHeight();
 
-    auto& m = processor.getMappings()[row];
+    g.fillAll(juce::Colours::white);
+    g.setFont(14.0f);
 
-    // 1) Label editor
-    if (columnId == 1)
+    // The cues changed since the index was built; refreshTable() catches up shortly
+    if (cues.getStoreId() != indexedStoreId || cues.getContentVersion() != indexedVersion)
+        return;
+
+    for (int row = scrollY / rowHeight; row < numRows; ++row)
     {
-        auto* ed = dynamic_cast<juce::TextEditor*>(existing);
-        if (!ed)
+        int y = row * rowHeight - scrollY;
+        if (y >= height)
+            break;
+
+        int index = searchIndex.getMatch(row);
+        if (index == activeIndex)
         {
-            ed = new juce::TextEditor();
-            ed->setFont(14.0f);
-            ed->onTextChange = [this, row, ed]()
-                {
-                    processor.getMappings()[row].setLabel(ed->getText());
-                };
+            g.setColour(juce::Colours::lightblue);
+            g.fillRect(0, y, width, rowHeight);
         }
-        ed->setText(m.getLabel(), juce::dontSendNotification);
-        return ed;
-    }
+        g.setColour(juce::Colours::lightgrey);
+        g.drawHorizontalLine(y + rowHeight - 1, 0.0f, (float)width);
 
-    // 2) MIDI Note ComboBox
-    if (columnId == 2)
-    {
-        auto* cb = dynamic_cast<juce::ComboBox*>(existing);
-        if (!cb)
+        for (int columnId = labelColumn; columnId <= deleteColumn; ++columnId)
         {
-            cb = new juce::ComboBox();
-            static const char* names[] = { "C","C#","D","D#","E","F","F#","G","G#","A","A#","B" };
-            for (int i = 0; i < 128; ++i)
-                cb->addItem(names[i % 12] + juce::String(i / 12 - 1), i + 1);
-            cb->onChange = [this, row, cb]()
-                {
-                    processor.getMappings()[row].setMidiNote(cb->getSelectedId() - 1);
-                };
+            auto cell = getCellBounds(row, columnId);
+            juce::String text;
+
+            switch (columnId)
+            {
+            case labelColumn:    text = cues.getLabel(index); break;
+            case noteColumn:     text = notePicker.getItemText(cues.getMidiNote(index)); break;
+            case timecodeColumn: text = cues.getTimecodeString(index); break;
+            case preRollColumn:  text = juce::String(cues.getPreRollFrames(index)); break;
+            case startColumn:    text = formatLearnedTime(cues.getDetectedStartTime(index)); break;
+            case endColumn:      text = formatLearnedTime(cues.getDetectedEndTime(index)); break;
+
+            default: // painted buttons
+            {
+                auto b = cell.reduced(3, 2).toFloat();
+                g.setColour(juce::Colours::darkgrey);
+                g.fillRoundedRectangle(b, 3.0f);
+                g.setColour(juce::Colours::white);
+                g.drawText(columnId == setStartColumn ? "Set Start"
+                    : columnId == setEndColumn ? "Set End" : "Delete",
+                    b, juce::Justification::centred, false);
+                continue;
+            }
+            }
+
+            g.setColour(juce::Colours::black);
+            g.drawText(text, cell.reduced(2, 0), juce::Justification::centredLeft, true);
         }
-        cb->setSelectedId(m.getMidiNote() + 1, juce::dontSendNotification);
-        return cb;
     }
+}
+
+/**
+ * @brief Resolves the clicked row to a cue id and edits the cell or runs its button.
+ */
+void MappingTableComponent::rowAreaClicked(const juce::MouseEvent& e)
+{
+    commitEdit();
+
+    int row = ((int)scrollBar.getCurrentRangeStart() + e.y) / rowHeight;
+    if (row < 0 || row >= searchIndex.getNumMatches())
+        return;
+
+    auto& cues = processor.getCues();
+    if (cues.getStoreId() != indexedStoreId || cues.getContentVersion() != indexedVersion)
+        return;
 
-    // 3) Mapping Timecode editor
-    if (columnId == 3)
+    int index = searchIndex.getMatch(row);
+    int columnId = header.getColumnIdAtX(e.x);
+
+    switch (columnId)
     {
-        auto* ed = dynamic_cast<juce::TextEditor*>(existing);
-        if (!ed)
-        {
-            ed = new juce::TextEditor();
-            ed->setFont(14.0f);
-            ed->onTextChange = [this, row, ed]()
-                {
-                    processor.getMappings()[row].setTimecodeString(ed->getText());
-                };
-        }
-        ed->setText(m.getTimecodeString(), juce::dontSendNotification);
-        return ed;
-    }
+    case labelColumn:
+    case noteColumn:
+    case timecodeColumn:
+    case preRollColumn:
+        beginEdit(cues.getCueId(index), columnId, getCellBounds(row, columnId));
+        break;
 
-    // 4 & 6) Start and End as read-only TextEditors
-    if (columnId == 4 || columnId == 6)
+    case setStartColumn:
+    case setEndColumn:
     {
-        auto* ed = dynamic_cast<juce::TextEditor*>(existing);
-        if (!ed)
-        {
-            ed = new juce::TextEditor();
-            ed->setFont(14.0f);
-            ed->setReadOnly(true);
-            ed->setJustification(juce::Justification::centredLeft);
-        }
+        // On a copy as well, since the audio thread learns into the live bank. Times
+        // are not searched, so the index stays current across the swap
+        const double now = processor.getBlockTime();
+        const bool start = columnId == setStartColumn;
+        const bool edited = processor.editActiveCues([index, now, start](CueStore& copy) {
+            if (start)
+                copy.setDetectedStartTime(index, now);
+            copy.setDetectedEndTime(index, start ? -1.0 : now);
+            copy.setIsActive(index, false);
+            }, { cues.getCueId(index) });
 
-        double t = (columnId == 4)
-            ? m.getDetectedStartTime()
-            : m.getDetectedEndTime();
+        if (edited)
+            indexedVersion = processor.getCues().getContentVersion();
+        rowArea.repaint();
+        break;
+    }
 
-        juce::String txt;
-        if (t >= 0.0)
-        {
-            int tot = int(t);
-            int hh = tot / 3600;
-            int mm = (tot % 3600) / 60;
-            int ss = tot % 60;
-            int ff = int((t - tot) * processor.getFrameRate());
-            txt = juce::String::formatted("%02d:%02d:%02d:%02d", hh, mm, ss, ff);
-        }
+    case deleteColumn:
+        processor.removeMapping(index);
+        refreshTable();
+        break;
 
-        ed->setText(txt, juce::dontSendNotification);
-        return ed;
+    default:
+        break;
     }
+}
+
+//==============================================================================
+void MappingTableComponent::beginEdit(CueStore::CueId id, int columnId,
+    juce::Rectangle<int> cellBounds)
+{
+    auto& cues = processor.getCues();
+    int index = cues.indexOfCue(id);
+    if (index < 0)
+        return;
+
+    editingCue = id;
+    editingStoreId = cues.getStoreId();
+    editingColumn = columnId;
 
-    // 5) Set Start button
-    if (columnId == 5)
+    if (columnId == noteColumn)
     {
-        auto* btn = dynamic_cast<juce::TextButton*>(existing);
-        if (!btn)
-        {
-            btn = new juce::TextButton("Set Start");
-            btn->onClick = [this, row]()
-                {
-                    double now = processor.getPlayheadTime();
-                    auto& mm = processor.getMappings()[row];
-                    mm.setDetectedStartTime(now);
-                    mm.setDetectedEndTime(-1.0);
-                    mm.setIsActive(false);
-                    table.updateContent();
-                };
-        }
-        return btn;
+        notePicker.setSelectedId(cues.getMidiNote(index) + 1, juce::dontSendNotification);
+        notePicker.setBounds(cellBounds);
+        notePicker.setVisible(true);
+        notePicker.showPopup();
     }
-
-    // 7) Set End button
-    if (columnId == 7)
+    else
     {
-        auto* btn = dynamic_cast<juce::TextButton*>(existing);
-        if (!btn)
-        {
-            btn = new juce::TextButton("Set End");
-            btn->onClick = [this, row]()
-                {
-                    double now = processor.getPlayheadTime();
-                    auto& mm = processor.getMappings()[row];
-                    mm.setDetectedEndTime(now);
-                    mm.setIsActive(false);
-                    table.updateContent();
-                };
-        }
-        return btn;
+        cellEditor.setText(columnId == labelColumn ? cues.getLabel(index)
+            : columnId == preRollColumn ? juce::String(cues.getPreRollFrames(index))
+            : cues.getTimecodeString(index), juce::dontSendNotification);
+        cellEditor.setBounds(cellBounds);
+        cellEditor.setVisible(true);
+        cellEditor.grabKeyboardFocus();
+        cellEditor.selectAll();
     }
+}
 
-    // 8) Delete button
-    if (columnId == 8)
+/**
+ * @brief Writes the edit back by cue id, so a row deleted or filtered away in the
+ * meantime can never receive another cue's edit.
+ */
+void MappingTableComponent::commitEdit()
+{
+    if (editingCue == 0)
+        return;
+
+    auto id = editingCue;
+    auto column = editingColumn;
+    editingCue = 0; // first, so focus changes below don't re-enter
+    editingColumn = 0;
+
+    // Ids are per bank: an edit started before a bank switch is dropped. The edit is
+    // made on a copy of the bank, which is then swapped in (see editActiveCues())
+    const auto& before = processor.getCues();
+    int index = before.getStoreId() == editingStoreId ? before.indexOfCue(id) : -1;
+    if (index >= 0)
     {
-        auto* btn = dynamic_cast<juce::TextButton*>(existing);
-        if (!btn)
+        const bool indexWasCurrent = indexedVersion == before.getContentVersion();
+        const auto text = cellEditor.getText();
+        const int note = notePicker.getSelectedId() - 1;
+
+        const bool edited = processor.editActiveCues([index, column, &text, note](CueStore& cues) {
+            if (column == labelColumn)
+                cues.setLabel(index, text);
+            else if (column == timecodeColumn)
+                cues.setTimecodeString(index, text.trim());
+            else if (column == preRollColumn)
+                cues.setPreRollFrames(index, juce::jlimit(0, MTCGenAudioProcessor::maxPreRollFrames,
+                    text.trim().getIntValue()));
+            else if (column == noteColumn && note >= 0)
+                cues.setMidiNote(index, note);
+            });
+
+        // Only this cue changed, so the index is patched rather than rebuilt
+        const auto& cues = processor.getCues();
+        if (edited && indexWasCurrent)
         {
-            btn = new juce::TextButton("Delete");
-            btn->onClick = [this, row]()
-                {
-                    processor.removeMapping(row);
-                    table.updateContent();
-                };
+            searchIndex.updateCue(cues, index);
+            indexedVersion = cues.getContentVersion();
+            updateScrollRange();
         }
-        return btn;
     }
 
-    return nullptr;
+    cellEditor.setVisible(false);
+    notePicker.setVisible(false);
+    rowArea.repaint();
+}
+
+void MappingTableComponent::cancelEdit()
+{
+    editingCue = 0;
+    editingColumn = 0;
+    cellEditor.setVisible(false);
+    notePicker.setVisible(false);
+}
+
+//==============================================================================
+void MappingTableComponent::scrollBarMoved(juce::ScrollBar*, double)
+{
+    commitEdit();
+    rowArea.repaint();
+}
+
+void MappingTableComponent::tableColumnsChanged(juce::TableHeaderComponent*)
+{
+    commitEdit();
+    rowArea.repaint();
+}
+
+void MappingTableComponent::tableColumnsResized(juce::TableHeaderComponent*)
+{
+    commitEdit();
+    rowArea.repaint();
+}
+
+void MappingTableComponent::mouseWheelMove(const juce::MouseEvent&,
+    const juce::MouseWheelDetails& wheel)
+{
+    scrollBar.setCurrentRangeStart(scrollBar.getCurrentRangeStart()
+        - wheel.deltaY * rowHeight * 10.0);
 }
 
 /**
- * @brief Called when the "Add Mapping" button is clicked.
+ * @brief Handles the "Add Mapping", add/remove bank, import and library buttons.
  */
 void MappingTableComponent::buttonClicked(juce::Button* b)
 {
     if (b == &addMappingButton)
     {
-        auto& v = processor.getMappings();
-        int note = v.empty() ? 60 : v.back().getMidiNote() + 1;
-        v.emplace_back("00:00:00:00", note, "New Mapping");
-        table.updateContent();
+        const auto& cues = processor.getCues();
+        int note = cues.isEmpty() ? 60 : juce::jmin(127, cues.getMidiNote(cues.size() - 1) + 1);
+        processor.editActiveCues([note](CueStore& copy) {
+            copy.add(MappingEntry("00:00:00:00", note, "New Mapping"));
+            });
+        refreshTable();
+        scrollBar.scrollToBottom();
+    }
+    else if (b == &addBankButton)
+    {
+        int index = processor.addBank("Bank " + juce::String(processor.getBanks().getNumBanks() + 1));
+        if (index >= 0)
+            processor.selectBank(index);
+        refreshTable();
+    }
+    else if (b == &removeBankButton)
+    {
+        processor.removeBank(processor.getBanks().getActiveIndex());
+        refreshTable();
+    }
+    else if (b == &importButton)
+    {
+        importChooser = std::make_unique<juce::FileChooser>("Learn cue times from a MIDI file",
+            juce::File::getSpecialLocation(juce::File::userDocumentsDirectory), "*.mid;*.midi");
+
+        const auto flags = juce::FileBrowserComponent::openMode
+            | juce::FileBrowserComponent::canSelectFiles;
+
+        // Even long shows parse in milliseconds, so this stays on the message thread
+        importChooser->launchAsync(flags, [this](const juce::FileChooser& chooser) {
+            const auto file = chooser.getResult();
+            if (file == juce::File())
+                return;
+
+            TriggerFileImporter::Summary summary;
+            juce::String error;
+            const bool ok = TriggerFileImporter::importFile(processor, file, summary, error);
+            refreshTable();
+
+            juce::AlertWindow::showMessageBoxAsync(
+                ok ? juce::MessageBoxIconType::InfoIcon : juce::MessageBoxIconType::WarningIcon,
+                "Import MIDI", ok ? summary.describe() : error);
+            });
+    }
+    else if (b == &libraryButton)
+    {
+        showLibraryMenu();
     }
 }
 
+void MappingTableComponent::showLibraryMenu()
+{
+    enum { linkItem = 1, saveItem, unlinkItem };
+
+    const auto* library = processor.getCueLibrary();
+    juce::PopupMenu menu;
+    if (library != nullptr)
+        menu.addSectionHeader("Linked to " + library->getFile().getFileName());
+    else if (processor.getCueLibraryError().isNotEmpty())
+        menu.addSectionHeader(processor.getCueLibraryError());
+    menu.addItem(linkItem, "Link Cue Library...");
+    menu.addItem(saveItem, "Save Banks as Cue Library...");
+    menu.addItem(unlinkItem, "Unlink (Keep a Copy of the Cues)", library != nullptr);
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&libraryButton),
+        [this](int result) {
+            if (result == unlinkItem)
+            {
+                processor.unlinkCueLibrary();
+                refreshTable();
+                return;
+            }
+            if (result != linkItem && result != saveItem)
+                return;
+
+            const bool save = result == saveItem;
+            libraryChooser = std::make_unique<juce::FileChooser>(
+                save ? "Save the cue banks as a library" : "Link a cue library",
+                juce::File::getSpecialLocation(juce::File::userDocumentsDirectory),
+                juce::String("*") + CueLibrary::fileExtension);
+
+            const auto flags = (save ? juce::FileBrowserComponent::saveMode
+                                        | juce::FileBrowserComponent::warnAboutOverwriting
+                                     : juce::FileBrowserComponent::openMode)
+                | juce::FileBrowserComponent::canSelectFiles;
+
+            libraryChooser->launchAsync(flags, [this, save](const juce::FileChooser& chooser) {
+                auto file = chooser.getResult();
+                if (file == juce::File())
+                    return;
+
+                if (save)
+                {
+                    file = file.withFileExtension(CueLibrary::fileExtension);
+                    juce::String error;
+                    if (!CueLibrary::write(processor.getBanks(), file, error))
+                    {
+                        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                            "Cue Library", error);
+                        return;
+                    }
+                }
+                linkLibrary(file);
+                });
+        });
+}
+
+void MappingTableComponent::linkLibrary(const juce::File& file)
+{
+    commitEdit();
+    juce::String error;
+    if (!processor.linkCueLibrary(file, error))
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+            "Cue Library", error);
+    refreshTable();
+}
+
 //==============================================================================
 // Paint the component background
 void MappingTableComponent::paint(juce::Graphics& g)
@@ -267,10 +553,23 @@ void MappingTableComponent::paint(juce::Graphics& g)
     g.fillAll(juce::Colours::lightgrey);
 }
 
-// Layout the button and the table
+// Layout the button, search box, header, rows and scrollbar
 void MappingTableComponent::resized()
 {
     auto area = getLocalBounds().reduced(4);
-    addMappingButton.setBounds(area.removeFromTop(30));
-    table.setBounds(area);
+
+    auto top = area.removeFromTop(30);
+    addMappingButton.setBounds(top.removeFromLeft(100));
+    bankComboBox.setBounds(top.removeFromLeft(140).reduced(4, 2));
+    addBankButton.setBounds(top.removeFromLeft(28).reduced(0, 2));
+    removeBankButton.setBounds(top.removeFromLeft(28).reduced(0, 2));
+    importButton.setBounds(top.removeFromLeft(110).reduced(4, 2));
+    libraryButton.setBounds(top.removeFromLeft(76).reduced(4, 2));
+    searchBox.setBounds(top.reduced(4, 2));
+
+    scrollBar.setBounds(area.removeFromRight(14));
+    header.setBounds(area.removeFromTop(24));
+    rowArea.setBounds(area);
+
+    updateScrollRange();
 }
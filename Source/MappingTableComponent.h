@@ -13,21 +13,36 @@
 
 #include <JuceHeader.h>
 #include "MTCGenProcessor.h"
+#include "CueSearchIndex.h"
 
 /**
  * @brief A component for displaying and editing mapping entries.
  *
+ * Rows are painted directly rather than built from per-cell components, so only
+ * the visible rows cost anything and the table scales to tens of thousands of cues.
+ * A single TextEditor and a single note ComboBox are moved over the cell being
+ * edited. Edits and buttons act on stable cue ids, resolved to an index only at
+ * the moment they are applied.
+ *
+ * The table shows the active cue bank. The bank box above it selects, renames (type
+ * into it), adds and removes banks; a program change switching banks on the audio
+ * thread is picked up by refreshTable().
+ *
  * Columns:
  * 1. Label           (editable)
  * 2. MIDI Note       (editable)
  * 3. Mapping Timecode(editable)
- * 4. Start           (read‑only)
- * 5. Set Start       (button)
- * 6. Delete          (button)
+ * 4. Pre-roll        (editable, frames)
+ * 5. Start           (read‑only)
+ * 6. Set Start       (button)
+ * 7. End             (read‑only)
+ * 8. Set End         (button)
+ * 9. Delete          (button)
  */
 class MappingTableComponent : public juce::Component,
-    public juce::TableListBoxModel,
-    public juce::Button::Listener
+    public juce::Button::Listener,
+    private juce::ScrollBar::Listener,
+    private juce::TableHeaderComponent::Listener
 {
 public:
     MappingTableComponent(MTCGenAudioProcessor& proc);
@@ -35,19 +50,114 @@ public:
 
     void paint(juce::Graphics&) override;
     void resized() override;
-    int getNumRows() override;
-
-    void paintRowBackground(juce::Graphics&, int row, int width, int height, bool) override;
-    void paintCell(juce::Graphics&, int row, int columnId, int width, int height, bool) override;
-    juce::Component* refreshComponentForCell(int row, int columnId, bool, juce::Component*) override;
+    void mouseWheelMove(const juce::MouseEvent&, const juce::MouseWheelDetails&) override;
 
     void buttonClicked(juce::Button* button) override;
-    void refreshTable() { table.updateContent(); }
+
+    /**
+     * @brief Picks up changes from the processor, including a bank switch. Cheap when
+     * nothing changed.
+     */
+    void refreshTable();
 
 private:
+    enum ColumnIds
+    {
+        labelColumn = 1,
+        noteColumn,
+        timecodeColumn,
+        preRollColumn,
+        startColumn,
+        setStartColumn,
+        endColumn,
+        setEndColumn,
+        deleteColumn
+    };
+
+    /**
+     * @brief The scrolling row area. Paints visible rows and forwards clicks.
+     */
+    class RowArea : public juce::Component
+    {
+    public:
+        explicit RowArea(MappingTableComponent& o) : owner(o) {}
+        void paint(juce::Graphics& g) override { owner.paintRows(g); }
+        void mouseDown(const juce::MouseEvent& e) override { owner.rowAreaClicked(e); }
+        void mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& w) override
+        {
+            owner.mouseWheelMove(e, w);
+        }
+
+    private:
+        MappingTableComponent& owner;
+    };
+
+    static constexpr int rowHeight = 22;
+
+    void scrollBarMoved(juce::ScrollBar*, double) override;
+    void tableColumnsChanged(juce::TableHeaderComponent*) override;
+    void tableColumnsResized(juce::TableHeaderComponent*) override;
+    void tableSortOrderChanged(juce::TableHeaderComponent*) override {}
+
+    /** Paints the rows that intersect the RowArea. */
+    void paintRows(juce::Graphics&);
+
+    /** Handles a click in the RowArea: starts an edit or runs a button. */
+    void rowAreaClicked(const juce::MouseEvent&);
+
+    /** Shows the shared editor/picker over a cell of the given cue. */
+    void beginEdit(CueStore::CueId id, int columnId, juce::Rectangle<int> cellBounds);
+
+    /** Applies the shared editor's text to the cue being edited. */
+    void commitEdit();
+
+    /** Hides the shared editor/picker without applying anything. */
+    void cancelEdit();
+
+    /** Refills the bank box from the processor's banks. */
+    void updateBankList();
+
+    /** Re-computes scroll range after the number of visible rows changed. */
+    void updateScrollRange();
+
+    /** Area of a cell in RowArea coordinates. */
+    juce::Rectangle<int> getCellBounds(int row, int columnId) const;
+
+    /** Shows the cue library menu: link, save the banks as a library, unlink. */
+    void showLibraryMenu();
+
+    /** Links the processor to a library file and reports failure. */
+    void linkLibrary(const juce::File& file);
+
+    /** Formats a learned time (s) as HH:MM:SS:FF, or empty if unset. */
+    juce::String formatLearnedTime(double t) const;
+
     MTCGenAudioProcessor& processor;
-    juce::TableListBox    table;
+    CueSearchIndex        searchIndex;
+    juce::uint32          indexedStoreId{ 0 };  /**< Bank the index was built from */
+    juce::uint32          indexedVersion{ 0 };  /**< CueStore content version the index reflects */
+    juce::uint32          shownBanksVersion{ 0 };
+    juce::uint32          paintedTimesVersion{ 0 };
+    int                   paintedActiveIndex{ -1 };
+
     juce::TextButton      addMappingButton{ "Add Mapping" };
+    juce::ComboBox        bankComboBox;
+    juce::TextButton      addBankButton{ "+" };
+    juce::TextButton      removeBankButton{ "-" };
+    juce::TextButton      importButton{ "Import MIDI..." };
+    std::unique_ptr<juce::FileChooser> importChooser;
+    juce::TextButton      libraryButton{ "Library..." };
+    std::unique_ptr<juce::FileChooser> libraryChooser;
+    juce::TextEditor      searchBox;
+    juce::TableHeaderComponent header;
+    RowArea               rowArea{ *this };
+    juce::ScrollBar       scrollBar{ true };
+
+    juce::TextEditor      cellEditor;  /**< Shared inline editor for label, timecode and pre-roll */
+    juce::ComboBox        notePicker;  /**< Shared 128-note picker */
+    CueStore::CueId       editingCue{ 0 };
+    juce::uint32          editingStoreId{ 0 };  /**< Bank editingCue belongs to */
+    int                   editingColumn{ 0 };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MappingTableComponent)
 };
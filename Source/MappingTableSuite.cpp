@@ -0,0 +1,211 @@
+/**
+ * @file MappingTableSuite.cpp
+ * @brief Definitions for MappingTableSuite methods.
+ */
+
+#include "MappingTableSuite.h"
+#include "CueSearchIndex.h"
+#include "MTCGenProcessor.h"
+
+namespace
+{
+    constexpr double frameMs = 1000.0 / 60.0;
+
+    /** Fills a store with numCues cues of varied labels, notes and timecodes. */
+    void fillStore(CueStore& cues, int numCues)
+    {
+        cues.reserve(numCues);
+        for (int i = 0; i < numCues; ++i)
+            cues.add(MappingEntry(juce::String::formatted("%02d:%02d:%02d:%02d",
+                                      i / 3600 % 24, i / 60 % 60, i % 60, i % 25),
+                i % 128, "Cue " + juce::String(i) + " scene " + juce::String(i % 37)));
+    }
+
+    /** What the index is documented to search: "label note timecode", lower case. */
+    juce::StringArray describeAll(const CueStore& cues)
+    {
+        juce::StringArray haystacks;
+        for (int i = 0; i < cues.size(); ++i)
+            haystacks.add((cues.getLabel(i) + " "
+                + juce::MidiMessage::getMidiNoteName(cues.getMidiNote(i), true, true, 4) + " "
+                + cues.getTimecodeString(i)).toLowerCase());
+        return haystacks;
+    }
+
+    /** The cues whose haystack holds every term of query, by testing each one. */
+    std::vector<int> scanAll(const juce::StringArray& haystacks, const juce::String& query)
+    {
+        auto terms = juce::StringArray::fromTokens(query.toLowerCase(), " \t", "");
+        terms.removeEmptyStrings();
+
+        std::vector<int> found;
+        for (int i = 0; i < haystacks.size(); ++i)
+        {
+            bool all = true;
+            for (auto& term : terms)
+                all = all && haystacks[i].contains(term);
+            if (all)
+                found.push_back(i);
+        }
+        return found;
+    }
+
+    std::vector<int> matchesOf(const CueSearchIndex& index)
+    {
+        std::vector<int> m;
+        for (int n = 0; n < index.getNumMatches(); ++n)
+            m.push_back(index.getMatch(n));
+        return m;
+    }
+
+    /** Four cues, queried by each field, by several terms, and after an edit. */
+    MtcGoldenSuite::Result checkFilter()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "search_filter";
+
+        CueStore cues;
+        cues.add(MappingEntry("00:10:00:00", 60, "Intro"));
+        cues.add(MappingEntry("00:20:00:00", 61, "Verse One"));
+        cues.add(MappingEntry("01:00:00:00", 62, "Verse Two"));
+        cues.add(MappingEntry("01:10:00:00", 60, "Finale"));
+
+        CueSearchIndex index;
+        index.rebuild(cues);
+
+        const struct { const char* query; std::vector<int> expected; } cases[] = {
+            { "",             { 0, 1, 2, 3 } },
+            { "VERSE",        { 1, 2 } },
+            { "verse t",      { 2 } },
+            { "verse two",    { 2 } },
+            { "verse",        { 1, 2 } },  // widened again
+            { "c4",           { 0, 3 } },  // note 60
+            { "c#4",          { 1 } },
+            { "01:",          { 2, 3 } },
+            { "01: c4",       { 3 } },
+            { "nothing",      {} }
+        };
+        for (auto& c : cases)
+        {
+            index.setQuery(c.query);
+            if (matchesOf(index) != c.expected)
+            {
+                r.message = juce::String("query '") + c.query + "' matched "
+                    + juce::String(index.getNumMatches()) + " cues";
+                return r;
+            }
+        }
+
+        // An edit moves a cue into, then out of, the current result
+        index.setQuery("finale");
+        cues.setLabel(0, "Finale Reprise");
+        index.updateCue(cues, 0);
+        const bool added = matchesOf(index) == std::vector<int>{ 0, 3 };
+        cues.setLabel(3, "Encore");
+        index.updateCue(cues, 3);
+        const bool removed = matchesOf(index) == std::vector<int>{ 0 };
+
+        if (!added || !removed)
+            r.message = "updateCue() did not move the edited cue into and out of the matches";
+        else
+            r.passed = true;
+        return r;
+    }
+
+    /**
+     * Types two queries into a 50,000-cue index one character at a time, then deletes
+     * back. Every keystroke must filter within one 60 fps frame and agree with a full
+     * scan. The rebuild is reported; it runs when cues are added or removed, not while
+     * scrolling or typing.
+     */
+    MtcGoldenSuite::Result checkLargeIndex()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "search_50k";
+
+        constexpr int numCues = 50000;
+        CueStore cues;
+        fillStore(cues, numCues);
+
+        CueSearchIndex index;
+        auto start = juce::Time::getMillisecondCounterHiRes();
+        index.rebuild(cues);
+        const double rebuildMs = juce::Time::getMillisecondCounterHiRes() - start;
+        const auto haystacks = describeAll(cues);
+
+        juce::StringArray keystrokes;
+        for (auto* query : { "scene 12 c#", "cue 4999" })
+        {
+            const juce::String q(query);
+            for (int n = 1; n <= q.length(); ++n)
+                keystrokes.add(q.substring(0, n));
+            for (int n = q.length() - 1; n >= 0; --n)
+                keystrokes.add(q.substring(0, n));
+        }
+
+        double slowestMs = 0.0;
+        for (auto& query : keystrokes)
+        {
+            start = juce::Time::getMillisecondCounterHiRes();
+            index.setQuery(query);
+            slowestMs = juce::jmax(slowestMs, juce::Time::getMillisecondCounterHiRes() - start);
+
+            if (matchesOf(index) != scanAll(haystacks, query))
+            {
+                r.message = "query '" + query + "' disagrees with a full scan";
+                return r;
+            }
+        }
+
+        r.passed = slowestMs < frameMs;
+        r.message = juce::String::formatted("%d cues: rebuild %.1f ms, %d keystrokes, slowest %.2f ms%s",
+            numCues, rebuildMs, keystrokes.size(), slowestMs,
+            r.passed ? "" : " (over one 60 fps frame)");
+        return r;
+    }
+
+    /**
+     * The table's Set Start and Set End go through editActiveCues() with the cue in
+     * timesSet: the times land in the published copy, the bank it replaced keeps the
+     * times it had, and the other cues keep theirs.
+     */
+    MtcGoldenSuite::Result checkSetTimes()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "set_times_copy";
+
+        MTCGenAudioProcessor processor;
+        const int second = MtcGoldenSuite::addSecondCue(processor);
+        processor.editActiveCues([second](CueStore& cues) {
+            cues.setDetectedStartTime(second, 4.0);
+            cues.setDetectedEndTime(second, 6.0);
+            }, { processor.getCues().getCueId(second) });
+
+        const auto& before = processor.getCues();
+        const auto id = before.getCueId(0);
+        const bool edited = processor.editActiveCues([](CueStore& copy) {
+            copy.setDetectedStartTime(0, 12.5);
+            copy.setDetectedEndTime(0, -1.0);
+            copy.setIsActive(0, false);
+            }, { id });
+        const auto& after = processor.getCues();
+
+        if (!edited || &after == &before)
+            r.message = "the edit was not swapped in";
+        else if (before.getDetectedStartTime(0) != -1.0)
+            r.message = "the bank it replaced was written";
+        else if (after.getDetectedStartTime(0) != 12.5 || after.getDetectedEndTime(0) != -1.0)
+            r.message = "the new start time was not published";
+        else if (after.getDetectedStartTime(second) != 4.0 || after.getDetectedEndTime(second) != 6.0)
+            r.message = "the other cue lost its learned times";
+        else
+            r.passed = true;
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> MappingTableSuite::run()
+{
+    return { checkFilter(), checkLargeIndex(), checkSetTimes() };
+}
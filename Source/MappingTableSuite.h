@@ -0,0 +1,31 @@
+/**
+ * @file MappingTableSuite.h
+ * @brief Declaration of MappingTableSuite, checks of what the mapping table relies on.
+ */
+
+#ifndef MAPPINGTABLESUITE_H_INCLUDED
+#define MAPPINGTABLESUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class MappingTableSuite
+ * @brief Checks the parts of the mapping table that run without a window:
+ *
+ * - "search_filter": CueSearchIndex matching label, note name and timecode, several
+ *   terms, narrowing, widening and updateCue()
+ * - "search_50k": a 50,000-cue index, each keystroke of a query timed against one
+ *   60 fps frame and checked against a full scan
+ * - "set_times_copy": Set Start / Set End's edit, made on a copy of the bank with the
+ *   cue in timesSet, leaves the bank it replaced untouched
+ */
+class MappingTableSuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // MAPPINGTABLESUITE_H_INCLUDED
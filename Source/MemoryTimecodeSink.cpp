@@ -0,0 +1,36 @@
+/**
+ * @file MemoryTimecodeSink.cpp
+ * @brief Definitions for MemoryTimecodeSink methods.
+ */
+
+#include "MemoryTimecodeSink.h"
+#include <algorithm>
+
+//==============================================================================
+MemoryTimecodeSink::MemoryTimecodeSink(int capacity)
+    : storage((size_t)juce::jmax(0, capacity))
+{
+}
+
+void MemoryTimecodeSink::handleTimecodeEvents(const Event* events, int count)
+{
+    const int n = numEvents.load(std::memory_order_relaxed);
+    const int numToCopy = juce::jmin(count, (int)storage.size() - n);
+    if (numToCopy < count)
+        dropped.fetch_add(count - numToCopy, std::memory_order_relaxed);
+
+    std::copy(events, events + numToCopy, storage.begin() + n);
+    numEvents.store(n + numToCopy, std::memory_order_release);
+}
+
+std::vector<TimecodeSink::Event> MemoryTimecodeSink::getEvents() const
+{
+    const int n = numEvents.load(std::memory_order_acquire);
+    return { storage.begin(), storage.begin() + n };
+}
+
+void MemoryTimecodeSink::clear() noexcept
+{
+    numEvents.store(0, std::memory_order_release);
+    dropped.store(0, std::memory_order_relaxed);
+}
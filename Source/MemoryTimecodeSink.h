@@ -0,0 +1,51 @@
+/**
+ * @file MemoryTimecodeSink.h
+ * @brief Declaration of the MemoryTimecodeSink class, a TimecodeSink that keeps the events.
+ */
+
+#ifndef MEMORYTIMECODESINK_H_INCLUDED
+#define MEMORYTIMECODESINK_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+#include "TimecodeSink.h"
+
+/**
+ * @class MemoryTimecodeSink
+ * @brief Records the events it receives into storage allocated up front, for tests and
+ * for checking what a sink sees.
+ *
+ * Recording copies into the preallocated buffer and publishes the new count with one
+ * atomic store, so the sink can be registered as realtime; events beyond the capacity
+ * are dropped and counted. Any thread may read what has been recorded so far.
+ */
+class MemoryTimecodeSink : public TimecodeSink
+{
+public:
+    /** Constructor: allocates room for capacity events. */
+    explicit MemoryTimecodeSink(int capacity = 65536);
+
+    void handleTimecodeEvents(const Event* events, int numEvents) override;
+
+    /** @brief Copy of the events recorded so far. Any thread. */
+    std::vector<Event> getEvents() const;
+
+    /** @brief Number of events recorded so far. Any thread. */
+    int getNumEvents() const noexcept { return numEvents.load(std::memory_order_acquire); }
+
+    /** @brief Events that did not fit. */
+    juce::int64 getNumDropped() const noexcept { return dropped.load(std::memory_order_relaxed); }
+
+    /** @brief Forgets the recorded events. Only while the sink is not registered. */
+    void clear() noexcept;
+
+private:
+    std::vector<Event> storage;
+    std::atomic<int> numEvents{ 0 };
+    std::atomic<juce::int64> dropped{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MemoryTimecodeSink)
+};
+
+#endif // MEMORYTIMECODESINK_H_INCLUDED
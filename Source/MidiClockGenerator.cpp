@@ -0,0 +1,108 @@
+/**
+ * @file MidiClockGenerator.cpp
+ * @brief Definitions for MidiClockGenerator methods.
+ */
+
+#include "MidiClockGenerator.h"
+#include "TraceRecorder.h"
+#include <cmath>
+
+namespace
+{
+    /** Host positions are doubles; treat anything closer than this (in ticks) as equal. */
+    constexpr double tickEpsilon = 1.0e-4;
+}
+
+//==============================================================================
+void MidiClockGenerator::process(juce::MidiBuffer& out, bool playing, double ppq, double bpm,
+    int numSamples, double sampleRate, int startSample) noexcept
+{
+    MTCGEN_TRACE_SCOPE("midiClock");
+    if (bpm <= 0.0 || sampleRate <= 0.0 || numSamples <= 0)
+        return;
+
+    const double samplesPerQuarter = sampleRate * 60.0 / bpm;
+    // Half a tick of slack before a position change counts as a jump
+    const bool located = havePosition
+        && std::abs(ppq - expectedPpq) * ticksPerQuarter > 0.5;
+
+    if (!playing)
+    {
+        if (wasPlaying)
+            out.addEvent(juce::MidiMessage::midiStop(), startSample);
+        if (wasPlaying || located || !havePosition)
+            addSongPosition(out, ppq, startSample);
+
+        wasPlaying = false;
+        havePosition = true;
+        expectedPpq = ppq;
+        return;
+    }
+
+    if (!wasPlaying)
+    {
+        if (std::abs(ppq) * ticksPerQuarter < tickEpsilon)
+        {
+            out.addEvent(juce::MidiMessage::midiStart(), startSample);
+            lastTick = -1;
+        }
+        else
+        {
+            // A stop already sent the SPP for this position unless the host moved since
+            if (located || !havePosition)
+                addSongPosition(out, ppq, startSample);
+            out.addEvent(juce::MidiMessage::midiContinue(), startSample);
+        }
+    }
+    else if (located)
+    {
+        out.addEvent(juce::MidiMessage::midiStop(), startSample);
+        addSongPosition(out, ppq, startSample);
+        out.addEvent(juce::MidiMessage::midiContinue(), startSample);
+    }
+
+    // Ticks on the absolute grid that fall inside the part
+    auto tick = juce::jmax(lastTick + 1,
+        (juce::int64)std::ceil(ppq * ticksPerQuarter - tickEpsilon));
+
+    for (;; ++tick)
+    {
+        double offset = ((double)tick / ticksPerQuarter - ppq) * samplesPerQuarter;
+        int sample = juce::jmax(0, (int)std::floor(offset + tickEpsilon));
+        if (sample >= numSamples)
+            break;
+
+        out.addEvent(juce::MidiMessage::midiClock(), startSample + sample);
+        lastTick = tick;
+    }
+
+    wasPlaying = true;
+    havePosition = true;
+    expectedPpq = ppq + numSamples / samplesPerQuarter;
+}
+
+void MidiClockGenerator::stop(juce::MidiBuffer& out) noexcept
+{
+    if (wasPlaying)
+        out.addEvent(juce::MidiMessage::midiStop(), 0);
+    reset();
+}
+
+void MidiClockGenerator::reset() noexcept
+{
+    wasPlaying = false;
+    havePosition = false;
+    expectedPpq = 0.0;
+    lastTick = -1;
+}
+
+//==============================================================================
+void MidiClockGenerator::addSongPosition(juce::MidiBuffer& out, double ppq, int samplePosition) noexcept
+{
+    // SPP counts sixteenths (14 bits); round up so no tick before it is skipped over
+    auto sixteenth = (int)std::ceil(juce::jmax(0.0, ppq) * 4.0 - tickEpsilon);
+    sixteenth = juce::jlimit(0, 16383, sixteenth);
+
+    out.addEvent(juce::MidiMessage::songPositionPointer(sixteenth), samplePosition);
+    lastTick = (juce::int64)sixteenth * ticksPerSixteenth - 1;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file MidiClockGenerator.h
+ * @brief Declaration of the MidiClockGenerator class (24-PPQN MIDI Clock and SPP).
+ */
+
+#ifndef MIDICLOCKGENERATOR_H_INCLUDED
+#define MIDICLOCKGENERATOR_H_INCLUDED
+
+#include <JuceHeader.h>
+
+/**
+ * @class MidiClockGenerator
+ * @brief Turns the host's musical position into MIDI Clock, Start/Stop/Continue and
+ * Song Position Pointer messages, placed at exact sample offsets within a block.
+ *
+ * Called once per block from processBlock with the playhead's ppq position and tempo:
+ *  - transport starts at ppq 0: Start, then clocks from beat 0
+ *  - transport starts elsewhere: SPP to the next sixteenth, Continue, clocks from there
+ *  - transport jumps while playing (locate, loop): Stop, SPP, Continue
+ *  - transport jumps while stopped: SPP
+ *  - transport stops: Stop, SPP (so receivers resume from the right place)
+ *
+ * Clock ticks lie on the absolute 24-PPQN grid of the host position, so consecutive
+ * blocks never duplicate or drop a tick. Everything is computed in place; no allocation
+ * beyond what the destination MidiBuffer already holds.
+ */
+class MidiClockGenerator
+{
+public:
+    static constexpr int ticksPerQuarter = 24;  /**< MIDI Clock resolution */
+    static constexpr int ticksPerSixteenth = 6; /**< One SPP "MIDI beat" */
+
+    /**
+     * @brief Adds the clock and transport messages for one block, or for the part of
+     * one that starts at startSample.
+     * @param out Destination buffer (sample positions relative to the block start).
+     * @param playing Host transport state.
+     * @param ppq Host position in quarter notes at startSample.
+     * @param bpm Host tempo.
+     * @param numSamples Length of the part, from startSample.
+     * @param sampleRate Audio sample rate.
+     * @param startSample First sample of the part within the block.
+     */
+    void process(juce::MidiBuffer& out, bool playing, double ppq, double bpm,
+        int numSamples, double sampleRate, int startSample = 0) noexcept;
+
+    /**
+     * @brief Sends Stop if the clock was running and forgets the transport state
+     * (used when the generator is switched off).
+     */
+    void stop(juce::MidiBuffer& out) noexcept;
+
+    /** @brief Forgets the transport state without sending anything. */
+    void reset() noexcept;
+
+private:
+    /**
+     * @brief Adds an SPP for the first sixteenth at or after ppq and re-anchors the tick
+     * grid there, so the first clock after Continue lands on that sixteenth.
+     */
+    void addSongPosition(juce::MidiBuffer& out, double ppq, int samplePosition) noexcept;
+
+    bool wasPlaying{ false };
+    bool havePosition{ false };     /**< expectedPpq is valid */
+    double expectedPpq{ 0.0 };      /**< Where the next block starts if nothing jumps */
+    juce::int64 lastTick{ -1 };     /**< Last tick index sent (ppq * ticksPerQuarter) */
+};
+
+#endif // MIDICLOCKGENERATOR_H_INCLUDED
@@ -0,0 +1,128 @@
+/**
+ * @file MidiOutputRouter.cpp
+ * @brief Definitions for MidiOutputRouter methods.
+ */
+
+#include "MidiOutputRouter.h"
+#include "RealtimeAudit.h"
+#include "TraceRecorder.h"
+
+//==============================================================================
+MidiOutputRouter::MidiOutputRouter()
+    : juce::Thread("MIDI Out Watchdog")
+{
+    startThread(juce::Thread::Priority::low);
+}
+
+MidiOutputRouter::~MidiOutputRouter()
+{
+    stopThread(1000);
+    setOutputs({});
+}
+
+//==============================================================================
+/**
+ * @brief Keeps the senders of devices that are still selected (so their queues and
+ * health history survive), starts senders for new devices and stops the rest once
+ * the audio thread can no longer reach them.
+ */
+void MidiOutputRouter::setOutputs(const juce::Array<juce::MidiDeviceInfo>& devices)
+{
+    juce::OwnedArray<MidiPortSender> next;
+
+    {
+        MTCGEN_RT_LOCK("sendersLock");
+        const juce::ScopedLock sl(sendersLock);
+        for (auto& d : devices)
+        {
+            if (next.size() >= maxPorts)
+                break;
+
+            int existing = -1;
+            for (int i = 0; i < senders.size() && existing < 0; ++i)
+                if (senders[i]->getDevice().identifier == d.identifier)
+                    existing = i;
+
+            next.add(existing >= 0 ? senders.removeAndReturn(existing) : new MidiPortSender(d));
+        }
+
+        senders.swapWith(next); // next now holds the deselected senders
+    }
+
+    publish();
+
+    // A send() that started before publish() may still hold an old pointer
+    MTCGEN_RT_BLOCKING("MidiOutputRouter: wait for send()");
+    while (sendsInFlight.load() > 0)
+        juce::Thread::yield();
+
+    next.clear();
+}
+
+void MidiOutputRouter::publish()
+{
+    MTCGEN_RT_LOCK("sendersLock");
+    const juce::ScopedLock sl(sendersLock);
+    for (int i = 0; i < senders.size(); ++i)
+        ports[(size_t)i].store(senders[i]);
+    numPorts.store(senders.size());
+}
+
+//==============================================================================
+void MidiOutputRouter::send(const juce::uint8* data, int size, double dueMs) noexcept
+{
+    sendsInFlight.fetch_add(1);
+    const int n = numPorts.load();
+    for (int i = 0; i < n; ++i)
+        ports[(size_t)i].load()->push(data, size, dueMs);
+    sendsInFlight.fetch_sub(1);
+}
+
+void MidiOutputRouter::pushFrame(const Timecode& tc, int rateCode) noexcept
+{
+    sendsInFlight.fetch_add(1);
+    const int n = numPorts.load();
+    for (int i = 0; i < n; ++i)
+        ports[(size_t)i].load()->pushFrame(tc.pack(), rateCode);
+    sendsInFlight.fetch_sub(1);
+}
+
+std::vector<MidiOutputRouter::PortStatus> MidiOutputRouter::getStatus() const
+{
+    const juce::ScopedLock sl(sendersLock);
+    std::vector<PortStatus> status;
+    status.reserve((size_t)senders.size());
+    for (auto* s : senders)
+        status.push_back({ s->getDevice(), s->getHealth() });
+    return status;
+}
+
+//==============================================================================
+/**
+ * @brief Checks every sender a few times a second: device presence (for reconnects)
+ * and writes stuck in the driver.
+ */
+void MidiOutputRouter::run()
+{
+    while (!threadShouldExit())
+    {
+        MTCGEN_TRACE_THREAD("MIDI Out Watchdog");
+        if (hasOutputs())
+        {
+            MTCGEN_TRACE_SCOPE("watchdog");
+            auto available = juce::MidiOutput::getAvailableDevices();
+            auto now = juce::Time::getMillisecondCounterHiRes();
+
+            const juce::ScopedLock sl(sendersLock);
+            for (auto* s : senders)
+            {
+                bool present = false;
+                for (auto& d : available)
+                    present = present || d.identifier == s->getDevice().identifier;
+                s->watchdogCheck(now, present);
+            }
+        }
+
+        wait(watchdogIntervalMs);
+    }
+}
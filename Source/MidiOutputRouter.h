@@ -0,0 +1,89 @@
+/**
+ * @file MidiOutputRouter.h
+ * @brief Declaration of the MidiOutputRouter class that fans messages out to per-port senders.
+ */
+
+#ifndef MIDIOUTPUTROUTER_H_INCLUDED
+#define MIDIOUTPUTROUTER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "MidiPortSender.h"
+#include "Timecode.h"
+
+/**
+ * @class MidiOutputRouter
+ * @brief The selected MIDI output ports, each behind its own MidiPortSender, plus a
+ * watchdog thread that checks them.
+ *
+ * send() copies a message into every port's queue and returns; it never waits on a
+ * driver, so one stalled or vanished device cannot delay the others or the audio thread.
+ *
+ * The watchdog runs a few times a second: it looks up which devices are present
+ * (so senders can close a vanished port and reopen it when it returns) and flags any
+ * port whose current write has been stuck for longer than MidiPortSender::stallMs.
+ */
+class MidiOutputRouter : private juce::Thread
+{
+public:
+    static constexpr int maxPorts = 64;
+    static constexpr int watchdogIntervalMs = 250;
+
+    /** @brief Name and health of one port, for the editor. */
+    struct PortStatus
+    {
+        juce::MidiDeviceInfo device;
+        MidiPortSender::Health health;
+    };
+
+    /** Constructor: starts the watchdog. */
+    MidiOutputRouter();
+    /** Destructor: stops the watchdog and every sender. */
+    ~MidiOutputRouter() override;
+
+    /**
+     * @brief Replaces the set of ports. Senders for devices that stay selected are kept.
+     * Message thread.
+     */
+    void setOutputs(const juce::Array<juce::MidiDeviceInfo>& devices);
+
+    /**
+     * @brief Queues a message's raw bytes on every port. The same encoded bytes are
+     * copied into each queue. Realtime-safe.
+     * @param dueMs Wall-clock time to send it at (see MidiPortSender::push()).
+     */
+    void send(const juce::uint8* data, int size, double dueMs = 0.0) noexcept;
+
+    /**
+     * @brief Publishes the current frame, which lagging ports resync to. Realtime-safe.
+     */
+    void pushFrame(const Timecode& tc, int rateCode) noexcept;
+
+    /** @brief True if at least one port is selected. */
+    bool hasOutputs() const noexcept { return numPorts.load(std::memory_order_acquire) > 0; }
+
+    /** @brief Health of every selected port. Message thread. */
+    std::vector<PortStatus> getStatus() const;
+
+private:
+    /** Watchdog loop. */
+    void run() override;
+
+    /** Republishes senders[] into ports[] for send(). Message thread. */
+    void publish();
+
+    // Read by send() on the audio thread
+    std::array<std::atomic<MidiPortSender*>, maxPorts> ports{};
+    std::atomic<int> numPorts{ 0 };
+    std::atomic<int> sendsInFlight{ 0 };  /**< send() calls that may still touch ports[] */
+
+    // Message thread (guarded by sendersLock for the watchdog)
+    mutable juce::CriticalSection sendersLock;
+    juce::OwnedArray<MidiPortSender> senders;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiOutputRouter)
+};
+
+#endif // MIDIOUTPUTROUTER_H_INCLUDED
@@ -53,7 +53,12 @@ juce::Component* MidiOutputSelector::refreshComponentForRow (int rowNumber, bool
     }
     auto names = processor.getAvailableMidiOutputNames();
     if (rowNumber < names.size())
-        toggle->setButtonText(names[rowNumber]);
+    {
+        auto health = healthTexts[rowNumber];
+        toggle->setButtonText(health.isEmpty() ? names[rowNumber] : names[rowNumber] + "   " + health);
+    }
+    toggle->setColour(juce::ToggleButton::textColourId,
+        healthColours[rowNumber] == juce::Colour() ? juce::Colours::white : healthColours[rowNumber]);
     toggle->setToggleState(selectedStates[rowNumber], juce::dontSendNotification);
     return toggle;
 }
@@ -68,6 +73,50 @@ void MidiOutputSelector::resized()
     listBox.setBounds(getLocalBounds());
 }
 
+void MidiOutputSelector::updateHealth()
+{
+    auto names = processor.getAvailableMidiOutputNames();
+    auto status = processor.getMidiOutputRouter().getStatus();
+
+    juce::StringArray texts;
+    juce::Array<juce::Colour> colours;
+    for (int row = 0; row < names.size(); ++row)
+    {
+        juce::String text;
+        juce::Colour colour;
+        for (auto& port : status)
+        {
+            if (port.device.name != names[row])
+                continue;
+
+            auto& h = port.health;
+            switch (h.state)
+            {
+            case MidiPortSender::Connecting:   text = "connecting";   colour = juce::Colours::lightgrey; break;
+            case MidiPortSender::Ok:           text = "ok";           colour = juce::Colours::lightgreen; break;
+            case MidiPortSender::Lagging:      text = "lagging";      colour = juce::Colours::orange; break;
+            case MidiPortSender::Stalled:      text = "stalled";      colour = juce::Colours::red; break;
+            case MidiPortSender::Disconnected: text = "disconnected"; colour = juce::Colours::red; break;
+            }
+
+            text << juce::String::formatted("  %.1f ms  q %d", h.peakWriteMs, h.queueDepth);
+            if (h.dropped > 0)    text << "  dropped " << (int)h.dropped;
+            if (h.coalesced > 0)  text << "  coalesced " << (int)h.coalesced;
+            if (h.reconnects > 0) text << "  reconnects " << (int)h.reconnects;
+            break;
+        }
+        texts.add(text);
+        colours.add(colour);
+    }
+
+    if (texts != healthTexts || colours != healthColours)
+    {
+        healthTexts = texts;
+        healthColours = colours;
+        listBox.updateContent();
+    }
+}
+
 void MidiOutputSelector::updateProcessorOutputs()
 {
     juce::Array<int> indices;
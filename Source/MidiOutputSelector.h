@@ -18,7 +18,8 @@
  * @brief A UI component that displays available MIDI outputs with checkboxes.
  *
  * Users can select one or more outputs. Selections are reflected by ToggleButtons.
- * When the selection changes, the processor is updated.
+ * When the selection changes, the processor is updated. Selected ports show their
+ * sender health (state, write time, queue depth, dropped/coalesced messages).
  */
 class MidiOutputSelector : public juce::Component,
                            public juce::ListBoxModel
@@ -41,6 +42,9 @@ public:
     
     // Component override.
     void resized() override;
+
+    /** Refreshes the per-port health shown next to selected outputs (editor timer). */
+    void updateHealth();
     
 private:
     /** Updates the processor with the indices of selected outputs. */
@@ -49,6 +53,8 @@ private:
     MTCGenAudioProcessor& processor;
     juce::ListBox listBox { "MidiOutputList" };
     juce::Array<bool> selectedStates;
+    juce::StringArray healthTexts;          /**< Per row, empty if not selected */
+    juce::Array<juce::Colour> healthColours;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiOutputSelector)
 };
@@ -0,0 +1,228 @@
+/**
+ * @file MidiPortSender.cpp
+ * @brief Definitions for MidiPortSender methods.
+ */
+
+#include "MidiPortSender.h"
+#include "MtcPacket.h"
+#include "RealtimeAudit.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    /** How often a missing or unopenable port is retried. */
+    constexpr double reopenIntervalMs = 1000.0;
+}
+
+//==============================================================================
+MidiPortSender::MidiPortSender(const juce::MidiDeviceInfo& d)
+    : juce::Thread("MIDI Out: " + d.name), device(d)
+{
+    startThread(juce::Thread::Priority::high);
+}
+
+MidiPortSender::~MidiPortSender()
+{
+    // A driver stuck in a write gets a while to return before the thread is killed
+    stopThread(2000);
+}
+
+//==============================================================================
+bool MidiPortSender::push(const juce::uint8* data, int size, double dueMs) noexcept
+{
+    if (size <= 0 || size > maxMessageBytes || fifo.getFreeSpace() < 1)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+    auto& item = queue[(size_t)(size1 > 0 ? start1 : start2)];
+    item.dueMs = dueMs;
+    item.size = (juce::uint8)size;
+    std::memcpy(item.bytes.data(), data, (size_t)size);
+    fifo.finishedWrite(1);
+    return true;
+}
+
+void MidiPortSender::pushFrame(juce::uint32 packedFrame, int rateCode) noexcept
+{
+    latestFrame.store(((juce::uint64)packedFrame << 8) | (juce::uint64)(rateCode & 3),
+        std::memory_order_release);
+}
+
+MidiPortSender::Health MidiPortSender::getHealth() const noexcept
+{
+    Health h;
+    h.state = (State)state.load(std::memory_order_relaxed);
+    h.queueDepth = fifo.getNumReady();
+    h.lastWriteMs = lastWriteMs.load(std::memory_order_relaxed);
+    h.peakWriteMs = peakWriteMs.load(std::memory_order_relaxed);
+    h.dropped = dropped.load(std::memory_order_relaxed);
+    h.coalesced = coalesced.load(std::memory_order_relaxed);
+    h.reconnects = reconnects.load(std::memory_order_relaxed);
+    return h;
+}
+
+void MidiPortSender::watchdogCheck(double nowMs, bool isPresent) noexcept
+{
+    devicePresent.store(isPresent);
+    if (!isPresent && state.load() != Disconnected)
+        reopenRequested.store(true);
+
+    auto started = writeStartedMs.load();
+    if (started > 0.0 && nowMs - started > stallMs)
+        state.store(Stalled);
+
+    // Let the peak decay, so a port that has recovered reads healthy again
+    peakWriteMs.store(peakWriteMs.load() * 0.5);
+}
+
+//==============================================================================
+/**
+ * @brief Opens the port when the device is present, then drains the queue once per
+ * millisecond, writing each message when it is due. Everything that can block on the
+ * driver runs here.
+ */
+void MidiPortSender::run()
+{
+    std::unique_ptr<juce::MidiOutput> output;
+    bool openedBefore = false;
+    double nextOpenMs = 0.0;
+
+    while (!threadShouldExit())
+    {
+        MTCGEN_TRACE_THREAD("MIDI Out");
+        if (reopenRequested.exchange(false))
+            output.reset();
+
+        if (output == nullptr)
+        {
+            // Whatever queued up while the port was closed is stale by now
+            fifo.finishedRead(fifo.getNumReady());
+
+            auto now = juce::Time::getMillisecondCounterHiRes();
+            if (devicePresent.load() && now >= nextOpenMs)
+            {
+                nextOpenMs = now + reopenIntervalMs;
+                MTCGEN_TRACE_SCOPE("portOpen");
+                output = juce::MidiOutput::openDevice(device.identifier);
+                if (output != nullptr && std::exchange(openedBefore, true))
+                    reconnects.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            if (output == nullptr)
+            {
+                state.store(devicePresent.load() ? Connecting : Disconnected);
+                wait(50);
+                continue;
+            }
+        }
+
+        const int numReady = fifo.getNumReady();
+        if (numReady == 0)
+        {
+            state.store(Ok);
+            wait(1);
+            continue;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(numReady, start1, size1, start2, size2);
+        std::copy_n(queue.begin() + start1, size1, batch.begin());
+        std::copy_n(queue.begin() + start2, size2, batch.begin() + size1);
+        fifo.finishedRead(size1 + size2);
+
+        const bool lagging = numReady > lagQueueDepth || lastWriteMs.load() > lagWriteMs;
+        state.store(lagging ? Lagging : Ok);
+
+        if (lagging)
+        {
+            writeCoalesced(*output, size1 + size2);
+        }
+        else
+        {
+            for (int i = 0; i < size1 + size2 && !threadShouldExit(); ++i)
+            {
+                waitUntilDue(batch[(size_t)i].dueMs);
+                write(*output, batch[(size_t)i].bytes.data(), batch[(size_t)i].size);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Sleeps through most of the gap and yields through the last millisecond, as
+ * a sleep can overshoot by about that much. A due time further off than maxHoldMs
+ * (a host clock that jumped) is not waited for in full.
+ */
+void MidiPortSender::waitUntilDue(double dueMs)
+{
+    const auto now = juce::Time::getMillisecondCounterHiRes();
+    dueMs = juce::jmin(dueMs, now + maxHoldMs);
+
+    for (auto remaining = dueMs - now; remaining > 0.0 && !threadShouldExit();
+         remaining = dueMs - juce::Time::getMillisecondCounterHiRes())
+    {
+        if (remaining > 2.0)
+            wait((int)remaining - 1);
+        else
+            juce::Thread::yield();
+    }
+}
+
+void MidiPortSender::write(juce::MidiOutput& out, const juce::uint8* bytes, int size)
+{
+    MTCGEN_TRACE_SCOPE("portWrite");
+    const auto started = juce::Time::getMillisecondCounterHiRes();
+    writeStartedMs.store(started);
+    MTCGEN_RT_BLOCKING("MidiOutput::sendMessageNow");
+    out.sendMessageNow(juce::MidiMessage(bytes, size));
+
+    const auto elapsed = juce::Time::getMillisecondCounterHiRes() - started;
+    writeStartedMs.store(0.0);
+    lastWriteMs.store(elapsed);
+    if (elapsed > peakWriteMs.load())
+        peakWriteMs.store(elapsed);
+}
+
+/**
+ * @brief Sends the batch without its timecode and clock ticks (they would all arrive
+ * late and in a burst), then one Full Frame of the latest published frame.
+ */
+void MidiPortSender::writeCoalesced(juce::MidiOutput& out, int numItems)
+{
+    MTCGEN_TRACE_SCOPE("portCoalesce");
+    juce::uint32 skipped = 0;
+    bool skippedTimecode = false;
+
+    for (int i = 0; i < numItems; ++i)
+    {
+        const auto& item = batch[(size_t)i];
+        const auto status = item.bytes[0];
+        const bool timecode = status == 0xf1 || MtcPacket::isFullFrame(item.bytes.data(), item.size);
+
+        if (timecode || status == 0xf8)
+        {
+            ++skipped;
+            skippedTimecode = skippedTimecode || timecode;
+            continue;
+        }
+
+        write(out, item.bytes.data(), item.size);
+    }
+
+    coalesced.fetch_add(skipped, std::memory_order_relaxed);
+
+    Timecode tc;
+    auto latest = latestFrame.load(std::memory_order_acquire);
+    if (skippedTimecode && Timecode::unpack((juce::uint32)(latest >> 8), tc))
+    {
+        auto fullFrame = MtcPacket::fullFrame(tc, (int)(latest & 3));
+        write(out, fullFrame.data(), fullFrame.size);
+    }
+}
@@ -0,0 +1,146 @@
+/**
+ * @file MidiPortSender.h
+ * @brief Declaration of the MidiPortSender class, a sender thread for one MIDI output port.
+ */
+
+#ifndef MIDIPORTSENDER_H_INCLUDED
+#define MIDIPORTSENDER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class MidiPortSender
+ * @brief Owns one MIDI output port and writes to it from its own thread, so a slow or
+ * stalled driver only ever delays that port.
+ *
+ * The audio thread hands messages over through push(), which copies the bytes into a
+ * bounded lock-free queue and never blocks: if the queue is full the message is dropped
+ * and counted. Each message carries the wall-clock time it is due, worked out from its
+ * sample position in the block, and the sender thread holds it back until then, so the
+ * quarter-frames and clock ticks of a block go out spaced as they were encoded rather
+ * than in one burst. Every write is timed.
+ *
+ * When the port lags (a deep queue or slow writes), a drained batch is coalesced:
+ * timecode messages and clock ticks that are already stale are dropped, transport
+ * messages and SPP are kept, and a single Full Frame of the latest published frame
+ * (see pushFrame()) is sent so the receiver relocks at the current position.
+ *
+ * The port is (re)opened on the sender thread whenever the device is present and not
+ * open, so a device that disappears and comes back is picked up again automatically.
+ * Presence and stalls are reported by the watchdog in MidiOutputRouter.
+ */
+class MidiPortSender : private juce::Thread
+{
+public:
+    /** @enum State @brief Health of the port as shown in the editor. */
+    enum State
+    {
+        Connecting,   /**< Not open yet */
+        Ok,           /**< Writing normally */
+        Lagging,      /**< Queue backing up or writes slow; stale frames are coalesced */
+        Stalled,      /**< A write has not returned for longer than stallMs */
+        Disconnected  /**< Device not present; reopened when it comes back */
+    };
+
+    /** @brief Snapshot of the port's health counters. */
+    struct Health
+    {
+        State state{ Connecting };
+        int queueDepth{ 0 };        /**< Messages waiting to be written */
+        double lastWriteMs{ 0.0 };  /**< Duration of the last write */
+        double peakWriteMs{ 0.0 };  /**< Slowest write since the watchdog last decayed it */
+        juce::uint32 dropped{ 0 };   /**< Messages dropped because the queue was full */
+        juce::uint32 coalesced{ 0 }; /**< Stale messages skipped while lagging */
+        juce::uint32 reconnects{ 0 };
+    };
+
+    static constexpr int queueCapacity = 1024;    /**< Messages, about 0.3 s of quarter-frames and clock */
+    static constexpr int maxMessageBytes = 12;    /**< Longest message queued (Full Frame is 10) */
+    static constexpr int lagQueueDepth = 64;      /**< Queue depth treated as lagging */
+    static constexpr double lagWriteMs = 5.0;     /**< Write time treated as lagging */
+    static constexpr double stallMs = 100.0;      /**< Write time treated as stalled */
+    static constexpr double maxHoldMs = 250.0;    /**< Longest a message is held for its due time */
+
+    /**
+     * @brief Starts the sender thread for a device; the port is opened on that thread.
+     */
+    explicit MidiPortSender(const juce::MidiDeviceInfo& device);
+
+    /** Destructor: stops the thread and closes the port. */
+    ~MidiPortSender() override;
+
+    /** @brief The device this sender writes to. */
+    const juce::MidiDeviceInfo& getDevice() const noexcept { return device; }
+
+    /**
+     * @brief Queues a message's raw bytes for the port. Realtime-safe: never blocks or
+     * allocates.
+     * @param dueMs juce::Time::getMillisecondCounterHiRes() time to send it at; 0 (or
+     *              any time already past) sends it as soon as the thread gets to it.
+     * @return False if the queue was full (or the message too long) and it was dropped.
+     */
+    bool push(const juce::uint8* data, int size, double dueMs = 0.0) noexcept;
+
+    /**
+     * @brief Publishes the current frame, used to resync a lagging port. Realtime-safe.
+     * @param packedFrame Timecode::pack() of the frame, 0 if none.
+     * @param rateCode MTC rate code (see Timecode::mtcRateCode()).
+     */
+    void pushFrame(juce::uint32 packedFrame, int rateCode) noexcept;
+
+    /** @brief Current health. Any thread. */
+    Health getHealth() const noexcept;
+
+    /**
+     * @brief Called periodically by the watchdog.
+     * @param nowMs juce::Time::getMillisecondCounterHiRes() at the check.
+     * @param devicePresent True if the device is in the system's output list.
+     */
+    void watchdogCheck(double nowMs, bool devicePresent) noexcept;
+
+private:
+    /** A queued message. */
+    struct Item
+    {
+        double dueMs{ 0.0 };
+        juce::uint8 size{ 0 };
+        std::array<juce::uint8, maxMessageBytes> bytes{};
+    };
+
+    /** Sender loop: opens the port, drains the queue and writes. */
+    void run() override;
+
+    /** Waits until a message is due, or until the thread is asked to stop. */
+    void waitUntilDue(double dueMs);
+
+    /** Writes one message, timing it for the watchdog. */
+    void write(juce::MidiOutput& out, const juce::uint8* bytes, int size);
+
+    /** Drops stale timecode and clock from a batch, then resyncs with one Full Frame. */
+    void writeCoalesced(juce::MidiOutput& out, int numItems);
+
+    juce::MidiDeviceInfo device;
+
+    juce::AbstractFifo fifo{ queueCapacity };
+    std::array<Item, queueCapacity> queue;   /**< Written by push(), read by run() */
+    std::array<Item, queueCapacity> batch;   /**< run() only */
+
+    std::atomic<juce::uint64> latestFrame{ 0 };  /**< Packed frame << 8 | rate code */
+
+    std::atomic<int> state{ Connecting };
+    std::atomic<bool> devicePresent{ true };
+    std::atomic<bool> reopenRequested{ false };
+    std::atomic<double> writeStartedMs{ 0.0 };   /**< 0 when no write is in progress */
+    std::atomic<double> lastWriteMs{ 0.0 };
+    std::atomic<double> peakWriteMs{ 0.0 };
+    std::atomic<juce::uint32> dropped{ 0 };
+    std::atomic<juce::uint32> coalesced{ 0 };
+    std::atomic<juce::uint32> reconnects{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiPortSender)
+};
+
+#endif // MIDIPORTSENDER_H_INCLUDED
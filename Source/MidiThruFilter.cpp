@@ -0,0 +1,44 @@
+/**
+ * @file MidiThruFilter.cpp
+ * @brief Definitions for MidiThruFilter methods.
+ */
+
+#include "MidiThruFilter.h"
+#include <array>
+#include <cstring>
+
+//==============================================================================
+void MidiThruFilter::prepare()
+{
+    scratch.ensureSize(reservedBytes);
+}
+
+void MidiThruFilter::setOptions(bool shouldPassTriggers, bool shouldPassSysEx,
+    int newChannel) noexcept
+{
+    passTriggers = shouldPassTriggers;
+    passSysEx = shouldPassSysEx;
+    channel = juce::jlimit(0, 16, newChannel);
+}
+
+void MidiThruFilter::add(const juce::MidiMessageMetadata& event, bool isTrigger) noexcept
+{
+    const auto status = event.data[0];
+
+    if (isTrigger && !passTriggers)
+        return;
+    if (!passSysEx && (status == 0xf0 || status == 0xf1))
+        return;
+
+    // Channel messages are at most three bytes; rewrite the status byte in a copy
+    if (channel > 0 && status >= 0x80 && status < 0xf0 && event.numBytes <= 3)
+    {
+        std::array<juce::uint8, 3> bytes{};
+        std::memcpy(bytes.data(), event.data, (size_t)event.numBytes);
+        bytes[0] = (juce::uint8)((status & 0xf0) | (channel - 1));
+        scratch.addEvent(bytes.data(), event.numBytes, event.samplePosition);
+        return;
+    }
+
+    scratch.addEvent(event.data, event.numBytes, event.samplePosition);
+}
@@ -0,0 +1,61 @@
+/**
+ * @file MidiThruFilter.h
+ * @brief Declaration of the MidiThruFilter class (what incoming MIDI passes downstream).
+ */
+
+#ifndef MIDITHRUFILTER_H_INCLUDED
+#define MIDITHRUFILTER_H_INCLUDED
+
+#include <JuceHeader.h>
+
+/**
+ * @class MidiThruFilter
+ * @brief Decides which incoming events processBlock passes on to the host, and on
+ * which channel.
+ *
+ * Consumed triggers (mapped notes, bank program changes) and incoming MTC / SysEx can
+ * be dropped, and channel messages can be moved to one channel. When everything passes
+ * unchanged the host's buffer is left alone. Otherwise the kept events are copied once,
+ * in the same pass that parses the input, into a scratch buffer reserved in prepare();
+ * end() then swaps it with the host's buffer, so no event is copied twice and neither
+ * buffer is reallocated once both have grown to the stream's size.
+ */
+class MidiThruFilter
+{
+public:
+    static constexpr int reservedBytes = 16384; /**< Scratch capacity set by prepare() */
+
+    /** @brief Reserves the scratch buffer. Call from prepareToPlay. */
+    void prepare();
+
+    /**
+     * @brief Sets the options for the next block.
+     * @param passTriggers Keep note and program change events that drove a cue.
+     * @param passSysEx Keep incoming MTC quarter-frames and SysEx.
+     * @param channel 1..16 to move every channel message to that channel, 0 to keep.
+     */
+    void setOptions(bool passTriggers, bool passSysEx, int channel) noexcept;
+
+    /** @brief True if the options change anything, i.e. the buffer must be rewritten. */
+    bool isActive() const noexcept { return !passTriggers || !passSysEx || channel > 0; }
+
+    /** @brief Starts a block. */
+    void begin() noexcept { scratch.clear(); }
+
+    /**
+     * @brief Keeps, remaps or drops one incoming event.
+     * @param isTrigger True if the event was consumed as a cue or bank trigger.
+     */
+    void add(const juce::MidiMessageMetadata& event, bool isTrigger) noexcept;
+
+    /** @brief Replaces the block's MIDI with the kept events. */
+    void end(juce::MidiBuffer& midi) noexcept { midi.swapWith(scratch); }
+
+private:
+    juce::MidiBuffer scratch;
+    bool passTriggers{ true };
+    bool passSysEx{ true };
+    int channel{ 0 };
+};
+
+#endif // MIDITHRUFILTER_H_INCLUDED
@@ -0,0 +1,308 @@
+/**
+ * @file MtcFileExporter.cpp
+ * @brief Definitions for MtcFileExporter methods.
+ */
+
+#include "MtcFileExporter.h"
+#include "MTCGenProcessor.h"
+#include "HostSimulator.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <utility>
+
+namespace
+{
+    /** Time covered by one cue's stream (pre-roll included); end is infinite if never learned. */
+    struct Coverage
+    {
+        double from;
+        double to;
+    };
+
+    void writeVarLen(juce::OutputStream& out, juce::uint32 value)
+    {
+        juce::uint8 bytes[5];
+        int n = 0;
+        bytes[n++] = (juce::uint8)(value & 0x7f);
+        while ((value >>= 7) != 0)
+            bytes[n++] = (juce::uint8)((value & 0x7f) | 0x80);
+        while (n > 0)
+            out.writeByte((char)bytes[--n]);
+    }
+
+    /** Loads a snapshot into a processor that only renders (no clock). */
+    void loadForRender(MTCGenAudioProcessor& processor, const juce::MemoryBlock& state)
+    {
+        processor.setStateInformation(state.getData(), (int)state.getSize());
+        processor.setClockEnabled(false);
+    }
+}
+
+//==============================================================================
+juce::MemoryBlock MtcFileExporter::snapshotState(MTCGenAudioProcessor& processor)
+{
+    juce::MemoryBlock state;
+    processor.getStateInformation(state);
+
+    // Each render copy would otherwise open its own sockets and shared memory
+    if (auto xml = juce::AudioProcessor::getXmlFromBinary(state.getData(), (int)state.getSize()))
+    {
+        xml->setAttribute("artNetEnabled", false);
+        xml->setAttribute("sharedMemoryEnabled", false);
+        xml->setAttribute("controlEnabled", false);
+        state.reset();
+        juce::AudioProcessor::copyXmlToBinary(*xml, state);
+    }
+    return state;
+}
+
+/**
+ * @brief Resolves the range, splits it at idle gaps on the block grid and renders the
+ * segments on a thread pool, one processor per worker.
+ */
+std::vector<MtcFileExporter::Event> MtcFileExporter::render(const juce::MemoryBlock& state,
+    Options options, int* numSegments)
+{
+    if (numSegments != nullptr)
+        *numSegments = 0;
+
+    std::vector<std::unique_ptr<MTCGenAudioProcessor>> workers;
+    workers.push_back(std::make_unique<MTCGenAudioProcessor>());
+    auto& probe = *workers.front();
+    loadForRender(probe, state);
+
+    const double rate = probe.getFrameRate();
+    const auto& cues = probe.getCues();
+
+    // Where each cue's stream runs, in host time
+    std::vector<Coverage> coverage;
+    double lastEnd = options.startSeconds;
+    for (int i = 0; i < cues.size(); ++i)
+    {
+        const double start = cues.getDetectedStartTime(i);
+        if (start < 0.0)
+            continue;
+
+        const double end = cues.getDetectedEndTime(i);
+        const bool learned = end > start;
+        coverage.push_back({ start - cues.getPreRollFrames(i) / rate,
+            learned ? end : std::numeric_limits<double>::max() });
+        lastEnd = juce::jmax(lastEnd, learned ? end : start);
+    }
+
+    if (options.endSeconds <= 0.0)
+        options.endSeconds = lastEnd + 1.0;
+    if (options.blockSize <= 0)
+        options.blockSize = probe.getMTCFormat() == FullSysEx
+            ? juce::roundToInt(options.sampleRate / rate) : 1024;
+
+    const double sr = options.sampleRate;
+    const juce::int64 block = options.blockSize;
+    const juce::int64 numBlocks = (juce::int64)std::ceil(
+        (options.endSeconds - options.startSeconds) * sr / (double)block);
+    if (numBlocks <= 0)
+        return {};
+
+    const juce::int64 totalSamples = numBlocks * block;
+
+    // The output runs behind the host by the reported pre-roll latency
+    probe.setRateAndBufferSizeDetails(sr, options.blockSize);
+    probe.prepareToPlay(sr, options.blockSize);
+    const double latencySeconds = probe.getLatencySamples() / sr;
+
+    // Split points: block boundaries inside gaps, a block and two frames clear of any
+    // cue, spaced so each worker gets a few segments
+    const int numThreads = options.numThreads > 0 ? options.numThreads
+                                                  : juce::SystemStats::getNumCpus();
+    const double margin = block / sr + 2.0 / rate;
+    const double targetSeconds = juce::jmax(options.minSegmentSeconds,
+        totalSamples / sr / (numThreads * 4));
+
+    std::sort(coverage.begin(), coverage.end(),
+        [](const Coverage& a, const Coverage& b) { return a.from < b.from; });
+
+    std::vector<std::pair<juce::int64, juce::int64>> segments;
+    juce::int64 segmentStart = 0;
+    double coveredTo = -std::numeric_limits<double>::max();
+
+    auto toBlockSample = [&](double t) {
+        return (juce::int64)std::ceil((t - options.startSeconds) * sr / (double)block) * block;
+    };
+
+    for (size_t i = 0; i <= coverage.size(); ++i)
+    {
+        const double nextFrom = i < coverage.size() ? coverage[i].from
+                                                    : std::numeric_limits<double>::max();
+        if (i > 0 && coveredTo < std::numeric_limits<double>::max() && nextFrom > coveredTo)
+        {
+            const auto split = toBlockSample(coveredTo + margin);
+            const bool inGap = (split - (double)block) / sr + options.startSeconds < nextFrom - margin;
+            const bool worthIt = (split - segmentStart) / sr >= targetSeconds;
+
+            if (inGap && worthIt && split > segmentStart && split < totalSamples)
+            {
+                segments.push_back({ segmentStart, split });
+                segmentStart = split;
+            }
+        }
+
+        if (i < coverage.size())
+            coveredTo = juce::jmax(coveredTo, coverage[i].to);
+    }
+    segments.push_back({ segmentStart, totalSamples });
+    if (numSegments != nullptr)
+        *numSegments = (int)segments.size();
+
+    // One processor per worker; each renders every numWorkers-th segment
+    const int numWorkers = juce::jmin(numThreads, (int)segments.size());
+    for (int w = 1; w < numWorkers; ++w)
+    {
+        workers.push_back(std::make_unique<MTCGenAudioProcessor>());
+        loadForRender(*workers.back(), state);
+    }
+
+    std::vector<std::vector<Event>> rendered(segments.size());
+    auto renderWorker = [&](int w) {
+        for (size_t s = (size_t)w; s < segments.size(); s += (size_t)numWorkers)
+            renderSegment(*workers[(size_t)w], options, latencySeconds,
+                segments[s].first, segments[s].second, rendered[s]);
+    };
+
+    if (numWorkers <= 1)
+    {
+        renderWorker(0);
+    }
+    else
+    {
+        juce::ThreadPool pool(numWorkers);
+        juce::WaitableEvent finished;
+        std::atomic<int> remaining{ numWorkers };
+
+        for (int w = 0; w < numWorkers; ++w)
+        {
+            pool.addJob([&, w]() {
+                renderWorker(w);
+                if (--remaining == 0)
+                    finished.signal();
+            });
+        }
+
+        finished.wait();
+    }
+
+    // Segments are disjoint and in order, so stitching is concatenation
+    std::vector<Event> events;
+    size_t total = 0;
+    for (auto& r : rendered)
+        total += r.size();
+    events.reserve(total);
+    for (auto& r : rendered)
+        events.insert(events.end(), r.begin(), r.end());
+
+    return events;
+}
+
+void MtcFileExporter::renderSegment(MTCGenAudioProcessor& processor, const Options& options,
+    double latencySeconds, juce::int64 fromSample, juce::int64 toSample, std::vector<Event>& out)
+{
+    const double sr = options.sampleRate;
+
+    // The simulator prepares the processor, which resets the stream: every segment
+    // starts idle, as the serial render would be at that point
+    HostSimulator sim(processor, sr);
+    HostSimulator::TransportSegment play;
+    play.lengthSamples = toSample - fromSample;
+    play.blockSize = options.blockSize;
+    play.locateSeconds = options.startSeconds + fromSample / sr + latencySeconds;
+    sim.addSegment(play);
+    sim.run();
+
+    for (auto& ev : sim.getCaptured())
+    {
+        const auto* bytes = ev.bytes.data();
+        const int size = (int)ev.bytes.size();
+        const bool quarterFrame = size == MtcPacket::quarterFrameSize && bytes[0] == 0xf1;
+        if (!quarterFrame && !MtcPacket::isFullFrame(bytes, size))
+            continue;
+
+        Event e{ fromSample + ev.samplePosition, {} };
+        std::copy(bytes, bytes + size, e.packet.bytes.begin());
+        e.packet.size = size;
+        out.push_back(e);
+    }
+}
+
+bool MtcFileExporter::exportToFile(const juce::MemoryBlock& state, const Options& options,
+    const juce::File& file, juce::String& error)
+{
+    auto events = render(state, options);
+    if (events.empty())
+    {
+        error = "Nothing to export: no learned cue runs in the range";
+        return false;
+    }
+
+    juce::MemoryOutputStream smf;
+    writeSmf(smf, events, options.sampleRate);
+    if (!file.replaceWithData(smf.getData(), smf.getDataSize()))
+    {
+        error = "Could not write " + file.getFullPathName();
+        return false;
+    }
+    return true;
+}
+
+//==============================================================================
+/**
+ * @brief Writes the header, a track name and tempo, then every event with its delta
+ * time. Ticks are rounded from absolute sample positions, so rounding never accumulates.
+ */
+void MtcFileExporter::writeSmf(juce::OutputStream& out, const std::vector<Event>& events,
+    double sampleRate)
+{
+    juce::MemoryOutputStream track;
+
+    // Track name "MTC", tempo 120 BPM (500000 us per quarter note)
+    const juce::uint8 header[] = { 0x00, 0xff, 0x03, 0x03, 'M', 'T', 'C',
+                                   0x00, 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20 };
+    track.write(header, sizeof(header));
+
+    juce::int64 lastTick = 0;
+    for (auto& e : events)
+    {
+        const auto tick = (juce::int64)std::llround(e.sample * ticksPerSecond / sampleRate);
+        writeVarLen(track, (juce::uint32)(tick - lastTick));
+        lastTick = tick;
+
+        const auto* bytes = e.packet.data();
+        if (bytes[0] == 0xf0)
+        {
+            // SysEx event: F0, length, then the bytes after F0 (ending with F7)
+            track.writeByte((char)0xf0);
+            writeVarLen(track, (juce::uint32)(e.packet.size - 1));
+            track.write(bytes + 1, (size_t)(e.packet.size - 1));
+        }
+        else
+        {
+            // Escape event: F7, length, then the raw quarter-frame
+            track.writeByte((char)0xf7);
+            writeVarLen(track, (juce::uint32)e.packet.size);
+            track.write(bytes, (size_t)e.packet.size);
+        }
+    }
+
+    const juce::uint8 endOfTrack[] = { 0x00, 0xff, 0x2f, 0x00 };
+    track.write(endOfTrack, sizeof(endOfTrack));
+
+    out.write("MThd", 4);
+    out.writeIntBigEndian(6);
+    out.writeShortBigEndian(0);  // format 0
+    out.writeShortBigEndian(1);  // one track
+    out.writeShortBigEndian((short)ticksPerQuarterNote);
+    out.write("MTrk", 4);
+    out.writeIntBigEndian((int)track.getDataSize());
+    out.write(track.getData(), track.getDataSize());
+}
@@ -0,0 +1,94 @@
+/**
+ * @file MtcFileExporter.h
+ * @brief Declaration of the MtcFileExporter class (offline MTC render to a Standard MIDI File).
+ */
+
+#ifndef MTCFILEEXPORTER_H_INCLUDED
+#define MTCFILEEXPORTER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcPacket.h"
+
+class MTCGenAudioProcessor;
+
+/**
+ * @class MtcFileExporter
+ * @brief Renders the MTC stream of a session over a host-time range, faster than real
+ * time, and writes it to a Standard MIDI File for playback systems that cannot host
+ * the plugin.
+ *
+ * The stream is produced by the generator itself: copies of the processor, loaded with
+ * the session's state, are driven through processBlock by a HostSimulator playing over
+ * the range, so the file holds exactly what the plugin would send with the transport
+ * running over the learned cue windows. Events are placed where the host would play
+ * them, i.e. with the reported pre-roll latency compensated.
+ *
+ * Long ranges are split at gaps between cues (where no cue, pre-roll included, is
+ * running and the stream is idle anyway) on the block grid of the whole range, and
+ * the segments are rendered in parallel on a thread pool. Because every segment
+ * starts idle and on the same block boundaries, the stitched result is identical to a
+ * single serial render.
+ *
+ * The file is format 0 at ticksPerQuarterNote PPQ and 120 BPM. Full Frames are stored
+ * as SysEx events and quarter-frames as F7 escape events, as the SMF spec requires
+ * for system common messages.
+ */
+class MtcFileExporter
+{
+public:
+    static constexpr int ticksPerQuarterNote = 960;
+    static constexpr double ticksPerSecond = ticksPerQuarterNote * 2.0; /**< At 120 BPM */
+
+    /** @brief What to render. */
+    struct Options
+    {
+        double startSeconds{ 0.0 };       /**< Host time at the start of the file */
+        double endSeconds{ 0.0 };         /**< Host time to stop at; 0 = end of the last cue */
+        double sampleRate{ 48000.0 };     /**< Rate the generator runs at */
+        int blockSize{ 0 };               /**< 0 = one frame (Full SysEx) or 1024 (quarter-frame) */
+        int numThreads{ 0 };              /**< 0 = one per CPU core */
+        double minSegmentSeconds{ 30.0 }; /**< Shorter stretches are not worth a thread */
+    };
+
+    /** @brief One rendered message. */
+    struct Event
+    {
+        juce::int64 sample;  /**< Samples from the start of the range */
+        MtcPacket packet;
+    };
+
+    /**
+     * @brief Takes the state the export runs from. Message thread: reads the cues.
+     * Output ports, Art-Net, shared memory and MIDI Clock are switched off in the copy.
+     */
+    static juce::MemoryBlock snapshotState(MTCGenAudioProcessor& processor);
+
+    /**
+     * @brief Renders the MTC stream of a state snapshot. Any thread; blocks until done.
+     * @param options Range and render settings; endSeconds 0 is resolved from the cues.
+     * @param numSegments If given, set to the number of segments the range was split into.
+     */
+    static std::vector<Event> render(const juce::MemoryBlock& state, Options options,
+        int* numSegments = nullptr);
+
+    /**
+     * @brief Renders a state snapshot and writes the result as a Standard MIDI File.
+     * @param error Set to a description of the failure.
+     * @return False if there was nothing to render or the file could not be written.
+     */
+    static bool exportToFile(const juce::MemoryBlock& state, const Options& options,
+        const juce::File& file, juce::String& error);
+
+private:
+    /** Renders [fromSample, toSample) of the range with one processor. */
+    static void renderSegment(MTCGenAudioProcessor& processor, const Options& options,
+        double latencySeconds, juce::int64 fromSample, juce::int64 toSample,
+        std::vector<Event>& out);
+
+    /** Writes events as a format 0 Standard MIDI File. */
+    static void writeSmf(juce::OutputStream& out, const std::vector<Event>& events,
+        double sampleRate);
+};
+
+#endif // MTCFILEEXPORTER_H_INCLUDED
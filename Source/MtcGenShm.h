@@ -0,0 +1,110 @@
+/**
+ * @file MtcGenShm.h
+ * @brief Layout of the shared-memory timecode segment and a reader for other processes.
+ *
+ * Plain C (C99, GCC or Clang builtins), so consumers need nothing but this header. The
+ * generator includes it too, so writer and readers always agree on the layout.
+ *
+ * The segment is a POSIX shared-memory object (default MTCGEN_SHM_DEFAULT_NAME) holding
+ * one MtcGenShm. It is guarded by a seqlock: the writer makes the sequence odd, updates
+ * the payload and makes it even again, and never waits for anyone. A reader copies the
+ * payload and retries if the sequence was odd or changed meanwhile:
+ *
+ *     const MtcGenShm* shm = mtcgen_shm_open(MTCGEN_SHM_DEFAULT_NAME);
+ *     MtcGenShmTimecode tc;
+ *     if (shm && mtcgen_shm_read(shm, &tc) && tc.running)
+ *         printf("%02d:%02d:%02d:%02d\n", tc.hours, tc.minutes, tc.seconds, tc.frames);
+ *
+ * See Examples/MtcShmReader.c.
+ */
+
+#ifndef MTCGENSHM_H_INCLUDED
+#define MTCGENSHM_H_INCLUDED
+
+#include <stdint.h>
+
+#define MTCGEN_SHM_DEFAULT_NAME "/mtcgen"
+#define MTCGEN_SHM_MAGIC        0x4d544347u /* "MTCG" */
+#define MTCGEN_SHM_VERSION      1u
+
+/** What the generator is doing, as of the last audio block. */
+typedef struct MtcGenShmTimecode
+{
+    int32_t  hours, minutes, seconds, frames; /* Current frame, valid if running */
+    double   frameRate;      /* 24, 25, 29.97 or 30 */
+    int32_t  running;        /* 1 while a cue drives timecode */
+    int32_t  playing;        /* 1 while the host transport plays */
+    uint32_t cueId;          /* Stable id of the running cue, 0 = none */
+    int32_t  cueNote;        /* MIDI note of the running cue, -1 = none */
+    int32_t  bank;           /* Active cue bank */
+    int32_t  reserved;
+    double   hostSeconds;    /* Host time of the block */
+    uint64_t blockCount;     /* Blocks published since the segment was opened */
+    uint64_t frameCount;     /* Times the frame changed */
+    uint64_t cueCount;       /* Times the running cue changed */
+} MtcGenShmTimecode;
+
+/** The whole segment. */
+typedef struct MtcGenShm
+{
+    uint32_t magic;          /* MTCGEN_SHM_MAGIC once initialised */
+    uint32_t version;        /* MTCGEN_SHM_VERSION */
+    int32_t  ownerPid;       /* Publishing process, 0 = nobody publishes */
+    uint32_t sequence;       /* Seqlock: odd while the payload is being written */
+    MtcGenShmTimecode timecode;
+} MtcGenShm;
+
+#ifndef __cplusplus
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/** Maps the segment read-only; returns NULL if it does not exist (yet). */
+static inline const MtcGenShm* mtcgen_shm_open(const char* name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+
+    void* p = mmap(NULL, sizeof(MtcGenShm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    return p == MAP_FAILED ? NULL : (const MtcGenShm*)p;
+}
+
+/** Unmaps a segment returned by mtcgen_shm_open(). */
+static inline void mtcgen_shm_close(const MtcGenShm* shm)
+{
+    if (shm != NULL)
+        munmap((void*)shm, sizeof(MtcGenShm));
+}
+
+/**
+ * Copies a consistent snapshot of the payload. Never blocks the writer.
+ * Returns 1 on success, 0 if nobody publishes, the layout differs or the writer
+ * stopped in the middle of an update.
+ */
+static inline int mtcgen_shm_read(const MtcGenShm* shm, MtcGenShmTimecode* out)
+{
+    if (shm->magic != MTCGEN_SHM_MAGIC || shm->version != MTCGEN_SHM_VERSION
+        || __atomic_load_n(&shm->ownerPid, __ATOMIC_RELAXED) == 0)
+        return 0;
+
+    for (long spins = 0; spins < 1000000; ++spins)
+    {
+        uint32_t before = __atomic_load_n(&shm->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1u)
+            continue; /* A write is in progress; it takes well under a microsecond */
+
+        *out = shm->timecode;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shm->sequence, __ATOMIC_RELAXED) == before)
+            return 1;
+    }
+    return 0;
+}
+
+#endif /* __cplusplus */
+
+#endif /* MTCGENSHM_H_INCLUDED */
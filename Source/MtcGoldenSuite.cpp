@@ -0,0 +1,295 @@
+/**
+ * @file MtcGoldenSuite.cpp
+ * @brief Definitions for MtcGoldenSuite methods.
+ */
+
+#include "MtcGoldenSuite.h"
+#include "MTCGenProcessor.h"
+#include "ArtNetSuite.h"
+#include "BlockTimingSuite.h"
+#include "ControlProtocolSuite.h"
+#include "ControlServerSuite.h"
+#include "CueLibrarySuite.h"
+#include "CueStoreScanSuite.h"
+#include "ExportSuite.h"
+#include "MappingTableSuite.h"
+#include "MtcKernelSuite.h"
+#include "PlayheadDllSuite.h"
+#include "RealtimeAuditSuite.h"
+#include "TimecodeSinkSuite.h"
+#include "TraceOverheadSuite.h"
+#include "TriggerImportSuite.h"
+
+namespace
+{
+    /** Compares (or with update set, rewrites) one captured stream against its golden file. */
+    MtcGoldenSuite::Result checkGolden(const HostSimulator& sim, const juce::File& goldenDir,
+        const juce::String& name, bool update)
+    {
+        MtcGoldenSuite::Result r;
+        r.name = name;
+        auto file = goldenDir.getChildFile(name + ".golden");
+
+        if (update)
+        {
+            r.passed = sim.writeGolden(file);
+            r.message = r.passed ? "updated" : "could not write " + file.getFullPathName();
+        }
+        else
+        {
+            r.passed = sim.matchesGolden(file, r.message);
+        }
+
+        return r;
+    }
+}
+
+//==============================================================================
+int MtcGoldenSuite::addSecondCue(MTCGenAudioProcessor& processor)
+{
+    int index = -1;
+    processor.editActiveCues([&index](CueStore& cues) {
+        cues.add(MappingEntry("01:00:00:00", 62, "Second Cue"));
+        index = cues.size() - 1;
+        });
+    return index;
+}
+
+/**
+ * @brief Host script shared by every case. Positions are absolute samples at 48 kHz
+ * until the final segment switches to 44.1 kHz.
+ */
+void MtcGoldenSuite::addStandardScript(HostSimulator& sim)
+{
+    using Segment = HostSimulator::TransportSegment;
+    const auto sr = (juce::int64)scriptSampleRate;
+
+    // 1) Play from zero; cue note 60 held for ~0.7 s
+    Segment play;
+    play.lengthSamples = sr;
+    play.blockSize = 512;
+    play.locateSeconds = 0.0;
+    sim.addSegment(play);
+    sim.addMidi(sr / 10, juce::MidiMessage::noteOn(1, 60, (juce::uint8)100));
+    sim.addMidi(sr * 8 / 10, juce::MidiMessage::noteOff(1, 60));
+
+    // 2) Stop for a quarter second, small blocks
+    Segment stop;
+    stop.lengthSamples = sr / 4;
+    stop.blockSize = 256;
+    stop.playing = false;
+    sim.addSegment(stop);
+
+    // 3) Scrub back into cue 60's learned window and play with an odd block size;
+    //    trigger cue 62 halfway
+    Segment scrub;
+    scrub.lengthSamples = sr / 2;
+    scrub.blockSize = 480;
+    scrub.locateSeconds = 0.5;
+    sim.addSegment(scrub);
+    sim.addMidi(sr + sr / 4 + sr / 4, juce::MidiMessage::noteOn(1, 62, (juce::uint8)100));
+
+    // 4) Loop 1.0 s .. 1.5 s with large blocks
+    Segment loop;
+    loop.lengthSamples = sr + sr / 5;
+    loop.blockSize = 1024;
+    loop.loopStartSeconds = 1.0;
+    loop.loopEndSeconds = 1.5;
+    sim.addSegment(loop);
+
+    // 5) Sample-rate change with tiny blocks
+    Segment rateChange;
+    rateChange.lengthSamples = 44100 * 3 / 10;
+    rateChange.blockSize = 64;
+    rateChange.sampleRate = 44100.0;
+    sim.addSegment(rateChange);
+}
+
+std::vector<MtcGoldenSuite::Result> MtcGoldenSuite::run(const juce::File& goldenDir,
+    bool updateGoldens)
+{
+    static const double rates[] = { 24.0, 25.0, 29.97, 30.0 };
+    static const MTCFormat formats[] = { FullSysEx, QuarterFrame };
+
+    std::vector<Result> results;
+    RealtimeAuditSuite::begin();
+
+    for (auto rate : rates)
+    {
+        for (auto format : formats)
+        {
+            MTCGenAudioProcessor processor;
+            processor.setFrameRate(rate);
+            processor.setMTCFormat(format);
+            addSecondCue(processor);
+
+            HostSimulator sim(processor, scriptSampleRate);
+            addStandardScript(sim);
+            sim.run();
+
+            results.push_back(checkGolden(sim, goldenDir, "mtc_" + juce::String(rate) + "_"
+                + (format == FullSysEx ? "fullsysex" : "quarterframe"), updateGoldens));
+        }
+    }
+
+    // MIDI Clock alongside Full SysEx MTC: golden stream, plus tick spacing within one
+    // sample period of the lowest sample rate in the script
+    {
+        MTCGenAudioProcessor processor;
+        processor.setClockEnabled(true);
+
+        HostSimulator sim(processor, scriptSampleRate);
+        addStandardScript(sim);
+        sim.run();
+
+        auto r = checkGolden(sim, goldenDir, "clock_30_fullsysex", updateGoldens);
+        auto jitter = sim.getIntervalStats(0xF8);
+        const double maxJitterSeconds = 1.0 / 44100.0;
+
+        if (r.passed && !updateGoldens
+            && (jitter.numIntervals == 0 || jitter.maxJitterSeconds > maxJitterSeconds))
+        {
+            r.passed = false;
+            r.message = juce::String::formatted("clock jitter %.1f us over %d intervals",
+                jitter.maxJitterSeconds * 1.0e6, jitter.numIntervals);
+        }
+
+        results.push_back(r);
+    }
+
+    // Pre-roll: cue 62 leads in a second early, so the stream is delayed by the
+    // reported latency and counts up into 01:00:00:00
+    {
+        MTCGenAudioProcessor processor;
+        processor.setFrameRate(25.0);
+        processor.setMTCFormat(QuarterFrame);
+        processor.setCuePreRoll(addSecondCue(processor), 25);
+
+        HostSimulator sim(processor, scriptSampleRate);
+        addStandardScript(sim);
+        sim.run();
+
+        results.push_back(checkGolden(sim, goldenDir, "preroll_25_quarterframe", updateGoldens));
+
+        // The same with MIDI Clock on: the clock must follow the MTC, so each host start
+        // and stop reaches the clock output one reported latency later, and the MTC is
+        // unchanged
+        MTCGenAudioProcessor clocked;
+        clocked.setFrameRate(25.0);
+        clocked.setMTCFormat(QuarterFrame);
+        clocked.setCuePreRoll(addSecondCue(clocked), 25);
+        clocked.setClockEnabled(true);
+        clocked.prepareToPlay(scriptSampleRate, 512);
+        const juce::int64 latency = clocked.getLatencySamples();
+
+        HostSimulator clockSim(clocked, scriptSampleRate);
+        addStandardScript(clockSim);
+        clockSim.run();
+
+        auto isClock = [](const HostSimulator::CapturedEvent& e) {
+            return e.bytes[0] == 0xf8 || e.bytes[0] == 0xfa || e.bytes[0] == 0xfb
+                || e.bytes[0] == 0xfc || e.bytes[0] == 0xf2;
+        };
+
+        Result r;
+        r.name = "preroll_clock_25";
+        std::vector<const HostSimulator::CapturedEvent*> mtc;
+        for (auto& e : clockSim.getCaptured())
+            if (!isClock(e))
+                mtc.push_back(&e);
+        const auto& expected = sim.getCaptured();
+        bool sameMtc = mtc.size() == expected.size();
+        for (size_t i = 0; sameMtc && i < mtc.size(); ++i)
+            sameMtc = mtc[i]->samplePosition == expected[i].samplePosition && mtc[i]->bytes == expected[i].bytes;
+        if (!sameMtc)
+            r.message = "the MTC changed with the clock on";
+
+        // The script starts at 0, stops at 1 s and starts again at 1.25 s (at 48 kHz)
+        const auto sr = (juce::int64)scriptSampleRate;
+        const juce::int64 edges[] = { 0, sr, sr + sr / 4 };
+        int edge = 0;
+        for (auto& e : clockSim.getCaptured())
+        {
+            if (r.message.isNotEmpty() || edge == (int)std::size(edges))
+                break;
+            const auto status = e.bytes[0];
+            if (status != 0xfa && status != 0xfb && status != 0xfc)
+                continue;
+
+            const bool wantStop = edge == 1;
+            if ((status == 0xfc) != wantStop || std::abs(e.samplePosition - (edges[edge] + latency)) > 1)
+                r.message = juce::String::formatted("%s at sample %d, expected %s at %d",
+                    status == 0xfc ? "Stop" : "Start/Continue", (int)e.samplePosition,
+                    wantStop ? "Stop" : "Start/Continue", (int)(edges[edge] + latency));
+            ++edge;
+        }
+        if (r.message.isEmpty() && edge < (int)std::size(edges))
+            r.message = "only " + juce::String(edge) + " of 3 transport edges reached the clock";
+
+        r.passed = r.message.isEmpty();
+        if (r.passed)
+            r.message = "clock transport " + juce::String((int)latency) + " samples behind the host";
+        results.push_back(r);
+    }
+
+    // Banks: a program change just before note 62 switches to a second bank that maps
+    // note 62 elsewhere, so the switch must land inside that block
+    {
+        MTCGenAudioProcessor processor;
+        int second = processor.addBank("Second Bank");
+        processor.selectBank(second);
+        processor.editActiveCues([](CueStore& cues) {
+            cues.add(MappingEntry("02:00:00:00", 62, "Other Bank"));
+            });
+        processor.selectBank(0);
+
+        HostSimulator sim(processor, scriptSampleRate);
+        addStandardScript(sim);
+        const auto sr = (juce::int64)scriptSampleRate;
+        sim.addMidi(sr + sr / 4 + sr / 4 - 1, juce::MidiMessage::programChange(1, second));
+        sim.run();
+
+        results.push_back(checkGolden(sim, goldenDir, "banks_30_fullsysex", updateGoldens));
+    }
+
+    // MIDI thru: the trigger notes are dropped, an unmapped note is kept and moved to
+    // channel 2, and the generated MTC is unaffected
+    {
+        MTCGenAudioProcessor processor;
+        addSecondCue(processor);
+        auto& params = processor.getParameters();
+        params.getParameter(MTCGenAudioProcessor::thruTriggersParamID)->setValueNotifyingHost(0.0f);
+        auto* channel = params.getParameter(MTCGenAudioProcessor::thruChannelParamID);
+        channel->setValueNotifyingHost(channel->convertTo0to1(2.0f));
+
+        HostSimulator sim(processor, scriptSampleRate);
+        addStandardScript(sim);
+        const auto sr = (juce::int64)scriptSampleRate;
+        sim.addMidi(sr / 5, juce::MidiMessage::noteOn(1, 64, (juce::uint8)90));
+        sim.addMidi(sr / 2, juce::MidiMessage::noteOff(1, 64));
+        sim.run();
+
+        results.push_back(checkGolden(sim, goldenDir, "thru_30_fullsysex", updateGoldens));
+    }
+
+    // The feature suites; the audit comes last, as it covers every case before it
+    auto append = [&results](std::vector<Result> more) {
+        results.insert(results.end(), more.begin(), more.end());
+    };
+    append(MtcKernelSuite::run());
+    append(TraceOverheadSuite::run());
+    append(TimecodeSinkSuite::run());
+    append(ExportSuite::run());
+    append(ArtNetSuite::run());
+    append(CueStoreScanSuite::run());
+    append(BlockTimingSuite::run());
+    append(TriggerImportSuite::run());
+    append(ControlProtocolSuite::run());
+    append(CueLibrarySuite::run());
+    append(MappingTableSuite::run());
+    append(PlayheadDllSuite::run());
+    append(ControlServerSuite::run());
+    append(RealtimeAuditSuite::run());
+
+    return results;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file MtcGoldenSuite.h
+ * @brief Declaration of MtcGoldenSuite, golden-stream regression checks for the generator.
+ */
+
+#ifndef MTCGOLDENSUITE_H_INCLUDED
+#define MTCGOLDENSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "HostSimulator.h"
+
+class MTCGenAudioProcessor;
+
+/**
+ * @class MtcGoldenSuite
+ * @brief Runs MTCGenAudioProcessor through a fixed host script for every frame rate
+ * and MTC format, and compares the emitted byte streams with stored golden files.
+ *
+ * Golden files are named "mtc_<rate>_<format>.golden" inside the given directory, plus
+ * "clock_30_fullsysex.golden" for MIDI Clock, which also checks clock jitter, and the
+ * pre-roll, bank and MIDI thru streams. With updateGoldens set, the files are
+ * (re)written instead of compared. "preroll_clock_25" replays the pre-roll case with
+ * MIDI Clock on and checks that each host start and stop reaches the clock one
+ * reported latency later, without changing the MTC.
+ *
+ * run() then runs the feature suites, one per source file (MtcKernelSuite,
+ * TraceOverheadSuite, TimecodeSinkSuite, ExportSuite, ArtNetSuite, CueStoreScanSuite,
+ * BlockTimingSuite, TriggerImportSuite, ControlProtocolSuite, CueLibrarySuite,
+ * MappingTableSuite, PlayheadDllSuite, ControlServerSuite), and reports
+ * RealtimeAuditSuite last. They share Result and the host script declared here, and
+ * set up their cues through the processor's edit API, as the editor does.
+ *
+ * Built and run only by the MTCGenTests console target (Tests/MTCGenTests.jucer).
+ */
+class MtcGoldenSuite
+{
+public:
+    /**
+     * @struct Result
+     * @brief Outcome of one rate/format case.
+     */
+    struct Result
+    {
+        juce::String name;    /**< e.g. "mtc_29.97_quarterframe" */
+        bool passed{ false };
+        juce::String message; /**< First difference, or "updated" */
+    };
+
+    /**
+     * @brief Runs the golden cases, then every feature suite.
+     * @param goldenDir Directory holding the golden files.
+     * @param updateGoldens True to write the captured streams as the new goldens.
+     */
+    static std::vector<Result> run(const juce::File& goldenDir, bool updateGoldens);
+
+    /**
+     * @brief Adds the standard script (play, note-on/off, stop, scrub, loop, block size
+     * and sample-rate changes) to a simulator.
+     */
+    static void addStandardScript(HostSimulator& sim);
+
+    /**
+     * @brief Adds the script's second cue (note 62 at 01:00:00:00) to the active bank
+     * through MTCGenAudioProcessor::editActiveCues().
+     * @return Index of the new cue.
+     */
+    static int addSecondCue(MTCGenAudioProcessor& processor);
+
+    static constexpr double scriptSampleRate = 48000.0; /**< Rate the script starts at */
+};
+
+#endif // MTCGOLDENSUITE_H_INCLUDED
@@ -0,0 +1,97 @@
+/**
+ * @file MtcKernelSuite.cpp
+ * @brief Definitions for MtcKernelSuite methods.
+ */
+
+#include "MtcKernelSuite.h"
+#include "MtcKernels.h"
+#include "MTCGenProcessor.h"
+#include <cstring>
+
+namespace
+{
+    /**
+     * Feeds one synthetic stream (ten minutes of 64-sample blocks at 48 kHz, across an
+     * hour boundary, restarting every minute) to generic() and to the kernel for the
+     * rate and format. Fails on the first block where they differ; the message gives
+     * the time each encoder took for the whole stream.
+     */
+    MtcGoldenSuite::Result checkKernel(int rateIndex, bool quarterFrames)
+    {
+        const double rate = MTCGenAudioProcessor::frameRateChoices[rateIndex];
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 64;
+        constexpr int numBlocks = (int)(sampleRate * 600.0) / blockSize;
+        constexpr int restartEvery = (int)(sampleRate * 60.0) / blockSize;
+
+        MtcGoldenSuite::Result r;
+        r.name = "kernel_" + juce::String(rate) + "_" + (quarterFrames ? "quarterframe" : "fullsysex");
+        const auto kernel = MtcKernels::select(rateIndex, quarterFrames);
+
+        auto makeBlock = [](int index) {
+            MtcKernels::Block block;
+            block.outputTime = index * blockSize / sampleRate;
+            block.mtcOffset = 3600.0 - 30.0;
+            block.startMtc = block.outputTime + block.mtcOffset;
+            block.sampleRate = sampleRate;
+            block.numSamples = blockSize;
+            block.restart = index % restartEvery == 0;
+            return block;
+        };
+
+        // Byte-for-byte comparison, block by block
+        juce::MidiBuffer expected, actual;
+        expected.ensureSize(256);
+        actual.ensureSize(256);
+        juce::int64 expectedQf = 0, actualQf = 0;
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            const auto block = makeBlock(i);
+            expected.clear();
+            actual.clear();
+            MtcKernels::generic(expected, block, rate, quarterFrames, expectedQf);
+            kernel(actual, block, actualQf);
+
+            bool same = expected.getNumEvents() == actual.getNumEvents() && expectedQf == actualQf;
+            for (auto e = expected.begin(), a = actual.begin(); same && e != expected.end(); ++e, ++a)
+                same = (*e).samplePosition == (*a).samplePosition && (*e).numBytes == (*a).numBytes
+                    && std::memcmp((*e).data, (*a).data, (size_t)(*e).numBytes) == 0;
+
+            if (!same)
+            {
+                r.message = "differs from generic() in block " + juce::String(i);
+                return r;
+            }
+        }
+
+        // Timing: each encoder alone over the same stream
+        auto timeStream = [&](auto&& encode) {
+            juce::int64 nextQf = 0;
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                actual.clear();
+                encode(makeBlock(i), nextQf);
+            }
+            return juce::Time::getMillisecondCounterHiRes() - start;
+        };
+        const double genericMs = timeStream([&](const MtcKernels::Block& b, juce::int64& qf) {
+            MtcKernels::generic(actual, b, rate, quarterFrames, qf); });
+        const double kernelMs = timeStream([&](const MtcKernels::Block& b, juce::int64& qf) {
+            kernel(actual, b, qf); });
+
+        r.passed = true;
+        r.message = juce::String::formatted("generic %.1f ms, kernel %.1f ms", genericMs, kernelMs);
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> MtcKernelSuite::run()
+{
+    std::vector<MtcGoldenSuite::Result> results;
+    for (int rateIndex = 0; rateIndex < MtcKernels::numRates; ++rateIndex)
+        for (auto quarterFrames : { false, true })
+            results.push_back(checkKernel(rateIndex, quarterFrames));
+    return results;
+}
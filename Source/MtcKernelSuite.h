@@ -0,0 +1,25 @@
+/**
+ * @file MtcKernelSuite.h
+ * @brief Declaration of MtcKernelSuite, checks of the specialised MTC encoders.
+ */
+
+#ifndef MTCKERNELSUITE_H_INCLUDED
+#define MTCKERNELSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class MtcKernelSuite
+ * @brief "kernel_<rate>_<format>" results check each MtcKernels kernel against the
+ * generic encoder over a long synthetic stream and report both encoders' times.
+ */
+class MtcKernelSuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // MTCKERNELSUITE_H_INCLUDED
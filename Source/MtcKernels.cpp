@@ -0,0 +1,188 @@
+/**
+ * @file MtcKernels.cpp
+ * @brief Definitions for MtcKernels: the generic encoder, the kernels and their table.
+ */
+
+#include "MtcKernels.h"
+#include "MTCGenProcessor.h"
+#include "MtcPacket.h"
+#include "Timecode.h"
+#include <array>
+#include <cmath>
+
+namespace
+{
+    /** Compile-time constants of one rate index. */
+    template <int RateIndex>
+    struct Rate
+    {
+        static constexpr double fps = RateIndex == 0 ? 24.0 : RateIndex == 1 ? 25.0
+                                    : RateIndex == 2 ? 29.97 : 30.0;
+        static constexpr int nominalFps = RateIndex == 0 ? 24 : RateIndex == 1 ? 25 : 30;
+        static constexpr int code = Timecode::mtcRateCode(fps);
+        static constexpr double quartersPerSecond = fps * 4.0;
+        static constexpr bool wholeFrames = fps == (double)nominalFps;
+    };
+
+    static_assert(Rate<0>::fps == MTCGenAudioProcessor::frameRateChoices[0]
+        && Rate<1>::fps == MTCGenAudioProcessor::frameRateChoices[1]
+        && Rate<2>::fps == MTCGenAudioProcessor::frameRateChoices[2]
+        && Rate<3>::fps == MTCGenAudioProcessor::frameRateChoices[3],
+        "kernel rates must follow frameRateChoices");
+
+    /**
+     * Second byte of quarter-frame piece p for a field value v (0..63): the piece
+     * number, and the low or high nibble of the field (Timecode::quarterFrameValue()).
+     * Piece 7 carries the rate code.
+     */
+    using PieceTable = std::array<std::array<juce::uint8, 64>, 8>;
+
+    template <int RateIndex>
+    constexpr PieceTable makePieceTable()
+    {
+        PieceTable t{};
+        for (int v = 0; v < 64; ++v)
+        {
+            t[0][v] = (juce::uint8)(0x00 | (v & 0x0f));
+            t[1][v] = (juce::uint8)(0x10 | ((v >> 4) & 0x01));
+            t[2][v] = (juce::uint8)(0x20 | (v & 0x0f));
+            t[3][v] = (juce::uint8)(0x30 | ((v >> 4) & 0x03));
+            t[4][v] = (juce::uint8)(0x40 | (v & 0x0f));
+            t[5][v] = (juce::uint8)(0x50 | ((v >> 4) & 0x03));
+            t[6][v] = (juce::uint8)(0x60 | (v & 0x0f));
+            t[7][v] = (juce::uint8)(0x70 | ((v >> 4) & 0x01) | ((Rate<RateIndex>::code & 0x03) << 1));
+        }
+        return t;
+    }
+
+    template <int RateIndex>
+    constexpr PieceTable pieceTable = makePieceTable<RateIndex>();
+
+    static_assert(pieceTable<2>[7][16] == 0x77, "piece 7: hours bit 4 and, for 29.97, rate code 3");
+    static_assert(pieceTable<1>[3][59] == 0x33, "piece 3: seconds high bits");
+
+    /**
+     * Frame that the quarter-frame sequence starting at firstQuarterFrame carries. Whole
+     * rates split the frame count with integers; 29.97 keeps the generic conversion
+     * through seconds, so both paths number its frames the same.
+     */
+    template <int RateIndex>
+    Timecode sequenceTimecode(juce::int64 firstQuarterFrame) noexcept
+    {
+        using R = Rate<RateIndex>;
+        if constexpr (R::wholeFrames)
+        {
+            const auto frame = firstQuarterFrame / 4;
+            const auto totalSecs = frame / R::nominalFps;
+            Timecode tc;
+            tc.hours = (int)(totalSecs / 3600);
+            tc.minutes = (int)((totalSecs % 3600) / 60);
+            tc.seconds = (int)(totalSecs % 60);
+            tc.frames = (int)(frame % R::nominalFps);
+            return tc;
+        }
+        else
+        {
+            return Timecode::fromSeconds(firstQuarterFrame / R::quartersPerSecond + 1.0e-9, R::fps);
+        }
+    }
+
+    /** The eight quarter-frame data bytes of a sequence, from the piece table. */
+    template <int RateIndex>
+    std::array<juce::uint8, 8> encodeSequence(const Timecode& tc) noexcept
+    {
+        const auto& t = pieceTable<RateIndex>;
+        const int f = tc.frames & 63, s = tc.seconds & 63, m = tc.minutes & 63, h = tc.hours & 63;
+        return { t[0][f], t[1][f], t[2][s], t[3][s], t[4][m], t[5][m], t[6][h], t[7][h] };
+    }
+
+    template <int RateIndex, bool QuarterFrames>
+    void encode(juce::MidiBuffer& out, const MtcKernels::Block& block,
+        juce::int64& nextQuarterFrame)
+    {
+        using R = Rate<RateIndex>;
+
+        if (!QuarterFrames || block.restart)
+        {
+            auto fullFrame = MtcPacket::fullFrame(Timecode::fromSeconds(block.startMtc, R::fps),
+                R::code);
+            out.addEvent(fullFrame.data(), fullFrame.size, block.startSample);
+        }
+
+        if constexpr (QuarterFrames)
+        {
+            if (block.restart)
+                nextQuarterFrame = (juce::int64)std::ceil(
+                    block.startMtc * R::quartersPerSecond - 1.0e-6);
+
+            juce::int64 sequence = -1;
+            std::array<juce::uint8, 8> pieces{};
+
+            for (;; ++nextQuarterFrame)
+            {
+                double at = nextQuarterFrame / R::quartersPerSecond - block.mtcOffset;
+                int sample = (int)std::floor((at - block.outputTime) * block.sampleRate + 1.0e-6);
+                if (sample >= block.numSamples)
+                    break;
+
+                const int piece = (int)(nextQuarterFrame & 7);
+                if (nextQuarterFrame - piece != sequence)
+                {
+                    sequence = nextQuarterFrame - piece;
+                    pieces = encodeSequence<RateIndex>(sequenceTimecode<RateIndex>(sequence));
+                }
+
+                const juce::uint8 qf[MtcPacket::quarterFrameSize] = { 0xf1, pieces[(size_t)piece] };
+                out.addEvent(qf, MtcPacket::quarterFrameSize, juce::jmax(block.startSample, sample));
+            }
+        }
+    }
+
+    const MtcKernels::Function kernelTable[MtcKernels::numRates][2] = {
+        { encode<0, false>, encode<0, true> },
+        { encode<1, false>, encode<1, true> },
+        { encode<2, false>, encode<2, true> },
+        { encode<3, false>, encode<3, true> },
+    };
+}
+
+MtcKernels::Function MtcKernels::select(int rateIndex, bool quarterFrames) noexcept
+{
+    return kernelTable[juce::jlimit(0, numRates - 1, rateIndex)][quarterFrames ? 1 : 0];
+}
+
+//==============================================================================
+void MtcKernels::generic(juce::MidiBuffer& out, const Block& block, double frameRate,
+    bool quarterFrames, juce::int64& nextQuarterFrame)
+{
+    const int rateCode = Timecode::mtcRateCode(frameRate);
+
+    if (!quarterFrames || block.restart)
+    {
+        auto tc = Timecode::fromSeconds(block.startMtc, frameRate);
+        auto fullFrame = MtcPacket::fullFrame(tc, rateCode);
+        out.addEvent(fullFrame.data(), fullFrame.size, block.startSample);
+    }
+
+    if (quarterFrames)
+    {
+        const double quartersPerSecond = frameRate * 4.0;
+        if (block.restart)
+            nextQuarterFrame = (juce::int64)std::ceil(block.startMtc * quartersPerSecond - 1.0e-6);
+
+        for (;; ++nextQuarterFrame)
+        {
+            double at = nextQuarterFrame / quartersPerSecond - block.mtcOffset;
+            int sample = (int)std::floor((at - block.outputTime) * block.sampleRate + 1.0e-6);
+            if (sample >= block.numSamples)
+                break;
+
+            // All eight pieces carry the frame the sequence started on
+            int piece = (int)(nextQuarterFrame & 7);
+            auto tc = Timecode::fromSeconds(
+                (nextQuarterFrame - piece) / quartersPerSecond + 1.0e-9, frameRate);
+            auto qf = MtcPacket::quarterFrame(piece, tc, rateCode);
+            out.addEvent(qf.data(), qf.size, juce::jmax(block.startSample, sample));
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * @file MtcKernels.h
+ * @brief Declaration of MtcKernels, the MTC block encoder specialised per rate and format.
+ */
+
+#ifndef MTCKERNELS_H_INCLUDED
+#define MTCKERNELS_H_INCLUDED
+
+#include <JuceHeader.h>
+
+/**
+ * @class MtcKernels
+ * @brief Writes one block of MTC, with a kernel compiled for every frame rate and format.
+ *
+ * The generic encoder branches on the format in every block, divides by the runtime
+ * frame rate, and rebuilds every quarter-frame from seconds (Timecode::fromSeconds()
+ * and a switch on the piece). A kernel takes the rate code and format as template
+ * arguments instead: the rate's constants fold at compile time, and the eight
+ * quarter-frame bytes of a sequence come from constexpr tables, once per two frames.
+ * The processor looks its kernel up in a function table when the rate or format
+ * changes (select()).
+ *
+ * Kernels are indexed like MTCGenAudioProcessor::frameRateChoices: 0 = 24, 1 = 25,
+ * 2 = 29.97, 3 = 30 fps. The rate code they send is Timecode::mtcRateCode() of the
+ * rate, so 29.97 goes out with the 30 fps code. Every kernel emits exactly
+ * the bytes and sample positions of generic(), which is kept as the reference the
+ * golden suite checks and times the kernels against.
+ */
+class MtcKernels
+{
+public:
+    static constexpr int numRates = 4;
+
+    /**
+     * @struct Block
+     * @brief One block of the stream, as worked out by the processor.
+     */
+    struct Block
+    {
+        double outputTime{ 0.0 }; /**< Output time of the block's first sample */
+        double mtcOffset{ 0.0 };  /**< MTC time minus output time for the cue */
+        double startMtc{ 0.0 };   /**< MTC time the block's output starts at */
+        double sampleRate{ 44100.0 };
+        int startSample{ 0 };     /**< No message is placed before this sample */
+        int numSamples{ 0 };
+        bool restart{ false };    /**< Stream (re)starts: Full Frame, quarter-frames realign */
+    };
+
+    /**
+     * @brief A kernel: appends the block's messages to out.
+     * @param nextQuarterFrame Quarter-frame position, carried from block to block.
+     */
+    using Function = void (*)(juce::MidiBuffer& out, const Block& block,
+        juce::int64& nextQuarterFrame);
+
+    /**
+     * @brief Looks up the kernel for a rate index (0..3, clamped) and format.
+     */
+    static Function select(int rateIndex, bool quarterFrames) noexcept;
+
+    /**
+     * @brief The unspecialised encoder, with the rate and format decided at run time.
+     */
+    static void generic(juce::MidiBuffer& out, const Block& block, double frameRate,
+        bool quarterFrames, juce::int64& nextQuarterFrame);
+};
+
+#endif // MTCKERNELS_H_INCLUDED
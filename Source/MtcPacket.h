@@ -0,0 +1,70 @@
+/**
+ * @file MtcPacket.h
+ * @brief Declaration of the MtcPacket struct, a fixed-size encoded MTC message.
+ */
+
+#ifndef MTCPACKET_H_INCLUDED
+#define MTCPACKET_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <array>
+#include "Timecode.h"
+
+/**
+ * @struct MtcPacket
+ * @brief One MTC message (a Full Frame SysEx or a quarter-frame) encoded into inline
+ * storage, so building it never touches the heap.
+ *
+ * juce::MidiMessage keeps anything longer than a pointer on the heap, so every Full
+ * Frame built with MidiMessage::fullFrame() allocated. The audio thread encodes a
+ * packet once and hands its raw bytes to the MidiBuffer and to every port's queue.
+ */
+struct MtcPacket
+{
+    static constexpr int fullFrameSize = 10;   /**< F0 7F 7F 01 01 hr mn sc fr F7 */
+    static constexpr int quarterFrameSize = 2; /**< F1 0p|dddd */
+
+    std::array<juce::uint8, fullFrameSize> bytes{};
+    int size{ 0 };
+
+    const juce::uint8* data() const noexcept { return bytes.data(); }
+
+    /**
+     * @brief Encodes a Full Frame message (device ID 7F, all devices).
+     * @param rateCode MTC rate code (see Timecode::mtcRateCode()).
+     */
+    static MtcPacket fullFrame(const Timecode& tc, int rateCode) noexcept
+    {
+        MtcPacket p;
+        p.bytes = { 0xf0, 0x7f, 0x7f, 0x01, 0x01,
+                    (juce::uint8)(((rateCode & 0x03) << 5) | (tc.hours & 0x1f)),
+                    (juce::uint8)(tc.minutes & 0x3f),
+                    (juce::uint8)(tc.seconds & 0x3f),
+                    (juce::uint8)(tc.frames & 0x1f),
+                    0xf7 };
+        p.size = fullFrameSize;
+        return p;
+    }
+
+    /**
+     * @brief Encodes quarter-frame piece 0..7 of a frame.
+     * @param rateCode MTC rate code, carried by piece 7.
+     */
+    static MtcPacket quarterFrame(int piece, const Timecode& tc, int rateCode) noexcept
+    {
+        MtcPacket p;
+        p.bytes[0] = 0xf1;
+        p.bytes[1] = (juce::uint8)(((piece & 7) << 4) | tc.quarterFrameValue(piece, rateCode));
+        p.size = quarterFrameSize;
+        return p;
+    }
+
+    /** @brief True if the bytes are a Full Frame message. */
+    static bool isFullFrame(const juce::uint8* b, int numBytes) noexcept
+    {
+        return numBytes == fullFrameSize && b[0] == 0xf0 && b[1] == 0x7f
+            && b[3] == 0x01 && b[4] == 0x01;
+    }
+};
+
+#endif // MTCPACKET_H_INCLUDED
@@ -0,0 +1,142 @@
+/**
+ * @file PlayheadDll.cpp
+ * @brief Definitions for PlayheadDll methods.
+ */
+
+#include "PlayheadDll.h"
+#include <cmath>
+
+namespace
+{
+    /** Raises a relaxed atomic maximum (single writer). */
+    void storeMax(std::atomic<double>& target, double value) noexcept
+    {
+        if (value > target.load(std::memory_order_relaxed))
+            target.store(value, std::memory_order_relaxed);
+    }
+}
+
+void PlayheadDll::prepare(double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    locked = false;
+    haveHostTime = false;
+    lastNumSamples = 0;
+}
+
+double PlayheadDll::snap(double position) noexcept
+{
+    locked = true;
+    time = position;
+    rate = 1.0 / sampleRate;
+    rateRatio.store(1.0, std::memory_order_relaxed);
+    return position;
+}
+
+/**
+ * @brief Measures callback jitter, then runs one loop step against the host position.
+ * Every path updates lastNumSamples, so the next prediction spans this block.
+ */
+double PlayheadDll::process(double hostSeconds, juce::Optional<juce::int64> hostSamples,
+    juce::Optional<juce::uint64> hostTimeNs, bool playing, int numSamples) noexcept
+{
+    if (resetRequested.exchange(false))
+    {
+        numBlocks.store(0, std::memory_order_relaxed);
+        numSnaps.store(0, std::memory_order_relaxed);
+        sumSquaredResidual.store(0.0, std::memory_order_relaxed);
+        maxResidual.store(0.0, std::memory_order_relaxed);
+        numCallbacks.store(0, std::memory_order_relaxed);
+        sumSquaredJitter.store(0.0, std::memory_order_relaxed);
+        maxJitter.store(0.0, std::memory_order_relaxed);
+    }
+
+    const int elapsedSamples = lastNumSamples;
+    lastNumSamples = numSamples;
+
+    // 1) Callback jitter: wall-clock spacing against the previous block's duration
+    if (hostTimeNs.hasValue())
+    {
+        if (haveHostTime && elapsedSamples > 0 && *hostTimeNs > lastHostTimeNs)
+        {
+            const double spacing = (double)(*hostTimeNs - lastHostTimeNs) * 1.0e-9;
+            const double jitter = std::abs(spacing - elapsedSamples / sampleRate);
+            numCallbacks.store(numCallbacks.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+            sumSquaredJitter.store(sumSquaredJitter.load(std::memory_order_relaxed)
+                + jitter * jitter, std::memory_order_relaxed);
+            storeMax(maxJitter, jitter);
+        }
+        lastHostTimeNs = *hostTimeNs;
+        haveHostTime = true;
+    }
+
+    // The measured position, used for every return below so the timebase never switches
+    // between the host's samples and its seconds
+    const double reported = hostSamples.hasValue() ? (double)*hostSamples / sampleRate
+                                                   : hostSeconds;
+
+    // 2) Stopped: nothing to smooth, restart the loop on the next start
+    if (!playing)
+    {
+        locked = false;
+        return reported;
+    }
+
+    if (!locked || elapsedSamples <= 0)
+    {
+        numSnaps.store(numSnaps.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return snap(reported);
+    }
+
+    // 3) Loop step
+    const double predicted = time + rate * elapsedSamples;
+    const double e = reported - predicted;
+
+    if (std::abs(e) > jumpSeconds)
+    {
+        numSnaps.store(numSnaps.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return snap(reported);
+    }
+
+    numBlocks.store(numBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sumSquaredResidual.store(sumSquaredResidual.load(std::memory_order_relaxed) + e * e,
+        std::memory_order_relaxed);
+    storeMax(maxResidual, std::abs(e));
+
+    // Sample-exact host: the residual is rounding, follow it exactly
+    if (std::abs(e) * sampleRate < 0.5)
+    {
+        time = reported;
+        return reported;
+    }
+
+    const double w = juce::MathConstants<double>::twoPi * bandwidthHz * elapsedSamples / sampleRate;
+    const double nominal = 1.0 / sampleRate;
+
+    // Never run backwards: a late report holds the time rather than rewinding it
+    time = juce::jmax(time, predicted + juce::MathConstants<double>::sqrt2 * w * e);
+    rate = juce::jlimit(nominal * 0.5, nominal * 2.0, rate + w * w * e / elapsedSamples);
+    rateRatio.store(rate * sampleRate, std::memory_order_relaxed);
+    return time;
+}
+
+PlayheadDll::Stats PlayheadDll::getStats() const
+{
+    Stats s;
+    s.numBlocks = numBlocks.load(std::memory_order_relaxed);
+    s.numSnaps = numSnaps.load(std::memory_order_relaxed);
+    if (s.numBlocks > 0)
+        s.rmsResidualMs = std::sqrt(sumSquaredResidual.load(std::memory_order_relaxed)
+            / (double)s.numBlocks) * 1000.0;
+    s.maxResidualMs = maxResidual.load(std::memory_order_relaxed) * 1000.0;
+    s.rateRatio = rateRatio.load(std::memory_order_relaxed);
+
+    const auto callbacks = numCallbacks.load(std::memory_order_relaxed);
+    s.hasHostTime = callbacks > 0;
+    if (callbacks > 0)
+        s.rmsCallbackJitterMs = std::sqrt(sumSquaredJitter.load(std::memory_order_relaxed)
+            / (double)callbacks) * 1000.0;
+    s.maxCallbackJitterMs = maxJitter.load(std::memory_order_relaxed) * 1000.0;
+    return s;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file PlayheadDll.h
+ * @brief Declaration of the PlayheadDll class (delay-locked loop over the host playhead).
+ */
+
+#ifndef PLAYHEADDLL_H_INCLUDED
+#define PLAYHEADDLL_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <atomic>
+
+/**
+ * @class PlayheadDll
+ * @brief Smooths the host's playhead position into a steady, monotonic timebase.
+ *
+ * Some hosts report positions that jitter from block to block or are quantised (to a
+ * millisecond, to their own buffer), and that jitter would go straight into the emitted
+ * frames. While the transport plays, a second-order delay-locked loop predicts each
+ * block's position from the previous one and the samples in between, at an estimated
+ * rate (timeline seconds per sample, nominally 1 / sampleRate), and moves only part of
+ * the way towards what the host reports:
+ *
+ *     e = reported - predicted;  time = predicted + b * e;  rate += c * e / samples
+ *
+ * with b = sqrt(2) * w, c = w * w and w = 2 * pi * bandwidth * block duration.
+ *
+ * The loop snaps to the host (and restarts) on a real discontinuity: transport start or
+ * stop, a locate or loop, any residual above jumpSeconds. A residual below half a sample
+ * is rounding, not jitter, so a sample-exact host is passed through untouched.
+ *
+ * The measured position is the host's sample position when it reports one, else its
+ * time in seconds. Its host time (getHostTimeNs) measures callback jitter: how far the
+ * wall-clock spacing of blocks strays from their duration. It does not drive the loop:
+ * the samples between blocks are exact, while the wall clock carries that very jitter.
+ * Both residuals are kept as statistics in relaxed atomics written by the audio thread,
+ * so hosts can be compared.
+ */
+class PlayheadDll
+{
+public:
+    static constexpr double bandwidthHz = 0.5;  /**< Loop bandwidth */
+    static constexpr double jumpSeconds = 0.05; /**< Larger residuals are a locate */
+
+    /**
+     * @struct Stats
+     * @brief A snapshot of the residuals, in milliseconds.
+     */
+    struct Stats
+    {
+        juce::int64 numBlocks{ 0 };     /**< Blocks tracked while playing */
+        juce::int64 numSnaps{ 0 };      /**< Discontinuities (locates, starts) */
+        double rmsResidualMs{ 0.0 };    /**< Reported minus predicted position */
+        double maxResidualMs{ 0.0 };
+        double rateRatio{ 1.0 };        /**< Estimated rate relative to the sample rate */
+        bool hasHostTime{ false };      /**< The host reports getHostTimeNs */
+        double rmsCallbackJitterMs{ 0.0 };
+        double maxCallbackJitterMs{ 0.0 };
+    };
+
+    /** @brief Sets the sample rate and forgets the loop state. Audio thread. */
+    void prepare(double sampleRate) noexcept;
+
+    /**
+     * @brief Tracks one block and returns the smoothed time of its first sample.
+     * Audio thread only.
+     * @param hostSeconds Host position in seconds.
+     * @param hostSamples Host position in samples, if reported.
+     * @param hostTimeNs Host's system time for the block, if reported.
+     * @param playing Host transport state.
+     * @param numSamples Samples in this block.
+     */
+    double process(double hostSeconds, juce::Optional<juce::int64> hostSamples,
+        juce::Optional<juce::uint64> hostTimeNs, bool playing, int numSamples) noexcept;
+
+    /** @brief Returns a snapshot. Safe from any thread. */
+    Stats getStats() const;
+
+    /** @brief Clears the statistics at the next block. Safe from any thread. */
+    void reset() noexcept { resetRequested.store(true); }
+
+private:
+    /** Restarts the loop at the host's measured position. */
+    double snap(double position) noexcept;
+
+    // Audio thread only
+    double sampleRate{ 44100.0 };
+    bool locked{ false };
+    double time{ 0.0 };               /**< Smoothed position of the current block */
+    double rate{ 0.0 };               /**< Timeline seconds per sample */
+    int lastNumSamples{ 0 };
+    juce::uint64 lastHostTimeNs{ 0 };
+    bool haveHostTime{ false };
+
+    // Written by the audio thread, read by anyone
+    std::atomic<juce::int64> numBlocks{ 0 };
+    std::atomic<juce::int64> numSnaps{ 0 };
+    std::atomic<double> sumSquaredResidual{ 0.0 };
+    std::atomic<double> maxResidual{ 0.0 };
+    std::atomic<double> rateRatio{ 1.0 };
+    std::atomic<juce::int64> numCallbacks{ 0 };
+    std::atomic<double> sumSquaredJitter{ 0.0 };
+    std::atomic<double> maxJitter{ 0.0 };
+
+    std::atomic<bool> resetRequested{ false };
+};
+
+#endif // PLAYHEADDLL_H_INCLUDED
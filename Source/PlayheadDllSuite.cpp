@@ -0,0 +1,204 @@
+/**
+ * @file PlayheadDllSuite.cpp
+ * @brief Definitions for PlayheadDllSuite methods.
+ */
+
+#include "PlayheadDllSuite.h"
+#include "MTCGenProcessor.h"
+#include <cmath>
+
+namespace
+{
+    constexpr int blockSize = 512;
+
+    /** One block: where the transport really was and the time the processor used. */
+    struct Block
+    {
+        double exact;
+        double smoothed;
+    };
+
+    /** A playing segment, optionally starting with a locate. */
+    HostSimulator::TransportSegment playFor(double seconds, double locateSeconds = -1.0)
+    {
+        HostSimulator::TransportSegment s;
+        s.lengthSamples = (juce::int64)(seconds * MtcGoldenSuite::scriptSampleRate);
+        s.blockSize = blockSize;
+        s.locateSeconds = locateSeconds;
+        return s;
+    }
+
+    /** Plays the segments against a host reporting with error and records every block. */
+    PlayheadDll::Stats play(const std::vector<HostSimulator::TransportSegment>& segments,
+        const HostSimulator::PositionError& error, std::vector<Block>& blocks)
+    {
+        MTCGenAudioProcessor processor;
+        HostSimulator sim(processor, MtcGoldenSuite::scriptSampleRate);
+        sim.setPositionError(error);
+
+        juce::int64 total = 0;
+        for (auto& s : segments)
+        {
+            sim.addSegment(s);
+            total += s.lengthSamples;
+        }
+
+        blocks.clear();
+        blocks.reserve((size_t)(total / blockSize + (juce::int64)segments.size()));
+        sim.onBlock = [&]() { blocks.push_back({ sim.getTransportSeconds(), processor.getBlockTime() }); };
+        sim.run();
+        return processor.getPlayheadDll().getStats();
+    }
+
+    /** True where the transport jumped between blocks i - 1 and i: a locate. */
+    bool isLocate(const std::vector<Block>& blocks, size_t i)
+    {
+        const double step = blocks[i].exact - blocks[i - 1].exact;
+        return step < 0.0 || step > 2.0 * blockSize / MtcGoldenSuite::scriptSampleRate;
+    }
+
+    /**
+     * Checks a run against a host with position error: no residual above maxResidualMs,
+     * no false locate, the smoothed time within maxErrorMs of the transport (and its rms
+     * within maxRmsErrorMs) once the loop has settled, and strictly increasing from block
+     * to block.
+     */
+    MtcGoldenSuite::Result checkSmoothing(const char* name, const HostSimulator::PositionError& error,
+        double maxResidualMs, double maxErrorMs, double maxRmsErrorMs)
+    {
+        MtcGoldenSuite::Result r;
+        r.name = name;
+
+        std::vector<Block> blocks;
+        const auto stats = play({ playFor(60.0) }, error, blocks);
+
+        // The loop starts from one erroneous report and takes a few time constants to settle
+        const double settledAfter = 10.0;
+        double worstMs = 0.0, sumSquaredMs = 0.0;
+        int numSettled = 0;
+        for (size_t i = 1; i < blocks.size() && r.message.isEmpty(); ++i)
+        {
+            if (blocks[i].smoothed <= blocks[i - 1].smoothed)
+                r.message = juce::String::formatted("time ran backwards at %.6f s: %.6f after %.6f",
+                    blocks[i].exact, blocks[i].smoothed, blocks[i - 1].smoothed);
+            else if (blocks[i].exact >= settledAfter)
+            {
+                const double errorMs = (blocks[i].smoothed - blocks[i].exact) * 1000.0;
+                worstMs = juce::jmax(worstMs, std::abs(errorMs));
+                sumSquaredMs += errorMs * errorMs;
+                ++numSettled;
+            }
+        }
+        const double rmsMs = numSettled > 0 ? std::sqrt(sumSquaredMs / numSettled) : 0.0;
+
+        if (r.message.isNotEmpty())
+            return r;
+
+        if (stats.numSnaps != 1)
+            r.message = "snapped " + juce::String(stats.numSnaps) + " times, expected only the start";
+        else if (stats.numBlocks != (juce::int64)blocks.size() - 1)
+            r.message = "tracked " + juce::String(stats.numBlocks) + " of " + juce::String((int)blocks.size() - 1) + " blocks";
+        else if (stats.maxResidualMs > maxResidualMs)
+            r.message = juce::String::formatted("max residual %.3f ms, limit %.3f ms", stats.maxResidualMs, maxResidualMs);
+        else if (worstMs > maxErrorMs)
+            r.message = juce::String::formatted("smoothed time %.3f ms from the transport, limit %.3f ms", worstMs, maxErrorMs);
+        else if (rmsMs > maxRmsErrorMs)
+            r.message = juce::String::formatted("smoothed time rms %.3f ms from the transport, limit %.3f ms", rmsMs, maxRmsErrorMs);
+        else
+        {
+            r.passed = true;
+            r.message = juce::String::formatted("residual rms %.3f max %.3f ms, smoothed rms %.3f max %.3f ms, rate %.6f",
+                stats.rmsResidualMs, stats.maxResidualMs, rmsMs, worstMs, stats.rateRatio);
+        }
+        return r;
+    }
+
+    /** A host reporting every sample exactly gets its own positions back. */
+    MtcGoldenSuite::Result checkExact()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "dll_exact";
+
+        std::vector<Block> blocks;
+        const auto stats = play({ playFor(10.0) }, {}, blocks);
+
+        for (auto& b : blocks)
+            if (std::abs(b.smoothed - b.exact) > 1.0e-9)
+            {
+                r.message = juce::String::formatted("%.9f s reported, %.9f s used", b.exact, b.smoothed);
+                return r;
+            }
+
+        r.passed = stats.numSnaps == 1 && stats.maxResidualMs * MtcGoldenSuite::scriptSampleRate < 500.0;
+        if (!r.passed)
+            r.message = juce::String::formatted("%d snaps, max residual %.6f ms",
+                (int)stats.numSnaps, stats.maxResidualMs);
+        return r;
+    }
+
+    /**
+     * A jittering host locates 55 s forward, then 60 ms back, just over jumpSeconds. Each
+     * locate must snap: the first block after it uses the reported position, not a step
+     * of the loop towards it.
+     */
+    MtcGoldenSuite::Result checkRelocate()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "dll_relocate";
+
+        HostSimulator::PositionError error;
+        error.jitterSeconds = 0.001;
+
+        std::vector<Block> blocks;
+        const auto stats = play({ playFor(5.0), playFor(5.0, 60.0), playFor(5.0, 64.94) }, error, blocks);
+
+        int numLocates = 0;
+        for (size_t i = 1; i < blocks.size() && r.message.isEmpty(); ++i)
+        {
+            if (isLocate(blocks, i))
+            {
+                ++numLocates;
+                const double offMs = std::abs(blocks[i].smoothed - blocks[i].exact) * 1000.0;
+                if (offMs > error.jitterSeconds * 1000.0 + 0.05)
+                    r.message = juce::String::formatted("locate to %.3f s used %.6f s, %.3f ms off",
+                        blocks[i].exact, blocks[i].smoothed, offMs);
+            }
+            else if (blocks[i].smoothed <= blocks[i - 1].smoothed)
+                r.message = juce::String::formatted("time ran backwards at %.6f s", blocks[i].exact);
+        }
+
+        if (r.message.isNotEmpty())
+            return r;
+
+        if (numLocates != 2)
+            r.message = "script has " + juce::String(numLocates) + " locates, expected 2";
+        else if (stats.numSnaps != 3)
+            r.message = "snapped " + juce::String(stats.numSnaps) + " times, expected the start and 2 locates";
+        else
+        {
+            r.passed = true;
+            r.message = juce::String::formatted("residual rms %.3f ms", stats.rmsResidualMs);
+        }
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> PlayheadDllSuite::run()
+{
+    HostSimulator::PositionError jitter;
+    jitter.jitterSeconds = 0.002;
+
+    HostSimulator::PositionError quantised;
+    quantised.quantumSeconds = 0.001;
+
+    // Jitter of +/-2 ms is 1.15 ms rms as reported; smoothed it must be well under half
+    // that. Rounding down is a bias the loop cannot see, so it only has to stay within
+    // one quantum.
+    return {
+        checkExact(),
+        checkSmoothing("dll_jitter", jitter, 5.0, 1.5, 0.5),
+        checkSmoothing("dll_quantised", quantised, 2.0, 1.0, 1.0),
+        checkRelocate()
+    };
+}
@@ -0,0 +1,32 @@
+/**
+ * @file PlayheadDllSuite.h
+ * @brief Declaration of PlayheadDllSuite, checks of the playhead smoothing loop.
+ */
+
+#ifndef PLAYHEADDLLSUITE_H_INCLUDED
+#define PLAYHEADDLLSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class PlayheadDllSuite
+ * @brief Plays the processor against hosts whose reported position strays from the
+ * transport (HostSimulator::PositionError) and checks the time the PlayheadDll hands the
+ * generator each block:
+ *
+ * - "dll_exact": a sample-exact host is passed through untouched
+ * - "dll_jitter": +/-2 ms of random error; the residual stays bounded, the smoothed time
+ *   stays close to the transport and never runs backwards
+ * - "dll_quantised": positions rounded down to a millisecond, with the same checks
+ * - "dll_relocate": locates forward and 60 ms back snap to the new position at once
+ */
+class PlayheadDllSuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // PLAYHEADDLLSUITE_H_INCLUDED
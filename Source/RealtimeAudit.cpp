@@ -0,0 +1,316 @@
+/**
+ * @file RealtimeAudit.cpp
+ * @brief Definitions for RealtimeAudit methods and, when MTCGEN_RT_AUDIT is enabled,
+ * the replaced global allocator.
+ */
+
+#include "RealtimeAudit.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if MTCGEN_RT_AUDIT && (JUCE_LINUX || JUCE_MAC)
+ #include <execinfo.h>
+#elif MTCGEN_RT_AUDIT && JUCE_WINDOWS
+ #include <windows.h>
+#endif
+
+namespace
+{
+    constexpr int maxSites = 256;
+    constexpr int maxFrames = 24;
+
+    /** One distinct violation site. key is 0 while the slot is free. */
+    struct Site
+    {
+        std::atomic<juce::uint64> key{ 0 };
+        std::atomic<int> count{ 0 };
+        std::atomic<bool> ready{ false };
+        RealtimeAudit::Kind kind{ RealtimeAudit::Allocation };
+        const char* section{ nullptr };
+        const char* what{ nullptr };
+        void* frames[maxFrames]{};
+        int numFrames{ 0 };
+    };
+
+    Site sites[maxSites];
+    std::atomic<int> numSites{ 0 };
+
+    thread_local const char* currentSection = nullptr;
+    thread_local bool recording = false;   // guards against re-entry from backtrace()
+
+    int captureFrames(void** frames, int max) noexcept
+    {
+       #if MTCGEN_RT_AUDIT && (JUCE_LINUX || JUCE_MAC)
+        return backtrace(frames, max);
+       #elif MTCGEN_RT_AUDIT && JUCE_WINDOWS
+        return (int)CaptureStackBackTrace(0, (DWORD)max, frames, nullptr);
+       #else
+        juce::ignoreUnused(frames, max);
+        return 0;
+       #endif
+    }
+
+    /** FNV-1a over the return addresses, skipping the audit's own frames. */
+    juce::uint64 hashFrames(void* const* frames, int numFrames) noexcept
+    {
+        juce::uint64 h = 14695981039346656037ull;
+        for (int i = 0; i < numFrames; ++i)
+        {
+            auto v = (juce::uint64)(juce::pointer_sized_uint)frames[i];
+            for (int b = 0; b < 8; ++b)
+            {
+                h ^= (v >> (b * 8)) & 0xff;
+                h *= 1099511628211ull;
+            }
+        }
+        return h != 0 ? h : 1;
+    }
+
+    /**
+     * Stores a violation in the fixed table without allocating. Sites are matched on
+     * (kind, stack hash); the first thread to claim a free slot fills in its details.
+     */
+    void record(RealtimeAudit::Kind kind, const char* what) noexcept
+    {
+        if (currentSection == nullptr || recording)
+            return;
+
+        recording = true;
+
+        void* frames[maxFrames];
+        int numFrames = captureFrames(frames, maxFrames);
+        constexpr int skip = 2; // captureFrames' caller and record() itself
+        void** siteFrames = frames + juce::jmin(skip, numFrames);
+        int numSiteFrames = juce::jmax(0, numFrames - skip);
+
+        juce::uint64 key = hashFrames(siteFrames, numSiteFrames) ^ ((juce::uint64)kind << 60);
+        if (key == 0)
+            key = 1;
+
+        for (int probe = 0; probe < maxSites; ++probe)
+        {
+            auto& site = sites[(key + (juce::uint64)probe) % maxSites];
+            juce::uint64 existing = site.key.load(std::memory_order_acquire);
+
+            if (existing == 0 && site.key.compare_exchange_strong(existing, key,
+                    std::memory_order_acq_rel))
+            {
+                site.kind = kind;
+                site.section = currentSection;
+                site.what = what;
+                site.numFrames = numSiteFrames;
+                for (int i = 0; i < numSiteFrames; ++i)
+                    site.frames[i] = siteFrames[i];
+                // Another thread may already have counted a hit here (it sees the key as
+                // soon as it is published), so add rather than store; clear() leaves 0
+                site.count.fetch_add(1, std::memory_order_relaxed);
+                site.ready.store(true, std::memory_order_release);
+                numSites.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+
+            if (existing == key)
+            {
+                site.count.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+        }
+
+        recording = false;
+    }
+
+    const char* kindName(RealtimeAudit::Kind kind) noexcept
+    {
+        switch (kind)
+        {
+            case RealtimeAudit::Allocation:   return "allocation";
+            case RealtimeAudit::Deallocation: return "deallocation";
+            case RealtimeAudit::LockAcquire:  return "lock";
+            case RealtimeAudit::BlockingCall: return "blocking call";
+        }
+        return "?";
+    }
+
+    /**
+     * glibc's backtrace() loads libgcc_s (and allocates) on its first call. Do that once
+     * at start-up so the first recorded violation does not recurse into the allocator.
+     */
+    struct BacktraceWarmUp
+    {
+        BacktraceWarmUp() noexcept
+        {
+            void* frames[2];
+            captureFrames(frames, 2);
+        }
+    } backtraceWarmUp;
+}
+
+//==============================================================================
+RealtimeAudit::ScopedRealtimeSection::ScopedRealtimeSection(const char* sectionName) noexcept
+    : previousSection(currentSection)
+{
+    currentSection = sectionName;
+}
+
+RealtimeAudit::ScopedRealtimeSection::~ScopedRealtimeSection() noexcept
+{
+    currentSection = previousSection;
+}
+
+void RealtimeAudit::noteLock(const char* lockName) noexcept
+{
+    record(LockAcquire, lockName);
+}
+
+void RealtimeAudit::noteBlockingCall(const char* callName) noexcept
+{
+    record(BlockingCall, callName);
+}
+
+void RealtimeAudit::noteAllocation(Kind kind) noexcept
+{
+    record(kind, nullptr);
+}
+
+bool RealtimeAudit::isInRealtimeSection() noexcept
+{
+    return currentSection != nullptr;
+}
+
+int RealtimeAudit::getNumViolations() noexcept
+{
+    return numSites.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+std::vector<RealtimeAudit::Violation> RealtimeAudit::getViolations()
+{
+    std::vector<Violation> result;
+
+    for (auto& site : sites)
+    {
+        if (!site.ready.load(std::memory_order_acquire))
+            continue;
+
+        Violation v;
+        v.kind = site.kind;
+        v.section = site.section;
+        v.what = site.what;
+        v.stackId = site.key.load(std::memory_order_relaxed);
+        v.count = site.count.load(std::memory_order_relaxed);
+
+       #if MTCGEN_RT_AUDIT && (JUCE_LINUX || JUCE_MAC)
+        if (char** symbols = backtrace_symbols(site.frames, site.numFrames))
+        {
+            for (int i = 0; i < site.numFrames; ++i)
+                v.stack << "    " << symbols[i] << "\n";
+            std::free(symbols);
+        }
+       #else
+        for (int i = 0; i < site.numFrames; ++i)
+            v.stack << "    0x" << juce::String::toHexString((juce::pointer_sized_int)site.frames[i]) << "\n";
+       #endif
+
+        result.push_back(v);
+    }
+
+    return result;
+}
+
+juce::String RealtimeAudit::createReport()
+{
+    juce::String report;
+
+    for (auto& v : getViolations())
+    {
+        report << kindName(v.kind);
+        if (v.what != nullptr)
+            report << " '" << v.what << "'";
+        report << " in " << (v.section != nullptr ? v.section : "?")
+               << " x" << v.count
+               << " [stack " << juce::String::toHexString((juce::int64)v.stackId) << "]\n"
+               << v.stack;
+    }
+
+    return report;
+}
+
+void RealtimeAudit::clear() noexcept
+{
+    for (auto& site : sites)
+    {
+        site.ready.store(false, std::memory_order_relaxed);
+        site.count.store(0, std::memory_order_relaxed);
+        site.key.store(0, std::memory_order_release);
+    }
+    numSites.store(0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+#if MTCGEN_RT_AUDIT
+/*
+ * Replaced global allocator. Every form forwards to malloc/free and reports the call
+ * when the current thread is inside a realtime section.
+ */
+namespace
+{
+    void* auditedAlloc(std::size_t size)
+    {
+        RealtimeAudit::noteAllocation(RealtimeAudit::Allocation);
+        if (void* p = std::malloc(size != 0 ? size : 1))
+            return p;
+        throw std::bad_alloc();
+    }
+
+    void* auditedAlignedAlloc(std::size_t size, std::align_val_t align)
+    {
+        RealtimeAudit::noteAllocation(RealtimeAudit::Allocation);
+        auto alignment = juce::jmax((std::size_t)align, sizeof(void*));
+        size = (juce::jmax(size, (std::size_t)1) + alignment - 1) / alignment * alignment;
+       #if JUCE_WINDOWS
+        if (void* p = _aligned_malloc(size, alignment))
+       #else
+        if (void* p = std::aligned_alloc(alignment, size))
+       #endif
+            return p;
+        throw std::bad_alloc();
+    }
+
+    void auditedFree(void* p) noexcept
+    {
+        if (p != nullptr)
+            RealtimeAudit::noteAllocation(RealtimeAudit::Deallocation);
+        std::free(p);
+    }
+
+    void auditedAlignedFree(void* p) noexcept
+    {
+        if (p != nullptr)
+            RealtimeAudit::noteAllocation(RealtimeAudit::Deallocation);
+       #if JUCE_WINDOWS
+        _aligned_free(p);
+       #else
+        std::free(p);
+       #endif
+    }
+}
+
+void* operator new(std::size_t size)                                   { return auditedAlloc(size); }
+void* operator new[](std::size_t size)                                 { return auditedAlloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept   { try { return auditedAlloc(size); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { try { return auditedAlloc(size); } catch (...) { return nullptr; } }
+void* operator new(std::size_t size, std::align_val_t a)               { return auditedAlignedAlloc(size, a); }
+void* operator new[](std::size_t size, std::align_val_t a)             { return auditedAlignedAlloc(size, a); }
+
+void operator delete(void* p) noexcept                                 { auditedFree(p); }
+void operator delete[](void* p) noexcept                               { auditedFree(p); }
+void operator delete(void* p, std::size_t) noexcept                    { auditedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept                  { auditedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept          { auditedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept        { auditedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept               { auditedAlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept             { auditedAlignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept  { auditedAlignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { auditedAlignedFree(p); }
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file RealtimeAudit.h
+ * @brief Declaration of RealtimeAudit, a debug/test mode that catches non-realtime-safe
+ * calls on the audio thread.
+ */
+
+#ifndef REALTIMEAUDIT_H_INCLUDED
+#define REALTIMEAUDIT_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+
+/**
+ * Set MTCGEN_RT_AUDIT=1 in the Projucer's preprocessor definitions (test/debug builds
+ * only) to enable the audit. It replaces the global operator new/delete, so leave it
+ * off for release and plugin builds shipped to hosts.
+ */
+#ifndef MTCGEN_RT_AUDIT
+ #define MTCGEN_RT_AUDIT 0
+#endif
+
+/**
+ * @class RealtimeAudit
+ * @brief Records allocations, lock acquisitions and known blocking calls made while a
+ * thread is inside a realtime section.
+ *
+ * Realtime sections are marked with MTCGEN_RT_SCOPE (processBlock).
+ * With MTCGEN_RT_AUDIT enabled, every heap allocation/deallocation inside a section is
+ * caught by the replaced global allocator; locks and blocking calls are reported by the
+ * MTCGEN_RT_LOCK / MTCGEN_RT_BLOCKING markers placed at those call sites. The markers
+ * sit on the locks and waits of the classes processBlock calls into (output router,
+ * timecode dispatcher and sinks, port senders), so a change that lets one of them
+ * reach the audio thread fails the suite.
+ *
+ * Each distinct (kind, call stack) pair is stored once in a fixed table, with a hit count
+ * and a stack identifier (hash of the return addresses), so recording never allocates.
+ * A headless test fails when getNumViolations() is non-zero and prints createReport().
+ */
+class RealtimeAudit
+{
+public:
+    /**
+     * @enum Kind
+     * @brief What went wrong.
+     */
+    enum Kind
+    {
+        Allocation = 0,
+        Deallocation,
+        LockAcquire,
+        BlockingCall
+    };
+
+    /**
+     * @struct Violation
+     * @brief One distinct violation site.
+     */
+    struct Violation
+    {
+        Kind kind;
+        const char* section;       /**< Realtime section it happened in */
+        const char* what;          /**< Lock/call name, or nullptr for allocations */
+        juce::uint64 stackId;      /**< Hash of the call stack */
+        int count;                 /**< Number of hits */
+        juce::String stack;        /**< Symbolised frames (filled by getViolations) */
+    };
+
+    /**
+     * @class ScopedRealtimeSection
+     * @brief Marks the current thread as realtime for the lifetime of the object.
+     */
+    class ScopedRealtimeSection
+    {
+    public:
+        explicit ScopedRealtimeSection(const char* sectionName) noexcept;
+        ~ScopedRealtimeSection() noexcept;
+
+    private:
+        const char* previousSection;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeSection)
+    };
+
+    /** @brief Reports a lock about to be taken (no-op outside realtime sections). */
+    static void noteLock(const char* lockName) noexcept;
+
+    /** @brief Reports a call known to block (no-op outside realtime sections). */
+    static void noteBlockingCall(const char* callName) noexcept;
+
+    /** @brief True while the calling thread is inside a realtime section. */
+    static bool isInRealtimeSection() noexcept;
+
+    /** @brief Number of distinct violation sites recorded. */
+    static int getNumViolations() noexcept;
+
+    /** @brief Copies out all recorded violations (allocates; not for realtime use). */
+    static std::vector<Violation> getViolations();
+
+    /** @brief Human-readable report of all violations, one block per site. */
+    static juce::String createReport();
+
+    /** @brief Forgets everything recorded so far. */
+    static void clear() noexcept;
+
+    /** @brief Internal: called by the replaced allocator. */
+    static void noteAllocation(Kind kind) noexcept;
+};
+
+#if MTCGEN_RT_AUDIT
+ #define MTCGEN_RT_SCOPE(name)    RealtimeAudit::ScopedRealtimeSection rtAuditSection_ (name)
+ #define MTCGEN_RT_LOCK(name)     RealtimeAudit::noteLock (name)
+ #define MTCGEN_RT_BLOCKING(name) RealtimeAudit::noteBlockingCall (name)
+#else
+ #define MTCGEN_RT_SCOPE(name)
+ #define MTCGEN_RT_LOCK(name)
+ #define MTCGEN_RT_BLOCKING(name)
+#endif
+
+#endif // REALTIMEAUDIT_H_INCLUDED
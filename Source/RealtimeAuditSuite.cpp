@@ -0,0 +1,28 @@
+/**
+ * @file RealtimeAuditSuite.cpp
+ * @brief Definitions for RealtimeAuditSuite methods.
+ */
+
+#include "RealtimeAuditSuite.h"
+#include "RealtimeAudit.h"
+
+//==============================================================================
+void RealtimeAuditSuite::begin()
+{
+    RealtimeAudit::clear();
+}
+
+std::vector<MtcGoldenSuite::Result> RealtimeAuditSuite::run()
+{
+    std::vector<MtcGoldenSuite::Result> results;
+
+   #if MTCGEN_RT_AUDIT
+    MtcGoldenSuite::Result audit;
+    audit.name = "realtime_audit";
+    audit.passed = RealtimeAudit::getNumViolations() == 0;
+    audit.message = audit.passed ? "no violations" : RealtimeAudit::createReport();
+    results.push_back(audit);
+   #endif
+
+    return results;
+}
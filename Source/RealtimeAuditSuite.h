@@ -0,0 +1,31 @@
+/**
+ * @file RealtimeAuditSuite.h
+ * @brief Declaration of RealtimeAuditSuite, the realtime-safety verdict over the whole run.
+ */
+
+#ifndef REALTIMEAUDITSUITE_H_INCLUDED
+#define REALTIMEAUDITSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class RealtimeAuditSuite
+ * @brief In MTCGEN_RT_AUDIT builds, "realtime_audit" fails if any allocation, lock or
+ * blocking call was recorded on the audio path between begin() and run(); other builds
+ * report nothing.
+ *
+ * MtcGoldenSuite::run() calls begin() first and run() last, so every case is audited.
+ */
+class RealtimeAuditSuite
+{
+public:
+    /** @brief Forgets earlier violations; call before the audited cases. */
+    static void begin();
+
+    /** @brief Reports the violations recorded since begin(). */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // REALTIMEAUDITSUITE_H_INCLUDED
@@ -0,0 +1,181 @@
+/**
+ * @file SharedTimecodePublisher.cpp
+ * @brief Definitions for SharedTimecodePublisher methods.
+ */
+
+#include "SharedTimecodePublisher.h"
+#include "RealtimeAudit.h"
+#include "Timecode.h"
+
+#if ! JUCE_WINDOWS
+ #include <cerrno>
+ #include <csignal>
+ #include <cstring>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+    /** Names claimed by instances in this process (the pid alone cannot tell them apart). */
+    juce::CriticalSection claimedLock;
+    juce::StringArray claimedNames;
+}
+
+SharedTimecodePublisher::~SharedTimecodePublisher()
+{
+    setEnabled(false);
+}
+
+void SharedTimecodePublisher::setName(const juce::String& newName)
+{
+    auto trimmed = newName.trim();
+    name = trimmed.startsWith("/") ? trimmed : "/" + trimmed;
+}
+
+/**
+ * @brief Maps the segment, checks nobody else owns it, initialises the header and
+ * touches the page so the audio thread never faults on it.
+ */
+bool SharedTimecodePublisher::setEnabled(bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == isEnabled())
+        return true;
+
+    if (!shouldBeEnabled)
+    {
+        release();
+        return true;
+    }
+
+#if JUCE_WINDOWS
+    lastError = "Shared memory publishing needs POSIX shared memory (Linux, macOS)";
+    return false;
+#else
+    {
+        const juce::ScopedLock sl(claimedLock);
+        if (claimedNames.contains(name))
+        {
+            lastError = name + " is already published by another instance";
+            return false;
+        }
+
+        const int fd = shm_open(name.toRawUTF8(), O_CREAT | O_RDWR, 0644);
+        if (fd < 0)
+        {
+            lastError = "shm_open " + name + ": " + juce::String(std::strerror(errno));
+            return false;
+        }
+
+        void* p = nullptr;
+        if (ftruncate(fd, (off_t)sizeof(MtcGenShm)) == 0)
+            p = mmap(nullptr, sizeof(MtcGenShm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int mapError = errno;
+        close(fd);
+
+        if (p == nullptr || p == MAP_FAILED)
+        {
+            lastError = "mapping " + name + ": " + juce::String(std::strerror(mapError));
+            return false;
+        }
+
+        auto* segment = static_cast<MtcGenShm*>(p);
+        const int owner = __atomic_load_n(&segment->ownerPid, __ATOMIC_RELAXED);
+        if (segment->magic == MTCGEN_SHM_MAGIC && owner != 0 && owner != (int)getpid()
+            && kill(owner, 0) == 0)
+        {
+            munmap(p, sizeof(MtcGenShm));
+            lastError = name + " is already published by process " + juce::String(owner);
+            return false;
+        }
+
+        std::memset(p, 0, sizeof(MtcGenShm));
+        segment->magic = MTCGEN_SHM_MAGIC;
+        segment->version = MTCGEN_SHM_VERSION;
+        segment->timecode.cueNote = -1;
+        __atomic_store_n(&segment->ownerPid, (int)getpid(), __ATOMIC_RELEASE);
+
+        claimedNames.add(name);
+        openName = name;
+        shm = segment;
+    }
+
+    lastFrame = 0;
+    lastCueId = 0;
+    lastError.clear();
+    enabled.store(true);
+    return true;
+#endif
+}
+
+void SharedTimecodePublisher::release()
+{
+    // publish() sets publishing before it checks enabled, so once enabled is false and
+    // publishing is clear, the audio thread cannot touch the mapping any more
+    enabled.store(false);
+    MTCGEN_RT_BLOCKING("SharedTimecodePublisher: wait for publish()");
+    while (publishing.load())
+        juce::Thread::yield();
+
+#if ! JUCE_WINDOWS
+    MTCGEN_RT_LOCK("claimedLock");
+    const juce::ScopedLock sl(claimedLock);
+    if (shm != nullptr)
+    {
+        __atomic_store_n(&shm->ownerPid, 0, __ATOMIC_RELEASE);
+        munmap(shm, sizeof(MtcGenShm));
+        shm_unlink(openName.toRawUTF8());
+        shm = nullptr;
+    }
+    claimedNames.removeString(openName);
+#endif
+}
+
+/**
+ * @brief Seqlock write: odd sequence, payload, even sequence. Readers that overlap it
+ * see the sequence change and retry.
+ */
+void SharedTimecodePublisher::publish(juce::uint32 packedFrame, double frameRate,
+    juce::uint32 cueId, int cueNote, int bank, bool playing, double hostSeconds) noexcept
+{
+#if JUCE_WINDOWS
+    juce::ignoreUnused(packedFrame, frameRate, cueId, cueNote, bank, playing, hostSeconds);
+#else
+    publishing.store(true);
+    if (!enabled.load())
+    {
+        publishing.store(false);
+        return;
+    }
+
+    auto& tc = shm->timecode;
+    const auto sequence = shm->sequence;
+    __atomic_store_n(&shm->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    Timecode frame;
+    tc.running = Timecode::unpack(packedFrame, frame) ? 1 : 0;
+    tc.hours = frame.hours;
+    tc.minutes = frame.minutes;
+    tc.seconds = frame.seconds;
+    tc.frames = frame.frames;
+    tc.frameRate = frameRate;
+    tc.playing = playing ? 1 : 0;
+    tc.cueId = cueId;
+    tc.cueNote = cueNote;
+    tc.bank = bank;
+    tc.hostSeconds = hostSeconds;
+    ++tc.blockCount;
+    if (packedFrame != lastFrame)
+        ++tc.frameCount;
+    if (cueId != lastCueId)
+        ++tc.cueCount;
+
+    __atomic_store_n(&shm->sequence, sequence + 2, __ATOMIC_RELEASE);
+
+    lastFrame = packedFrame;
+    lastCueId = cueId;
+    publishing.store(false);
+#endif
+}
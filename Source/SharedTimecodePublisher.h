@@ -0,0 +1,87 @@
+/**
+ * @file SharedTimecodePublisher.h
+ * @brief Declaration of the SharedTimecodePublisher class (timecode in POSIX shared memory).
+ */
+
+#ifndef SHAREDTIMECODEPUBLISHER_H_INCLUDED
+#define SHAREDTIMECODEPUBLISHER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <atomic>
+#include "MtcGenShm.h"
+
+/**
+ * @class SharedTimecodePublisher
+ * @brief Publishes the current frame, running cue and transport state into a named
+ * POSIX shared-memory segment (layout in MtcGenShm.h), so local programs can read the
+ * timecode without a loopback MIDI port.
+ *
+ * The audio thread calls publish() once per block: a seqlock write of a few words into
+ * memory that was mapped and touched when the segment was opened, so it never blocks,
+ * allocates or makes a system call. Readers retry instead of locking.
+ *
+ * One process owns a segment at a time: opening fails while another live process (or
+ * another instance in this one) publishes under the same name. Disabling waits for a
+ * publish() in progress, marks the segment unowned (so readers let go of it) and
+ * unlinks it. Not available on Windows.
+ */
+class SharedTimecodePublisher
+{
+public:
+    /** Constructor */
+    SharedTimecodePublisher() = default;
+    /** Destructor: releases the segment. */
+    ~SharedTimecodePublisher();
+
+    /**
+     * @brief Sets the segment name (e.g. "/mtcgen"). Takes effect on the next enable.
+     */
+    void setName(const juce::String& newName);
+
+    /** @brief Segment name. */
+    juce::String getName() const { return name; }
+
+    /**
+     * @brief Opens and claims the segment, or releases it. Message thread.
+     * @return False if it could not be opened; see getLastError().
+     */
+    bool setEnabled(bool shouldBeEnabled);
+
+    /** @brief True while publishing. */
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_acquire); }
+
+    /** @brief Why the last setEnabled(true) failed. */
+    juce::String getLastError() const { return lastError; }
+
+    /**
+     * @brief Publishes the state of one block. Audio thread; does nothing while disabled.
+     * @param packedFrame Frame from Timecode::pack(), 0 if no cue runs.
+     * @param frameRate Current frame rate.
+     * @param cueId Running cue, 0 = none.
+     * @param cueNote MIDI note of the running cue, -1 = none.
+     * @param bank Active bank index.
+     * @param playing Host transport state.
+     * @param hostSeconds Host time of the block.
+     */
+    void publish(juce::uint32 packedFrame, double frameRate, juce::uint32 cueId, int cueNote,
+        int bank, bool playing, double hostSeconds) noexcept;
+
+private:
+    /** Marks the segment unowned, unmaps and unlinks it. */
+    void release();
+
+    juce::String name{ MTCGEN_SHM_DEFAULT_NAME };
+    juce::String openName;               /**< Name of the segment shm maps */
+    juce::String lastError;
+    MtcGenShm* shm{ nullptr };           /**< Mapped while owned */
+    std::atomic<bool> enabled{ false };
+    std::atomic<bool> publishing{ false }; /**< Audio thread is inside publish() */
+
+    // Audio thread only
+    juce::uint32 lastFrame{ 0 };
+    juce::uint32 lastCueId{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedTimecodePublisher)
+};
+
+#endif // SHAREDTIMECODEPUBLISHER_H_INCLUDED
@@ -0,0 +1,82 @@
+/**
+ * @file TestMain.cpp
+ * @brief Entry point of MTCGenTests, the console runner for MtcGoldenSuite.
+ *
+ * Built only by Tests/MTCGenTests.jucer (with MTCGEN_HEADLESS=1 and MTCGEN_RT_AUDIT=1);
+ * the plugin project does not compile this file.
+ */
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "MtcGoldenSuite.h"
+
+namespace
+{
+    const char* usage =
+        "Usage: MTCGenTests [--golden <dir>] [--update]\n"
+        "\n"
+        "  --golden <dir>   Directory holding the golden files (default: the Golden\n"
+        "                   directory next to Tests/MTCGenTests.jucer)\n"
+        "  --update         Rewrite the golden files from the current build instead of\n"
+        "                   comparing against them\n";
+
+    /** The first Golden directory found walking up from the executable. */
+    juce::File findGoldenDir()
+    {
+        auto dir = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getParentDirectory();
+        for (; dir.getParentDirectory() != dir; dir = dir.getParentDirectory())
+        {
+            if (dir.getChildFile("Golden").isDirectory())
+                return dir.getChildFile("Golden");
+        }
+        return {};
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        std::cout << usage;
+        return 0;
+    }
+
+    // Creates the message manager the processor's parameters expect; no windows
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    const bool update = args.containsOption("--update");
+    auto goldenDir = args.containsOption("--golden") ? args.getFileForOption("--golden")
+                                                     : findGoldenDir();
+    if (goldenDir == juce::File())
+    {
+        std::cerr << "no Golden directory found; pass --golden <dir>\n" << usage;
+        return 1;
+    }
+    if (update && !goldenDir.createDirectory())
+    {
+        std::cerr << "could not create " << goldenDir.getFullPathName() << "\n";
+        return 1;
+    }
+
+    int numFailed = 0;
+    for (auto& r : MtcGoldenSuite::run(goldenDir, update))
+    {
+        std::cout << (r.passed ? "PASS  " : "FAIL  ") << r.name;
+        if (r.message.isNotEmpty())
+            std::cout << "  " << r.message;
+        std::cout << "\n";
+
+        if (!r.passed)
+            ++numFailed;
+    }
+
+    if (numFailed > 0)
+    {
+        std::cerr << numFailed << " failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file Timecode.h
+ * @brief Declaration of the Timecode struct (HH:MM:SS:FF fields and packing helpers).
+ */
+
+#ifndef TIMECODE_H_INCLUDED
+#define TIMECODE_H_INCLUDED
+
+#include <JuceHeader.h>
+
+/**
+ * @struct Timecode
+ * @brief One timecode frame split into fields.
+ *
+ * pack()/unpack() squeeze a frame into a single 32-bit word so it can be handed
+ * between threads with one atomic store/load; quarterFrameValue() splits it into the
+ * eight MTC quarter-frame nibbles.
+ */
+struct Timecode
+{
+    int hours{ 0 };
+    int minutes{ 0 };
+    int seconds{ 0 };
+    int frames{ 0 };
+
+    static constexpr juce::uint32 validFlag = 0x80000000u; /**< Set in every packed frame */
+
+    /**
+     * @brief Splits a running time into HH:MM:SS:FF.
+     * @param outTime Time in seconds (base timecode + elapsed).
+     * @param frameRate Frames per second.
+     */
+    static Timecode fromSeconds(double outTime, double frameRate) noexcept
+    {
+        int totalSecs = int(outTime);
+        Timecode tc;
+        tc.hours = totalSecs / 3600;
+        tc.minutes = (totalSecs % 3600) / 60;
+        tc.seconds = totalSecs % 60;
+        tc.frames = int((outTime - totalSecs) * frameRate);
+        return tc;
+    }
+
+    /** @brief Packs the fields into one word (hh|mm|ss|ff) with validFlag set. */
+    juce::uint32 pack() const noexcept
+    {
+        return validFlag
+            | ((juce::uint32)(hours & 0x1f) << 24)
+            | ((juce::uint32)(minutes & 0xff) << 16)
+            | ((juce::uint32)(seconds & 0xff) << 8)
+            | (juce::uint32)(frames & 0xff);
+    }
+
+    /**
+     * @brief Unpacks a word written by pack().
+     * @return False if packed is 0 / has no validFlag (no timecode running).
+     */
+    static bool unpack(juce::uint32 packed, Timecode& out) noexcept
+    {
+        if ((packed & validFlag) == 0)
+            return false;
+
+        out.hours = (int)((packed >> 24) & 0x1f);
+        out.minutes = (int)((packed >> 16) & 0xff);
+        out.seconds = (int)((packed >> 8) & 0xff);
+        out.frames = (int)(packed & 0xff);
+        return true;
+    }
+
+    /**
+     * @brief MTC rate code carried in Full Frame and quarter-frame piece 7:
+     * 0 = 24, 1 = 25, 3 = 30 fps.
+     *
+     * 29.97 is counted non-drop (fromSeconds() numbers every frame), so it is sent with
+     * the 30 fps code, as receivers expect for 29.97 NDF. Code 2 (30 drop-frame) would
+     * make them skip frame numbers this count never skips, so it is never sent.
+     */
+    static constexpr int mtcRateCode(double frameRate) noexcept
+    {
+        if (frameRate < 24.5)  return 0;
+        if (frameRate < 25.5)  return 1;
+        return 3;
+    }
+
+    /**
+     * @brief Data nibble of quarter-frame piece 0..7 (frames low/high, seconds low/high,
+     * minutes low/high, hours low/high + rate code).
+     */
+    int quarterFrameValue(int piece, int rateCode) const noexcept
+    {
+        switch (piece & 7)
+        {
+            case 0:  return frames & 0x0f;
+            case 1:  return (frames >> 4) & 0x01;
+            case 2:  return seconds & 0x0f;
+            case 3:  return (seconds >> 4) & 0x03;
+            case 4:  return minutes & 0x0f;
+            case 5:  return (minutes >> 4) & 0x03;
+            case 6:  return hours & 0x0f;
+            default: return ((hours >> 4) & 0x01) | ((rateCode & 0x03) << 1);
+        }
+    }
+};
+
+#endif // TIMECODE_H_INCLUDED
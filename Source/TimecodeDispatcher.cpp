@@ -0,0 +1,195 @@
+/**
+ * @file TimecodeDispatcher.cpp
+ * @brief Definitions for TimecodeDispatcher methods.
+ */
+
+#include "TimecodeDispatcher.h"
+#include "RealtimeAudit.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+
+namespace
+{
+    /** Removes sink from the deferred list, closing the gap it leaves. */
+    template <typename List>
+    void removeFromList(List& list, std::atomic<int>& count, TimecodeSink* sink)
+    {
+        const int n = count.load();
+        for (int i = 0; i < n; ++i)
+        {
+            if (list[(size_t)i].load() != sink)
+                continue;
+
+            for (int j = i; j + 1 < n; ++j)
+                list[(size_t)j].store(list[(size_t)j + 1].load());
+            count.store(n - 1);
+            return;
+        }
+    }
+}
+
+//==============================================================================
+TimecodeDispatcher::TimecodeDispatcher()
+    : juce::Thread("MTCGen Sinks")
+{
+    startThread(juce::Thread::Priority::low);
+}
+
+TimecodeDispatcher::~TimecodeDispatcher()
+{
+    stopThread(1000);
+}
+
+//==============================================================================
+bool TimecodeDispatcher::addSink(TimecodeSink* sink, TimecodeSink::Threading threading)
+{
+    MTCGEN_RT_LOCK("registrationLock");
+    const juce::ScopedLock sl(registrationLock);
+
+    if (threading == TimecodeSink::Realtime)
+    {
+        SinkList list = *realtimeSinks.load();
+        if (list.size >= maxSinks)
+            return false;
+
+        list.sinks[(size_t)list.size++] = sink;
+        publishRealtime(list);
+        return true;
+    }
+
+    const juce::ScopedLock dl(deferredLock);
+    const int n = numDeferred.load();
+    if (n >= maxSinks)
+        return false;
+
+    deferredSinks[(size_t)n].store(sink);
+    numDeferred.store(n + 1);
+    return true;
+}
+
+/**
+ * @brief The deferred thread only reads its list with deferredLock held, so that list
+ * is changed under it; the realtime list is rebuilt without the sink and republished.
+ */
+void TimecodeDispatcher::removeSink(TimecodeSink* sink)
+{
+    MTCGEN_RT_LOCK("registrationLock");
+    const juce::ScopedLock sl(registrationLock);
+    {
+        const juce::ScopedLock dl(deferredLock);
+        removeFromList(deferredSinks, numDeferred, sink);
+    }
+
+    const auto& current = *realtimeSinks.load();
+    SinkList list;
+    for (int i = 0; i < current.size; ++i)
+        if (current.sinks[(size_t)i] != sink)
+            list.sinks[(size_t)list.size++] = current.sinks[(size_t)i];
+
+    if (list.size != current.size)
+        publishRealtime(list);
+}
+
+void TimecodeDispatcher::publishRealtime(const SinkList& list)
+{
+    auto* spare = realtimeSinks.load() == &realtimeLists[0] ? &realtimeLists[1] : &realtimeLists[0];
+    *spare = list;
+    realtimeSinks.store(spare);
+
+    // The old list becomes the spare for the next change, so nothing may still read it
+    waitForDispatch();
+}
+
+void TimecodeDispatcher::waitForDispatch() const
+{
+    MTCGEN_RT_BLOCKING("TimecodeDispatcher: wait for dispatch()");
+    while (dispatchesInFlight.load() > 0)
+        juce::Thread::yield();
+}
+
+//==============================================================================
+void TimecodeDispatcher::add(const TimecodeSink::Event& event) noexcept
+{
+    if (numBatched >= maxEventsPerBlock)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    batch[(size_t)numBatched++] = event;
+}
+
+void TimecodeDispatcher::dispatch() noexcept
+{
+    const int n = numBatched;
+    numBatched = 0;
+    if (n == 0)
+        return;
+
+    dispatchesInFlight.fetch_add(1);
+    const auto& realtime = *realtimeSinks.load();
+    for (int i = 0; i < realtime.size; ++i)
+        realtime.sinks[(size_t)i]->handleTimecodeEvents(batch.data(), n);
+    dispatchesInFlight.fetch_sub(1);
+
+    if (numDeferred.load(std::memory_order_acquire) == 0)
+        return;
+
+    // One copy into the shared queue, whatever the number of deferred sinks
+    const int numToWrite = juce::jmin(n, fifo.getFreeSpace());
+    if (numToWrite < n)
+        dropped.fetch_add(n - numToWrite, std::memory_order_relaxed);
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numToWrite, start1, size1, start2, size2);
+    std::copy(batch.begin(), batch.begin() + size1, queue.begin() + start1);
+    std::copy(batch.begin() + size1, batch.begin() + size1 + size2, queue.begin() + start2);
+    fifo.finishedWrite(size1 + size2);
+}
+
+//==============================================================================
+void TimecodeDispatcher::flush()
+{
+    MTCGEN_RT_LOCK("deferredLock");
+    const juce::ScopedLock sl(deferredLock);
+    deliverDeferred();
+}
+
+void TimecodeDispatcher::run()
+{
+    while (!threadShouldExit())
+    {
+        MTCGEN_TRACE_THREAD("MTCGen Sinks");
+        {
+            const juce::ScopedLock sl(deferredLock);
+            deliverDeferred();
+        }
+        wait(deferredIntervalMs);
+    }
+}
+
+/**
+ * @brief Sinks read the events in place in the queue (in at most two runs, where it
+ * wraps) before the space is given back to the audio thread.
+ */
+void TimecodeDispatcher::deliverDeferred()
+{
+    const int ready = fifo.getNumReady();
+    if (ready == 0)
+        return;
+
+    MTCGEN_TRACE_SCOPE("deferredSinks");
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(ready, start1, size1, start2, size2);
+
+    const int n = numDeferred.load(std::memory_order_acquire);
+    for (int i = 0; i < n; ++i)
+    {
+        auto* sink = deferredSinks[(size_t)i].load();
+        if (size1 > 0)
+            sink->handleTimecodeEvents(queue.data() + start1, size1);
+        if (size2 > 0)
+            sink->handleTimecodeEvents(queue.data() + start2, size2);
+    }
+
+    fifo.finishedRead(size1 + size2);
+}
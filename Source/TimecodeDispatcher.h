@@ -0,0 +1,121 @@
+/**
+ * @file TimecodeDispatcher.h
+ * @brief Declaration of the TimecodeDispatcher class that hands each block's timecode
+ * events to the registered sinks.
+ */
+
+#ifndef TIMECODEDISPATCHER_H_INCLUDED
+#define TIMECODEDISPATCHER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "TimecodeSink.h"
+
+/**
+ * @class TimecodeDispatcher
+ * @brief The registered TimecodeSinks and the thread that serves the deferred ones.
+ *
+ * The audio thread collects a block's events with add() into a fixed batch and hands
+ * it over with dispatch(): realtime sinks are called right there, and the batch is
+ * copied once into a single lock-free queue shared by every deferred sink. The
+ * dispatcher thread drains that queue every deferredIntervalMs and passes each drained
+ * batch to every deferred sink in turn, so a slow sink delays only the other deferred
+ * sinks, never the audio thread. A full batch or queue drops events and counts them.
+ *
+ * Sinks are not owned. The realtime list is never edited where dispatch() may be reading
+ * it: registration fills the spare of two lists and publishes it with one pointer store,
+ * and returns only once no dispatch() can still be reading the old one. removeSink()
+ * therefore returns only once the sink can no longer be called.
+ */
+class TimecodeDispatcher : private juce::Thread
+{
+public:
+    static constexpr int maxSinks = 16;             /**< Per threading */
+    static constexpr int maxEventsPerBlock = 512;   /**< About 4 s of quarter-frames */
+    static constexpr int queueCapacity = 4096;      /**< Events waiting for deferred sinks */
+    static constexpr int deferredIntervalMs = 10;
+
+    /** Constructor: starts the deferred thread. */
+    TimecodeDispatcher();
+    /** Destructor: stops the thread; deferred events still queued are discarded. */
+    ~TimecodeDispatcher() override;
+
+    /**
+     * @brief Registers a sink, which must outlive its registration. Message thread.
+     * @return False if maxSinks of that threading are already registered.
+     */
+    bool addSink(TimecodeSink* sink, TimecodeSink::Threading threading);
+
+    /**
+     * @brief Unregisters a sink; once this returns it is not called again. Message thread.
+     */
+    void removeSink(TimecodeSink* sink);
+
+    /** @brief True if any sink is registered, so the audio thread can skip add(). */
+    bool hasSinks() const noexcept
+    {
+        return realtimeSinks.load(std::memory_order_acquire)->size + numDeferred.load(std::memory_order_acquire) > 0;
+    }
+
+    /** @brief Appends an event to the current block's batch. Audio thread. */
+    void add(const TimecodeSink::Event& event) noexcept;
+
+    /**
+     * @brief Calls the realtime sinks with the batch, queues it for the deferred sinks
+     * and starts a new batch. Audio thread.
+     */
+    void dispatch() noexcept;
+
+    /**
+     * @brief Delivers everything queued to the deferred sinks now, instead of on the
+     * next pass of the thread. Message thread.
+     */
+    void flush();
+
+    /** @brief Events lost to a full batch or queue. Any thread. */
+    juce::int64 getNumDropped() const noexcept { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    /** Deferred loop. */
+    void run() override;
+
+    /** Drains the queue into the deferred sinks. Called with deferredLock held. */
+    void deliverDeferred();
+
+    /** A published list of realtime sinks. */
+    struct SinkList
+    {
+        std::array<TimecodeSink*, maxSinks> sinks{};
+        int size{ 0 };
+    };
+
+    /** Publishes the spare list, then waits until the old one is no longer read. */
+    void publishRealtime(const SinkList& list);
+
+    /** Waits until no dispatch() can still hold a pointer to the previous list. */
+    void waitForDispatch() const;
+
+    // Audio thread
+    std::array<TimecodeSink::Event, maxEventsPerBlock> batch;
+    int numBatched{ 0 };
+
+    // Registered sinks, read by dispatch() and the deferred thread
+    std::array<SinkList, 2> realtimeLists;                  /**< Published one and spare */
+    std::atomic<const SinkList*> realtimeSinks{ &realtimeLists[0] };
+    std::array<std::atomic<TimecodeSink*>, maxSinks> deferredSinks{};
+    std::atomic<int> numDeferred{ 0 };
+    std::atomic<int> dispatchesInFlight{ 0 };
+
+    // Shared queue: written by dispatch(), read under deferredLock
+    juce::AbstractFifo fifo{ queueCapacity };
+    std::array<TimecodeSink::Event, queueCapacity> queue;
+
+    juce::CriticalSection registrationLock;    /**< Message thread: addSink/removeSink */
+    juce::CriticalSection deferredLock;        /**< Serialises deferred delivery */
+    std::atomic<juce::int64> dropped{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimecodeDispatcher)
+};
+
+#endif // TIMECODEDISPATCHER_H_INCLUDED
@@ -0,0 +1,137 @@
+/**
+ * @file TimecodeDisplay.cpp
+ * @brief Definitions for TimecodeDisplay methods.
+ */
+
+#include "TimecodeDisplay.h"
+
+//==============================================================================
+TimecodeDisplay::TimecodeDisplay(MTCGenAudioProcessor& proc)
+    : processor(proc),
+    vBlank(this, [this]() { onVBlank(); })
+{
+    setOpaque(true);
+    layoutGlyphs(0, shownCells);
+}
+
+TimecodeDisplay::~TimecodeDisplay() {}
+
+//==============================================================================
+/**
+ * @brief Runs once per display refresh. At most numCells small rectangles are
+ * invalidated, and only when the frame actually changed.
+ */
+void TimecodeDisplay::onVBlank()
+{
+    auto packed = processor.getCurrentFramePacked();
+    if (packed == shownFrame)
+        return;
+
+    shownFrame = packed;
+
+    std::array<juce::int8, numCells> next;
+    layoutGlyphs(packed, next);
+
+    for (int i = 0; i < numCells; ++i)
+    {
+        if (next[(size_t)i] != shownCells[(size_t)i])
+        {
+            shownCells[(size_t)i] = next[(size_t)i];
+            repaint(getCellBounds(i));
+        }
+    }
+}
+
+void TimecodeDisplay::layoutGlyphs(juce::uint32 packed,
+    std::array<juce::int8, numCells>& cells) noexcept
+{
+    cells.fill(dashGlyph);
+    cells[2] = cells[5] = cells[8] = colonGlyph;
+
+    Timecode tc;
+    if (!Timecode::unpack(packed, tc))
+        return;
+
+    const int fields[4] = { tc.hours, tc.minutes, tc.seconds, tc.frames };
+    for (int f = 0; f < 4; ++f)
+    {
+        int v = fields[f] % 100;
+        cells[(size_t)(f * 3)] = (juce::int8)(v / 10);
+        cells[(size_t)(f * 3 + 1)] = (juce::int8)(v % 10);
+    }
+}
+
+//==============================================================================
+void TimecodeDisplay::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+
+    // Only on first paint, after a resize or when moved to a screen with another scale
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (scale != cachedScale)
+        rebuildGlyphCache(scale);
+
+    if (prefixImage.isValid() && g.clipRegionIntersects(prefixArea))
+        g.drawImage(prefixImage, prefixArea.toFloat());
+
+    for (int i = 0; i < numCells; ++i)
+    {
+        auto cell = getCellBounds(i);
+        auto& glyph = glyphs[(size_t)shownCells[(size_t)i]];
+        if (glyph.isValid() && g.clipRegionIntersects(cell))
+            g.drawImage(glyph, cell.toFloat());
+    }
+}
+
+void TimecodeDisplay::resized()
+{
+    auto area = getLocalBounds().reduced(2);
+    prefixArea = area.removeFromLeft(area.getWidth() * 3 / 10);
+    digitsArea = area;
+    cachedScale = 0.0f; // force the glyphs to be rendered at the new size
+}
+
+juce::Rectangle<int> TimecodeDisplay::getCellBounds(int cell) const
+{
+    int cellWidth = digitsArea.getWidth() / numCells;
+    return { digitsArea.getX() + cell * cellWidth, digitsArea.getY(),
+             cellWidth, digitsArea.getHeight() };
+}
+
+/**
+ * @brief Renders each glyph once into its own image at physical pixel size.
+ */
+void TimecodeDisplay::rebuildGlyphCache(float scale)
+{
+    cachedScale = scale;
+
+    auto cell = getCellBounds(0);
+    int w = juce::roundToInt(cell.getWidth() * scale);
+    int h = juce::roundToInt(cell.getHeight() * scale);
+    if (w <= 0 || h <= 0)
+        return;
+
+    juce::Font font("Consolas", h * 0.5f, juce::Font::plain);
+    static const char glyphChars[numGlyphs + 1] = "0123456789:-";
+
+    for (int i = 0; i < numGlyphs; ++i)
+    {
+        glyphs[(size_t)i] = juce::Image(juce::Image::ARGB, w, h, true);
+        juce::Graphics gi(glyphs[(size_t)i]);
+        gi.setColour(juce::Colours::lime);
+        gi.setFont(font);
+        gi.drawText(juce::String::charToString(glyphChars[i]), 0, 0, w, h,
+            juce::Justification::centred, false);
+    }
+
+    int pw = juce::roundToInt(prefixArea.getWidth() * scale);
+    int ph = juce::roundToInt(prefixArea.getHeight() * scale);
+    if (pw > 0 && ph > 0)
+    {
+        prefixImage = juce::Image(juce::Image::ARGB, pw, ph, true);
+        juce::Graphics gp(prefixImage);
+        gp.setColour(juce::Colours::lime);
+        gp.setFont(font.withHeight(ph * 0.4f));
+        gp.drawText("Timecode:", 0, 0, pw, ph, juce::Justification::centredRight, false);
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * @file TimecodeDisplay.h
+ * @brief Declaration of the TimecodeDisplay component (big HH:MM:SS:FF readout).
+ */
+
+#ifndef TIMECODEDISPLAY_H_INCLUDED
+#define TIMECODEDISPLAY_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <array>
+#include "MTCGenProcessor.h"
+
+/**
+ * @class TimecodeDisplay
+ * @brief Large timecode readout that follows the display refresh.
+ *
+ * On every vertical blank the component reads the processor's packed frame with one
+ * atomic load. Digits that differ from what is on screen are repainted individually,
+ * using glyph images that are rendered once per size/scale. Nothing on the per-frame
+ * path allocates: no strings are formatted and no text is laid out.
+ */
+class TimecodeDisplay : public juce::Component
+{
+public:
+    /**
+     * @brief Constructs the display.
+     * @param proc Processor whose current frame is shown.
+     */
+    explicit TimecodeDisplay(MTCGenAudioProcessor& proc);
+    ~TimecodeDisplay() override;
+
+    void paint(juce::Graphics&) override;
+    void resized() override;
+
+private:
+    /** Glyph slots: '0'..'9', then ':' and '-'. */
+    enum { colonGlyph = 10, dashGlyph = 11, numGlyphs = 12 };
+
+    /** Positions in "HH:MM:SS:FF". */
+    static constexpr int numCells = 11;
+
+    /** Called on each display refresh: compares the frame and invalidates changed cells. */
+    void onVBlank();
+
+    /** Fills cells with glyph indices for a packed frame (dashes if none). */
+    static void layoutGlyphs(juce::uint32 packed, std::array<juce::int8, numCells>& cells) noexcept;
+
+    /** Renders all glyph images for the current cell size and pixel scale. */
+    void rebuildGlyphCache(float scale);
+
+    /** Bounds of one character cell. */
+    juce::Rectangle<int> getCellBounds(int cell) const;
+
+    MTCGenAudioProcessor& processor;
+
+    std::array<juce::Image, numGlyphs> glyphs;     /**< Pre-rendered digits, colon and dash */
+    juce::Image prefixImage;                       /**< Pre-rendered "Timecode" caption */
+    float cachedScale{ 0.0f };                     /**< Pixel scale the images were built for */
+
+    std::array<juce::int8, numCells> shownCells{}; /**< Glyph index currently on screen per cell */
+    juce::uint32 shownFrame{ 0xffffffffu };        /**< Last packed frame seen */
+
+    juce::Rectangle<int> prefixArea, digitsArea;
+
+    juce::VBlankAttachment vBlank;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimecodeDisplay)
+};
+
+#endif // TIMECODEDISPLAY_H_INCLUDED
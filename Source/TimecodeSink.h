@@ -0,0 +1,70 @@
+/**
+ * @file TimecodeSink.h
+ * @brief Declaration of the TimecodeSink interface, a destination for the timecode stream.
+ */
+
+#ifndef TIMECODESINK_H_INCLUDED
+#define TIMECODESINK_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "Timecode.h"
+
+/**
+ * @class TimecodeSink
+ * @brief Receives what the generator does each block as a batch of timestamped events:
+ * the frame changing, every quarter-frame, locates (the stream restarting somewhere
+ * new) and cues starting and stopping.
+ *
+ * Sinks are registered with the processor's TimecodeDispatcher, together with the
+ * thread they need to run on. Realtime sinks are called on the audio thread at the end
+ * of the block and must not block or allocate. Deferred sinks are called on the
+ * dispatcher's thread a few milliseconds later, in batches, and may do anything.
+ *
+ * Events are only produced while output is enabled; turning it off stops the cue.
+ */
+class TimecodeSink
+{
+public:
+    /** @enum Threading @brief Where a sink's handleTimecodeEvents() is called. */
+    enum Threading
+    {
+        Realtime,  /**< On the audio thread, once per block */
+        Deferred   /**< On the dispatcher thread, through the shared queue */
+    };
+
+    /**
+     * @struct Event
+     * @brief One thing the generator did.
+     */
+    struct Event
+    {
+        /** @enum Type @brief What happened. */
+        enum Type : juce::uint8
+        {
+            Frame,         /**< The output frame at the start of the block changed */
+            QuarterFrame,  /**< A quarter-frame was sent; data holds its data byte */
+            Locate,        /**< The stream restarted at frame (Full Frame sent) */
+            CueStart,      /**< cueId began driving the output, from frame */
+            CueStop        /**< cueId stopped driving the output */
+        };
+
+        Type type{ Frame };
+        juce::uint8 rateCode{ 0 };    /**< MTC rate code, see Timecode::mtcRateCode() */
+        juce::uint8 data{ 0 };        /**< QuarterFrame: 0p|dddd */
+        juce::int8 note{ -1 };        /**< CueStart, CueStop: the cue's MIDI note */
+        int samplePosition{ 0 };      /**< Offset into the block */
+        juce::uint32 frame{ 0 };      /**< Frame, Locate, CueStart: Timecode::pack() */
+        juce::uint32 cueId{ 0 };      /**< CueStore::CueId of the cue driving the output */
+        double hostTime{ 0.0 };       /**< Output time of the event, in host seconds */
+    };
+
+    virtual ~TimecodeSink() = default;
+
+    /**
+     * @brief Called with the next events, in time order. Realtime sinks get one block's
+     * events per call; deferred sinks get whatever was queued since their last call.
+     */
+    virtual void handleTimecodeEvents(const Event* events, int numEvents) = 0;
+};
+
+#endif // TIMECODESINK_H_INCLUDED
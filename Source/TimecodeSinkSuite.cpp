@@ -0,0 +1,144 @@
+/**
+ * @file TimecodeSinkSuite.cpp
+ * @brief Definitions for TimecodeSinkSuite methods.
+ */
+
+#include "TimecodeSinkSuite.h"
+#include "MTCGenProcessor.h"
+#include "MemoryTimecodeSink.h"
+#include "FileTimecodeSink.h"
+
+namespace
+{
+    /**
+     * Plays the standard script (quarter-frames, two cues) with a realtime and a
+     * deferred MemoryTimecodeSink and a deferred FileTimecodeSink registered. Fails if
+     * the quarter-frames the sinks saw differ from the MIDI stream, a cue stop does not
+     * match the cue started before it, or a deferred sink saw something else than the
+     * realtime one.
+     */
+    MtcGoldenSuite::Result checkTimecodeSinks()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "timecode_sinks";
+
+        MTCGenAudioProcessor processor;
+        processor.setMTCFormat(QuarterFrame);
+        MtcGoldenSuite::addSecondCue(processor);
+
+        MemoryTimecodeSink realtime, deferred;
+        FileTimecodeSink file;
+        const auto logFile = juce::File::createTempFile(".txt");
+        if (!file.open(logFile, r.message))
+            return r;
+
+        auto& sinks = processor.getTimecodeSinks();
+        sinks.addSink(&realtime, TimecodeSink::Realtime);
+        sinks.addSink(&deferred, TimecodeSink::Deferred);
+        sinks.addSink(&file, TimecodeSink::Deferred);
+
+        HostSimulator sim(processor, MtcGoldenSuite::scriptSampleRate);
+        MtcGoldenSuite::addStandardScript(sim);
+        sim.run();
+
+        sinks.flush();
+        sinks.removeSink(&realtime);
+        sinks.removeSink(&deferred);
+        sinks.removeSink(&file);
+        file.close();
+
+        juce::StringArray lines;
+        logFile.readLines(lines);
+        logFile.deleteFile();
+        lines.removeEmptyStrings();
+
+        const auto events = realtime.getEvents();
+        const auto queued = deferred.getEvents();
+
+        // Quarter-frames against the bytes that went out
+        std::vector<juce::uint8> sent, seen;
+        for (auto& c : sim.getCaptured())
+            if (c.bytes.size() == 2 && c.bytes[0] == 0xf1)
+                sent.push_back(c.bytes[1]);
+
+        int numLocates = 0, numStarts = 0;
+        juce::uint32 running = 0;
+        for (auto& e : events)
+        {
+            if (e.type == TimecodeSink::Event::QuarterFrame)
+                seen.push_back(e.data);
+            else if (e.type == TimecodeSink::Event::Locate)
+                ++numLocates;
+            else if (e.type == TimecodeSink::Event::CueStart)
+            {
+                if (running != 0 && r.message.isEmpty())
+                    r.message = "cue started while another was running";
+                running = e.cueId;
+                ++numStarts;
+            }
+            else if (e.type == TimecodeSink::Event::CueStop)
+            {
+                if (e.cueId != running && r.message.isEmpty())
+                    r.message = "cue stop does not match the running cue";
+                running = 0;
+            }
+        }
+
+        bool sameQueued = queued.size() == events.size();
+        for (size_t i = 0; sameQueued && i < events.size(); ++i)
+            sameQueued = queued[i].type == events[i].type && queued[i].frame == events[i].frame
+                && queued[i].cueId == events[i].cueId && queued[i].data == events[i].data
+                && queued[i].samplePosition == events[i].samplePosition;
+
+        if (r.message.isEmpty() && seen != sent)
+            r.message = "sinks saw " + juce::String((int)seen.size()) + " quarter-frames, "
+                + juce::String((int)sent.size()) + " were sent";
+        else if (r.message.isEmpty() && sinks.getNumDropped() + realtime.getNumDropped() > 0)
+            r.message = "events were dropped";
+        else if (r.message.isEmpty() && (!sameQueued || lines.size() != (int)queued.size()))
+            r.message = "deferred sinks saw other events than the realtime sink";
+
+        r.passed = r.message.isEmpty() && numStarts > 0;
+        if (r.passed)
+            r.message = juce::String::formatted("%d events: %d quarter-frames, %d locates, %d cue starts",
+                (int)events.size(), (int)seen.size(), numLocates, numStarts);
+        else if (r.message.isEmpty())
+            r.message = "no cue started";
+        return r;
+    }
+
+    /**
+     * The Art-Net sender is registered only while enabled: a fresh processor, and one
+     * whose Art-Net output was turned on and off again, must report no sinks.
+     */
+    MtcGoldenSuite::Result checkIdleSinks()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "sinks_idle";
+
+        MTCGenAudioProcessor processor;
+        auto& sinks = processor.getTimecodeSinks();
+        const bool idleAtStart = !sinks.hasSinks();
+
+        processor.setArtNetEnabled(true);
+        const bool registered = sinks.hasSinks() && processor.isArtNetEnabled();
+        processor.setArtNetEnabled(false);
+        const bool idleAfter = !sinks.hasSinks() && !processor.isArtNetEnabled();
+
+        if (!idleAtStart)
+            r.message = "a new processor has a sink registered";
+        else if (!registered)
+            r.message = "enabling Art-Net did not register its sink";
+        else if (!idleAfter)
+            r.message = "disabling Art-Net left its sink registered";
+        else
+            r.passed = true;
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> TimecodeSinkSuite::run()
+{
+    return { checkTimecodeSinks(), checkIdleSinks() };
+}
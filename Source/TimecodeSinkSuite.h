@@ -0,0 +1,27 @@
+/**
+ * @file TimecodeSinkSuite.h
+ * @brief Declaration of TimecodeSinkSuite, checks of what timecode sinks receive.
+ */
+
+#ifndef TIMECODESINKSUITE_H_INCLUDED
+#define TIMECODESINKSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class TimecodeSinkSuite
+ * @brief "timecode_sinks" checks the events realtime and deferred TimecodeSinks receive
+ * against the MIDI stream the standard script produces. "sinks_idle" checks that a
+ * processor has no sink registered (so no sink work on the audio thread) until Art-Net
+ * output is turned on, and none again once it is turned off.
+ */
+class TimecodeSinkSuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // TIMECODESINKSUITE_H_INCLUDED
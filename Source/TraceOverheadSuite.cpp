@@ -0,0 +1,85 @@
+/**
+ * @file TraceOverheadSuite.cpp
+ * @brief Definitions for TraceOverheadSuite methods.
+ */
+
+#include "TraceOverheadSuite.h"
+#include "MTCGenProcessor.h"
+#include "TraceRecorder.h"
+
+namespace
+{
+    /**
+     * Plays the standard script (quarter-frames and MIDI Clock, two cues) ten times
+     * untraced, then ten times while a trace records to a temporary file. Fails if the
+     * trace changed the stream or, with the trace points compiled in, recorded nothing;
+     * the message gives both run times and the trace's event and drop counts.
+     */
+    MtcGoldenSuite::Result checkTraceOverhead()
+    {
+        constexpr int numRuns = 10;
+
+        MtcGoldenSuite::Result r;
+        r.name = "trace_overhead";
+        if (TraceRecorder::isRecording())
+        {
+            r.passed = true;
+            r.message = "skipped: a trace is already being recorded";
+            return r;
+        }
+
+        const auto reference = juce::File::createTempFile(".golden");
+        const auto traceFile = juce::File::createTempFile(".json");
+        juce::String difference;
+
+        auto runScript = [&](bool traced) {
+            double ms = 0.0;
+            for (int i = 0; i < numRuns; ++i)
+            {
+                MTCGenAudioProcessor processor;
+                processor.setMTCFormat(QuarterFrame);
+                processor.setClockEnabled(true);
+                MtcGoldenSuite::addSecondCue(processor);
+
+                HostSimulator sim(processor, MtcGoldenSuite::scriptSampleRate);
+                MtcGoldenSuite::addStandardScript(sim);
+
+                const auto start = juce::Time::getMillisecondCounterHiRes();
+                sim.run();
+                ms += juce::Time::getMillisecondCounterHiRes() - start;
+
+                if (i == 0 && !traced)
+                    sim.writeGolden(reference);
+                else if (i == 0 && !sim.matchesGolden(reference, difference))
+                    difference = "traced stream differs: " + difference;
+            }
+            return ms;
+        };
+
+        const double untracedMs = runScript(false);
+        if (!TraceRecorder::start(traceFile, r.message))
+        {
+            reference.deleteFile();
+            return r;
+        }
+        const double tracedMs = runScript(true);
+        TraceRecorder::stop();
+
+        const auto numEvents = TraceRecorder::getNumEvents();
+        reference.deleteFile();
+        traceFile.deleteFile();
+
+        r.passed = difference.isEmpty() && (numEvents > 0 || !MTCGEN_TRACE);
+        r.message = difference.isNotEmpty() ? difference
+            : juce::String::formatted("untraced %.1f ms, traced %.1f ms (%+.1f%%), %d events, %d dropped",
+                untracedMs, tracedMs, (tracedMs / juce::jmax(untracedMs, 1.0e-3) - 1.0) * 100.0,
+                (int)numEvents, (int)TraceRecorder::getNumDropped());
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> TraceOverheadSuite::run()
+{
+    return { checkTraceOverhead() };
+}
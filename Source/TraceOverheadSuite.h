@@ -0,0 +1,25 @@
+/**
+ * @file TraceOverheadSuite.h
+ * @brief Declaration of TraceOverheadSuite, the cost of recording a trace.
+ */
+
+#ifndef TRACEOVERHEADSUITE_H_INCLUDED
+#define TRACEOVERHEADSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class TraceOverheadSuite
+ * @brief "trace_overhead" times the standard script with and without a TraceRecorder
+ * trace running, and fails if the trace changes the stream.
+ */
+class TraceOverheadSuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // TRACEOVERHEADSUITE_H_INCLUDED
@@ -0,0 +1,336 @@
+/**
+ * @file TraceRecorder.cpp
+ * @brief Definitions for TraceRecorder methods: the per-thread rings and the flusher.
+ */
+
+#include "TraceRecorder.h"
+#include <memory>
+
+namespace
+{
+    constexpr juce::uint32 ringMask = (juce::uint32)TraceRecorder::eventsPerThread - 1;
+    static_assert((TraceRecorder::eventsPerThread & ringMask) == 0,
+        "eventsPerThread must be a power of two");
+
+    struct Event
+    {
+        juce::int64 ticks;
+        const char* name;
+        char phase;   // 'B', 'E' or 'i'
+    };
+
+    /**
+     * A slot moves Free -> Claiming -> Owned when a thread records its first event, and
+     * Owned -> Reclaiming -> Free when start() or the flusher takes it back, so the name
+     * and tid are stable whenever the flusher reads them.
+     */
+    enum SlotState { Free, Claiming, Owned, Reclaiming };
+
+    /**
+     * One thread's ring: the thread pushes at head, the flusher pops at tail. There is
+     * no thread_local (its destructor registration allocates on first use); a thread
+     * finds its slot by its id, and holds busy while it writes so a reclaim can wait
+     * for it.
+     */
+    struct ThreadBuffer
+    {
+        Event events[TraceRecorder::eventsPerThread];
+        std::atomic<juce::uint32> head{ 0 };
+        std::atomic<juce::uint32> tail{ 0 };
+        std::atomic<juce::int64> dropped{ 0 };
+        std::atomic<int> state{ Free };
+        std::atomic<juce::Thread::ThreadID> owner{ nullptr };
+        std::atomic<bool> busy{ false };
+        std::atomic<const char*> label{ nullptr };   // setThreadName(), overrides defaultName
+        const char* defaultName{ "Thread" };
+        int tid{ 0 };
+        int generation{ 0 };
+
+        // Flusher side
+        bool announced{ false };
+        const char* announcedLabel{ nullptr };
+        int idleDrains{ 0 };
+    };
+
+    ThreadBuffer buffers[TraceRecorder::maxThreads];
+    std::atomic<int> numSlotsUsed{ 0 };   // High-water mark, bounds the search
+    std::atomic<juce::int64> unclaimedDropped{ 0 };
+    std::atomic<juce::int64> numWritten{ 0 };
+    std::atomic<juce::int64> startTicks{ 0 };
+    juce::File traceFile;
+
+    /**
+     * Takes a free slot for the calling thread, returned busy. Allocation-free: the
+     * default name is a literal, and threads name themselves with setThreadName().
+     */
+    ThreadBuffer* claimSlot(juce::Thread::ThreadID self, const char* label) noexcept
+    {
+        for (int i = 0; i < TraceRecorder::maxThreads; ++i)
+        {
+            auto& b = buffers[i];
+            int expected = Free;
+            if (!b.state.compare_exchange_strong(expected, Claiming, std::memory_order_acquire))
+                continue;
+
+            b.defaultName = juce::MessageManager::existsAndIsCurrentThread() ? "Message" : "Thread";
+            // A reused slot gets a fresh tid, so the viewer does not join two threads
+            b.tid = i + 1 + b.generation++ * TraceRecorder::maxThreads;
+            b.label.store(label, std::memory_order_relaxed);
+            b.owner.store(self, std::memory_order_relaxed);
+            b.busy.store(true, std::memory_order_seq_cst);
+            b.state.store(Owned, std::memory_order_seq_cst);
+
+            auto used = numSlotsUsed.load();
+            while (used < i + 1 && !numSlotsUsed.compare_exchange_weak(used, i + 1)) {}
+            return &b;
+        }
+        return nullptr;
+    }
+
+    /**
+     * The calling thread's slot, claimed if it has none, with busy set; nullptr if every
+     * slot is taken. Setting busy before checking the state, while a reclaim sets the
+     * state before checking busy, means one of the two always sees the other.
+     */
+    ThreadBuffer* acquireSlot(const char* label) noexcept
+    {
+        const auto self = juce::Thread::getCurrentThreadId();
+        const int used = numSlotsUsed.load(std::memory_order_acquire);
+        for (int i = 0; i < used; ++i)
+        {
+            auto& b = buffers[i];
+            if (b.owner.load(std::memory_order_relaxed) != self)
+                continue;
+
+            b.busy.store(true, std::memory_order_seq_cst);
+            if (b.state.load(std::memory_order_seq_cst) == Owned
+                && b.owner.load(std::memory_order_relaxed) == self)
+                return &b;
+            b.busy.store(false, std::memory_order_release);
+        }
+        return claimSlot(self, label);
+    }
+
+    /** Takes a slot back from its thread. Only start() and the flusher call this. */
+    void reclaimSlot(ThreadBuffer& b) noexcept
+    {
+        b.state.store(Reclaiming, std::memory_order_seq_cst);
+        while (b.busy.load(std::memory_order_seq_cst))
+            juce::Thread::yield();
+
+        b.tail.store(b.head.load(std::memory_order_acquire), std::memory_order_release);
+        b.owner.store(nullptr, std::memory_order_relaxed);
+        b.announced = false;
+        b.idleDrains = 0;
+        b.state.store(Free, std::memory_order_release);
+    }
+
+    void push(const char* name, char phase) noexcept
+    {
+        auto* b = acquireSlot(nullptr);
+        if (b == nullptr)
+        {
+            unclaimedDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const auto h = b->head.load(std::memory_order_relaxed);
+        if (h - b->tail.load(std::memory_order_acquire) >= (juce::uint32)TraceRecorder::eventsPerThread)
+            b->dropped.fetch_add(1, std::memory_order_relaxed);
+        else
+        {
+            b->events[h & ringMask] = { juce::Time::getHighResolutionTicks(), name, phase };
+            b->head.store(h + 1, std::memory_order_release);
+        }
+        b->busy.store(false, std::memory_order_release);
+    }
+
+    /** Empties every ring into the file; the only consumer while a trace runs. */
+    class Flusher : public juce::Thread
+    {
+    public:
+        explicit Flusher(std::unique_ptr<juce::FileOutputStream> stream)
+            : juce::Thread("MTCGen Trace"), out(std::move(stream))
+        {
+        }
+
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                drain();
+                wait(TraceRecorder::flushIntervalMs);
+            }
+            drain();
+        }
+
+        /** Closes the JSON once the thread has stopped. */
+        void finish()
+        {
+            out->writeText("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"MTCGen\"}}\n"
+                "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":"
+                + juce::String(TraceRecorder::getNumDropped()) + "}}\n", false, false, nullptr);
+            out->flush();
+        }
+
+    private:
+        void drain()
+        {
+            const double microsPerTick = 1.0e6 / (double)juce::Time::getHighResolutionTicksPerSecond();
+            const auto origin = startTicks.load(std::memory_order_relaxed);
+            juce::MemoryOutputStream text;
+
+            for (auto& b : buffers)
+            {
+                if (b.state.load(std::memory_order_acquire) != Owned)
+                    continue;
+
+                const auto t = b.tail.load(std::memory_order_relaxed);
+                const auto h = b.head.load(std::memory_order_acquire);
+
+                if (h != t)
+                {
+                    const char* label = b.label.load(std::memory_order_relaxed);
+                    if (!b.announced || label != b.announcedLabel)
+                    {
+                        text << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b.tid
+                             << ",\"args\":{\"name\":\"" << (label != nullptr ? label : b.defaultName)
+                             << "\"}},\n";
+                        b.announced = true;
+                        b.announcedLabel = label;
+                    }
+
+                    for (auto i = t; i != h; ++i)
+                    {
+                        const auto& e = b.events[i & ringMask];
+                        text << "{\"name\":\"" << e.name << "\",\"ph\":\"" << juce::String::charToString(e.phase)
+                             << "\",\"ts\":" << juce::String((double)(e.ticks - origin) * microsPerTick, 3)
+                             << ",\"pid\":1,\"tid\":" << b.tid
+                             << (e.phase == 'i' ? ",\"s\":\"t\"},\n" : "},\n");
+                    }
+                    b.tail.store(h, std::memory_order_release);
+                    numWritten.fetch_add((juce::int64)(h - t), std::memory_order_relaxed);
+                    b.idleDrains = 0;
+                }
+                else if (++b.idleDrains * TraceRecorder::flushIntervalMs >= TraceRecorder::idleReclaimMs)
+                {
+                    // Most likely an exited thread; if not, its next event claims a new slot
+                    reclaimSlot(b);
+                }
+            }
+
+            if (text.getDataSize() > 0)
+            {
+                out->write(text.getData(), text.getDataSize());
+                out->flush();
+            }
+        }
+
+        std::unique_ptr<juce::FileOutputStream> out;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Flusher)
+    };
+
+    std::unique_ptr<Flusher> flusher;
+
+    /** Finishes a trace still running when the plug-in is unloaded. */
+    struct StopAtExit
+    {
+        ~StopAtExit() { TraceRecorder::stop(); }
+    } stopAtExit;
+}
+
+//==============================================================================
+/**
+ * @brief Frees every slot, discarding what the rings hold from before (threads that are
+ * still running claim a new one), then starts the flusher and lets the trace points
+ * record.
+ */
+bool TraceRecorder::start(const juce::File& file, juce::String& error)
+{
+    if (flusher != nullptr)
+    {
+        error = "A trace is already being recorded to " + traceFile.getFullPathName();
+        return false;
+    }
+
+    file.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+    if (!stream->openedOk())
+    {
+        error = "Could not write " + file.getFullPathName();
+        return false;
+    }
+    stream->writeText("{\"traceEvents\":[\n", false, false, nullptr);
+
+    for (auto& b : buffers)
+    {
+        if (b.state.load(std::memory_order_acquire) == Owned)
+            reclaimSlot(b);
+        b.dropped.store(0, std::memory_order_relaxed);
+    }
+
+    traceFile = file;
+    unclaimedDropped.store(0, std::memory_order_relaxed);
+    numWritten.store(0, std::memory_order_relaxed);
+    startTicks.store(juce::Time::getHighResolutionTicks(), std::memory_order_relaxed);
+
+    flusher = std::make_unique<Flusher>(std::move(stream));
+    flusher->startThread();
+    recording.store(true, std::memory_order_release);
+    return true;
+}
+
+void TraceRecorder::stop()
+{
+    if (flusher == nullptr)
+        return;
+
+    recording.store(false, std::memory_order_release);
+    flusher->stopThread(2000);
+    flusher->finish();
+    flusher.reset();
+}
+
+juce::File TraceRecorder::getFile()
+{
+    return traceFile;
+}
+
+juce::int64 TraceRecorder::getNumEvents() noexcept
+{
+    return numWritten.load(std::memory_order_relaxed);
+}
+
+juce::int64 TraceRecorder::getNumDropped() noexcept
+{
+    auto total = unclaimedDropped.load(std::memory_order_relaxed);
+    for (auto& b : buffers)
+        total += b.dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+//==============================================================================
+void TraceRecorder::begin(const char* name) noexcept
+{
+    push(name, 'B');
+}
+
+void TraceRecorder::end(const char* name) noexcept
+{
+    push(name, 'E');
+}
+
+void TraceRecorder::instant(const char* name) noexcept
+{
+    push(name, 'i');
+}
+
+void TraceRecorder::setThreadName(const char* name) noexcept
+{
+    if (auto* b = acquireSlot(name))
+    {
+        b->label.store(name, std::memory_order_relaxed);
+        b->busy.store(false, std::memory_order_release);
+    }
+}
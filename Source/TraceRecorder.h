@@ -0,0 +1,127 @@
+/**
+ * @file TraceRecorder.h
+ * @brief Declaration of TraceRecorder, an opt-in cross-thread tracer that writes Chrome
+ * trace-event JSON.
+ */
+
+#ifndef TRACERECORDER_H_INCLUDED
+#define TRACERECORDER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <atomic>
+
+/**
+ * The trace points are compiled in by default and cost one relaxed atomic load each
+ * while no trace is being recorded. Set MTCGEN_TRACE=0 in the Projucer's preprocessor
+ * definitions to compile them out entirely.
+ */
+#ifndef MTCGEN_TRACE
+ #define MTCGEN_TRACE 1
+#endif
+
+/**
+ * @class TraceRecorder
+ * @brief Records what the audio thread, the port sender threads, the message thread and
+ * the other workers were doing, for reconstructing a timecode glitch after a show.
+ *
+ * Trace points are marked with MTCGEN_TRACE_SCOPE (a begin/end pair around a block) and
+ * MTCGEN_TRACE_INSTANT. Each thread writes to its own single-producer ring of fixed
+ * size, claimed on its first event and found again by thread id, so recording never
+ * locks or allocates; a full ring drops events and counts them. A slot is freed when a
+ * trace starts or after idleReclaimMs without events, so exited threads give theirs
+ * back. A background thread
+ * drains the rings every flushIntervalMs into a Chrome trace-event JSON file, which
+ * chrome://tracing or ui.perfetto.dev opens.
+ *
+ * Event and thread names must be string literals: only the pointer is stored.
+ */
+class TraceRecorder
+{
+public:
+    static constexpr int maxThreads = 64;          /**< Threads beyond this are not traced */
+    static constexpr int eventsPerThread = 4096;   /**< Ring size per thread (power of two) */
+    static constexpr int flushIntervalMs = 50;
+    static constexpr int idleReclaimMs = 2000;     /**< Slots idle this long are freed */
+
+    /**
+     * @brief Starts recording to file, which is overwritten. Message thread.
+     * @return False if a trace is already running or the file cannot be written.
+     */
+    static bool start(const juce::File& file, juce::String& error);
+
+    /**
+     * @brief Stops recording, writes what is left and closes the file. Message thread.
+     */
+    static void stop();
+
+    /** @brief True while a trace is being recorded. Any thread. */
+    static bool isRecording() noexcept { return recording.load(std::memory_order_relaxed); }
+
+    /** @brief File of the current or last trace. */
+    static juce::File getFile();
+
+    /** @brief Events written to the file so far in the current or last trace. */
+    static juce::int64 getNumEvents() noexcept;
+
+    /** @brief Events lost to full rings (or to threads beyond maxThreads). */
+    static juce::int64 getNumDropped() noexcept;
+
+    /** @brief Records the start of a block on the calling thread. */
+    static void begin(const char* name) noexcept;
+
+    /** @brief Records the end of the block begin(name) started. */
+    static void end(const char* name) noexcept;
+
+    /** @brief Records a point event on the calling thread. */
+    static void instant(const char* name) noexcept;
+
+    /**
+     * @brief Names the calling thread in the trace; unnamed threads show as "Thread"
+     * (or "Message"). Cheap enough to call on every pass of a thread's loop, which also
+     * names it again after its slot was reclaimed.
+     */
+    static void setThreadName(const char* name) noexcept;
+
+    /**
+     * @class ScopedEvent
+     * @brief begin() on construction and end() on destruction, if a trace was running
+     * when the block started.
+     */
+    class ScopedEvent
+    {
+    public:
+        explicit ScopedEvent(const char* eventName) noexcept
+            : name(eventName), active(isRecording())
+        {
+            if (active)
+                begin(name);
+        }
+
+        ~ScopedEvent() noexcept
+        {
+            if (active)
+                end(name);
+        }
+
+    private:
+        const char* name;
+        bool active;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedEvent)
+    };
+
+private:
+    static inline std::atomic<bool> recording{ false };
+};
+
+#if MTCGEN_TRACE
+ #define MTCGEN_TRACE_SCOPE(name)   TraceRecorder::ScopedEvent JUCE_JOIN_MACRO(traceEvent_, __LINE__) (name)
+ #define MTCGEN_TRACE_INSTANT(name) do { if (TraceRecorder::isRecording()) TraceRecorder::instant (name); } while (false)
+ #define MTCGEN_TRACE_THREAD(name)  do { if (TraceRecorder::isRecording()) TraceRecorder::setThreadName (name); } while (false)
+#else
+ #define MTCGEN_TRACE_SCOPE(name)
+ #define MTCGEN_TRACE_INSTANT(name) do {} while (false)
+ #define MTCGEN_TRACE_THREAD(name)  do {} while (false)
+#endif
+
+#endif // TRACERECORDER_H_INCLUDED
@@ -0,0 +1,357 @@
+/**
+ * @file TriggerFileImporter.cpp
+ * @brief Definitions for TriggerFileImporter methods.
+ */
+
+#include "TriggerFileImporter.h"
+#include "MTCGenProcessor.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+    /** Reads big-endian fields and variable-length quantities, never past the end. */
+    struct Reader
+    {
+        const juce::uint8* pos;
+        const juce::uint8* end;
+        bool failed{ false };
+
+        size_t remaining() const noexcept { return (size_t)(end - pos); }
+
+        juce::uint8 byte() noexcept
+        {
+            if (pos >= end)
+            {
+                failed = true;
+                return 0;
+            }
+            return *pos++;
+        }
+
+        juce::uint32 bigEndian(int numBytes) noexcept
+        {
+            juce::uint32 v = 0;
+            while (--numBytes >= 0)
+                v = (v << 8) | byte();
+            return v;
+        }
+
+        juce::uint32 varLen() noexcept
+        {
+            juce::uint32 v = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                const auto b = byte();
+                v = (v << 7) | (b & 0x7f);
+                if ((b & 0x80) == 0)
+                    return v;
+            }
+            failed = true;
+            return v;
+        }
+
+        void skip(size_t numBytes) noexcept
+        {
+            if (numBytes > remaining())
+                failed = true;
+            pos += juce::jmin(numBytes, remaining());
+        }
+    };
+
+    struct TickEvent
+    {
+        juce::int64 tick;
+        juce::uint8 type;
+        juce::uint8 value;
+    };
+
+    struct TempoChange
+    {
+        juce::int64 tick;
+        juce::uint32 microsPerQuarter;
+    };
+
+    /** Walks one MTrk chunk, keeping notes, program changes and tempo changes. */
+    bool readTrack(Reader track, std::vector<TickEvent>& events, std::vector<TempoChange>& tempos)
+    {
+        juce::int64 tick = 0;
+        juce::uint8 runningStatus = 0;
+
+        while (track.remaining() > 0 && !track.failed)
+        {
+            tick += track.varLen();
+
+            juce::uint8 status = track.pos < track.end ? *track.pos : 0;
+            if ((status & 0x80) != 0)
+                ++track.pos;
+            else if ((status = runningStatus) == 0)
+                return false;
+
+            if (status == 0xff)
+            {
+                // Meta event; only tempo and end of track matter
+                const auto type = track.byte();
+                const auto length = track.varLen();
+                if (type == 0x51 && length == 3)
+                    tempos.push_back({ tick, track.bigEndian(3) });
+                else if (type == 0x2f)
+                    break;
+                else
+                    track.skip(length);
+                runningStatus = 0;
+            }
+            else if (status == 0xf0 || status == 0xf7)
+            {
+                track.skip(track.varLen());
+                runningStatus = 0;
+            }
+            else if (status > 0xf0)
+            {
+                return false;
+            }
+            else
+            {
+                runningStatus = status;
+                const auto type = (juce::uint8)(status & 0xf0);
+                const auto data1 = track.byte();
+                const auto data2 = (type == 0xc0 || type == 0xd0) ? (juce::uint8)0 : track.byte();
+
+                // A note-on with velocity 0 is a note-off
+                if (type == 0x90 && data2 > 0)
+                    events.push_back({ tick, 0x90, (juce::uint8)(data1 & 0x7f) });
+                else if (type == 0x80 || type == 0x90)
+                    events.push_back({ tick, 0x80, (juce::uint8)(data1 & 0x7f) });
+                else if (type == 0xc0)
+                    events.push_back({ tick, 0xc0, (juce::uint8)(data1 & 0x7f) });
+            }
+        }
+        return !track.failed;
+    }
+}
+
+//==============================================================================
+juce::String TriggerFileImporter::Summary::describe() const
+{
+    juce::String text = "Learned " + juce::String(numCuesLearned)
+        + (numCuesLearned == 1 ? " cue" : " cues") + " from " + juce::String(numTriggers)
+        + " events (" + juce::String(lengthSeconds, 1) + " s)";
+    if (numUnmappedNotes > 0)
+        text << "; " << numUnmappedNotes << " note-ons had no cue";
+    if (numBanksRefused > 0)
+        text << "; " << numBanksRefused << (numBanksRefused == 1 ? " bank was" : " banks were")
+             << " changed during the import and left as they were";
+    return text;
+}
+
+/**
+ * @brief Parses the header and every track chunk, then converts ticks to seconds with
+ * one walk along the sorted tempo map.
+ */
+bool TriggerFileImporter::readTriggers(const void* data, size_t numBytes,
+    std::vector<Trigger>& triggers, juce::String& error)
+{
+    Reader file{ static_cast<const juce::uint8*>(data), static_cast<const juce::uint8*>(data) + numBytes };
+    triggers.clear();
+
+    if (numBytes < 14 || std::memcmp(file.pos, "MThd", 4) != 0)
+    {
+        error = "Not a Standard MIDI File";
+        return false;
+    }
+    file.skip(4);
+    const auto headerLength = file.bigEndian(4);
+    const auto format = file.bigEndian(2);
+    const auto numTracks = file.bigEndian(2);
+    const auto division = file.bigEndian(2);
+    file.skip(headerLength > 6 ? headerLength - 6 : 0);
+
+    if (format > 1)
+    {
+        error = "MIDI file format " + juce::String(format) + " is not supported (use format 0 or 1)";
+        return false;
+    }
+    if (division == 0)
+    {
+        error = "MIDI file has no time division";
+        return false;
+    }
+
+    // A kept event takes three bytes or so (delta, running status data)
+    std::vector<TickEvent> events;
+    std::vector<TempoChange> tempos;
+    events.reserve(numBytes / 3);
+
+    for (juce::uint32 t = 0; t < numTracks && file.remaining() >= 8 && !file.failed; )
+    {
+        const bool isTrack = std::memcmp(file.pos, "MTrk", 4) == 0;
+        file.skip(4);
+        const auto length = (size_t)file.bigEndian(4);
+        if (length > file.remaining())
+        {
+            error = "MIDI file is truncated";
+            return false;
+        }
+
+        if (isTrack)
+        {
+            if (!readTrack({ file.pos, file.pos + length }, events, tempos))
+            {
+                error = "MIDI track " + juce::String((int)t + 1) + " is corrupt";
+                return false;
+            }
+            ++t;
+        }
+        file.skip(length);
+    }
+
+    // Merge the tracks; events at the same tick keep their track order
+    std::stable_sort(events.begin(), events.end(),
+        [](const TickEvent& a, const TickEvent& b) { return a.tick < b.tick; });
+    std::stable_sort(tempos.begin(), tempos.end(),
+        [](const TempoChange& a, const TempoChange& b) { return a.tick < b.tick; });
+
+    triggers.reserve(events.size());
+
+    if ((division & 0x8000) != 0)
+    {
+        // SMPTE division: frames per second (negative, -29 meaning 29.97) and ticks per frame
+        const int fps = -(int)(juce::int8)(division >> 8);
+        const double ticksPerSecond = (fps == 29 ? 29.97 : (double)fps) * (division & 0xff);
+        if (ticksPerSecond <= 0.0)
+        {
+            error = "MIDI file has an invalid SMPTE time division";
+            return false;
+        }
+        for (auto& e : events)
+            triggers.push_back({ e.tick / ticksPerSecond, e.type, e.value });
+    }
+    else
+    {
+        // Tempo map: seconds at the last change, plus ticks since then at its tempo
+        const double ppq = (double)division;
+        double segmentSeconds = 0.0;
+        juce::int64 segmentTick = 0;
+        double secondsPerTick = 0.5 / ppq;
+        size_t nextTempo = 0;
+
+        for (auto& e : events)
+        {
+            for (; nextTempo < tempos.size() && tempos[nextTempo].tick <= e.tick; ++nextTempo)
+            {
+                segmentSeconds += (tempos[nextTempo].tick - segmentTick) * secondsPerTick;
+                segmentTick = tempos[nextTempo].tick;
+                secondsPerTick = tempos[nextTempo].microsPerQuarter / (1.0e6 * ppq);
+            }
+            triggers.push_back({ segmentSeconds + (e.tick - segmentTick) * secondsPerTick,
+                                 e.type, e.value });
+        }
+    }
+
+    if (triggers.empty())
+    {
+        error = "The MIDI file has no notes or program changes";
+        return false;
+    }
+    return true;
+}
+
+//==============================================================================
+/**
+ * @brief Copies a bank the first time a trigger reaches it, edits the copies, then
+ * swaps them in through replaceBankCues(), so times learned live in the meantime
+ * survive for the cues the file does not touch.
+ */
+TriggerFileImporter::Summary TriggerFileImporter::learn(MTCGenAudioProcessor& processor,
+    const std::vector<Trigger>& triggers)
+{
+    auto& banks = processor.getBanks();
+    const int numBanks = banks.getNumBanks();
+    std::vector<std::unique_ptr<CueStore>> edited((size_t)numBanks);
+    std::vector<const CueStore*> sources((size_t)numBanks);
+    std::vector<std::vector<CueStore::CueId>> touched((size_t)numBanks);
+
+    Summary summary;
+    summary.numTriggers = (int)triggers.size();
+    int bank = banks.getActiveIndex();
+
+    for (auto& t : triggers)
+    {
+        summary.lengthSeconds = t.seconds;
+
+        if (t.type == 0xc0)
+        {
+            if (t.value < numBanks)
+                bank = t.value;
+            continue;
+        }
+
+        auto& cues = edited[(size_t)bank];
+        if (cues == nullptr)
+        {
+            sources[(size_t)bank] = &banks.getBank(bank);
+            cues = std::make_unique<CueStore>();
+            cues->copyFrom(*sources[(size_t)bank]);
+        }
+
+        const int i = cues->findNote(t.value);
+        if (i < 0)
+        {
+            if (t.type == 0x90)
+                ++summary.numUnmappedNotes;
+            continue;
+        }
+
+        if (t.type == 0x90)
+        {
+            cues->setDetectedStartTime(i, t.seconds);
+            cues->setDetectedEndTime(i, -1.0);
+        }
+        else
+        {
+            cues->setDetectedEndTime(i, t.seconds);
+        }
+        cues->setIsActive(i, false);
+        touched[(size_t)bank].push_back(cues->getCueId(i));
+    }
+
+    for (int b = 0; b < numBanks; ++b)
+    {
+        auto& ids = touched[(size_t)b];
+        if (ids.empty())
+            continue;
+
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        if (processor.replaceBankCues(b, *sources[(size_t)b], std::move(edited[(size_t)b]), ids))
+            summary.numCuesLearned += (int)ids.size();
+        else
+            ++summary.numBanksRefused;
+    }
+    return summary;
+}
+
+bool TriggerFileImporter::importFile(MTCGenAudioProcessor& processor, const juce::File& file,
+    Summary& summary, juce::String& error)
+{
+    juce::MemoryBlock data;
+    if (!file.loadFileAsData(data))
+    {
+        error = "Could not read " + file.getFullPathName();
+        return false;
+    }
+
+    std::vector<Trigger> triggers;
+    if (!readTriggers(data.getData(), data.getSize(), triggers, error))
+        return false;
+
+    summary = learn(processor, triggers);
+    if (summary.numBanksRefused > 0)
+    {
+        error = summary.describe() + ". Import the file again.";
+        return false;
+    }
+    return true;
+}
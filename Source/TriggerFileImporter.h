@@ -0,0 +1,78 @@
+/**
+ * @file TriggerFileImporter.h
+ * @brief Declaration of the TriggerFileImporter class (learn cue windows from a MIDI file).
+ */
+
+#ifndef TRIGGERFILEIMPORTER_H_INCLUDED
+#define TRIGGERFILEIMPORTER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+
+class MTCGenAudioProcessor;
+
+/**
+ * @class TriggerFileImporter
+ * @brief Learns cue start/end times in bulk from a Standard MIDI File, such as the
+ * host's exported trigger track, instead of playing through the whole show.
+ *
+ * The file is read in one pass straight from memory: the tracks are walked event by
+ * event and only note-on/off, program change and tempo events are kept, as small
+ * records. The note and program events of every track are then merged in tick order
+ * and converted to seconds along the tempo map (or the SMPTE division).
+ *
+ * learn() plays the triggers against the cue banks exactly as live MIDI from host
+ * time 0 would (see MTCGenAudioProcessor::startMappingForNote()): a note-on sets its
+ * cue's start and clears its end, a note-off sets the end, and a program change
+ * switches the bank the following notes belong to, starting from the active bank. The
+ * edits are made on copies of the banks, which are then swapped in, so playback sees
+ * each bank either before or after the import.
+ */
+class TriggerFileImporter
+{
+public:
+    /** @brief One trigger, in file time. */
+    struct Trigger
+    {
+        double seconds;      /**< Time from the start of the file, tempo map applied */
+        juce::uint8 type;    /**< 0x90 note-on, 0x80 note-off or 0xc0 program change */
+        juce::uint8 value;   /**< Note or program number */
+    };
+
+    /** @brief What an import did. */
+    struct Summary
+    {
+        int numTriggers{ 0 };       /**< Note and program change events in the file */
+        int numCuesLearned{ 0 };    /**< Cues whose start or end was set */
+        int numUnmappedNotes{ 0 };  /**< Note-ons no cue of their bank maps */
+        int numBanksRefused{ 0 };   /**< Banks replaced during the import, left as they were */
+        double lengthSeconds{ 0.0 }; /**< Time of the last trigger */
+
+        /** @brief One-line description for a message box or the console. */
+        juce::String describe() const;
+    };
+
+    /**
+     * @brief Parses a format 0 or 1 Standard MIDI File into triggers in time order.
+     * Any thread.
+     * @param error Set to a description of the failure.
+     * @return False if the data is not a usable MIDI file.
+     */
+    static bool readTriggers(const void* data, size_t numBytes, std::vector<Trigger>& triggers,
+        juce::String& error);
+
+    /**
+     * @brief Sets the learned times of every cue the triggers reach. Message thread.
+     */
+    static Summary learn(MTCGenAudioProcessor& processor, const std::vector<Trigger>& triggers);
+
+    /**
+     * @brief Reads a file and learns from it. Message thread.
+     * @return False if the file could not be read or parsed, or a bank was replaced while
+     *         its times were learned (see Summary::numBanksRefused).
+     */
+    static bool importFile(MTCGenAudioProcessor& processor, const juce::File& file,
+        Summary& summary, juce::String& error);
+};
+
+#endif // TRIGGERFILEIMPORTER_H_INCLUDED
@@ -0,0 +1,405 @@
+/**
+ * @file TriggerImportSuite.cpp
+ * @brief Definitions for TriggerImportSuite methods.
+ */
+
+#include "TriggerImportSuite.h"
+#include "MTCGenProcessor.h"
+#include "TriggerFileImporter.h"
+#include <cmath>
+#include <initializer_list>
+
+namespace
+{
+    using Bytes = std::vector<juce::uint8>;
+    using Trigger = TriggerFileImporter::Trigger;
+
+    void appendBigEndian(Bytes& out, juce::uint32 value, int numBytes)
+    {
+        while (--numBytes >= 0)
+            out.push_back((juce::uint8)(value >> (8 * numBytes)));
+    }
+
+    void appendVarLen(Bytes& out, juce::uint32 value)
+    {
+        juce::uint8 groups[5];
+        int n = 0;
+        groups[n++] = (juce::uint8)(value & 0x7f);
+        while ((value >>= 7) != 0)
+            groups[n++] = (juce::uint8)(0x80 | (value & 0x7f));
+        while (n > 0)
+            out.push_back(groups[--n]);
+    }
+
+    /** An MTrk body written event by event at absolute ticks. */
+    struct Track
+    {
+        Bytes bytes;
+        juce::int64 lastTick{ 0 };
+
+        /** Appends the delta time and the raw bytes, so running status is up to the caller. */
+        void event(juce::int64 tick, std::initializer_list<juce::uint8> data)
+        {
+            appendVarLen(bytes, (juce::uint32)(tick - lastTick));
+            lastTick = tick;
+            bytes.insert(bytes.end(), data);
+        }
+
+        void tempo(juce::int64 tick, juce::uint32 microsPerQuarter)
+        {
+            event(tick, { 0xff, 0x51, 0x03, (juce::uint8)(microsPerQuarter >> 16),
+                          (juce::uint8)(microsPerQuarter >> 8), (juce::uint8)microsPerQuarter });
+        }
+
+        Bytes finish()
+        {
+            event(lastTick, { 0xff, 0x2f, 0x00 });
+            return bytes;
+        }
+    };
+
+    Bytes makeFile(int format, juce::uint16 division, const std::vector<Bytes>& tracks)
+    {
+        Bytes file{ 'M', 'T', 'h', 'd' };
+        appendBigEndian(file, 6, 4);
+        appendBigEndian(file, (juce::uint32)format, 2);
+        appendBigEndian(file, (juce::uint32)tracks.size(), 2);
+        appendBigEndian(file, division, 2);
+        for (auto& track : tracks)
+        {
+            file.insert(file.end(), { 'M', 'T', 'r', 'k' });
+            appendBigEndian(file, (juce::uint32)track.size(), 4);
+            file.insert(file.end(), track.begin(), track.end());
+        }
+        return file;
+    }
+
+    bool readTriggers(const Bytes& file, std::vector<Trigger>& triggers, juce::String& error)
+    {
+        return TriggerFileImporter::readTriggers(file.data(), file.size(), triggers, error);
+    }
+
+    /** Empty if the triggers match, else the first difference. Times agree to 1 ns. */
+    juce::String compareTriggers(const std::vector<Trigger>& actual, const std::vector<Trigger>& expected)
+    {
+        for (size_t i = 0; i < juce::jmin(actual.size(), expected.size()); ++i)
+        {
+            const auto& a = actual[i];
+            const auto& e = expected[i];
+            if (a.type != e.type || a.value != e.value || std::abs(a.seconds - e.seconds) > 1.0e-9)
+                return juce::String::formatted("trigger %d: %02x %d at %.9f s, expected %02x %d at %.9f s",
+                    (int)i, a.type, a.value, a.seconds, e.type, e.value, e.seconds);
+        }
+        if (actual.size() != expected.size())
+            return juce::String((int)actual.size()) + " triggers, expected " + juce::String((int)expected.size());
+        return {};
+    }
+
+    /** Empty if the learned window of the cue mapped to note in bank is [start, end]. */
+    juce::String checkWindow(MTCGenAudioProcessor& processor, int bank, int note,
+        double start, double end)
+    {
+        auto& cues = processor.getBanks().getBank(bank);
+        const int i = cues.findNote(note);
+        if (i < 0)
+            return "bank " + juce::String(bank) + " has no cue for note " + juce::String(note);
+        if (std::abs(cues.getDetectedStartTime(i) - start) > 1.0e-9
+            || std::abs(cues.getDetectedEndTime(i) - end) > 1.0e-9)
+            return juce::String::formatted("bank %d note %d learned %.6f..%.6f, expected %.6f..%.6f",
+                bank, note, cues.getDetectedStartTime(i), cues.getDetectedEndTime(i), start, end);
+        return {};
+    }
+
+    //==============================================================================
+    /**
+     * Format 0 at 480 ticks per quarter and the default 120 bpm (0.5 s per quarter). Only
+     * the first event carries a status byte per run; a velocity-0 note-on ends note 60.
+     */
+    MtcGoldenSuite::Result checkRunningStatus()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "import_running_status";
+
+        Track t;
+        t.event(0, { 0x90, 60, 100 });
+        t.event(480, { 60, 0 });           // running status, velocity 0: note-off
+        t.event(480, { 62, 100 });         // running status note-on
+        t.event(1440, { 0x80, 62, 64 });
+        t.event(1440, { 0xc1, 1 });        // program change, any channel
+        t.event(1920, { 64 });             // running status with one data byte
+        const auto file = makeFile(0, 480, { t.finish() });
+
+        std::vector<Trigger> triggers;
+        if (!readTriggers(file, triggers, r.message))
+            return r;
+
+        r.message = compareTriggers(triggers, {
+            { 0.0, 0x90, 60 }, { 0.5, 0x80, 60 }, { 0.5, 0x90, 62 },
+            { 1.5, 0x80, 62 }, { 1.5, 0xc0, 1 }, { 2.0, 0xc0, 64 } });
+        r.passed = r.message.isEmpty();
+        return r;
+    }
+
+    /**
+     * Format 1 at 96 ticks per quarter: a tempo track (120 bpm, 60 bpm from tick 192,
+     * 240 bpm from tick 288) and two trigger tracks, one switching to bank 1 at the tick
+     * the other ends note 60. Bank 0 maps notes 60 and 64, bank 1 notes 62 and 64.
+     */
+    MtcGoldenSuite::Result checkFormat1Tempo()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "import_format1_tempo";
+
+        Track tempo;
+        tempo.tempo(0, 500000);
+        tempo.tempo(192, 1000000);
+        tempo.tempo(288, 250000);
+
+        Track notes;
+        notes.event(96, { 0x90, 60, 100 });
+        notes.event(240, { 0x80, 60, 0 });
+        notes.event(336, { 0x90, 62, 100 });
+        notes.event(360, { 0x90, 65, 100 });
+        notes.event(370, { 0x90, 65, 0 });
+        notes.event(384, { 0x80, 62, 0 });
+
+        Track other;
+        other.event(0, { 0x90, 64, 100 });
+        other.event(200, { 0x80, 64, 0 });
+        other.event(240, { 0xc0, 1 });
+
+        const auto file = makeFile(1, 96, { tempo.finish(), notes.finish(), other.finish() });
+
+        std::vector<Trigger> triggers;
+        if (!readTriggers(file, triggers, r.message))
+            return r;
+
+        // 0.5 s per quarter to tick 192 (1 s), 1 s per quarter to tick 288 (2 s), then 0.25 s
+        r.message = compareTriggers(triggers, {
+            { 0.0, 0x90, 64 },
+            { 0.5, 0x90, 60 },
+            { 1.0 + 8.0 / 96.0, 0x80, 64 },
+            { 1.5, 0x80, 60 },               // same tick: the earlier track first
+            { 1.5, 0xc0, 1 },
+            { 2.125, 0x90, 62 },
+            { 2.1875, 0x90, 65 },
+            { 2.0 + 82.0 * 0.25 / 96.0, 0x80, 65 },
+            { 2.25, 0x80, 62 } });
+        if (r.message.isNotEmpty())
+            return r;
+
+        MTCGenAudioProcessor processor;    // bank 0 starts with a cue for note 60
+        processor.editActiveCues([](CueStore& cues) { cues.add(MappingEntry("01:01:00:00", 64)); });
+        processor.addBank("Bank 2");
+        processor.selectBank(1);
+        processor.editActiveCues([](CueStore& cues) {
+            cues.add(MappingEntry("02:00:00:00", 62));
+            cues.add(MappingEntry("02:01:00:00", 64));
+            });
+        processor.selectBank(0);
+
+        const auto summary = TriggerFileImporter::learn(processor, triggers);
+        for (auto& problem : { checkWindow(processor, 0, 60, 0.5, 1.5),
+                               checkWindow(processor, 0, 64, 0.0, 1.0 + 8.0 / 96.0),
+                               checkWindow(processor, 1, 62, 2.125, 2.25),
+                               checkWindow(processor, 1, 64, -1.0, -1.0) })
+            if (problem.isNotEmpty())
+            {
+                r.message = problem;
+                return r;
+            }
+
+        if (summary.numTriggers != 9 || summary.numCuesLearned != 3 || summary.numUnmappedNotes != 1
+            || std::abs(summary.lengthSeconds - 2.25) > 1.0e-9
+            || processor.getBanks().getActiveIndex() != 0)
+        {
+            r.message = "unexpected summary: " + summary.describe();
+            return r;
+        }
+
+        r.passed = true;
+        r.message = summary.describe();
+        return r;
+    }
+
+    /** SMPTE divisions: 25 fps at 40 ticks per frame, and 29.97 (-29) at 80. */
+    MtcGoldenSuite::Result checkSmpte()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "import_smpte";
+
+        Track t25;
+        t25.event(1000, { 0x90, 60, 100 });
+        t25.event(2500, { 0x80, 60, 0 });
+
+        std::vector<Trigger> triggers;
+        if (!readTriggers(makeFile(0, 0xe728, { t25.finish() }), triggers, r.message))
+            return r;
+        r.message = compareTriggers(triggers, { { 1.0, 0x90, 60 }, { 2.5, 0x80, 60 } });
+        if (r.message.isNotEmpty())
+        {
+            r.message = "25 fps: " + r.message;
+            return r;
+        }
+
+        Track t2997;
+        t2997.event(23976, { 0x90, 61, 100 });   // 10 s at 29.97 * 80 ticks per second
+        if (!readTriggers(makeFile(0, 0xe350, { t2997.finish() }), triggers, r.message))
+            return r;
+        r.message = compareTriggers(triggers, { { 10.0, 0x90, 61 } });
+        if (r.message.isNotEmpty())
+        {
+            r.message = "29.97 fps: " + r.message;
+            return r;
+        }
+
+        r.passed = true;
+        return r;
+    }
+
+    /**
+     * Files readTriggers() must refuse, each with the error it should give, and every
+     * proper prefix of a valid file, which must all fail without reading past the end.
+     */
+    MtcGoldenSuite::Result checkRejects()
+    {
+        MtcGoldenSuite::Result r;
+        r.name = "import_rejects";
+
+        auto trackOf = [](std::initializer_list<juce::uint8> body) {
+            Track t;
+            t.bytes.assign(body);
+            return t.finish();
+        };
+
+        Track valid;
+        valid.event(0, { 0x90, 60, 100 });
+        valid.event(480, { 0x80, 60, 0 });
+        const auto validFile = makeFile(0, 480, { valid.finish() });
+
+        auto truncated = validFile;
+        truncated.resize(truncated.size() - 5);
+
+        struct Case
+        {
+            const char* what;
+            Bytes file;
+            const char* error;
+        };
+
+        const std::vector<Case> cases = {
+            { "not a MIDI file", Bytes{ 'R', 'I', 'F', 'F', 0, 0, 0, 6, 0, 0, 0, 1, 1, 0xe0 }, "Not a Standard MIDI File" },
+            { "format 2", makeFile(2, 480, { trackOf({ 0x00, 0x90, 60, 100 }) }), "format 2" },
+            { "division 0", makeFile(0, 0, { trackOf({ 0x00, 0x90, 60, 100 }) }), "no time division" },
+            { "truncated", truncated, "truncated" },
+            { "data byte first", makeFile(0, 480, { trackOf({ 0x00, 60, 100 }) }), "corrupt" },
+            { "data after meta", makeFile(0, 480, { trackOf({ 0x00, 0x90, 60, 100, 0x00, 0xff, 0x01, 0x00, 0x00, 60, 0 }) }), "corrupt" },
+            { "system common", makeFile(0, 480, { trackOf({ 0x00, 0xf2, 0x00, 0x00 }) }), "corrupt" },
+            { "5-byte delta", makeFile(0, 480, { trackOf({ 0x80, 0x80, 0x80, 0x80, 0x00, 0x90, 60, 100 }) }), "corrupt" },
+            { "cut note", makeFile(0, 480, { Bytes{ 0x00, 0x90, 60 } }), "corrupt" },
+            { "no notes", makeFile(0, 480, { trackOf({}) }), "no notes" },
+            { "SMPTE 0 ticks", makeFile(0, 0xe700, { trackOf({ 0x00, 0x90, 60, 100 }) }), "invalid SMPTE" },
+        };
+
+        std::vector<Trigger> triggers;
+        for (auto& c : cases)
+        {
+            juce::String error;
+            if (readTriggers(c.file, triggers, error) || !error.contains(c.error))
+            {
+                r.message = juce::String(c.what) + ": expected \"" + c.error + "\", got \"" + error + "\"";
+                return r;
+            }
+        }
+
+        // Each prefix is copied, so reading past its end would touch memory it does not own
+        for (size_t length = 0; length < validFile.size(); ++length)
+        {
+            const Bytes prefix(validFile.begin(), validFile.begin() + (std::ptrdiff_t)length);
+            juce::String error;
+            if (readTriggers(prefix, triggers, error))
+            {
+                r.message = "accepted the first " + juce::String((int)length) + " bytes of a valid file";
+                return r;
+            }
+        }
+
+        r.passed = true;
+        r.message = juce::String((int)cases.size()) + " bad files and "
+            + juce::String((int)validFile.size()) + " prefixes rejected";
+        return r;
+    }
+
+    /**
+     * 50,000 note on/off pairs on a 480-tick grid, with the tempo alternating between
+     * 120 and 90 bpm every bar, learned into a bank mapping all 128 notes. Fails if
+     * the last trigger's time differs from the tempo map summed bar by bar, or if parsing
+     * and learning take a second or more: the editor imports on the message thread.
+     */
+    MtcGoldenSuite::Result checkLargeImport()
+    {
+        constexpr int numPairs = 50000;
+        constexpr double maxMs = 1000.0;
+        constexpr int ppq = 480;
+        constexpr int bar = 4 * ppq;
+        constexpr juce::uint32 tempos[] = { 500000, 666667 };
+
+        MtcGoldenSuite::Result r;
+        r.name = "import_100k";
+
+        const juce::int64 lastTick = (juce::int64)(numPairs - 1) * ppq + ppq / 2;
+        Track tempo, notes;
+        for (juce::int64 tick = 0, b = 0; tick <= lastTick; tick += bar, ++b)
+            tempo.tempo(tick, tempos[b % 2]);
+        for (int i = 0; i < numPairs; ++i)
+        {
+            const auto note = (juce::uint8)(i % 128);
+            notes.event((juce::int64)i * ppq, { 0x90, note, 100 });
+            notes.event((juce::int64)i * ppq + ppq / 2, { 0x80, note, 0 });
+        }
+        const auto file = makeFile(1, ppq, { tempo.finish(), notes.finish() });
+
+        std::vector<Trigger> triggers;
+        const auto parseStart = juce::Time::getMillisecondCounterHiRes();
+        if (!readTriggers(file, triggers, r.message))
+            return r;
+        const auto parseMs = juce::Time::getMillisecondCounterHiRes() - parseStart;
+
+        double expectedLast = 0.0;
+        for (juce::int64 tick = 0, b = 0; tick <= lastTick; tick += bar, ++b)
+            expectedLast += (double)juce::jmin((juce::int64)bar, lastTick - tick) * tempos[b % 2] / (1.0e6 * ppq);
+
+        if ((int)triggers.size() != 2 * numPairs
+            || std::abs(triggers.back().seconds - expectedLast) > 1.0e-6)
+        {
+            r.message = juce::String::formatted("%d triggers, last at %.6f s; expected %d at %.6f s",
+                (int)triggers.size(), triggers.empty() ? 0.0 : triggers.back().seconds,
+                2 * numPairs, expectedLast);
+            return r;
+        }
+
+        MTCGenAudioProcessor processor;
+        processor.editActiveCues([](CueStore& cues) {
+            for (int note = 0; note < 128; ++note)
+                if (cues.findNote(note) < 0)
+                    cues.add(MappingEntry("01:00:00:00", note));
+            });
+
+        const auto learnStart = juce::Time::getMillisecondCounterHiRes();
+        const auto summary = TriggerFileImporter::learn(processor, triggers);
+        const auto learnMs = juce::Time::getMillisecondCounterHiRes() - learnStart;
+
+        r.passed = summary.numCuesLearned == 128 && summary.numUnmappedNotes == 0
+            && summary.numBanksRefused == 0 && parseMs + learnMs < maxMs;
+        r.message = juce::String::formatted("%d events (%d KB): parse %.1f ms, learn %.1f ms (limit %.0f ms together); ",
+            (int)triggers.size(), (int)(file.size() / 1024), parseMs, learnMs, maxMs) + summary.describe();
+        return r;
+    }
+}
+
+//==============================================================================
+std::vector<MtcGoldenSuite::Result> TriggerImportSuite::run()
+{
+    return { checkRunningStatus(), checkFormat1Tempo(), checkSmpte(), checkRejects(),
+             checkLargeImport() };
+}
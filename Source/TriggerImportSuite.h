@@ -0,0 +1,33 @@
+/**
+ * @file TriggerImportSuite.h
+ * @brief Declaration of TriggerImportSuite, checks of the MIDI file trigger importer.
+ */
+
+#ifndef TRIGGERIMPORTSUITE_H_INCLUDED
+#define TRIGGERIMPORTSUITE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MtcGoldenSuite.h"
+
+/**
+ * @class TriggerImportSuite
+ * @brief Feeds TriggerFileImporter Standard MIDI Files built in memory:
+ *
+ * - "import_running_status": running status, velocity-0 note-offs and one-byte
+ *   program changes under running status
+ * - "import_format1_tempo": three tracks merged in tick order against a tempo map, and
+ *   the cue times learn() sets in each bank
+ * - "import_smpte": 25 fps and 29.97 fps SMPTE divisions
+ * - "import_rejects": truncated and corrupt files, and every prefix of a valid one
+ * - "import_100k": a 100,000-event file through readTriggers() and learn(), together
+ *   in under a second
+ */
+class TriggerImportSuite
+{
+public:
+    /** @brief Runs every case of the suite. */
+    static std::vector<MtcGoldenSuite::Result> run();
+};
+
+#endif // TRIGGERIMPORTSUITE_H_INCLUDED